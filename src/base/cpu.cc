@@ -8,6 +8,7 @@
 
 #include <algorithm>
 
+#include "base/basictypes.h"
 #include "build/build_config.h"
 
 #if defined(ARCH_CPU_X86_FAMILY)
@@ -33,6 +34,8 @@ CPU::CPU()
     has_ssse3_(false),
     has_sse41_(false),
     has_sse42_(false),
+    has_avx_(false),
+    has_avx2_(false),
     has_non_stop_time_stamp_counter_(false),
     cpu_vendor_("unknown") {
   Initialize();
@@ -83,6 +86,21 @@ void __cpuidex(int cpu_info[4], int info_type, int info_index) {
 
 #endif
 #endif  // _MSC_VER
+
+// Returns the contents of the extended control register |xcr|.
+uint64 xgetbv(uint32 xcr) {
+#if defined(_MSC_VER)
+  return _xgetbv(xcr);
+#else
+  uint32 eax, edx;
+  __asm__ volatile (
+    "xgetbv \n\t"
+    : "=a"(eax), "=d"(edx)
+    : "c"(xcr)
+  );
+  return (static_cast<uint64>(edx) << 32) | eax;
+#endif
+}
 #endif  // ARCH_CPU_X86_FAMILY
 
 void CPU::Initialize() {
@@ -120,7 +138,18 @@ void CPU::Initialize() {
     has_ssse3_ = (cpu_info[2] & 0x00000200) != 0;
     has_sse41_ = (cpu_info[2] & 0x00080000) != 0;
     has_sse42_ = (cpu_info[2] & 0x00100000) != 0;
-    has_avx_ = (cpu_info[2] & 0x10000000) != 0;
+    // AVX instructions fault unless the OS saves the YMM registers on
+    // context switches, which it advertises through OSXSAVE and XCR0.
+    has_avx_ = (cpu_info[2] & 0x10000000) != 0 &&
+        (cpu_info[2] & 0x08000000) != 0 &&
+        (xgetbv(0) & 6) == 6;
+  }
+
+  // AVX2 is reported in the extended features leaf, and needs the same OS
+  // support for the YMM registers as AVX.
+  if (num_ids >= 7) {
+    __cpuidex(cpu_info, 7, 0);
+    has_avx2_ = has_avx_ && (cpu_info[1] & 0x00000020) != 0;
   }
 
   // Get the brand string of the cpu.
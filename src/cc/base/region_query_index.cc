@@ -0,0 +1,70 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/base/region_query_index.h"
+
+#include <algorithm>
+
+namespace cc {
+
+namespace {
+
+bool BottomAtOrAbove(const gfx::Rect& rect, int y) {
+  return rect.bottom() <= y;
+}
+
+}  // namespace
+
+RegionQueryIndex::RegionQueryIndex() {}
+
+RegionQueryIndex::~RegionQueryIndex() {}
+
+void RegionQueryIndex::SubtractFrom(const Region& region, Region* target) {
+  gfx::Rect bounds = target->bounds();
+  if (bounds.IsEmpty() || !bounds.Intersects(region.bounds()))
+    return;
+
+  UpdateFor(region);
+  for (RectIterator it = FirstCandidate(bounds);
+       it != rects_.end() && it->y() < bounds.bottom();
+       ++it) {
+    if (it->Intersects(bounds))
+      target->Subtract(*it);
+  }
+}
+
+bool RegionQueryIndex::Intersects(const Region& region, gfx::Rect rect) {
+  if (rect.IsEmpty() || !rect.Intersects(region.bounds()))
+    return false;
+
+  UpdateFor(region);
+  for (RectIterator it = FirstCandidate(rect);
+       it != rects_.end() && it->y() < rect.bottom();
+       ++it) {
+    if (it->Intersects(rect))
+      return true;
+  }
+  return false;
+}
+
+void RegionQueryIndex::UpdateFor(const Region& region) {
+  // Copies of a Region share their rects, so this is cheap when |region| is
+  // the one the index was built from.
+  if (region == indexed_region_)
+    return;
+
+  indexed_region_ = region;
+  rects_.clear();
+  for (Region::Iterator it(region); it.has_rect(); it.next())
+    rects_.push_back(it.rect());
+}
+
+RegionQueryIndex::RectIterator RegionQueryIndex::FirstCandidate(
+    gfx::Rect rect) const {
+  // The bottoms of the rects never decrease, since the bands don't overlap.
+  return std::lower_bound(
+      rects_.begin(), rects_.end(), rect.y(), BottomAtOrAbove);
+}
+
+}  // namespace cc
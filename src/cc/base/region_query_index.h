@@ -0,0 +1,49 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CC_BASE_REGION_QUERY_INDEX_H_
+#define CC_BASE_REGION_QUERY_INDEX_H_
+
+#include <vector>
+
+#include "cc/base/cc_export.h"
+#include "cc/base/region.h"
+#include "ui/gfx/rect.h"
+
+namespace cc {
+
+// Finds the rects of a Region that intersect a query rect without walking
+// the whole Region. A Region's rects come in horizontal bands, sorted from
+// top to bottom, that do not overlap vertically, so the bands touching a
+// query are found by binary search. The index is rebuilt when it is queried
+// with a Region other than the one it was built from; querying the same,
+// unmodified Region repeatedly is cheap.
+class CC_EXPORT RegionQueryIndex {
+ public:
+  RegionQueryIndex();
+  ~RegionQueryIndex();
+
+  // Subtracts |region| from |target|, only looking at the rects of |region|
+  // which intersect the bounds of |target|.
+  void SubtractFrom(const Region& region, Region* target);
+
+  // Returns true if |rect| intersects |region|.
+  bool Intersects(const Region& region, gfx::Rect rect);
+
+ private:
+  typedef std::vector<gfx::Rect>::const_iterator RectIterator;
+
+  void UpdateFor(const Region& region);
+  // Returns the first rect ending below the top of |rect|. Any rects that
+  // intersect |rect| follow it, before the first rect starting at or below
+  // the bottom of |rect|.
+  RectIterator FirstCandidate(gfx::Rect rect) const;
+
+  Region indexed_region_;
+  std::vector<gfx::Rect> rects_;
+};
+
+}  // namespace cc
+
+#endif  // CC_BASE_REGION_QUERY_INDEX_H_
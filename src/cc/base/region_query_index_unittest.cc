@@ -0,0 +1,74 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/base/region_query_index.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace cc {
+namespace {
+
+// A checkerboard, so the region has many bands of many rects each.
+Region MakeCheckerboard(int cells, int cell_size) {
+  Region region;
+  for (int y = 0; y < cells; ++y) {
+    for (int x = y % 2; x < cells; x += 2)
+      region.Union(gfx::Rect(x * cell_size, y * cell_size, cell_size,
+                             cell_size));
+  }
+  return region;
+}
+
+void ExpectMatchesRegion(const Region& region, RegionQueryIndex* index) {
+  for (int y = -15; y < 120; y += 7) {
+    for (int x = -15; x < 120; x += 11) {
+      for (int size = 1; size < 40; size += 13) {
+        gfx::Rect query(x, y, size, size + 3);
+
+        Region expected = query;
+        expected.Subtract(region);
+        Region actual = query;
+        index->SubtractFrom(region, &actual);
+        EXPECT_EQ(expected.ToString(), actual.ToString())
+            << "query " << query.ToString();
+
+        EXPECT_EQ(region.Intersects(query), index->Intersects(region, query))
+            << "query " << query.ToString();
+      }
+    }
+  }
+}
+
+TEST(RegionQueryIndexTest, MatchesRegion) {
+  RegionQueryIndex index;
+  ExpectMatchesRegion(MakeCheckerboard(10, 10), &index);
+}
+
+TEST(RegionQueryIndexTest, EmptyRegion) {
+  RegionQueryIndex index;
+  Region empty;
+  Region target = gfx::Rect(0, 0, 10, 10);
+  index.SubtractFrom(empty, &target);
+  EXPECT_EQ(gfx::Rect(0, 0, 10, 10).ToString(), target.ToString());
+  EXPECT_FALSE(index.Intersects(empty, gfx::Rect(0, 0, 10, 10)));
+}
+
+TEST(RegionQueryIndexTest, RebuildsWhenRegionChanges) {
+  RegionQueryIndex index;
+  Region region = MakeCheckerboard(10, 10);
+  ExpectMatchesRegion(region, &index);
+
+  region.Union(gfx::Rect(5, 5, 50, 20));
+  ExpectMatchesRegion(region, &index);
+
+  region.Subtract(gfx::Rect(0, 0, 60, 60));
+  ExpectMatchesRegion(region, &index);
+
+  // A different region with the same rect count.
+  Region other = MakeCheckerboard(10, 11);
+  ExpectMatchesRegion(other, &index);
+}
+
+}  // namespace
+}  // namespace cc
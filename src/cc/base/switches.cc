@@ -72,6 +72,20 @@ const char kMaxUnusedResourceMemoryUsagePercentage[] =
 // Requires --enable-compositor-frame-message.
 const char kCompositeToMailbox[] = "composite-to-mailbox";
 
+// Let idle raster threads help rasterize large tiles that another raster
+// thread is working on.
+const char kEnableParallelTileRaster[] = "enable-parallel-tile-raster";
+
+// With software compositing, keep a compressed copy of tiles that are
+// evicted to stay within the memory budget, so they can be restored without
+// rasterizing them again.
+const char kEnableCompressedTiles[] = "enable-compressed-tiles";
+
+// Reuse the draw properties of layer subtrees that did not change since the
+// last frame instead of recomputing them for the whole tree.
+const char kEnableIncrementalDrawProperties[] =
+    "enable-incremental-draw-properties";
+
 // Check that property changes during paint do not occur.
 const char kStrictLayerPropertyChangeChecking[] =
     "strict-layer-property-change-checking";
@@ -36,6 +36,9 @@ CC_EXPORT extern const char kMaxTilesForInterestArea[];
 CC_EXPORT extern const char kMaxUnusedResourceMemoryUsagePercentage[];
 CC_EXPORT extern const char kEnablePinchVirtualViewport[];
 CC_EXPORT extern const char kEnablePartialSwap[];
+CC_EXPORT extern const char kEnableParallelTileRaster[];
+CC_EXPORT extern const char kEnableCompressedTiles[];
+CC_EXPORT extern const char kEnableIncrementalDrawProperties[];
 CC_EXPORT extern const char kStrictLayerPropertyChangeChecking[];
 CC_EXPORT extern const char kUseMapImage[];
 
@@ -99,6 +99,127 @@ struct CC_EXPORT DrawProperties {
   bool layer_or_descendant_has_copy_request;
 };
 
+// What CalculateDrawProperties last computed a layer's subtree from, and the
+// parts of the result that are not kept in the subtree's DrawProperties. When
+// no layer in the subtree has changed and the inputs are the same, the subtree
+// is added to the render surface layer list again without recomputing it.
+template <typename LayerType, typename RenderSurfaceType>
+struct CC_EXPORT SubtreeDrawPropertiesCache {
+  // How the last update of the subtree ended.
+  enum Outcome {
+    // The subtree was skipped before any of it was added to a list.
+    SUBTREE_SKIPPED,
+    // The subtree was visited, but the layer's surface was removed again as
+    // nothing in it was drawable. Nothing in the subtree was added to a list.
+    SURFACE_REMOVED,
+    // The layer and its drawable descendants were added to the lists.
+    SUBTREE_ADDED,
+  };
+
+  struct Inputs {
+    Inputs()
+        : fixed_container(NULL),
+          ancestor_clips_subtree(false),
+          nearest_ancestor_that_moves_pixels(NULL),
+          max_texture_size(0),
+          device_scale_factor(1.f),
+          page_scale_factor(1.f),
+          page_scale_application_layer(NULL),
+          in_subtree_of_page_scale_application_layer(false),
+          subtree_can_use_lcd_text(false),
+          subtree_can_adjust_raster_scales(false),
+          subtree_is_visible_from_ancestor(false),
+          parent_draw_opacity(1.f),
+          parent_draw_opacity_is_animating(false),
+          parent_screen_space_opacity_is_animating(false),
+          parent_draw_transform_is_animating(false),
+          parent_screen_space_transform_is_animating(false),
+          parent_render_target(NULL) {}
+
+    bool Matches(const Inputs& other) const {
+      return fixed_container == other.fixed_container &&
+          clip_rect_from_ancestor == other.clip_rect_from_ancestor &&
+          clip_rect_of_target_surface == other.clip_rect_of_target_surface &&
+          ancestor_clips_subtree == other.ancestor_clips_subtree &&
+          nearest_ancestor_that_moves_pixels ==
+              other.nearest_ancestor_that_moves_pixels &&
+          max_texture_size == other.max_texture_size &&
+          device_scale_factor == other.device_scale_factor &&
+          page_scale_factor == other.page_scale_factor &&
+          page_scale_application_layer ==
+              other.page_scale_application_layer &&
+          in_subtree_of_page_scale_application_layer ==
+              other.in_subtree_of_page_scale_application_layer &&
+          subtree_can_use_lcd_text == other.subtree_can_use_lcd_text &&
+          subtree_can_adjust_raster_scales ==
+              other.subtree_can_adjust_raster_scales &&
+          subtree_is_visible_from_ancestor ==
+              other.subtree_is_visible_from_ancestor &&
+          parent_draw_opacity == other.parent_draw_opacity &&
+          parent_draw_opacity_is_animating ==
+              other.parent_draw_opacity_is_animating &&
+          parent_screen_space_opacity_is_animating ==
+              other.parent_screen_space_opacity_is_animating &&
+          parent_draw_transform_is_animating ==
+              other.parent_draw_transform_is_animating &&
+          parent_screen_space_transform_is_animating ==
+              other.parent_screen_space_transform_is_animating &&
+          parent_render_target == other.parent_render_target &&
+          parent_target_clip_rect == other.parent_target_clip_rect &&
+          parent_matrix == other.parent_matrix &&
+          full_hierarchy_matrix == other.full_hierarchy_matrix &&
+          scroll_compensation_matrix == other.scroll_compensation_matrix;
+    }
+
+    gfx::Transform parent_matrix;
+    gfx::Transform full_hierarchy_matrix;
+    gfx::Transform scroll_compensation_matrix;
+    LayerType* fixed_container;
+    gfx::Rect clip_rect_from_ancestor;
+    gfx::Rect clip_rect_of_target_surface;
+    bool ancestor_clips_subtree;
+    RenderSurfaceType* nearest_ancestor_that_moves_pixels;
+    int max_texture_size;
+    float device_scale_factor;
+    float page_scale_factor;
+    LayerType* page_scale_application_layer;
+    bool in_subtree_of_page_scale_application_layer;
+    bool subtree_can_use_lcd_text;
+    bool subtree_can_adjust_raster_scales;
+    bool subtree_is_visible_from_ancestor;
+
+    // The parent's draw properties that the layer's own properties are
+    // computed from.
+    float parent_draw_opacity;
+    bool parent_draw_opacity_is_animating;
+    bool parent_screen_space_opacity_is_animating;
+    bool parent_draw_transform_is_animating;
+    bool parent_screen_space_transform_is_animating;
+    LayerType* parent_render_target;
+    gfx::Rect parent_target_clip_rect;
+  };
+
+  SubtreeDrawPropertiesCache()
+      : reusable(false),
+        outcome(SUBTREE_SKIPPED),
+        added_to_layer_list(false) {}
+
+  Inputs inputs;
+
+  // False if something in the subtree can change without its layers noting
+  // it, e.g. while a layer animates, in which case it is always recomputed.
+  bool reusable;
+
+  Outcome outcome;
+
+  // True if the layer itself was added to its target's layer list.
+  bool added_to_layer_list;
+
+  // The drawable content rect of the subtree in target surface space, as
+  // returned to the parent.
+  gfx::Rect drawable_content_rect_of_subtree;
+};
+
 }  // namespace cc
 
 #endif  // CC_LAYERS_DRAW_PROPERTIES_H_
@@ -58,7 +58,9 @@ LayerImpl::LayerImpl(LayerTreeImpl* tree_impl, int id)
       compositing_reasons_(kCompositingReasonUnknown),
       current_draw_mode_(DRAW_MODE_NONE),
       horizontal_scrollbar_layer_(NULL),
-      vertical_scrollbar_layer_(NULL) {
+      vertical_scrollbar_layer_(NULL),
+      needs_draw_properties_update_(true),
+      descendant_needs_draw_properties_update_(false) {
   DCHECK_GT(layer_id_, 0);
   DCHECK(layer_tree_impl_);
   layer_tree_impl_->RegisterLayer(this);
@@ -79,6 +81,7 @@ void LayerImpl::AddChild(scoped_ptr<LayerImpl> child) {
   child->set_parent(this);
   DCHECK_EQ(layer_tree_impl(), child->layer_tree_impl());
   children_.push_back(child.Pass());
+  SetNeedsDrawPropertiesUpdate();
   layer_tree_impl()->set_needs_update_draw_properties();
 }
 
@@ -89,6 +92,7 @@ scoped_ptr<LayerImpl> LayerImpl::RemoveChild(LayerImpl* child) {
     if (*it == child) {
       scoped_ptr<LayerImpl> ret = children_.take(it);
       children_.erase(it);
+      SetNeedsDrawPropertiesUpdate();
       layer_tree_impl()->set_needs_update_draw_properties();
       return ret.Pass();
     }
@@ -101,6 +105,7 @@ void LayerImpl::ClearChildList() {
     return;
 
   children_.clear();
+  SetNeedsDrawPropertiesUpdate();
   layer_tree_impl()->set_needs_update_draw_properties();
 }
 
@@ -151,7 +156,51 @@ void LayerImpl::CreateRenderSurface() {
 }
 
 void LayerImpl::ClearRenderSurface() {
+  if (!draw_properties_.render_surface)
+    return;
   draw_properties_.render_surface.reset();
+  SetNeedsDrawPropertiesUpdate();
+}
+
+void LayerImpl::SetNeedsDrawPropertiesUpdate() {
+  if (needs_draw_properties_update_)
+    return;
+  needs_draw_properties_update_ = true;
+
+  // Mask and replica layers have their owner as parent, so this reaches the
+  // owner for them too.
+  for (LayerImpl* ancestor = parent_; ancestor; ancestor = ancestor->parent_) {
+    bool ancestors_already_know =
+        ancestor->needs_draw_properties_update_ ||
+        ancestor->descendant_needs_draw_properties_update_;
+    ancestor->descendant_needs_draw_properties_update_ = true;
+    if (ancestors_already_know)
+      break;
+  }
+}
+
+void LayerImpl::DidUpdateDrawProperties() {
+  needs_draw_properties_update_ = false;
+  descendant_needs_draw_properties_update_ = false;
+
+  // Mask and replica layers are updated along with their owner.
+  if (mask_layer_)
+    mask_layer_->DidUpdateDrawProperties();
+  if (replica_layer_)
+    replica_layer_->DidUpdateDrawProperties();
+
+  for (size_t i = 0; i < children_.size(); ++i) {
+    if (children_[i]->needs_draw_properties_update_ ||
+        children_[i]->descendant_needs_draw_properties_update_) {
+      descendant_needs_draw_properties_update_ = true;
+      break;
+    }
+  }
+}
+
+void LayerImpl::CreateSubtreeDrawPropertiesCache() {
+  DCHECK(!subtree_draw_properties_cache_);
+  subtree_draw_properties_cache_.reset(new DrawPropertiesCache);
 }
 
 scoped_ptr<SharedQuadState> LayerImpl::CreateSharedQuadState() const {
@@ -290,6 +339,10 @@ void LayerImpl::ApplySentScrollDeltas() {
   scroll_offset_ += sent_scroll_delta_;
   scroll_delta_ -= sent_scroll_delta_;
   sent_scroll_delta_ = gfx::Vector2d();
+
+  // The scroll compensation of fixed-position descendants depends on the
+  // scroll delta alone.
+  SetNeedsDrawPropertiesUpdate();
 }
 
 InputHandler::ScrollStatus LayerImpl::TryScroll(
@@ -506,11 +559,13 @@ bool LayerImpl::LayerSurfacePropertyChanged() const {
 
 void LayerImpl::NoteLayerSurfacePropertyChanged() {
   layer_surface_property_changed_ = true;
+  SetNeedsDrawPropertiesUpdate();
   layer_tree_impl()->set_needs_update_draw_properties();
 }
 
 void LayerImpl::NoteLayerPropertyChanged() {
   layer_property_changed_ = true;
+  SetNeedsDrawPropertiesUpdate();
   layer_tree_impl()->set_needs_update_draw_properties();
 }
 
@@ -556,10 +611,13 @@ bool LayerImpl::LayerIsAlwaysDamaged() const {
 
 void LayerImpl::OnOpacityAnimated(float opacity) {
   SetOpacity(opacity);
+  // The animation may have just started without changing the value.
+  SetNeedsDrawPropertiesUpdate();
 }
 
 void LayerImpl::OnTransformAnimated(const gfx::Transform& transform) {
   SetTransform(transform);
+  SetNeedsDrawPropertiesUpdate();
 }
 
 bool LayerImpl::IsActive() const {
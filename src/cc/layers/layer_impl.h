@@ -138,7 +138,12 @@ class CC_EXPORT LayerImpl : LayerAnimationValueObserver {
   bool hide_layer_and_subtree() const { return hide_layer_and_subtree_; }
 
   bool force_render_surface() const { return force_render_surface_; }
-  void SetForceRenderSurface(bool force) { force_render_surface_ = force; }
+  void SetForceRenderSurface(bool force) {
+    if (force_render_surface_ == force)
+      return;
+    force_render_surface_ = force;
+    SetNeedsDrawPropertiesUpdate();
+  }
 
   void SetAnchorPoint(gfx::PointF anchor_point);
   gfx::PointF anchor_point() const { return anchor_point_; }
@@ -178,7 +183,10 @@ class CC_EXPORT LayerImpl : LayerAnimationValueObserver {
   gfx::PointF position() const { return position_; }
 
   void SetIsContainerForFixedPositionLayers(bool container) {
+    if (is_container_for_fixed_position_layers_ == container)
+      return;
     is_container_for_fixed_position_layers_ = container;
+    SetNeedsDrawPropertiesUpdate();
   }
   // This is a non-trivial function in Layer.
   bool IsContainerForFixedPositionLayers() const {
@@ -193,7 +201,10 @@ class CC_EXPORT LayerImpl : LayerAnimationValueObserver {
   }
 
   void SetPositionConstraint(const LayerPositionConstraint& constraint) {
+    if (position_constraint_ == constraint)
+      return;
     position_constraint_ = constraint;
+    SetNeedsDrawPropertiesUpdate();
   }
   const LayerPositionConstraint& position_constraint() const {
     return position_constraint_;
@@ -203,7 +214,10 @@ class CC_EXPORT LayerImpl : LayerAnimationValueObserver {
   bool preserves_3d() const { return preserves_3d_; }
 
   void SetUseParentBackfaceVisibility(bool use) {
+    if (use_parent_backface_visibility_ == use)
+      return;
     use_parent_backface_visibility_ = use;
+    SetNeedsDrawPropertiesUpdate();
   }
   bool use_parent_backface_visibility() const {
     return use_parent_backface_visibility_;
@@ -234,6 +248,27 @@ class CC_EXPORT LayerImpl : LayerAnimationValueObserver {
   void CreateRenderSurface();
   void ClearRenderSurface();
 
+  // Marks this layer as changed in a way that CalculateDrawProperties has to
+  // see, and its ancestors as having a changed descendant, so that subtrees
+  // without changes can be reused when the tree's settings allow it.
+  void SetNeedsDrawPropertiesUpdate();
+  bool needs_draw_properties_update() const {
+    return needs_draw_properties_update_;
+  }
+  bool descendant_needs_draw_properties_update() const {
+    return descendant_needs_draw_properties_update_;
+  }
+  // Called by CalculateDrawProperties once it has visited this layer's
+  // subtree. Children it did not visit keep their changes.
+  void DidUpdateDrawProperties();
+
+  typedef SubtreeDrawPropertiesCache<LayerImpl, RenderSurfaceImpl>
+      DrawPropertiesCache;
+  DrawPropertiesCache* subtree_draw_properties_cache() const {
+    return subtree_draw_properties_cache_.get();
+  }
+  void CreateSubtreeDrawPropertiesCache();
+
   DrawProperties<LayerImpl, RenderSurfaceImpl>& draw_properties() {
     return draw_properties_;
   }
@@ -309,6 +344,9 @@ class CC_EXPORT LayerImpl : LayerAnimationValueObserver {
 
   void SetScrollOffsetDelegate(
       LayerScrollOffsetDelegate* scroll_offset_delegate);
+  LayerScrollOffsetDelegate* scroll_offset_delegate() const {
+    return scroll_offset_delegate_;
+  }
   void SetScrollOffset(gfx::Vector2d scroll_offset);
   gfx::Vector2d scroll_offset() const { return scroll_offset_; }
 
@@ -327,7 +365,12 @@ class CC_EXPORT LayerImpl : LayerAnimationValueObserver {
   // initial scroll
   gfx::Vector2dF ScrollBy(gfx::Vector2dF scroll);
 
-  void SetScrollable(bool scrollable) { scrollable_ = scrollable; }
+  void SetScrollable(bool scrollable) {
+    if (scrollable_ == scrollable)
+      return;
+    scrollable_ = scrollable;
+    SetNeedsDrawPropertiesUpdate();
+  }
   bool scrollable() const { return scrollable_; }
 
   void ApplySentScrollDeltas();
@@ -576,6 +619,12 @@ class CC_EXPORT LayerImpl : LayerAnimationValueObserver {
   // hierarchy before layers can be drawn.
   DrawProperties<LayerImpl, RenderSurfaceImpl> draw_properties_;
 
+  // Change tracking for reusing draw properties of unchanged subtrees. See
+  // SetNeedsDrawPropertiesUpdate().
+  bool needs_draw_properties_update_;
+  bool descendant_needs_draw_properties_update_;
+  scoped_ptr<DrawPropertiesCache> subtree_draw_properties_cache_;
+
   DISALLOW_COPY_AND_ASSIGN(LayerImpl);
 };
 
@@ -0,0 +1,157 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/output/software_blit_row.h"
+
+#include <string.h>
+
+#include "base/logging.h"
+#include "build/build_config.h"
+#include "third_party/skia/include/core/SkColorPriv.h"
+
+#if defined(ARCH_CPU_X86_FAMILY) && \
+    (defined(__SSE2__) || defined(ARCH_CPU_X86_64))
+#define SOFTWARE_BLIT_ROW_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace cc {
+
+namespace {
+
+#if defined(SOFTWARE_BLIT_ROW_USE_SSE2)
+
+// SkAlphaMulQ() on four pixels. |scale| holds each pixel's scale in both of
+// the pixel's 16-bit halves.
+inline __m128i AlphaMulQ_SSE2(__m128i c, __m128i scale) {
+  const __m128i rb_mask = _mm_set1_epi32(0x00FF00FF);
+  __m128i rb = _mm_and_si128(c, rb_mask);
+  __m128i ag = _mm_srli_epi16(c, 8);
+  rb = _mm_srli_epi16(_mm_mullo_epi16(rb, scale), 8);
+  ag = _mm_andnot_si128(rb_mask, _mm_mullo_epi16(ag, scale));
+  return _mm_or_si128(rb, ag);
+}
+
+// SkPMSrcOver() on four pixels.
+inline __m128i SrcOver_SSE2(__m128i src, __m128i dst) {
+  __m128i dst_scale =
+      _mm_sub_epi32(_mm_set1_epi32(256), _mm_srli_epi32(src, 24));
+  dst_scale = _mm_or_si128(dst_scale, _mm_slli_epi32(dst_scale, 16));
+  return _mm_add_epi32(src, AlphaMulQ_SSE2(dst, dst_scale));
+}
+
+inline __m128i LoadPixels(const SkPMColor* pixels) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+}
+
+inline void StorePixels(SkPMColor* pixels, __m128i value) {
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), value);
+}
+
+#endif  // defined(SOFTWARE_BLIT_ROW_USE_SSE2)
+
+}  // namespace
+
+void BlitRowFillColor(SkPMColor* dst, int count, SkPMColor color) {
+  int i = 0;
+#if defined(SOFTWARE_BLIT_ROW_USE_SSE2)
+  const __m128i color4 = _mm_set1_epi32(color);
+  for (; i + 4 <= count; i += 4)
+    StorePixels(dst + i, color4);
+#endif
+  for (; i < count; ++i)
+    dst[i] = color;
+}
+
+void BlitRowBlendColor(SkPMColor* dst, int count, SkPMColor color) {
+  // Matches SkBlitRow::Color32().
+  if (!color)
+    return;
+  unsigned color_alpha = SkGetPackedA32(color);
+  if (color_alpha == 255) {
+    BlitRowFillColor(dst, count, color);
+    return;
+  }
+
+  unsigned scale = 256 - SkAlpha255To256(color_alpha);
+  int i = 0;
+#if defined(SOFTWARE_BLIT_ROW_USE_SSE2)
+  const __m128i color4 = _mm_set1_epi32(color);
+  const __m128i scale4 = _mm_set1_epi16(scale);
+  for (; i + 4 <= count; i += 4) {
+    StorePixels(dst + i,
+                _mm_add_epi32(color4,
+                              AlphaMulQ_SSE2(LoadPixels(dst + i), scale4)));
+  }
+#endif
+  for (; i < count; ++i)
+    dst[i] = color + SkAlphaMulQ(dst[i], scale);
+}
+
+void BlitRowCopy(SkPMColor* dst, const SkPMColor* src, int count) {
+  memcpy(dst, src, count * sizeof(SkPMColor));
+}
+
+void BlitRowBlend(SkPMColor* dst,
+                  const SkPMColor* src,
+                  int count,
+                  U8CPU alpha,
+                  bool src_is_opaque) {
+  DCHECK_LE(alpha, 255u);
+  if (src_is_opaque && alpha == 255) {
+    BlitRowCopy(dst, src, count);
+    return;
+  }
+
+  int i = 0;
+  if (src_is_opaque) {
+    // Matches S32_Blend_BlitRow32.
+    unsigned src_scale = SkAlpha255To256(alpha);
+    unsigned dst_scale = 256 - src_scale;
+#if defined(SOFTWARE_BLIT_ROW_USE_SSE2)
+    const __m128i src_scale4 = _mm_set1_epi16(src_scale);
+    const __m128i dst_scale4 = _mm_set1_epi16(dst_scale);
+    for (; i + 4 <= count; i += 4) {
+      StorePixels(
+          dst + i,
+          _mm_add_epi32(AlphaMulQ_SSE2(LoadPixels(src + i), src_scale4),
+                        AlphaMulQ_SSE2(LoadPixels(dst + i), dst_scale4)));
+    }
+#endif
+    for (; i < count; ++i) {
+      dst[i] = SkAlphaMulQ(src[i], src_scale) +
+               SkAlphaMulQ(dst[i], dst_scale);
+    }
+    return;
+  }
+
+  if (alpha == 255) {
+    // Matches S32A_Opaque_BlitRow32.
+#if defined(SOFTWARE_BLIT_ROW_USE_SSE2)
+    for (; i + 4 <= count; i += 4) {
+      StorePixels(dst + i,
+                  SrcOver_SSE2(LoadPixels(src + i), LoadPixels(dst + i)));
+    }
+#endif
+    for (; i < count; ++i)
+      dst[i] = SkPMSrcOver(src[i], dst[i]);
+    return;
+  }
+
+  // Matches S32A_Blend_BlitRow32. SkBlendARGB32() is a source-over of the
+  // source scaled by the paint alpha.
+  unsigned src_scale = SkAlpha255To256(alpha);
+#if defined(SOFTWARE_BLIT_ROW_USE_SSE2)
+  const __m128i src_scale4 = _mm_set1_epi16(src_scale);
+  for (; i + 4 <= count; i += 4) {
+    StorePixels(dst + i,
+                SrcOver_SSE2(AlphaMulQ_SSE2(LoadPixels(src + i), src_scale4),
+                             LoadPixels(dst + i)));
+  }
+#endif
+  for (; i < count; ++i)
+    dst[i] = SkBlendARGB32(src[i], dst[i], alpha);
+}
+
+}  // namespace cc
@@ -0,0 +1,40 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CC_OUTPUT_SOFTWARE_BLIT_ROW_H_
+#define CC_OUTPUT_SOFTWARE_BLIT_ROW_H_
+
+#include "cc/base/cc_export.h"
+#include "third_party/skia/include/core/SkColor.h"
+
+namespace cc {
+
+// Row blitters for the SoftwareRenderer's fast paths, which draw simple quads
+// straight into an N32 bitmap instead of going through SkCanvas. Each one
+// produces exactly the pixels the matching Skia blitter does for a non-AA,
+// unfiltered draw, and uses SSE2 where it is available.
+
+// Fills |count| pixels at |dst| with the premultiplied |color| using
+// kSrc_Mode.
+CC_EXPORT void BlitRowFillColor(SkPMColor* dst, int count, SkPMColor color);
+
+// Blends the premultiplied |color| over |count| pixels at |dst| using
+// kSrcOver_Mode.
+CC_EXPORT void BlitRowBlendColor(SkPMColor* dst, int count, SkPMColor color);
+
+// Copies |count| pixels from |src| to |dst|, as kSrc_Mode does.
+CC_EXPORT void BlitRowCopy(SkPMColor* dst, const SkPMColor* src, int count);
+
+// Draws |count| pixels of |src| over |dst| using kSrcOver_Mode with a paint
+// alpha of |alpha|. |src_is_opaque| must match SkBitmap::isOpaque() for the
+// source bitmap, since Skia blends opaque bitmaps slightly differently.
+CC_EXPORT void BlitRowBlend(SkPMColor* dst,
+                            const SkPMColor* src,
+                            int count,
+                            U8CPU alpha,
+                            bool src_is_opaque);
+
+}  // namespace cc
+
+#endif  // CC_OUTPUT_SOFTWARE_BLIT_ROW_H_
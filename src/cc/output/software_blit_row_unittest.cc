@@ -0,0 +1,119 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/output/software_blit_row.h"
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkColorPriv.h"
+
+namespace cc {
+namespace {
+
+// Enough pixels to cover the vector loops and a scalar tail of each length.
+const int kMaxCount = 19;
+
+class SoftwareBlitRowTest : public testing::Test {
+ public:
+  SoftwareBlitRowTest() : seed_(1) {}
+
+ protected:
+  // Returns a valid premultiplied color, with fully transparent and fully
+  // opaque pixels mixed in.
+  SkPMColor NextColor(bool opaque) {
+    unsigned alpha = opaque ? 255 : Next() % 256;
+    if (!opaque && Next() % 4 == 0)
+      alpha = Next() % 2 ? 255 : 0;
+    return SkPackARGB32(alpha,
+                        Next() % (alpha + 1),
+                        Next() % (alpha + 1),
+                        Next() % (alpha + 1));
+  }
+
+  void FillColors(std::vector<SkPMColor>* colors, bool opaque) {
+    colors->resize(kMaxCount);
+    for (size_t i = 0; i < colors->size(); ++i)
+      (*colors)[i] = NextColor(opaque);
+  }
+
+ private:
+  unsigned Next() {
+    seed_ = seed_ * 1103515245 + 12345;
+    return seed_ >> 8;
+  }
+
+  unsigned seed_;
+};
+
+TEST_F(SoftwareBlitRowTest, BlendColorMatchesSkia) {
+  std::vector<SkPMColor> dst;
+  for (int count = 0; count <= kMaxCount; ++count) {
+    for (int iteration = 0; iteration < 50; ++iteration) {
+      FillColors(&dst, false);
+      std::vector<SkPMColor> expected(dst);
+      SkPMColor color = NextColor(false);
+
+      // SkBlitRow::Color32().
+      unsigned scale = 256 - SkAlpha255To256(SkGetPackedA32(color));
+      for (int i = 0; color && i < count; ++i)
+        expected[i] = color + SkAlphaMulQ(expected[i], scale);
+
+      BlitRowBlendColor(&dst[0], count, color);
+      for (int i = 0; i < kMaxCount; ++i)
+        ASSERT_EQ(expected[i], dst[i]) << count << " pixels, at " << i;
+    }
+  }
+}
+
+TEST_F(SoftwareBlitRowTest, FillColor) {
+  std::vector<SkPMColor> dst(kMaxCount, 0);
+  SkPMColor color = SkPackARGB32(0x80, 0x40, 0x20, 0x10);
+  BlitRowFillColor(&dst[0], kMaxCount - 1, color);
+  for (int i = 0; i < kMaxCount - 1; ++i)
+    EXPECT_EQ(color, dst[i]);
+  EXPECT_EQ(0u, dst[kMaxCount - 1]);
+}
+
+TEST_F(SoftwareBlitRowTest, BlendMatchesSkia) {
+  const U8CPU kAlphas[] = { 0, 1, 127, 128, 200, 254, 255 };
+  std::vector<SkPMColor> src;
+  std::vector<SkPMColor> dst;
+  for (int opaque = 0; opaque < 2; ++opaque) {
+    for (size_t a = 0; a < arraysize(kAlphas); ++a) {
+      U8CPU alpha = kAlphas[a];
+      for (int count = 0; count <= kMaxCount; ++count) {
+        FillColors(&src, opaque);
+        FillColors(&dst, false);
+        std::vector<SkPMColor> expected(dst);
+
+        // The procs SkBlitRow::Factory32() picks for each case.
+        unsigned src_scale = SkAlpha255To256(alpha);
+        for (int i = 0; i < count; ++i) {
+          if (opaque && alpha == 255) {
+            expected[i] = src[i];
+          } else if (opaque) {
+            expected[i] = SkAlphaMulQ(src[i], src_scale) +
+                          SkAlphaMulQ(expected[i], 256 - src_scale);
+          } else if (alpha == 255) {
+            expected[i] = SkPMSrcOver(src[i], expected[i]);
+          } else {
+            expected[i] = SkBlendARGB32(src[i], expected[i], alpha);
+          }
+        }
+
+        BlitRowBlend(&dst[0], &src[0], count, alpha, opaque);
+        for (int i = 0; i < kMaxCount; ++i) {
+          ASSERT_EQ(expected[i], dst[i])
+              << "opaque " << opaque << ", alpha " << alpha << ", "
+              << count << " pixels, at " << i;
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace cc
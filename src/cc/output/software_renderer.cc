@@ -11,6 +11,7 @@
 #include "cc/output/compositor_frame_metadata.h"
 #include "cc/output/copy_output_request.h"
 #include "cc/output/output_surface.h"
+#include "cc/output/software_blit_row.h"
 #include "cc/output/software_output_device.h"
 #include "cc/quads/checkerboard_draw_quad.h"
 #include "cc/quads/debug_border_draw_quad.h"
@@ -24,6 +25,7 @@
 #include "third_party/skia/include/core/SkDevice.h"
 #include "third_party/skia/include/core/SkMatrix.h"
 #include "third_party/skia/include/core/SkShader.h"
+#include "third_party/skia/include/core/SkXfermode.h"
 #include "third_party/skia/include/effects/SkLayerRasterizer.h"
 #include "ui/gfx/rect_conversions.h"
 #include "ui/gfx/skia_util.h"
@@ -47,6 +49,20 @@ bool IsScaleAndIntegerTranslate(const SkMatrix& matrix) {
          SkScalarNearlyZero(matrix[SkMatrix::kMPersp2] - 1.0f);
 }
 
+bool IsRectNearlyInteger(const SkRect& rect) {
+  return IsScalarNearlyInteger(rect.fLeft) &&
+         IsScalarNearlyInteger(rect.fTop) &&
+         IsScalarNearlyInteger(rect.fRight) &&
+         IsScalarNearlyInteger(rect.fBottom);
+}
+
+SkIRect RoundRect(const SkRect& rect) {
+  return SkIRect::MakeLTRB(SkScalarRound(rect.fLeft),
+                           SkScalarRound(rect.fTop),
+                           SkScalarRound(rect.fRight),
+                           SkScalarRound(rect.fBottom));
+}
+
 }  // anonymous namespace
 
 scoped_ptr<SoftwareRenderer> SoftwareRenderer::Create(
@@ -337,8 +353,10 @@ void SoftwareRenderer::DrawSolidColorQuad(const DrawingFrame* frame,
                                           const SolidColorDrawQuad* quad) {
   current_paint_.setColor(quad->color);
   current_paint_.setAlpha(quad->opacity() * SkColorGetA(quad->color));
-  current_canvas_->drawRect(gfx::RectFToSkRect(QuadVertexRect()),
-                            current_paint_);
+  SkRect quad_rect = gfx::RectFToSkRect(QuadVertexRect());
+  if (DrawColorFast(quad_rect))
+    return;
+  current_canvas_->drawRect(quad_rect, current_paint_);
 }
 
 void SoftwareRenderer::DrawTextureQuad(const DrawingFrame* frame,
@@ -392,10 +410,12 @@ void SoftwareRenderer::DrawTileQuad(const DrawingFrame* frame,
                                                 quad->resource_id);
 
   SkRect uv_rect = gfx::RectFToSkRect(quad->tex_coord_rect);
+  SkRect quad_rect = gfx::RectFToSkRect(QuadVertexRect());
+  if (DrawBitmapFast(*lock.sk_bitmap(), uv_rect, quad_rect))
+    return;
   current_paint_.setFilterBitmap(true);
   current_canvas_->drawBitmapRectToRect(*lock.sk_bitmap(), &uv_rect,
-                                        gfx::RectFToSkRect(QuadVertexRect()),
-                                        &current_paint_);
+                                        quad_rect, &current_paint_);
 }
 
 void SoftwareRenderer::DrawRenderPassQuad(const DrawingFrame* frame,
@@ -476,6 +496,122 @@ void SoftwareRenderer::DrawUnsupportedQuad(const DrawingFrame* frame,
                             current_paint_);
 }
 
+bool SoftwareRenderer::PrepareFastPath(const SkRect& quad_rect,
+                                       SkBitmap* target,
+                                       SkIRect* device_rect,
+                                       SkIRect* clipped_rect) {
+  // Layers and non-rectangular clips are left to the canvas, as are quads
+  // whose edges are antialiased or fall between device pixels.
+  if (current_canvas_->getTopDevice() != current_canvas_->getDevice() ||
+      current_canvas_->getClipType() != SkCanvas::kRect_ClipType ||
+      current_paint_.isAntiAlias())
+    return false;
+
+  const SkMatrix& matrix = current_canvas_->getTotalMatrix();
+  if (matrix.getType() & ~(SkMatrix::kTranslate_Mask | SkMatrix::kScale_Mask))
+    return false;
+
+  SkRect mapped_rect;
+  matrix.mapRect(&mapped_rect, quad_rect);
+  if (!IsRectNearlyInteger(mapped_rect))
+    return false;
+  *device_rect = RoundRect(mapped_rect);
+
+  *target = current_canvas_->getDevice()->accessBitmap(true);
+  if (target->config() != SkBitmap::kARGB_8888_Config)
+    return false;
+
+  SkIRect clip_rect;
+  current_canvas_->getClipDeviceBounds(&clip_rect);
+  *clipped_rect = *device_rect;
+  if (!clipped_rect->intersect(clip_rect))
+    clipped_rect->setEmpty();
+  return true;
+}
+
+bool SoftwareRenderer::DrawColorFast(const SkRect& quad_rect) {
+  SkXfermode::Mode mode;
+  if (!SkXfermode::AsMode(current_paint_.getXfermode(), &mode) ||
+      (mode != SkXfermode::kSrc_Mode && mode != SkXfermode::kSrcOver_Mode))
+    return false;
+
+  SkBitmap target;
+  SkIRect device_rect;
+  SkIRect clipped_rect;
+  if (!PrepareFastPath(quad_rect, &target, &device_rect, &clipped_rect))
+    return false;
+
+  SkAutoLockPixels target_lock(target);
+  if (!target.getPixels())
+    return false;
+
+  TRACE_EVENT0("cc", "SoftwareRenderer::DrawColorFast");
+  SkPMColor color = SkPreMultiplyColor(current_paint_.getColor());
+  for (int y = clipped_rect.fTop; y < clipped_rect.fBottom; ++y) {
+    SkPMColor* dst = target.getAddr32(clipped_rect.fLeft, y);
+    if (mode == SkXfermode::kSrc_Mode)
+      BlitRowFillColor(dst, clipped_rect.width(), color);
+    else
+      BlitRowBlendColor(dst, clipped_rect.width(), color);
+  }
+  return true;
+}
+
+bool SoftwareRenderer::DrawBitmapFast(const SkBitmap& source,
+                                      const SkRect& source_rect,
+                                      const SkRect& quad_rect) {
+  SkXfermode::Mode mode;
+  if (!SkXfermode::AsMode(current_paint_.getXfermode(), &mode) ||
+      (mode != SkXfermode::kSrc_Mode && mode != SkXfermode::kSrcOver_Mode))
+    return false;
+  if (source.config() != SkBitmap::kARGB_8888_Config ||
+      !IsRectNearlyInteger(source_rect))
+    return false;
+
+  // Scaled bitmaps are filtered, so only a bitmap drawn at its own size at
+  // an integer offset is a blit.
+  const SkMatrix& matrix = current_canvas_->getTotalMatrix();
+  if (matrix.getScaleX() < 0 || matrix.getScaleY() < 0)
+    return false;
+
+  SkBitmap target;
+  SkIRect device_rect;
+  SkIRect clipped_rect;
+  if (!PrepareFastPath(quad_rect, &target, &device_rect, &clipped_rect))
+    return false;
+
+  SkIRect source_irect = RoundRect(source_rect);
+  if (source_irect.width() != device_rect.width() ||
+      source_irect.height() != device_rect.height() ||
+      !SkIRect::MakeWH(source.width(), source.height()).contains(source_irect))
+    return false;
+
+  SkAutoLockPixels target_lock(target);
+  SkAutoLockPixels source_lock(source);
+  if (!target.getPixels() || !source.getPixels())
+    return false;
+
+  TRACE_EVENT0("cc", "SoftwareRenderer::DrawBitmapFast");
+  int source_dx = source_irect.fLeft - device_rect.fLeft;
+  int source_dy = source_irect.fTop - device_rect.fTop;
+  bool source_is_opaque = source.isOpaque();
+  for (int y = clipped_rect.fTop; y < clipped_rect.fBottom; ++y) {
+    SkPMColor* dst = target.getAddr32(clipped_rect.fLeft, y);
+    const SkPMColor* src =
+        source.getAddr32(clipped_rect.fLeft + source_dx, y + source_dy);
+    if (mode == SkXfermode::kSrc_Mode) {
+      BlitRowCopy(dst, src, clipped_rect.width());
+    } else {
+      BlitRowBlend(dst,
+                   src,
+                   clipped_rect.width(),
+                   current_paint_.getAlpha(),
+                   source_is_opaque);
+    }
+  }
+  return true;
+}
+
 void SoftwareRenderer::CopyCurrentRenderPassToBitmap(
     DrawingFrame* frame,
     scoped_ptr<CopyOutputRequest> request) {
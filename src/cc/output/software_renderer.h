@@ -92,6 +92,19 @@ class CC_EXPORT SoftwareRenderer : public DirectRenderer {
   void DrawUnsupportedQuad(const DrawingFrame* frame,
                            const DrawQuad* quad);
 
+  // The fast paths write simple quads straight into the pixels of the
+  // current canvas, skipping Skia's generic draw dispatch. They produce the
+  // same pixels Skia would and return false when a quad needs anything
+  // beyond a blit of whole device pixels, leaving it to the canvas.
+  bool PrepareFastPath(const SkRect& quad_rect,
+                       SkBitmap* target,
+                       SkIRect* device_rect,
+                       SkIRect* clipped_rect);
+  bool DrawColorFast(const SkRect& quad_rect);
+  bool DrawBitmapFast(const SkBitmap& source,
+                      const SkRect& source_rect,
+                      const SkRect& quad_rect);
+
   RendererCapabilities capabilities_;
   bool visible_;
   bool is_scissor_enabled_;
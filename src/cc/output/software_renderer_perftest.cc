@@ -0,0 +1,206 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/output/software_renderer.h"
+
+#include "base/time/time.h"
+#include "cc/output/compositor_frame_metadata.h"
+#include "cc/output/software_output_device.h"
+#include "cc/quads/render_pass.h"
+#include "cc/quads/solid_color_draw_quad.h"
+#include "cc/quads/tile_draw_quad.h"
+#include "cc/test/fake_output_surface.h"
+#include "cc/test/render_pass_test_common.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace cc {
+namespace {
+
+static const int kTimeLimitMillis = 2000;
+static const int kWarmupRuns = 5;
+static const int kTimeCheckInterval = 10;
+
+static const int kViewportWidth = 1024;
+static const int kViewportHeight = 768;
+static const int kTileSize = 256;
+
+class SoftwareRendererPerfTest : public testing::Test, public RendererClient {
+ public:
+  SoftwareRendererPerfTest() : num_runs_(0) {}
+
+  // Overridden from testing::Test:
+  virtual void SetUp() OVERRIDE {
+    viewport_ = gfx::Rect(kViewportWidth, kViewportHeight);
+    output_surface_ = FakeOutputSurface::CreateSoftware(
+        make_scoped_ptr(new SoftwareOutputDevice));
+    resource_provider_ = ResourceProvider::Create(output_surface_.get(), 0);
+    renderer_ = SoftwareRenderer::Create(
+        this, output_surface_.get(), resource_provider_.get());
+
+    gfx::Size tile_size(kTileSize, kTileSize);
+    SkBitmap tile;
+    tile.setConfig(SkBitmap::kARGB_8888_Config, kTileSize, kTileSize);
+    tile.allocPixels();
+    tile.eraseARGB(0xFF, 0x20, 0x80, 0xC0);
+    tile_resource_ = resource_provider_->CreateResource(
+        tile_size, GL_RGBA, ResourceProvider::TextureUsageAny);
+    resource_provider_->SetPixels(tile_resource_,
+                                  static_cast<uint8_t*>(tile.getPixels()),
+                                  gfx::Rect(tile_size),
+                                  gfx::Rect(tile_size),
+                                  gfx::Vector2d());
+  }
+
+  // RendererClient implementation.
+  virtual gfx::Rect DeviceViewport() const OVERRIDE {
+    return viewport_;
+  }
+  virtual float DeviceScaleFactor() const OVERRIDE {
+    return 1.f;
+  }
+  virtual const LayerTreeSettings& Settings() const OVERRIDE {
+    return settings_;
+  }
+  virtual void SetFullRootLayerDamage() OVERRIDE {}
+  virtual bool HasImplThread() const OVERRIDE { return false; }
+  virtual bool ShouldClearRootRenderPass() const OVERRIDE {
+    return true;
+  }
+  virtual CompositorFrameMetadata MakeCompositorFrameMetadata() const OVERRIDE {
+    return CompositorFrameMetadata();
+  }
+  virtual bool AllowPartialSwap() const OVERRIDE {
+    return true;
+  }
+  virtual bool ExternalStencilTestEnabled() const OVERRIDE { return false; }
+
+  bool DidRun() {
+    ++num_runs_;
+    if (num_runs_ == kWarmupRuns)
+      start_time_ = base::TimeTicks::HighResNow();
+
+    if (!start_time_.is_null() && (num_runs_ % kTimeCheckInterval) == 0) {
+      base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start_time_;
+      if (elapsed >= base::TimeDelta::FromMilliseconds(kTimeLimitMillis)) {
+        elapsed_ = elapsed;
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // Adds a layer of tiles covering the viewport, drawn with |opacity|.
+  void AppendTileLayer(TestRenderPass* pass, float opacity) {
+    gfx::Size layer_size(viewport_.size());
+    scoped_ptr<SharedQuadState> shared_state = SharedQuadState::Create();
+    shared_state->SetAll(
+        gfx::Transform(), layer_size, viewport_, viewport_, false, opacity);
+    for (int y = 0; y < layer_size.height(); y += kTileSize) {
+      for (int x = 0; x < layer_size.width(); x += kTileSize) {
+        gfx::Rect tile_rect(x, y, kTileSize, kTileSize);
+        scoped_ptr<TileDrawQuad> quad = TileDrawQuad::Create();
+        quad->SetNew(shared_state.get(),
+                     tile_rect,
+                     tile_rect,
+                     tile_resource_,
+                     gfx::RectF(kTileSize, kTileSize),
+                     gfx::Size(kTileSize, kTileSize),
+                     false);
+        pass->AppendQuad(quad.PassAs<DrawQuad>());
+      }
+    }
+    pass->AppendSharedQuadState(shared_state.Pass());
+  }
+
+  // Adds a grid of |cell_size| solid color quads covering the viewport.
+  // The layer is drawn at |scale|, so it is made up of smaller quads.
+  void AppendColorLayer(TestRenderPass* pass,
+                        int cell_size,
+                        int scale,
+                        SkColor color) {
+    gfx::Size layer_size(viewport_.width() / scale,
+                         viewport_.height() / scale);
+    gfx::Transform transform;
+    transform.Scale(scale, scale);
+    scoped_ptr<SharedQuadState> shared_state = SharedQuadState::Create();
+    shared_state->SetAll(
+        transform, layer_size, gfx::Rect(layer_size), viewport_, false, 1.f);
+    int scaled_cell_size = cell_size / scale;
+    for (int y = 0; y < layer_size.height(); y += scaled_cell_size) {
+      for (int x = 0; x < layer_size.width(); x += scaled_cell_size) {
+        scoped_ptr<SolidColorDrawQuad> quad = SolidColorDrawQuad::Create();
+        quad->SetNew(shared_state.get(),
+                     gfx::Rect(x, y, scaled_cell_size, scaled_cell_size),
+                     color,
+                     false);
+        pass->AppendQuad(quad.PassAs<DrawQuad>());
+      }
+    }
+    pass->AppendSharedQuadState(shared_state.Pass());
+  }
+
+  void RunFrameTest(const std::string& test_name,
+                    scoped_ptr<TestRenderPass> pass) {
+    start_time_ = base::TimeTicks();
+    num_runs_ = 0;
+
+    RenderPassList list;
+    list.push_back(pass.PassAs<RenderPass>());
+    do {
+      renderer_->DrawFrame(&list);
+    } while (DidRun());
+
+    // Format matches chrome/test/perf/perf_test.h:PrintResult
+    printf("*RESULT %s: %.2f ms/frame\n",
+           test_name.c_str(),
+           elapsed_.InMillisecondsF() / (num_runs_ - kWarmupRuns));
+  }
+
+  scoped_ptr<TestRenderPass> CreateRootPass() {
+    scoped_ptr<TestRenderPass> pass = TestRenderPass::Create();
+    pass->SetNew(RenderPass::Id(1, 1), viewport_, viewport_, gfx::Transform());
+    return pass.Pass();
+  }
+
+ protected:
+  gfx::Rect viewport_;
+  LayerTreeSettings settings_;
+  scoped_ptr<FakeOutputSurface> output_surface_;
+  scoped_ptr<ResourceProvider> resource_provider_;
+  scoped_ptr<SoftwareRenderer> renderer_;
+  ResourceProvider::ResourceId tile_resource_;
+  base::TimeTicks start_time_;
+  base::TimeDelta elapsed_;
+  int num_runs_;
+};
+
+TEST_F(SoftwareRendererPerfTest, OpaqueTiles) {
+  scoped_ptr<TestRenderPass> pass = CreateRootPass();
+  AppendTileLayer(pass.get(), 1.f);
+  RunFrameTest("software_renderer_opaque_tiles", pass.Pass());
+}
+
+TEST_F(SoftwareRendererPerfTest, TranslucentTilesOverTiles) {
+  scoped_ptr<TestRenderPass> pass = CreateRootPass();
+  AppendTileLayer(pass.get(), 0.5f);
+  AppendTileLayer(pass.get(), 1.f);
+  RunFrameTest("software_renderer_translucent_tiles", pass.Pass());
+}
+
+TEST_F(SoftwareRendererPerfTest, TranslucentSolidColorsOverTiles) {
+  scoped_ptr<TestRenderPass> pass = CreateRootPass();
+  AppendColorLayer(pass.get(), 32, 1, SkColorSetARGB(0x80, 0xFF, 0, 0));
+  AppendTileLayer(pass.get(), 1.f);
+  RunFrameTest("software_renderer_translucent_solid_colors", pass.Pass());
+}
+
+TEST_F(SoftwareRendererPerfTest, ScaledSolidColors) {
+  scoped_ptr<TestRenderPass> pass = CreateRootPass();
+  AppendColorLayer(pass.get(), 64, 2, SK_ColorGREEN);
+  RunFrameTest("software_renderer_scaled_solid_colors", pass.Pass());
+}
+
+}  // namespace
+}  // namespace cc
@@ -20,6 +20,7 @@
 #include "testing/gtest/include/gtest/gtest.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkDevice.h"
+#include "ui/gfx/skia_util.h"
 
 namespace cc {
 namespace {
@@ -212,6 +213,115 @@ TEST_F(SoftwareRendererTest, TileQuad) {
             output.getColor(inner_size.width() - 1, inner_size.height() - 1));
 }
 
+TEST_F(SoftwareRendererTest, FastPathsMatchSkia) {
+  gfx::Size viewport_size(100, 100);
+  gfx::Rect viewport_rect(viewport_size);
+  gfx::Size tile_size(40, 30);
+  set_viewport(viewport_rect);
+  InitializeRenderer(make_scoped_ptr(new SoftwareOutputDevice));
+
+  // A translucent tile with a different color in each row, so that a blit
+  // from the wrong source row would show.
+  SkBitmap tile;
+  tile.setConfig(
+      SkBitmap::kARGB_8888_Config, tile_size.width(), tile_size.height());
+  tile.allocPixels();
+  for (int y = 0; y < tile_size.height(); ++y) {
+    for (int x = 0; x < tile_size.width(); ++x) {
+      *tile.getAddr32(x, y) = SkPreMultiplyARGB(
+          0x40 + 4 * y, 0xFF - 5 * x, 8 * y, 0x80);
+    }
+  }
+  ResourceProvider::ResourceId resource =
+      resource_provider()->CreateResource(
+          tile_size, GL_RGBA, ResourceProvider::TextureUsageAny);
+  resource_provider()->SetPixels(resource,
+                                 static_cast<uint8_t*>(tile.getPixels()),
+                                 gfx::Rect(tile_size),
+                                 gfx::Rect(tile_size),
+                                 gfx::Vector2d());
+
+  RenderPass::Id root_render_pass_id = RenderPass::Id(1, 1);
+  scoped_ptr<TestRenderPass> root_render_pass = TestRenderPass::Create();
+  root_render_pass->SetNew(
+      root_render_pass_id, viewport_rect, viewport_rect, gfx::Transform());
+
+  // Front to back: a translucent solid color quad, a tile at an integer
+  // translation with opacity, and an opaque background scaled up from a
+  // smaller quad.
+  gfx::Rect color_rect(10, 10, 50, 50);
+  scoped_ptr<SharedQuadState> color_state = SharedQuadState::Create();
+  color_state->SetAll(
+      gfx::Transform(), viewport_size, viewport_rect, viewport_rect, false,
+      0.5f);
+  scoped_ptr<SolidColorDrawQuad> color_quad = SolidColorDrawQuad::Create();
+  color_quad->SetNew(
+      color_state.get(), color_rect, SkColorSetARGB(0xC0, 0xFF, 0, 0), false);
+  root_render_pass->AppendQuad(color_quad.PassAs<DrawQuad>());
+
+  gfx::Transform tile_transform;
+  tile_transform.Translate(20, 30);
+  scoped_ptr<SharedQuadState> tile_state = SharedQuadState::Create();
+  tile_state->SetAll(
+      tile_transform, tile_size, gfx::Rect(tile_size), viewport_rect, false,
+      0.7f);
+  scoped_ptr<TileDrawQuad> tile_quad = TileDrawQuad::Create();
+  tile_quad->SetNew(tile_state.get(),
+                    gfx::Rect(tile_size),
+                    gfx::Rect(),
+                    resource,
+                    gfx::RectF(tile_size),
+                    tile_size,
+                    false);
+  root_render_pass->AppendQuad(tile_quad.PassAs<DrawQuad>());
+
+  gfx::Transform background_transform;
+  background_transform.Scale(4, 4);
+  scoped_ptr<SharedQuadState> background_state = SharedQuadState::Create();
+  background_state->SetAll(
+      background_transform, gfx::Size(25, 25), gfx::Rect(25, 25),
+      viewport_rect, false, 1.f);
+  scoped_ptr<SolidColorDrawQuad> background_quad =
+      SolidColorDrawQuad::Create();
+  background_quad->SetNew(
+      background_state.get(), gfx::Rect(25, 25), SK_ColorWHITE, false);
+  root_render_pass->AppendQuad(background_quad.PassAs<DrawQuad>());
+
+  RenderPassList list;
+  list.push_back(root_render_pass.PassAs<RenderPass>());
+  renderer()->DrawFrame(&list);
+
+  SkBitmap output;
+  output.setConfig(SkBitmap::kARGB_8888_Config,
+                   viewport_size.width(),
+                   viewport_size.height());
+  output.allocPixels();
+  renderer()->GetFramebufferPixels(output.getPixels(), viewport_rect);
+
+  // Draw the same scene through SkCanvas.
+  SkBitmap expected;
+  expected.setConfig(SkBitmap::kARGB_8888_Config,
+                     viewport_size.width(),
+                     viewport_size.height());
+  expected.allocPixels();
+  SkCanvas canvas(expected);
+  canvas.drawColor(SK_ColorWHITE, SkXfermode::kSrc_Mode);
+  SkPaint tile_paint;
+  tile_paint.setAlpha(0.7f * 255);
+  canvas.drawBitmap(tile, 20, 30, &tile_paint);
+  SkPaint color_paint;
+  color_paint.setColor(SK_ColorRED);
+  color_paint.setAlpha(0.5f * 0xC0);
+  canvas.drawRect(gfx::RectToSkRect(color_rect), color_paint);
+
+  for (int y = 0; y < viewport_size.height(); ++y) {
+    for (int x = 0; x < viewport_size.width(); ++x) {
+      ASSERT_EQ(*expected.getAddr32(x, y), *output.getAddr32(x, y))
+          << "at " << x << ", " << y;
+    }
+  }
+}
+
 TEST_F(SoftwareRendererTest, ShouldClearRootRenderPass) {
   gfx::Rect viewport_rect(0, 0, 100, 100);
   set_viewport(viewport_rect);
@@ -0,0 +1,196 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/resources/compressed_bitmap.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+
+namespace cc {
+
+namespace {
+
+// Each op is a word holding the op in its top two bits and a pixel count in
+// the rest, followed by the op's pixels.
+enum Op {
+  // One pixel, repeated count times.
+  RUN_OP = 0,
+  // Count pixels, copied as is.
+  LITERAL_OP = 1,
+  // No pixels; count pixels are copied from the row above.
+  COPY_ABOVE_OP = 2
+};
+
+const int kOpShift = 30;
+const uint32 kMaxCount = (1u << kOpShift) - 1;
+
+// Shorter runs are cheaper to keep as part of a literal.
+const size_t kMinRunLength = 3;
+
+inline uint32 MakeOp(Op op, size_t count) {
+  DCHECK_LE(count, kMaxCount);
+  return (static_cast<uint32>(op) << kOpShift) | static_cast<uint32>(count);
+}
+
+class Encoder {
+ public:
+  Encoder(const uint32* pixels, size_t count, size_t width)
+      : pixels_(pixels),
+        count_(count),
+        width_(width),
+        literal_start_(0),
+        literal_count_(0),
+        data_(NULL) {}
+
+  // Returns false if the encoded pixels would be as large as |pixels|.
+  bool Encode(std::vector<uint32>* data) {
+    data_ = data;
+    data_->reserve(count_ / 4);
+    size_t i = 0;
+    while (i < count_) {
+      size_t run = RunLength(i);
+      size_t copy = CopyAboveLength(i);
+      if (std::max(run, copy) < kMinRunLength) {
+        if (!literal_count_)
+          literal_start_ = i;
+        ++literal_count_;
+        ++i;
+        continue;
+      }
+
+      FlushLiteral();
+      if (copy >= run) {
+        data_->push_back(MakeOp(COPY_ABOVE_OP, copy));
+        i += copy;
+      } else {
+        data_->push_back(MakeOp(RUN_OP, run));
+        data_->push_back(pixels_[i]);
+        i += run;
+      }
+      if (data_->size() >= count_)
+        return false;
+    }
+    FlushLiteral();
+    return data_->size() < count_;
+  }
+
+ private:
+  size_t RunLength(size_t i) const {
+    size_t end = std::min(count_, i + kMaxCount);
+    size_t j = i + 1;
+    while (j < end && pixels_[j] == pixels_[i])
+      ++j;
+    return j - i;
+  }
+
+  size_t CopyAboveLength(size_t i) const {
+    if (i < width_)
+      return 0;
+    size_t end = std::min(count_, i + kMaxCount);
+    size_t j = i;
+    while (j < end && pixels_[j] == pixels_[j - width_])
+      ++j;
+    return j - i;
+  }
+
+  void FlushLiteral() {
+    while (literal_count_) {
+      size_t count = std::min<size_t>(literal_count_, kMaxCount);
+      data_->push_back(MakeOp(LITERAL_OP, count));
+      data_->insert(data_->end(),
+                    pixels_ + literal_start_,
+                    pixels_ + literal_start_ + count);
+      literal_start_ += count;
+      literal_count_ -= count;
+    }
+  }
+
+  const uint32* pixels_;
+  size_t count_;
+  size_t width_;
+  size_t literal_start_;
+  size_t literal_count_;
+  std::vector<uint32>* data_;
+};
+
+}  // namespace
+
+// static
+scoped_ptr<CompressedBitmap> CompressedBitmap::Create(const SkBitmap& bitmap) {
+  DCHECK_EQ(SkBitmap::kARGB_8888_Config, bitmap.config());
+  SkAutoLockPixels lock(bitmap);
+  size_t width = bitmap.width();
+  size_t count = width * bitmap.height();
+  if (!count || !bitmap.getPixels())
+    return scoped_ptr<CompressedBitmap>();
+
+  // The encoder needs the rows next to each other.
+  std::vector<uint32> packed;
+  const uint32* pixels = bitmap.getAddr32(0, 0);
+  if (bitmap.rowBytes() != width * sizeof(uint32)) {
+    packed.reserve(count);
+    for (int y = 0; y < bitmap.height(); ++y) {
+      const uint32* row = bitmap.getAddr32(0, y);
+      packed.insert(packed.end(), row, row + width);
+    }
+    pixels = &packed[0];
+  }
+
+  std::vector<uint32> data;
+  Encoder encoder(pixels, count, width);
+  if (!encoder.Encode(&data))
+    return scoped_ptr<CompressedBitmap>();
+
+  return make_scoped_ptr(new CompressedBitmap(
+      gfx::Size(bitmap.width(), bitmap.height()), &data));
+}
+
+CompressedBitmap::CompressedBitmap(gfx::Size size, std::vector<uint32>* data)
+    : size_(size) {
+  data_.swap(*data);
+  // Don't hold on to what the encoder reserved.
+  std::vector<uint32>(data_).swap(data_);
+}
+
+CompressedBitmap::~CompressedBitmap() {}
+
+void CompressedBitmap::Decompress(uint8_t* pixels) const {
+  uint32* out = reinterpret_cast<uint32*>(pixels);
+  uint32* out_end = out + size_.GetArea();
+  size_t width = size_.width();
+  std::vector<uint32>::const_iterator it = data_.begin();
+  while (it != data_.end()) {
+    uint32 op = *it >> kOpShift;
+    uint32 count = *it & kMaxCount;
+    ++it;
+    DCHECK_LE(out + count, out_end);
+    switch (op) {
+      case RUN_OP:
+        std::fill(out, out + count, *it);
+        ++it;
+        break;
+      case LITERAL_OP:
+        std::copy(it, it + count, out);
+        it += count;
+        break;
+      case COPY_ABOVE_OP: {
+        // The source overlaps what this op writes when |count| is more
+        // than a row, so copy one pixel at a time.
+        const uint32* above = out - width;
+        for (uint32 i = 0; i < count; ++i)
+          out[i] = above[i];
+        break;
+      }
+      default:
+        NOTREACHED();
+        return;
+    }
+    out += count;
+  }
+  DCHECK_EQ(out_end, out);
+}
+
+}  // namespace cc
@@ -0,0 +1,49 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CC_RESOURCES_COMPRESSED_BITMAP_H_
+#define CC_RESOURCES_COMPRESSED_BITMAP_H_
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "cc/base/cc_export.h"
+#include "ui/gfx/size.h"
+
+class SkBitmap;
+
+namespace cc {
+
+// A losslessly compressed copy of a 32-bit bitmap. Pixels are stored as runs
+// of one color, runs copied from the row above, and literal pixels, which is
+// cheap to encode and decode and works well on rasterized web content, where
+// large areas are a single color or repeat vertically.
+class CC_EXPORT CompressedBitmap {
+ public:
+  // Returns NULL when compressing |bitmap| would not save any memory.
+  // |bitmap| must be an ARGB_8888 bitmap.
+  static scoped_ptr<CompressedBitmap> Create(const SkBitmap& bitmap);
+
+  ~CompressedBitmap();
+
+  gfx::Size size() const { return size_; }
+  size_t bytes() const { return data_.size() * sizeof(uint32); }
+
+  // Writes the pixels to |pixels|, which holds size().GetArea() pixels
+  // with no padding between rows.
+  void Decompress(uint8_t* pixels) const;
+
+ private:
+  CompressedBitmap(gfx::Size size, std::vector<uint32>* data);
+
+  gfx::Size size_;
+  std::vector<uint32> data_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompressedBitmap);
+};
+
+}  // namespace cc
+
+#endif  // CC_RESOURCES_COMPRESSED_BITMAP_H_
@@ -0,0 +1,95 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/resources/compressed_bitmap.h"
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+
+namespace cc {
+namespace {
+
+SkBitmap CreateBitmap(int width, int height) {
+  SkBitmap bitmap;
+  bitmap.setConfig(SkBitmap::kARGB_8888_Config, width, height);
+  bitmap.allocPixels();
+  bitmap.eraseColor(SK_ColorWHITE);
+  return bitmap;
+}
+
+void ExpectRoundTrip(const SkBitmap& bitmap) {
+  scoped_ptr<CompressedBitmap> compressed = CompressedBitmap::Create(bitmap);
+  ASSERT_TRUE(compressed.get());
+  EXPECT_EQ(bitmap.width(), compressed->size().width());
+  EXPECT_EQ(bitmap.height(), compressed->size().height());
+  EXPECT_LT(compressed->bytes(), bitmap.getSize());
+
+  std::vector<uint32> pixels(bitmap.width() * bitmap.height());
+  compressed->Decompress(reinterpret_cast<uint8_t*>(&pixels[0]));
+  SkAutoLockPixels lock(bitmap);
+  for (int y = 0; y < bitmap.height(); ++y) {
+    for (int x = 0; x < bitmap.width(); ++x) {
+      ASSERT_EQ(*bitmap.getAddr32(x, y), pixels[y * bitmap.width() + x])
+          << "at " << x << ", " << y;
+    }
+  }
+}
+
+TEST(CompressedBitmapTest, SolidColor) {
+  SkBitmap bitmap = CreateBitmap(256, 256);
+  scoped_ptr<CompressedBitmap> compressed = CompressedBitmap::Create(bitmap);
+  ASSERT_TRUE(compressed.get());
+  // The whole bitmap is a single run.
+  EXPECT_EQ(2 * sizeof(uint32), compressed->bytes());
+  ExpectRoundTrip(bitmap);
+}
+
+TEST(CompressedBitmapTest, PageLikeContent) {
+  // Lines of "text" and a few boxes on a white background.
+  SkBitmap bitmap = CreateBitmap(256, 256);
+  for (int y = 10; y < 250; y += 16) {
+    for (int x = 8; x < 240; x += 9)
+      bitmap.eraseArea(SkIRect::MakeXYWH(x, y, 5 + x % 3, 9), SK_ColorBLACK);
+  }
+  bitmap.eraseArea(SkIRect::MakeXYWH(20, 100, 120, 60), SK_ColorBLUE);
+  bitmap.eraseArea(SkIRect::MakeXYWH(0, 0, 1, 256), SK_ColorRED);
+  ExpectRoundTrip(bitmap);
+}
+
+TEST(CompressedBitmapTest, VerticalGradient) {
+  SkBitmap bitmap = CreateBitmap(100, 37);
+  for (int y = 0; y < bitmap.height(); ++y) {
+    bitmap.eraseArea(SkIRect::MakeXYWH(0, y, bitmap.width(), 1),
+                     SkColorSetARGB(255, y, 255 - y, y / 2));
+  }
+  ExpectRoundTrip(bitmap);
+}
+
+TEST(CompressedBitmapTest, HorizontalGradient) {
+  // Every row repeats the one above, but no two neighbors are the same.
+  SkBitmap bitmap = CreateBitmap(200, 50);
+  for (int x = 0; x < bitmap.width(); ++x) {
+    bitmap.eraseArea(SkIRect::MakeXYWH(x, 0, 1, bitmap.height()),
+                     SkColorSetARGB(255, x, 255 - x, 0));
+  }
+  ExpectRoundTrip(bitmap);
+}
+
+TEST(CompressedBitmapTest, NoiseIsNotCompressed) {
+  SkBitmap bitmap = CreateBitmap(64, 64);
+  SkAutoLockPixels lock(bitmap);
+  uint32 seed = 1;
+  for (int y = 0; y < bitmap.height(); ++y) {
+    for (int x = 0; x < bitmap.width(); ++x) {
+      seed = seed * 1103515245 + 12345;
+      *bitmap.getAddr32(x, y) = seed | 0xFF000000;
+    }
+  }
+  EXPECT_FALSE(CompressedBitmap::Create(bitmap).get());
+}
+
+}  // namespace
+}  // namespace cc
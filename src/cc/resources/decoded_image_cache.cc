@@ -0,0 +1,144 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/resources/decoded_image_cache.h"
+
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "skia/ext/lazy_pixel_ref.h"
+
+namespace cc {
+
+namespace {
+
+// Decoded images that no raster task uses are kept locked up to this limit.
+const size_t kDefaultMemoryLimitInBytes = 64 * 1024 * 1024;
+
+base::LazyInstance<DecodedImageCache>::Leaky g_decoded_image_cache =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+DecodedImageCache::Entry::Entry() : bytes(0), ref_count(0), decoded(false) {}
+
+DecodedImageCache::Entry::~Entry() {}
+
+// static
+DecodedImageCache* DecodedImageCache::GetInstance() {
+  return g_decoded_image_cache.Pointer();
+}
+
+DecodedImageCache::DecodedImageCache()
+    : entries_(EntryMap::NO_AUTO_EVICT),
+      memory_limit_in_bytes_(kDefaultMemoryLimitInBytes),
+      memory_usage_bytes_(0),
+      decoded_image_count_(0) {}
+
+DecodedImageCache::~DecodedImageCache() {
+  for (EntryMap::iterator it = entries_.begin(); it != entries_.end(); ++it) {
+    DCHECK_EQ(0, it->second.ref_count);
+    if (it->second.decoded)
+      UnlockEntry(&it->second);
+  }
+}
+
+void DecodedImageCache::SetMemoryLimitInBytes(size_t memory_limit_in_bytes) {
+  base::AutoLock lock(lock_);
+  memory_limit_in_bytes_ = memory_limit_in_bytes;
+  ReduceMemoryUsage(memory_limit_in_bytes_);
+}
+
+bool DecodedImageCache::RefImage(skia::LazyPixelRef* pixel_ref) {
+  base::AutoLock lock(lock_);
+  uint32_t id = pixel_ref->getGenerationID();
+  EntryMap::iterator it = entries_.Get(id);
+  if (it == entries_.end()) {
+    Entry entry;
+    entry.pixel_ref = skia::SharePtr(pixel_ref);
+    it = entries_.Put(id, entry);
+  }
+  ++it->second.ref_count;
+  return it->second.decoded;
+}
+
+void DecodedImageCache::UnrefImage(skia::LazyPixelRef* pixel_ref) {
+  base::AutoLock lock(lock_);
+  EntryMap::iterator it = entries_.Peek(pixel_ref->getGenerationID());
+  DCHECK(it != entries_.end());
+  DCHECK_LT(0, it->second.ref_count);
+  if (--it->second.ref_count)
+    return;
+
+  // Nothing will decode an image that no raster task needs anymore.
+  if (!it->second.decoded) {
+    entries_.Erase(it);
+    return;
+  }
+  ReduceMemoryUsage(memory_limit_in_bytes_);
+}
+
+void DecodedImageCache::DidDecodeImage(skia::LazyPixelRef* pixel_ref) {
+  base::AutoLock lock(lock_);
+  uint32_t id = pixel_ref->getGenerationID();
+  EntryMap::iterator it = entries_.Get(id);
+  if (it == entries_.end()) {
+    Entry entry;
+    entry.pixel_ref = skia::SharePtr(pixel_ref);
+    it = entries_.Put(id, entry);
+  }
+
+  Entry& entry = it->second;
+  if (entry.decoded)
+    return;
+
+  // The decode task still holds a lock, so this only adds a lock count.
+  pixel_ref->lockPixels();
+  entry.decoded = true;
+  entry.bytes = pixel_ref->DecodedSizeInBytes();
+  memory_usage_bytes_ += entry.bytes;
+  ++decoded_image_count_;
+  ReduceMemoryUsage(memory_limit_in_bytes_);
+}
+
+void DecodedImageCache::DiscardUnusedImages() {
+  base::AutoLock lock(lock_);
+  ReduceMemoryUsage(0);
+}
+
+size_t DecodedImageCache::memory_usage_bytes() const {
+  base::AutoLock lock(lock_);
+  return memory_usage_bytes_;
+}
+
+size_t DecodedImageCache::decoded_image_count() const {
+  base::AutoLock lock(lock_);
+  return decoded_image_count_;
+}
+
+void DecodedImageCache::ReduceMemoryUsage(size_t memory_limit_in_bytes) {
+  lock_.AssertAcquired();
+  EntryMap::reverse_iterator it = entries_.rbegin();
+  while (memory_usage_bytes_ > memory_limit_in_bytes &&
+         it != entries_.rend()) {
+    Entry& entry = it->second;
+    if (entry.ref_count || !entry.decoded) {
+      ++it;
+      continue;
+    }
+
+    UnlockEntry(&entry);
+    it = entries_.Erase(it);
+  }
+}
+
+void DecodedImageCache::UnlockEntry(Entry* entry) {
+  DCHECK(entry->decoded);
+  entry->pixel_ref->unlockPixels();
+  entry->decoded = false;
+  DCHECK_GE(memory_usage_bytes_, entry->bytes);
+  memory_usage_bytes_ -= entry->bytes;
+  --decoded_image_count_;
+}
+
+}  // namespace cc
@@ -0,0 +1,83 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CC_RESOURCES_DECODED_IMAGE_CACHE_H_
+#define CC_RESOURCES_DECODED_IMAGE_CACHE_H_
+
+#include "base/basictypes.h"
+#include "base/containers/mru_cache.h"
+#include "base/synchronization/lock.h"
+#include "cc/base/cc_export.h"
+#include "skia/ext/refptr.h"
+
+namespace skia {
+class LazyPixelRef;
+}
+
+namespace cc {
+
+// Keeps decoded lazy pixel refs locked, so that their pixels stay in the
+// image decoding store and raster tasks that draw them don't decode them
+// again. A pixel ref is a single image frame at a single scale, so entries
+// are keyed by pixel ref generation ID.
+//
+// Raster tasks hold a ref on every image they draw. Decoded images that no
+// raster task refs are unlocked, least recently used first, once the cache
+// goes over its memory limit.
+//
+// The cache is shared by all tile managers in the process, and is safe to
+// use from any thread.
+class CC_EXPORT DecodedImageCache {
+ public:
+  static DecodedImageCache* GetInstance();
+
+  DecodedImageCache();
+  ~DecodedImageCache();
+
+  void SetMemoryLimitInBytes(size_t memory_limit_in_bytes);
+
+  // Adds a ref on |pixel_ref|, which keeps it from being unlocked once it
+  // is decoded. Returns true if |pixel_ref| is already decoded.
+  bool RefImage(skia::LazyPixelRef* pixel_ref);
+  void UnrefImage(skia::LazyPixelRef* pixel_ref);
+
+  // Called when a decode task for |pixel_ref| has finished running. The
+  // task must still hold a lock on the pixels, so that locking them again
+  // doesn't decode them.
+  void DidDecodeImage(skia::LazyPixelRef* pixel_ref);
+
+  // Unlocks all decoded images that no raster task refs.
+  void DiscardUnusedImages();
+
+  size_t memory_usage_bytes() const;
+  size_t decoded_image_count() const;
+
+ private:
+  struct Entry {
+    Entry();
+    ~Entry();
+
+    skia::RefPtr<skia::LazyPixelRef> pixel_ref;
+    size_t bytes;
+    int ref_count;
+    bool decoded;
+  };
+  typedef base::HashingMRUCache<uint32_t, Entry> EntryMap;
+
+  // These are called with |lock_| held.
+  void ReduceMemoryUsage(size_t memory_limit_in_bytes);
+  void UnlockEntry(Entry* entry);
+
+  mutable base::Lock lock_;
+  EntryMap entries_;
+  size_t memory_limit_in_bytes_;
+  size_t memory_usage_bytes_;
+  size_t decoded_image_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(DecodedImageCache);
+};
+
+}  // namespace cc
+
+#endif  // CC_RESOURCES_DECODED_IMAGE_CACHE_H_
@@ -0,0 +1,158 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/resources/decoded_image_cache.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/time/time.h"
+#include "skia/ext/lazy_pixel_ref.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace cc {
+
+namespace {
+
+static const int kTimeLimitMillis = 2000;
+static const int kWarmupRuns = 5;
+static const int kTimeCheckInterval = 10;
+
+// A page with a column of large photos, rasterized in rows of tiles.
+static const int kImageCount = 20;
+static const int kImageWidth = 1024;
+static const int kImageHeight = 768;
+static const int kTileSize = 256;
+static const int kTilesPerRow = kImageWidth / kTileSize;
+
+// Stands in for a JPEG: locking the pixels allocates and fills them, and
+// unlocking them frees them again.
+class FakeJpegPixelRef : public skia::LazyPixelRef {
+ public:
+  explicit FakeJpegPixelRef(int* decode_count) : decode_count_(decode_count) {}
+  virtual ~FakeJpegPixelRef() {}
+
+  // Overridden from SkPixelRef:
+  virtual SkFlattenable::Factory getFactory() OVERRIDE { return NULL; }
+  virtual void* onLockPixels(SkColorTable** color_table) OVERRIDE {
+    ++*decode_count_;
+    pixels_.reset(new uint32[kImageWidth * kImageHeight]);
+    std::fill(pixels_.get(),
+              pixels_.get() + kImageWidth * kImageHeight,
+              static_cast<uint32>(getGenerationID()));
+    return pixels_.get();
+  }
+  virtual void onUnlockPixels() OVERRIDE { pixels_.reset(); }
+
+  // Overridden from skia::LazyPixelRef:
+  virtual bool PrepareToDecode(const PrepareParams& params) OVERRIDE {
+    return true;
+  }
+  virtual bool MaybeDecoded() OVERRIDE { return !!pixels_; }
+  virtual void Decode() OVERRIDE {}
+  virtual size_t DecodedSizeInBytes() const OVERRIDE {
+    return 4 * kImageWidth * kImageHeight;
+  }
+
+ private:
+  int* decode_count_;
+  scoped_ptr<uint32[]> pixels_;
+};
+
+class DecodedImageCachePerfTest : public testing::Test {
+ public:
+  DecodedImageCachePerfTest() : num_runs_(0), decode_count_(0) {}
+
+  // Overridden from testing::Test:
+  virtual void SetUp() OVERRIDE {
+    for (int i = 0; i < kImageCount; ++i) {
+      images_.push_back(
+          skia::AdoptRef(new FakeJpegPixelRef(&decode_count_)));
+    }
+  }
+
+  void AfterTest(const std::string test_name) {
+    // Format matches chrome/test/perf/perf_test.h:PrintResult
+    printf("*RESULT %s: %.2f runs/s\n",
+           test_name.c_str(),
+           num_runs_ / elapsed_.InSecondsF());
+    printf("*RESULT %s_decodes: %.2f decodes/run\n",
+           test_name.c_str(),
+           static_cast<double>(decode_count_) / num_runs_);
+  }
+
+  bool DidRun() {
+    ++num_runs_;
+    if (num_runs_ == kWarmupRuns)
+      start_time_ = base::TimeTicks::HighResNow();
+
+    if (!start_time_.is_null() && (num_runs_ % kTimeCheckInterval) == 0) {
+      base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start_time_;
+      if (elapsed >= base::TimeDelta::FromMilliseconds(kTimeLimitMillis)) {
+        elapsed_ = elapsed;
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // Does what the tile manager and raster worker pool do for a tile that
+  // draws |image|: a decode task runs unless the image is already decoded,
+  // and the raster task then locks the pixels while it draws.
+  void RasterTile(DecodedImageCache* cache, FakeJpegPixelRef* image) {
+    if (!cache->RefImage(image)) {
+      image->lockPixels();
+      cache->DidDecodeImage(image);
+      image->unlockPixels();
+    }
+
+    image->lockPixels();
+    image->unlockPixels();
+    cache->UnrefImage(image);
+  }
+
+  // Scrolls the page down and back up, rasterizing each row of tiles as it
+  // comes into view.
+  void RunScrollTest(const std::string test_name,
+                     size_t memory_limit_in_bytes) {
+    DecodedImageCache cache;
+    cache.SetMemoryLimitInBytes(memory_limit_in_bytes);
+
+    start_time_ = base::TimeTicks();
+    num_runs_ = 0;
+    decode_count_ = 0;
+    int rows = kImageCount * kImageHeight / kTileSize;
+    do {
+      for (int row = 0; row < 2 * rows; ++row) {
+        int y = (row < rows ? row : 2 * rows - row - 1) * kTileSize;
+        for (int x = 0; x < kTilesPerRow; ++x)
+          RasterTile(&cache, images_[y / kImageHeight].get());
+      }
+    } while (DidRun());
+
+    AfterTest(test_name);
+  }
+
+ private:
+  std::vector<skia::RefPtr<FakeJpegPixelRef> > images_;
+
+  base::TimeTicks start_time_;
+  base::TimeDelta elapsed_;
+  int num_runs_;
+  int decode_count_;
+};
+
+TEST_F(DecodedImageCachePerfTest, ScrollLargeImages) {
+  size_t image_bytes = 4 * kImageWidth * kImageHeight;
+  RunScrollTest("scroll_large_images_no_cache", 0);
+  RunScrollTest("scroll_large_images_cache_4", 4 * image_bytes);
+  RunScrollTest("scroll_large_images_cache_all", kImageCount * image_bytes);
+}
+
+}  // namespace
+
+}  // namespace cc
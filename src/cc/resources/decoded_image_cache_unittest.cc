@@ -0,0 +1,182 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/resources/decoded_image_cache.h"
+
+#include "base/memory/scoped_ptr.h"
+#include "skia/ext/lazy_pixel_ref.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace cc {
+namespace {
+
+const size_t kImageBytes = 4 * 100 * 100;
+
+// Counts how many times the pixels are decoded, which is whenever they are
+// locked while not already locked.
+class CountingLazyPixelRef : public skia::LazyPixelRef {
+ public:
+  CountingLazyPixelRef()
+      : pixels_(new char[kImageBytes]), decode_count_(0), locked_(false) {}
+  virtual ~CountingLazyPixelRef() {}
+
+  int decode_count() const { return decode_count_; }
+  bool locked() const { return locked_; }
+
+  // Decodes the image the way an image decode task does, which keeps the
+  // pixels locked until the cache has taken its own lock.
+  void DecodeAndCache(DecodedImageCache* cache) {
+    lockPixels();
+    cache->DidDecodeImage(this);
+    unlockPixels();
+  }
+
+  // Overridden from SkPixelRef:
+  virtual SkFlattenable::Factory getFactory() OVERRIDE { return NULL; }
+  virtual void* onLockPixels(SkColorTable** color_table) OVERRIDE {
+    ++decode_count_;
+    locked_ = true;
+    return pixels_.get();
+  }
+  virtual void onUnlockPixels() OVERRIDE { locked_ = false; }
+
+  // Overridden from skia::LazyPixelRef:
+  virtual bool PrepareToDecode(const PrepareParams& params) OVERRIDE {
+    return true;
+  }
+  virtual bool MaybeDecoded() OVERRIDE { return locked_; }
+  virtual void Decode() OVERRIDE {}
+  virtual size_t DecodedSizeInBytes() const OVERRIDE { return kImageBytes; }
+
+ private:
+  scoped_ptr<char[]> pixels_;
+  int decode_count_;
+  bool locked_;
+};
+
+TEST(DecodedImageCacheTest, DecodedImageIsShared) {
+  DecodedImageCache cache;
+  skia::RefPtr<CountingLazyPixelRef> image =
+      skia::AdoptRef(new CountingLazyPixelRef);
+
+  // The first raster task needs to wait for the image to be decoded.
+  EXPECT_FALSE(cache.RefImage(image.get()));
+  image->DecodeAndCache(&cache);
+  EXPECT_EQ(1, image->decode_count());
+  EXPECT_TRUE(image->locked());
+  EXPECT_EQ(kImageBytes, cache.memory_usage_bytes());
+  EXPECT_EQ(1u, cache.decoded_image_count());
+
+  // Later raster tasks use the decoded image, even once no task refs it.
+  cache.UnrefImage(image.get());
+  EXPECT_TRUE(cache.RefImage(image.get()));
+  EXPECT_TRUE(cache.RefImage(image.get()));
+  image->lockPixels();
+  image->unlockPixels();
+  cache.UnrefImage(image.get());
+  cache.UnrefImage(image.get());
+  EXPECT_EQ(1, image->decode_count());
+  EXPECT_TRUE(image->locked());
+}
+
+TEST(DecodedImageCacheTest, LeastRecentlyUsedImagesAreUnlocked) {
+  DecodedImageCache cache;
+  cache.SetMemoryLimitInBytes(2 * kImageBytes);
+
+  skia::RefPtr<CountingLazyPixelRef> images[3];
+  for (size_t i = 0; i < arraysize(images); ++i) {
+    images[i] = skia::AdoptRef(new CountingLazyPixelRef);
+    images[i]->DecodeAndCache(&cache);
+  }
+
+  // The first image was unlocked to make room for the third one.
+  EXPECT_FALSE(images[0]->locked());
+  EXPECT_EQ(2 * kImageBytes, cache.memory_usage_bytes());
+
+  // Using the second and then the third image makes the second the least
+  // recently used one.
+  EXPECT_TRUE(cache.RefImage(images[1].get()));
+  cache.UnrefImage(images[1].get());
+  EXPECT_TRUE(cache.RefImage(images[2].get()));
+  cache.UnrefImage(images[2].get());
+
+  skia::RefPtr<CountingLazyPixelRef> fourth =
+      skia::AdoptRef(new CountingLazyPixelRef);
+  fourth->DecodeAndCache(&cache);
+  EXPECT_FALSE(images[1]->locked());
+  EXPECT_TRUE(images[2]->locked());
+  EXPECT_TRUE(fourth->locked());
+  EXPECT_EQ(2 * kImageBytes, cache.memory_usage_bytes());
+  EXPECT_EQ(2u, cache.decoded_image_count());
+}
+
+TEST(DecodedImageCacheTest, ImagesUsedByRasterTasksAreKept) {
+  DecodedImageCache cache;
+  cache.SetMemoryLimitInBytes(kImageBytes);
+
+  skia::RefPtr<CountingLazyPixelRef> first =
+      skia::AdoptRef(new CountingLazyPixelRef);
+  skia::RefPtr<CountingLazyPixelRef> second =
+      skia::AdoptRef(new CountingLazyPixelRef);
+  EXPECT_FALSE(cache.RefImage(first.get()));
+  EXPECT_FALSE(cache.RefImage(second.get()));
+  first->DecodeAndCache(&cache);
+  second->DecodeAndCache(&cache);
+
+  // Both images are used, so the cache goes over its limit.
+  EXPECT_TRUE(first->locked());
+  EXPECT_TRUE(second->locked());
+  EXPECT_EQ(2 * kImageBytes, cache.memory_usage_bytes());
+
+  cache.UnrefImage(first.get());
+  EXPECT_FALSE(first->locked());
+  EXPECT_EQ(kImageBytes, cache.memory_usage_bytes());
+
+  cache.UnrefImage(second.get());
+  EXPECT_TRUE(second->locked());
+  EXPECT_EQ(kImageBytes, cache.memory_usage_bytes());
+}
+
+TEST(DecodedImageCacheTest, DiscardUnusedImages) {
+  DecodedImageCache cache;
+  skia::RefPtr<CountingLazyPixelRef> used =
+      skia::AdoptRef(new CountingLazyPixelRef);
+  skia::RefPtr<CountingLazyPixelRef> unused =
+      skia::AdoptRef(new CountingLazyPixelRef);
+  EXPECT_FALSE(cache.RefImage(used.get()));
+  used->DecodeAndCache(&cache);
+  unused->DecodeAndCache(&cache);
+
+  cache.DiscardUnusedImages();
+  EXPECT_TRUE(used->locked());
+  EXPECT_FALSE(unused->locked());
+  EXPECT_EQ(kImageBytes, cache.memory_usage_bytes());
+
+  cache.UnrefImage(used.get());
+  cache.DiscardUnusedImages();
+  EXPECT_FALSE(used->locked());
+  EXPECT_EQ(0u, cache.memory_usage_bytes());
+  EXPECT_EQ(0u, cache.decoded_image_count());
+}
+
+TEST(DecodedImageCacheTest, CanceledDecodeIsForgotten) {
+  DecodedImageCache cache;
+  skia::RefPtr<CountingLazyPixelRef> image =
+      skia::AdoptRef(new CountingLazyPixelRef);
+
+  // The raster task that needed the image was canceled before the image
+  // was decoded.
+  EXPECT_FALSE(cache.RefImage(image.get()));
+  cache.UnrefImage(image.get());
+  EXPECT_EQ(0, image->decode_count());
+
+  EXPECT_FALSE(cache.RefImage(image.get()));
+  image->DecodeAndCache(&cache);
+  cache.UnrefImage(image.get());
+  EXPECT_EQ(1, image->decode_count());
+  EXPECT_TRUE(image->locked());
+}
+
+}  // namespace
+}  // namespace cc
@@ -54,7 +54,10 @@ ManagedTileState::ManagedTileState()
       required_for_activation(false),
       time_to_needed_in_seconds(std::numeric_limits<float>::infinity()),
       distance_to_visible_in_pixels(std::numeric_limits<float>::infinity()),
-      visible_and_ready_to_draw(false) {
+      visible_and_ready_to_draw(false),
+      priority_changed(true),
+      prioritized_group(-1),
+      prioritized_index(0) {
   for (int i = 0; i < NUM_TREES; ++i) {
     tree_bin[i] = NEVER_BIN;
     bin[i] = NEVER_BIN;
@@ -68,6 +71,7 @@ ManagedTileState::TileVersion::TileVersion()
 
 ManagedTileState::TileVersion::~TileVersion() {
   DCHECK(!resource_);
+  DCHECK(!compressed_);
 }
 
 bool ManagedTileState::TileVersion::IsReadyToDraw() const {
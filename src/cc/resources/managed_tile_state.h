@@ -6,6 +6,7 @@
 #define CC_RESOURCES_MANAGED_TILE_STATE_H_
 
 #include "base/memory/scoped_ptr.h"
+#include "cc/resources/compressed_bitmap.h"
 #include "cc/resources/platform_color.h"
 #include "cc/resources/raster_worker_pool.h"
 #include "cc/resources/resource_pool.h"
@@ -122,6 +123,9 @@ class CC_EXPORT ManagedTileState {
       SkColor solid_color_;
       bool has_text_;
       scoped_ptr<ResourcePool::Resource> resource_;
+      // A copy of the pixels of a resource that was freed to save memory,
+      // which can be restored without rasterizing again.
+      scoped_ptr<CompressedBitmap> compressed_;
       RasterWorkerPool::RasterTask raster_task_;
   };
 
@@ -134,7 +138,8 @@ class CC_EXPORT ManagedTileState {
   TileVersion tile_versions[NUM_RASTER_MODES];
   RasterMode raster_mode;
 
-  // Ephemeral state, valid only during TileManager::ManageTiles.
+  // Binning state. TileManager only recomputes it when |priority_changed| is
+  // set or the global state that affects binning changes.
   bool is_in_never_bin_on_both_trees() const {
     return bin[HIGH_PRIORITY_BIN] == NEVER_BIN &&
            bin[LOW_PRIORITY_BIN] == NEVER_BIN;
@@ -156,6 +161,12 @@ class CC_EXPORT ManagedTileState {
   float time_to_needed_in_seconds;
   float distance_to_visible_in_pixels;
   bool visible_and_ready_to_draw;
+  bool priority_changed;
+
+  // The tile's place in the TileManager's PrioritizedTileSet, or -1 for
+  // |prioritized_group| when it isn't in the set.
+  int prioritized_group;
+  size_t prioritized_index;
 };
 
 }  // namespace cc
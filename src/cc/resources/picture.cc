@@ -8,6 +8,7 @@
 #include <limits>
 #include <set>
 
+#include "base/atomic_sequence_num.h"
 #include "base/base64.h"
 #include "base/debug/trace_event.h"
 #include "base/values.h"
@@ -34,6 +35,8 @@ namespace cc {
 
 namespace {
 
+base::StaticAtomicSequenceNumber g_next_picture_id;
+
 SkData* EncodeBitmap(size_t* offset, const SkBitmap& bm) {
   const int kJpegQuality = 80;
   std::vector<unsigned char> data;
@@ -88,7 +91,8 @@ scoped_refptr<Picture> Picture::Create(gfx::Rect layer_rect) {
 }
 
 Picture::Picture(gfx::Rect layer_rect)
-    : layer_rect_(layer_rect) {
+    : id_(g_next_picture_id.GetNext()),
+      layer_rect_(layer_rect) {
   // Instead of recording a trace event for object creation here, we wait for
   // the picture to be recorded in Picture::Record.
 }
@@ -134,15 +138,18 @@ scoped_refptr<Picture> Picture::CreateFromValue(const base::Value* raw_value) {
 Picture::Picture(SkPicture* picture,
                  gfx::Rect layer_rect,
                  gfx::Rect opaque_rect) :
+    id_(g_next_picture_id.GetNext()),
     layer_rect_(layer_rect),
     opaque_rect_(opaque_rect),
     picture_(skia::AdoptRef(picture)) {
 }
 
 Picture::Picture(const skia::RefPtr<SkPicture>& picture,
+                 int id,
                  gfx::Rect layer_rect,
                  gfx::Rect opaque_rect,
                  const PixelRefMap& pixel_refs) :
+    id_(id),
     layer_rect_(layer_rect),
     opaque_rect_(opaque_rect),
     picture_(picture),
@@ -173,6 +180,7 @@ void Picture::CloneForDrawing(int num_threads) {
   for (int i = 0; i < num_threads; i++) {
     scoped_refptr<Picture> clone = make_scoped_refptr(
         new Picture(skia::AdoptRef(new SkPicture(clones[i])),
+                    id_,
                     layer_rect_,
                     opaque_rect_,
                     pixel_refs_));
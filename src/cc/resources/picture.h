@@ -49,6 +49,10 @@ class CC_EXPORT Picture
   gfx::Rect LayerRect() const { return layer_rect_; }
   gfx::Rect OpaqueRect() const { return opaque_rect_; }
 
+  // Unique to each recording. Clones for drawing share the ID of the
+  // picture they were cloned from.
+  int id() const { return id_; }
+
   // Get thread-safe clone for rasterizing with on a specific thread.
   scoped_refptr<Picture> GetCloneForDrawingOnThread(
       unsigned thread_index) const;
@@ -121,6 +125,7 @@ class CC_EXPORT Picture
   // This constructor assumes SkPicture is already ref'd and transfers
   // ownership to this picture.
   Picture(const skia::RefPtr<SkPicture>&,
+          int id,
           gfx::Rect layer_rect,
           gfx::Rect opaque_rect,
           const PixelRefMap& pixel_refs);
@@ -130,6 +135,7 @@ class CC_EXPORT Picture
           gfx::Rect opaque_rect);
   ~Picture();
 
+  int id_;
   gfx::Rect layer_rect_;
   gfx::Rect opaque_rect_;
   skia::RefPtr<SkPicture> picture_;
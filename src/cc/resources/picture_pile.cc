@@ -42,6 +42,8 @@ bool PicturePile::Update(
   background_color_ = background_color;
   contents_opaque_ = contents_opaque;
 
+  analysis_cache_->Invalidate(invalidation);
+
   gfx::Rect interest_rect = visible_layer_rect;
   interest_rect.Inset(
       -kPixelDistanceToRecord,
@@ -0,0 +1,79 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/resources/picture_pile_analysis_cache.h"
+
+#include "cc/base/region.h"
+
+namespace {
+
+// A tile's worth of entries for every tile of several large layers. When
+// the cache fills up it is simply cleared, as the entries that matter are
+// re-added as soon as their tiles are analyzed again.
+const size_t kMaxEntries = 4096;
+
+}  // namespace
+
+namespace cc {
+
+PicturePileAnalysisCache::Entry::Entry() {
+}
+
+PicturePileAnalysisCache::Entry::~Entry() {
+}
+
+PicturePileAnalysisCache::PicturePileAnalysisCache() {
+}
+
+PicturePileAnalysisCache::~PicturePileAnalysisCache() {
+}
+
+bool PicturePileAnalysisCache::Lookup(gfx::Rect layer_rect,
+                                      const PictureIds& picture_ids,
+                                      Result* result) const {
+  base::AutoLock lock(lock_);
+
+  EntryMap::const_iterator it = entries_.find(layer_rect);
+  if (it == entries_.end() || it->second.picture_ids != picture_ids)
+    return false;
+
+  *result = it->second.result;
+  return true;
+}
+
+void PicturePileAnalysisCache::Insert(gfx::Rect layer_rect,
+                                      const PictureIds& picture_ids,
+                                      const Result& result) {
+  base::AutoLock lock(lock_);
+
+  if (entries_.size() >= kMaxEntries &&
+      entries_.find(layer_rect) == entries_.end())
+    entries_.clear();
+
+  Entry& entry = entries_[layer_rect];
+  entry.picture_ids = picture_ids;
+  entry.result = result;
+}
+
+void PicturePileAnalysisCache::Invalidate(const Region& layer_invalidation) {
+  if (layer_invalidation.IsEmpty())
+    return;
+
+  base::AutoLock lock(lock_);
+
+  for (EntryMap::iterator it = entries_.begin(); it != entries_.end();) {
+    if (layer_invalidation.Intersects(it->first))
+      entries_.erase(it++);
+    else
+      ++it;
+  }
+}
+
+size_t PicturePileAnalysisCache::size() const {
+  base::AutoLock lock(lock_);
+
+  return entries_.size();
+}
+
+}  // namespace cc
@@ -0,0 +1,80 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CC_RESOURCES_PICTURE_PILE_ANALYSIS_CACHE_H_
+#define CC_RESOURCES_PICTURE_PILE_ANALYSIS_CACHE_H_
+
+#include <map>
+#include <vector>
+
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "cc/base/cc_export.h"
+#include "third_party/skia/include/core/SkColor.h"
+#include "ui/gfx/rect.h"
+
+namespace cc {
+
+class Region;
+
+// Remembers the result of analyzing layer rects of a picture pile, so that
+// tiles covering the same content are not analyzed again when they are
+// re-rasterized or when a new pile is created from the same recordings on
+// commit. Each entry records the IDs of the pictures it was computed from
+// and is only returned while the same pictures cover the rect, which keeps
+// piles from different commits that share one cache from seeing each other's
+// stale results. Safe to use from any thread.
+class CC_EXPORT PicturePileAnalysisCache
+    : public base::RefCountedThreadSafe<PicturePileAnalysisCache> {
+ public:
+  struct Result {
+    Result() : is_solid_color(false), has_text(false), solid_color(0) {}
+
+    bool is_solid_color;
+    bool has_text;
+    SkColor solid_color;
+  };
+
+  typedef std::vector<int> PictureIds;
+
+  PicturePileAnalysisCache();
+
+  // Returns true and sets |result| if |layer_rect| was analyzed with the
+  // pictures in |picture_ids|.
+  bool Lookup(gfx::Rect layer_rect,
+              const PictureIds& picture_ids,
+              Result* result) const;
+  void Insert(gfx::Rect layer_rect,
+              const PictureIds& picture_ids,
+              const Result& result);
+
+  // Drops entries intersecting |layer_invalidation|. Their pictures are
+  // being re-recorded, so the entries can't be hit again.
+  void Invalidate(const Region& layer_invalidation);
+
+  size_t size() const;
+
+ private:
+  friend class base::RefCountedThreadSafe<PicturePileAnalysisCache>;
+
+  struct Entry {
+    Entry();
+    ~Entry();
+
+    PictureIds picture_ids;
+    Result result;
+  };
+  typedef std::map<gfx::Rect, Entry> EntryMap;
+
+  ~PicturePileAnalysisCache();
+
+  mutable base::Lock lock_;
+  EntryMap entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(PicturePileAnalysisCache);
+};
+
+}  // namespace cc
+
+#endif  // CC_RESOURCES_PICTURE_PILE_ANALYSIS_CACHE_H_
@@ -0,0 +1,66 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/resources/picture_pile_analysis_cache.h"
+
+#include "cc/base/region.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace cc {
+namespace {
+
+PicturePileAnalysisCache::Result SolidResult(SkColor color) {
+  PicturePileAnalysisCache::Result result;
+  result.is_solid_color = true;
+  result.solid_color = color;
+  return result;
+}
+
+TEST(PicturePileAnalysisCacheTest, LookupRequiresSamePictures) {
+  scoped_refptr<PicturePileAnalysisCache> cache(new PicturePileAnalysisCache);
+  gfx::Rect rect(0, 0, 256, 256);
+
+  PicturePileAnalysisCache::PictureIds ids;
+  ids.push_back(1);
+  ids.push_back(2);
+  cache->Insert(rect, ids, SolidResult(SK_ColorRED));
+
+  PicturePileAnalysisCache::Result result;
+  EXPECT_TRUE(cache->Lookup(rect, ids, &result));
+  EXPECT_TRUE(result.is_solid_color);
+  EXPECT_EQ(SK_ColorRED, result.solid_color);
+
+  // A different rect misses.
+  EXPECT_FALSE(cache->Lookup(gfx::Rect(0, 0, 128, 128), ids, &result));
+
+  // So does the same rect covered by a newer recording.
+  PicturePileAnalysisCache::PictureIds newer_ids(ids);
+  newer_ids.push_back(3);
+  EXPECT_FALSE(cache->Lookup(rect, newer_ids, &result));
+
+  // Inserting for the newer recording replaces the old entry.
+  cache->Insert(rect, newer_ids, SolidResult(SK_ColorBLUE));
+  EXPECT_FALSE(cache->Lookup(rect, ids, &result));
+  EXPECT_TRUE(cache->Lookup(rect, newer_ids, &result));
+  EXPECT_EQ(SK_ColorBLUE, result.solid_color);
+  EXPECT_EQ(1u, cache->size());
+}
+
+TEST(PicturePileAnalysisCacheTest, Invalidate) {
+  scoped_refptr<PicturePileAnalysisCache> cache(new PicturePileAnalysisCache);
+  PicturePileAnalysisCache::PictureIds ids(1, 1);
+  cache->Insert(gfx::Rect(0, 0, 256, 256), ids, SolidResult(SK_ColorRED));
+  cache->Insert(gfx::Rect(256, 0, 256, 256), ids, SolidResult(SK_ColorRED));
+  EXPECT_EQ(2u, cache->size());
+
+  cache->Invalidate(Region(gfx::Rect(300, 10, 5, 5)));
+  EXPECT_EQ(1u, cache->size());
+
+  PicturePileAnalysisCache::Result result;
+  EXPECT_TRUE(cache->Lookup(gfx::Rect(0, 0, 256, 256), ids, &result));
+  EXPECT_FALSE(cache->Lookup(gfx::Rect(256, 0, 256, 256), ids, &result));
+}
+
+}  // namespace
+}  // namespace cc
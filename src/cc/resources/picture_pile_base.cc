@@ -29,7 +29,8 @@ PicturePileBase::PicturePileBase()
       contents_opaque_(false),
       slow_down_raster_scale_factor_for_debug_(0),
       show_debug_picture_borders_(false),
-      num_raster_threads_(0) {
+      num_raster_threads_(0),
+      analysis_cache_(new PicturePileAnalysisCache) {
   tiling_.SetMaxTextureSize(gfx::Size(kBasePictureSize, kBasePictureSize));
   tile_grid_info_.fTileInterval.setEmpty();
   tile_grid_info_.fMargin.setEmpty();
@@ -47,7 +48,8 @@ PicturePileBase::PicturePileBase(const PicturePileBase* other)
       slow_down_raster_scale_factor_for_debug_(
           other->slow_down_raster_scale_factor_for_debug_),
       show_debug_picture_borders_(other->show_debug_picture_borders_),
-      num_raster_threads_(other->num_raster_threads_) {
+      num_raster_threads_(other->num_raster_threads_),
+      analysis_cache_(other->analysis_cache_) {
 }
 
 PicturePileBase::PicturePileBase(
@@ -61,7 +63,8 @@ PicturePileBase::PicturePileBase(
       slow_down_raster_scale_factor_for_debug_(
           other->slow_down_raster_scale_factor_for_debug_),
       show_debug_picture_borders_(other->show_debug_picture_borders_),
-      num_raster_threads_(other->num_raster_threads_) {
+      num_raster_threads_(other->num_raster_threads_),
+      analysis_cache_(other->analysis_cache_) {
   const PictureListMap& other_pic_list_map = other->picture_list_map_;
   for (PictureListMap::const_iterator map_iter = other_pic_list_map.begin();
        map_iter != other_pic_list_map.end(); ++map_iter) {
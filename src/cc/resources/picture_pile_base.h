@@ -14,6 +14,7 @@
 #include "cc/base/region.h"
 #include "cc/base/tiling_data.h"
 #include "cc/resources/picture.h"
+#include "cc/resources/picture_pile_analysis_cache.h"
 #include "ui/gfx/size.h"
 
 namespace base {
@@ -70,6 +71,10 @@ class CC_EXPORT PicturePileBase : public base::RefCounted<PicturePileBase> {
   bool show_debug_picture_borders_;
   int num_raster_threads_;
 
+  // Shared by every pile created from this one, including clones and the
+  // piles pushed to the impl thread on later commits.
+  scoped_refptr<PicturePileAnalysisCache> analysis_cache_;
+
  private:
   void SetBufferPixels(int buffer_pixels);
 
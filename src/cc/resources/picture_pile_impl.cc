@@ -192,6 +192,15 @@ void PicturePileImpl::RasterCommon(
       if (!unclipped.Intersects(content_clip))
         continue;
 
+      // Only the part of this picture that isn't covered by pictures above
+      // it can be drawn. Playing back with a clip around just that part lets
+      // the picture's bounding box hierarchy skip every op outside of it;
+      // the difference clips applied below leave the canvas clip bounds
+      // unchanged, so the hierarchy can't see them.
+      Region visible_region(unclipped);
+      visible_region.Intersect(content_clip);
+      gfx::Rect raster_clip = visible_region.bounds();
+
       base::TimeDelta total_duration =
           base::TimeDelta::FromInternalValue(0);
       base::TimeDelta best_duration =
@@ -205,7 +214,7 @@ void PicturePileImpl::RasterCommon(
         if (raster_stats)
           start_time = base::TimeTicks::HighResNow();
 
-        (*i)->Raster(canvas, callback, content_clip, contents_scale);
+        (*i)->Raster(canvas, callback, raster_clip, contents_scale);
 
         if (raster_stats) {
           base::TimeDelta duration = base::TimeTicks::HighResNow() - start_time;
@@ -291,17 +300,55 @@ void PicturePileImpl::AnalyzeInRect(gfx::Rect content_rect,
 
   layer_rect.Intersect(gfx::Rect(tiling_.total_size()));
 
-  SkBitmap empty_bitmap;
-  empty_bitmap.setConfig(SkBitmap::kNo_Config,
-                         layer_rect.width(),
-                         layer_rect.height());
-  skia::AnalysisDevice device(empty_bitmap);
-  skia::AnalysisCanvas canvas(&device);
+  // Debug borders are drawn into the analysis canvas too, so results
+  // can't be shared while they are showing.
+  bool use_cache = !show_debug_picture_borders_;
+
+  PicturePileAnalysisCache::PictureIds picture_ids;
+  PicturePileAnalysisCache::Result result;
+  if (use_cache) {
+    GetPictureIdsInRect(layer_rect, &picture_ids);
+    use_cache = !picture_ids.empty();
+  }
 
-  RasterForAnalysis(&canvas, layer_rect, 1.0f);
+  if (!use_cache ||
+      !analysis_cache_->Lookup(layer_rect, picture_ids, &result)) {
+    SkBitmap empty_bitmap;
+    empty_bitmap.setConfig(SkBitmap::kNo_Config,
+                           layer_rect.width(),
+                           layer_rect.height());
+    skia::AnalysisDevice device(empty_bitmap);
+    skia::AnalysisCanvas canvas(&device);
+
+    RasterForAnalysis(&canvas, layer_rect, 1.0f);
+
+    result.is_solid_color = canvas.GetColorIfSolid(&result.solid_color);
+    result.has_text = canvas.HasText();
+    if (use_cache)
+      analysis_cache_->Insert(layer_rect, picture_ids, result);
+  }
 
-  analysis->is_solid_color = canvas.GetColorIfSolid(&analysis->solid_color);
-  analysis->has_text = canvas.HasText();
+  analysis->is_solid_color = result.is_solid_color;
+  analysis->solid_color = result.solid_color;
+  analysis->has_text = result.has_text;
+}
+
+void PicturePileImpl::GetPictureIdsInRect(
+    gfx::Rect layer_rect,
+    PicturePileAnalysisCache::PictureIds* picture_ids) const {
+  for (TilingData::Iterator tile_iter(&tiling_, layer_rect);
+       tile_iter; ++tile_iter) {
+    PictureListMap::const_iterator map_iter =
+        picture_list_map_.find(tile_iter.index());
+    if (map_iter == picture_list_map_.end())
+      continue;
+    const PictureList& pic_list = map_iter->second;
+    for (PictureList::const_iterator i = pic_list.begin();
+         i != pic_list.end(); ++i) {
+      if ((*i)->LayerRect().Intersects(layer_rect))
+        picture_ids->push_back((*i)->id());
+    }
+  }
 }
 
 PicturePileImpl::Analysis::Analysis()
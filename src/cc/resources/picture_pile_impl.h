@@ -139,6 +139,12 @@ class CC_EXPORT PicturePileImpl : public PicturePileBase {
       float contents_scale,
       RasterStats* raster_stats);
 
+  // Appends the IDs of the pictures that cover |layer_rect| to
+  // |picture_ids|, tile by tile in recording order.
+  void GetPictureIdsInRect(
+      gfx::Rect layer_rect,
+      PicturePileAnalysisCache::PictureIds* picture_ids) const;
+
   // Once instantiated, |clones_for_drawing_| can't be modified.  This
   // guarantees thread-safe access during the life time of a PicturePileImpl
   // instance.  This member variable must be last so that other member
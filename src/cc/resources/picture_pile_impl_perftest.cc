@@ -0,0 +1,141 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/resources/picture_pile_impl.h"
+
+#include "base/time/time.h"
+#include "cc/test/fake_content_layer_client.h"
+#include "cc/test/fake_picture_pile_impl.h"
+#include "cc/test/fake_rendering_stats_instrumentation.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkDevice.h"
+#include "ui/gfx/rect.h"
+#include "ui/gfx/size_conversions.h"
+
+namespace cc {
+
+namespace {
+
+static const int kTimeLimitMillis = 2000;
+static const int kWarmupRuns = 1;
+static const int kTimeCheckInterval = 1;
+
+// A long page recorded in large pictures, covered by many small ops.
+static const int kPileTileSize = 512;
+static const int kLayerWidth = 1024;
+static const int kLayerHeight = 8192;
+static const int kCellSize = 16;
+
+class PicturePileImplPerfTest : public testing::Test {
+ public:
+  PicturePileImplPerfTest() : num_runs_(0) {}
+
+  // Overridden from testing::Test:
+  virtual void SetUp() OVERRIDE {
+    pile_ = FakePicturePileImpl::CreateFilledPile(
+        gfx::Size(kPileTileSize, kPileTileSize),
+        gfx::Size(kLayerWidth, kLayerHeight));
+    for (int y = 0; y < kLayerHeight; y += kCellSize) {
+      for (int x = 0; x < kLayerWidth; x += kCellSize) {
+        SkPaint paint;
+        paint.setColor(SkColorSetRGB(x % 256, y % 256, (x + y) % 256));
+        pile_->add_draw_rect_with_paint(
+            gfx::RectF(x, y, kCellSize - 4, kCellSize - 4), paint);
+      }
+    }
+    pile_->RerecordPile();
+
+    // Record a picture over the top half of every pile tile, as an
+    // invalidation would, so that the pictures underneath are only
+    // partially visible.
+    SkTileGridPicture::TileGridInfo tile_grid_info;
+    tile_grid_info.fTileInterval = SkISize::Make(256, 256);
+    tile_grid_info.fMargin.setEmpty();
+    tile_grid_info.fOffset.setZero();
+    FakeRenderingStatsInstrumentation stats_instrumentation;
+    for (int y = 0; y < pile_->tiling().num_tiles_y(); ++y) {
+      for (int x = 0; x < pile_->tiling().num_tiles_x(); ++x) {
+        gfx::Rect rect = pile_->tiling().TileBounds(x, y);
+        rect.set_height(rect.height() / 2);
+        scoped_refptr<Picture> picture = Picture::Create(rect);
+        picture->Record(&invalidation_client_,
+                        tile_grid_info,
+                        &stats_instrumentation);
+        pile_->AddPictureToRecording(x, y, picture);
+      }
+    }
+  }
+
+  bool DidRun() {
+    ++num_runs_;
+    if (num_runs_ == kWarmupRuns)
+      start_time_ = base::TimeTicks::HighResNow();
+
+    if (!start_time_.is_null() && (num_runs_ % kTimeCheckInterval) == 0) {
+      base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start_time_;
+      if (elapsed >= base::TimeDelta::FromMilliseconds(kTimeLimitMillis)) {
+        elapsed_ = elapsed;
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // Rasterizes the whole layer at |contents_scale| as tiles of
+  // |tile_size| content pixels, until the time limit is reached.
+  void RunRasterTest(const std::string test_name,
+                     int tile_size,
+                     float contents_scale) {
+    start_time_ = base::TimeTicks();
+    num_runs_ = 0;
+
+    gfx::Size content_bounds = gfx::ToCeiledSize(gfx::ScaleSize(
+        gfx::Size(kLayerWidth, kLayerHeight), contents_scale));
+
+    SkBitmap bitmap;
+    bitmap.setConfig(SkBitmap::kARGB_8888_Config, tile_size, tile_size);
+    bitmap.allocPixels();
+    SkDevice device(bitmap);
+
+    int num_tiles = 0;
+    do {
+      num_tiles = 0;
+      for (int y = 0; y < content_bounds.height(); y += tile_size) {
+        for (int x = 0; x < content_bounds.width(); x += tile_size) {
+          SkCanvas canvas(&device);
+          pile_->RasterToBitmap(&canvas,
+                                gfx::Rect(x, y, tile_size, tile_size),
+                                contents_scale,
+                                NULL);
+          ++num_tiles;
+        }
+      }
+    } while (DidRun());
+
+    // Format matches chrome/test/perf/perf_test.h:PrintResult
+    printf("*RESULT %s: %.2f tiles/s\n",
+           test_name.c_str(),
+           (num_runs_ - kWarmupRuns) * num_tiles / elapsed_.InSecondsF());
+  }
+
+ protected:
+  FakeContentLayerClient invalidation_client_;
+  scoped_refptr<FakePicturePileImpl> pile_;
+  base::TimeTicks start_time_;
+  base::TimeDelta elapsed_;
+  int num_runs_;
+};
+
+TEST_F(PicturePileImplPerfTest, RasterTiles) {
+  RunRasterTest("picture_pile_raster_256_1.0", 256, 1.f);
+  RunRasterTest("picture_pile_raster_64_1.0", 64, 1.f);
+  RunRasterTest("picture_pile_raster_256_0.5", 256, 0.5f);
+  RunRasterTest("picture_pile_raster_64_2.0", 64, 2.f);
+}
+
+}  // namespace
+
+}  // namespace cc
@@ -0,0 +1,156 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/resources/prioritized_tile_set.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "cc/resources/tile.h"
+
+namespace cc {
+
+class BinComparator {
+ public:
+  bool operator()(const Tile* a, const Tile* b) const {
+    const ManagedTileState& ams = a->managed_state();
+    const ManagedTileState& bms = b->managed_state();
+
+    if (ams.visible_and_ready_to_draw != bms.visible_and_ready_to_draw)
+      return ams.visible_and_ready_to_draw;
+
+    if (ams.bin[HIGH_PRIORITY_BIN] != bms.bin[HIGH_PRIORITY_BIN])
+      return ams.bin[HIGH_PRIORITY_BIN] < bms.bin[HIGH_PRIORITY_BIN];
+
+    if (ams.bin[LOW_PRIORITY_BIN] != bms.bin[LOW_PRIORITY_BIN])
+      return ams.bin[LOW_PRIORITY_BIN] < bms.bin[LOW_PRIORITY_BIN];
+
+    if (ams.required_for_activation != bms.required_for_activation)
+      return ams.required_for_activation;
+
+    if (ams.resolution != bms.resolution)
+      return ams.resolution < bms.resolution;
+
+    if (ams.time_to_needed_in_seconds !=  bms.time_to_needed_in_seconds)
+      return ams.time_to_needed_in_seconds < bms.time_to_needed_in_seconds;
+
+    if (ams.distance_to_visible_in_pixels !=
+        bms.distance_to_visible_in_pixels) {
+      return ams.distance_to_visible_in_pixels <
+             bms.distance_to_visible_in_pixels;
+    }
+
+    gfx::Rect a_rect = a->content_rect();
+    gfx::Rect b_rect = b->content_rect();
+    if (a_rect.y() != b_rect.y())
+      return a_rect.y() < b_rect.y();
+    return a_rect.x() < b_rect.x();
+  }
+};
+
+PrioritizedTileSet::PrioritizedTileSet() : size_(0) {
+  for (int group = 0; group < kNumGroups; ++group)
+    group_sorted_[group] = true;
+}
+
+PrioritizedTileSet::~PrioritizedTileSet() {
+  Clear();
+}
+
+// static
+int PrioritizedTileSet::GroupForTile(const Tile* tile) {
+  const ManagedTileState& mts = tile->managed_state();
+  return (mts.visible_and_ready_to_draw ? 0 : NUM_BINS * NUM_BINS) +
+         mts.bin[HIGH_PRIORITY_BIN] * NUM_BINS +
+         mts.bin[LOW_PRIORITY_BIN];
+}
+
+void PrioritizedTileSet::InsertTile(Tile* tile) {
+  int group = GroupForTile(tile);
+  ManagedTileState& mts = tile->managed_state();
+  if (mts.prioritized_group != group) {
+    RemoveTile(tile);
+    mts.prioritized_group = group;
+    mts.prioritized_index = groups_[group].size();
+    groups_[group].push_back(tile);
+    ++size_;
+  }
+  group_sorted_[group] = false;
+}
+
+void PrioritizedTileSet::RemoveTile(Tile* tile) {
+  ManagedTileState& mts = tile->managed_state();
+  int group = mts.prioritized_group;
+  if (group < 0)
+    return;
+
+  std::vector<Tile*>& tiles = groups_[group];
+  DCHECK_EQ(tile, tiles[mts.prioritized_index]);
+  Tile* last = tiles.back();
+  tiles[mts.prioritized_index] = last;
+  last->managed_state().prioritized_index = mts.prioritized_index;
+  tiles.pop_back();
+  group_sorted_[group] = false;
+
+  mts.prioritized_group = -1;
+  --size_;
+}
+
+void PrioritizedTileSet::Clear() {
+  for (int group = 0; group < kNumGroups; ++group) {
+    std::vector<Tile*>& tiles = groups_[group];
+    for (size_t i = 0; i < tiles.size(); ++i)
+      tiles[i]->managed_state().prioritized_group = -1;
+    tiles.clear();
+    group_sorted_[group] = true;
+  }
+  size_ = 0;
+}
+
+void PrioritizedTileSet::SortGroupIfNeeded(int group) {
+  if (group_sorted_[group])
+    return;
+
+  std::vector<Tile*>& tiles = groups_[group];
+  std::sort(tiles.begin(), tiles.end(), BinComparator());
+  for (size_t i = 0; i < tiles.size(); ++i)
+    tiles[i]->managed_state().prioritized_index = i;
+  group_sorted_[group] = true;
+}
+
+PrioritizedTileSet::Iterator::Iterator(PrioritizedTileSet* set,
+                                       bool use_priority_ordering)
+    : set_(set),
+      use_priority_ordering_(use_priority_ordering),
+      group_(0),
+      index_(0) {
+  if (use_priority_ordering_)
+    set_->SortGroupIfNeeded(group_);
+  SkipEmptyGroups();
+}
+
+PrioritizedTileSet::Iterator::~Iterator() {}
+
+PrioritizedTileSet::Iterator& PrioritizedTileSet::Iterator::operator++() {
+  DCHECK(*this);
+  ++index_;
+  SkipEmptyGroups();
+  return *this;
+}
+
+Tile* PrioritizedTileSet::Iterator::operator*() const {
+  DCHECK(*this);
+  return set_->groups_[group_][index_];
+}
+
+void PrioritizedTileSet::Iterator::SkipEmptyGroups() {
+  while (group_ < kNumGroups && index_ >= set_->groups_[group_].size()) {
+    ++group_;
+    index_ = 0;
+    if (group_ < kNumGroups && use_priority_ordering_)
+      set_->SortGroupIfNeeded(group_);
+  }
+}
+
+}  // namespace cc
@@ -0,0 +1,79 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CC_RESOURCES_PRIORITIZED_TILE_SET_H_
+#define CC_RESOURCES_PRIORITIZED_TILE_SET_H_
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "cc/base/cc_export.h"
+#include "cc/resources/managed_tile_state.h"
+
+namespace cc {
+class Tile;
+
+// The tiles TileManager may assign memory to, grouped by their bins. A tile
+// only moves between groups when its bins change, and a group is only
+// sorted when it is iterated in priority order, so tiles that are never
+// reached before memory runs out are never sorted.
+class CC_EXPORT PrioritizedTileSet {
+ public:
+  PrioritizedTileSet();
+  ~PrioritizedTileSet();
+
+  // Adds |tile|, or moves it to the group for its current bins if it is
+  // already in the set. Either way its position within the group is
+  // recomputed the next time the group is iterated in priority order.
+  void InsertTile(Tile* tile);
+  void RemoveTile(Tile* tile);
+  void Clear();
+
+  size_t size() const { return size_; }
+
+  // Visits the tiles, highest priority first when |use_priority_ordering|
+  // is true. The set must not be modified while iterating.
+  class CC_EXPORT Iterator {
+   public:
+    Iterator(PrioritizedTileSet* set, bool use_priority_ordering);
+    ~Iterator();
+
+    // Visits the remaining tiles without sorting any more groups. Use when
+    // the order of the remaining tiles no longer matters.
+    void DisablePriorityOrdering() { use_priority_ordering_ = false; }
+
+    Iterator& operator++();
+    Tile* operator->() const { return *(*this); }
+    Tile* operator*() const;
+    operator bool() const { return group_ < kNumGroups; }
+
+   private:
+    void SkipEmptyGroups();
+
+    PrioritizedTileSet* set_;
+    bool use_priority_ordering_;
+    int group_;
+    size_t index_;
+  };
+
+ private:
+  friend class Iterator;
+
+  // One group per combination of |visible_and_ready_to_draw| and the bins
+  // for both bin priorities, in the order BinComparator sorts them.
+  static const int kNumGroups = 2 * NUM_BINS * NUM_BINS;
+
+  static int GroupForTile(const Tile* tile);
+  void SortGroupIfNeeded(int group);
+
+  std::vector<Tile*> groups_[kNumGroups];
+  bool group_sorted_[kNumGroups];
+  size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(PrioritizedTileSet);
+};
+
+}  // namespace cc
+
+#endif  // CC_RESOURCES_PRIORITIZED_TILE_SET_H_
@@ -4,8 +4,13 @@
 
 #include "cc/resources/raster_worker_pool.h"
 
+#include <algorithm>
+
+#include "base/atomicops.h"
 #include "base/json/json_writer.h"
 #include "base/metrics/histogram.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
 #include "base/values.h"
 #include "cc/debug/benchmark_instrumentation.h"
 #include "cc/debug/devtools_instrumentation.h"
@@ -13,6 +18,8 @@
 #include "cc/resources/picture_pile_impl.h"
 #include "skia/ext/lazy_pixel_ref.h"
 #include "skia/ext/paint_simplifier.h"
+#include "skia/ext/refptr.h"
+#include "third_party/skia/include/core/SkDevice.h"
 
 namespace cc {
 
@@ -22,6 +29,19 @@ namespace {
 // a tile is of solid color.
 const bool kUseColorEstimator = true;
 
+// Tiles smaller than this many pixels are always rasterized by a
+// single thread.
+const int kMinParallelRasterArea = 256 * 256;
+
+// Limits on how finely a tile is split when other worker threads are
+// idle. Each band plays back the tile's pictures clipped to the band.
+const int kMaxRasterBands = 4;
+const int kMinRasterBandHeight = 64;
+
+// If not 0, the number of bands tiles are split into instead of one per
+// idle thread. See RasterWorkerPool::SetRasterBandCountForTesting().
+int g_raster_band_count_for_testing = 0;
+
 class DisableLCDTextFilter : public SkDrawFilter {
  public:
   // SkDrawFilter interface.
@@ -34,6 +54,89 @@ class DisableLCDTextFilter : public SkDrawFilter {
   }
 };
 
+// Rasterizes the bands of a tile on each thread that runs it. Bands
+// are claimed in order, so any number of threads can help, including
+// none besides the thread that owns the tile.
+class RasterBandsHelper : public internal::WorkerPoolTaskHelper {
+ public:
+  typedef base::Callback<void(gfx::Rect band,
+                              unsigned thread_index,
+                              PicturePileImpl::RasterStats* raster_stats)>
+      RasterBandCallback;
+
+  RasterBandsHelper(const RasterBandCallback& raster_band_callback,
+                    const std::vector<gfx::Rect>& bands,
+                    bool record_raster_stats)
+      : raster_band_callback_(raster_band_callback),
+        bands_(bands),
+        raster_stats_(bands.size()),
+        record_raster_stats_(record_raster_stats),
+        next_band_(0),
+        all_bands_finished_cv_(&lock_),
+        num_finished_bands_(0) {
+  }
+
+  // Overridden from internal::WorkerPoolTaskHelper:
+  virtual void RunOnWorkerThread(unsigned thread_index) OVERRIDE {
+    while (true) {
+      const int band =
+          base::subtle::NoBarrier_AtomicIncrement(&next_band_, 1) - 1;
+      if (band >= static_cast<int>(bands_.size()))
+        return;
+
+      raster_band_callback_.Run(
+          bands_[band],
+          thread_index,
+          record_raster_stats_ ? &raster_stats_[band] : NULL);
+
+      base::AutoLock lock(lock_);
+      if (++num_finished_bands_ == bands_.size())
+        all_bands_finished_cv_.Signal();
+    }
+  }
+
+  // Waits for bands claimed by other threads to finish, then sums the
+  // stats for all bands into |raster_stats|, if not NULL.
+  void WaitForAllBands(PicturePileImpl::RasterStats* raster_stats) {
+    {
+      base::AutoLock lock(lock_);
+      while (num_finished_bands_ < bands_.size())
+        all_bands_finished_cv_.Wait();
+    }
+
+    if (!raster_stats)
+      return;
+    raster_stats->total_pixels_rasterized = 0;
+    raster_stats->total_rasterize_time = base::TimeDelta();
+    raster_stats->best_rasterize_time = base::TimeDelta();
+    for (size_t i = 0; i < raster_stats_.size(); ++i) {
+      raster_stats->total_pixels_rasterized +=
+          raster_stats_[i].total_pixels_rasterized;
+      raster_stats->total_rasterize_time +=
+          raster_stats_[i].total_rasterize_time;
+      raster_stats->best_rasterize_time +=
+          raster_stats_[i].best_rasterize_time;
+    }
+  }
+
+ private:
+  virtual ~RasterBandsHelper() {}
+
+  const RasterBandCallback raster_band_callback_;
+  const std::vector<gfx::Rect> bands_;
+  std::vector<PicturePileImpl::RasterStats> raster_stats_;
+  const bool record_raster_stats_;
+
+  // Index of the next band to be claimed.
+  base::subtle::Atomic32 next_band_;
+
+  base::Lock lock_;
+  base::ConditionVariable all_bands_finished_cv_;
+  size_t num_finished_bands_;
+
+  DISALLOW_COPY_AND_ASSIGN(RasterBandsHelper);
+};
+
 class RasterWorkerPoolTaskImpl : public internal::RasterWorkerPoolTask {
  public:
   RasterWorkerPoolTaskImpl(const Resource* resource,
@@ -107,11 +210,60 @@ class RasterWorkerPoolTaskImpl : public internal::RasterWorkerPoolTask {
     if (analysis_.is_solid_color)
       return false;
 
+    PicturePileImpl::RasterStats raster_stats;
+    PicturePileImpl::RasterStats* raster_stats_or_null =
+        rendering_stats_->record_rendering_stats() ? &raster_stats : NULL;
+
+    // Split large tiles into bands when other worker threads are idle,
+    // so that one expensive tile doesn't hold up the frame.
+    int num_bands = 1;
+    if (content_rect_.width() * content_rect_.height() >=
+        kMinParallelRasterArea) {
+      int max_bands = g_raster_band_count_for_testing;
+      if (!max_bands) {
+        max_bands = static_cast<int>(
+            WorkerPool::GetIdleThreadCountForCurrentTask()) + 1;
+      }
+      num_bands = std::min(
+          max_bands,
+          std::min(kMaxRasterBands,
+                   content_rect_.height() / kMinRasterBandHeight));
+    }
+
+    if (num_bands > 1) {
+      RasterInBands(device, num_bands, thread_index, raster_stats_or_null);
+    } else {
+      SkCanvas canvas(device);
+      RasterRect(&canvas, content_rect_, thread_index, raster_stats_or_null);
+    }
+
+    if (raster_stats_or_null) {
+      rendering_stats_->AddRaster(
+          raster_stats.total_rasterize_time,
+          raster_stats.best_rasterize_time,
+          raster_stats.total_pixels_rasterized,
+          is_tile_in_pending_tree_now_bin_);
+
+      HISTOGRAM_CUSTOM_COUNTS(
+          "Renderer4.PictureRasterTimeUS",
+          raster_stats.total_rasterize_time.InMicroseconds(),
+          0,
+          100000,
+          100);
+    }
+    return true;
+  }
+
+  // Rasterizes |rect|, which is in content space and lies within
+  // |content_rect_|, into |canvas| using the picture clone for
+  // |thread_index|.
+  void RasterRect(SkCanvas* canvas,
+                  gfx::Rect rect,
+                  unsigned thread_index,
+                  PicturePileImpl::RasterStats* raster_stats) {
     PicturePileImpl* picture_clone =
         picture_pile_->GetCloneForDrawingOnThread(thread_index);
 
-    SkCanvas canvas(device);
-
     skia::RefPtr<SkDrawFilter> draw_filter;
     switch (raster_mode_) {
       case LOW_QUALITY_RASTER_MODE:
@@ -127,29 +279,61 @@ class RasterWorkerPoolTaskImpl : public internal::RasterWorkerPoolTask {
         NOTREACHED();
     }
 
-    canvas.setDrawFilter(draw_filter.get());
+    canvas->setDrawFilter(draw_filter.get());
 
-    if (rendering_stats_->record_rendering_stats()) {
-      PicturePileImpl::RasterStats raster_stats;
-      picture_clone->RasterToBitmap(
-          &canvas, content_rect_, contents_scale_, &raster_stats);
-      rendering_stats_->AddRaster(
-          raster_stats.total_rasterize_time,
-          raster_stats.best_rasterize_time,
-          raster_stats.total_pixels_rasterized,
-          is_tile_in_pending_tree_now_bin_);
+    picture_clone->RasterToBitmap(
+        canvas, rect, contents_scale_, raster_stats);
+  }
 
-      HISTOGRAM_CUSTOM_COUNTS(
-          "Renderer4.PictureRasterTimeUS",
-          raster_stats.total_rasterize_time.InMicroseconds(),
-          0,
-          100000,
-          100);
-    } else {
-      picture_clone->RasterToBitmap(
-          &canvas, content_rect_, contents_scale_, NULL);
+  // Rasterizes |band| into the rows of |device| it covers. Called by
+  // RasterBandsHelper, possibly on another worker thread.
+  void RasterBand(SkDevice* device,
+                  gfx::Rect band,
+                  unsigned thread_index,
+                  PicturePileImpl::RasterStats* raster_stats) {
+    TRACE_EVENT0("cc", "RasterWorkerPoolTaskImpl::RasterBand");
+
+    // Each band gets its own bitmap sharing the device's pixels, so
+    // that clearing the canvas only clears that band.
+    const SkBitmap& device_bitmap = device->accessBitmap(true);
+    SkAutoLockPixels lock_pixels(device_bitmap);
+    SkBitmap band_bitmap;
+    band_bitmap.setConfig(device_bitmap.config(),
+                          band.width(),
+                          band.height(),
+                          device_bitmap.rowBytes());
+    band_bitmap.setPixels(
+        device_bitmap.getAddr(0, band.y() - content_rect_.y()));
+    SkDevice band_device(band_bitmap);
+    SkCanvas canvas(&band_device);
+    RasterRect(&canvas, band, thread_index, raster_stats);
+  }
+
+  // Splits |content_rect_| into |num_bands| horizontal bands and
+  // rasterizes them on this thread and any idle worker threads.
+  void RasterInBands(SkDevice* device,
+                     int num_bands,
+                     unsigned thread_index,
+                     PicturePileImpl::RasterStats* raster_stats) {
+    std::vector<gfx::Rect> bands;
+    for (int i = 0; i < num_bands; ++i) {
+      int top = content_rect_.y() + content_rect_.height() * i / num_bands;
+      int bottom =
+          content_rect_.y() + content_rect_.height() * (i + 1) / num_bands;
+      bands.push_back(gfx::Rect(
+          content_rect_.x(), top, content_rect_.width(), bottom - top));
     }
-    return true;
+
+    scoped_refptr<RasterBandsHelper> helper(new RasterBandsHelper(
+        base::Bind(&RasterWorkerPoolTaskImpl::RasterBand,
+                   base::Unretained(this),
+                   device),
+        bands,
+        raster_stats != NULL));
+    WorkerPool::AddTaskHelper(helper.get());
+    helper->RunOnWorkerThread(thread_index);
+    WorkerPool::RemoveTaskHelper(helper.get());
+    helper->WaitForAllBands(raster_stats);
   }
 
   // Overridden from internal::RasterWorkerPoolTask:
@@ -199,10 +383,11 @@ class ImageDecodeWorkerPoolTaskImpl : public internal::WorkerPoolTask {
                                 int layer_id,
                                 RenderingStatsInstrumentation* rendering_stats,
                                 const RasterWorkerPool::Task::Reply& reply)
-      : pixel_ref_(pixel_ref),
+      : pixel_ref_(skia::SharePtr(pixel_ref)),
         layer_id_(layer_id),
         rendering_stats_(rendering_stats),
-        reply_(reply) {}
+        reply_(reply),
+        locked_pixels_(false) {}
 
   // Overridden from internal::WorkerPoolTask:
   virtual void RunOnWorkerThread(unsigned thread_index) OVERRIDE {
@@ -210,7 +395,10 @@ class ImageDecodeWorkerPoolTaskImpl : public internal::WorkerPoolTask {
     devtools_instrumentation::ScopedLayerTask image_decode_task(
         devtools_instrumentation::kImageDecodeTask, layer_id_);
     base::TimeTicks start_time = rendering_stats_->StartRecording();
-    pixel_ref_->Decode();
+    // Keep the pixels locked until the reply has run, so the decoded image
+    // can't be discarded before the reply gets a chance to lock it too.
+    pixel_ref_->lockPixels();
+    locked_pixels_ = true;
     base::TimeDelta duration = rendering_stats_->EndRecording(start_time);
     rendering_stats_->AddDeferredImageDecode(duration);
   }
@@ -219,13 +407,17 @@ class ImageDecodeWorkerPoolTaskImpl : public internal::WorkerPoolTask {
   }
 
  protected:
-  virtual ~ImageDecodeWorkerPoolTaskImpl() {}
+  virtual ~ImageDecodeWorkerPoolTaskImpl() {
+    if (locked_pixels_)
+      pixel_ref_->unlockPixels();
+  }
 
  private:
-  skia::LazyPixelRef* pixel_ref_;
+  skia::RefPtr<skia::LazyPixelRef> pixel_ref_;
   int layer_id_;
   RenderingStatsInstrumentation* rendering_stats_;
   const RasterWorkerPool::Task::Reply reply_;
+  bool locked_pixels_;
 
   DISALLOW_COPY_AND_ASSIGN(ImageDecodeWorkerPoolTaskImpl);
 };
@@ -408,6 +600,12 @@ RasterWorkerPool::Task RasterWorkerPool::CreateImageDecodeTask(
                                                 reply));
 }
 
+// static
+void RasterWorkerPool::SetRasterBandCountForTesting(int num_bands) {
+  DCHECK_GE(num_bands, 0);
+  g_raster_band_count_for_testing = num_bands;
+}
+
 RasterWorkerPool::RasterWorkerPool(ResourceProvider* resource_provider,
                                    size_t num_threads)
     : WorkerPool(num_threads, kWorkerThreadNamePrefix),
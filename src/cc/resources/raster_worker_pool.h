@@ -205,6 +205,12 @@ class CC_EXPORT RasterWorkerPool : public WorkerPool {
       RenderingStatsInstrumentation* stats_instrumentation,
       const Task::Reply& reply);
 
+  // Makes raster tasks split tiles that are large enough into |num_bands|
+  // bands whether or not other worker threads are idle. Bands nobody helps
+  // with are rasterized by the thread running the task. 0 restores the
+  // default.
+  static void SetRasterBandCountForTesting(int num_bands);
+
  protected:
   typedef std::vector<scoped_refptr<internal::WorkerPoolTask> > TaskVector;
   typedef std::vector<scoped_refptr<internal::RasterWorkerPoolTask> >
@@ -4,8 +4,21 @@
 
 #include "cc/resources/raster_worker_pool.h"
 
+#include <algorithm>
+
+#include "base/threading/platform_thread.h"
 #include "base/time/time.h"
+#include "cc/base/completion_event.h"
+#include "cc/base/region.h"
+#include "cc/debug/rendering_stats_instrumentation.h"
+#include "cc/resources/picture_pile.h"
+#include "cc/resources/picture_pile_impl.h"
+#include "cc/resources/resource.h"
+#include "cc/test/fake_content_layer_client.h"
+#include "skia/ext/refptr.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkDevice.h"
+#include "third_party/skia/include/effects/SkBlurMaskFilter.h"
 
 namespace cc {
 
@@ -15,6 +28,10 @@ static const int kTimeLimitMillis = 2000;
 static const int kWarmupRuns = 5;
 static const int kTimeCheckInterval = 10;
 
+static const int kLatencyRuns = 50;
+static const int kLatencyTileSize = 512;
+static const size_t kLatencyNumRasterThreads = 4;
+
 class PerfWorkerPoolTaskImpl : public internal::WorkerPoolTask {
  public:
   // Overridden from internal::WorkerPoolTask:
@@ -114,6 +131,90 @@ class PerfRasterWorkerPool : public RasterWorkerPool {
   DISALLOW_COPY_AND_ASSIGN(PerfRasterWorkerPool);
 };
 
+class LatencyWorkerPoolTaskImpl : public internal::WorkerPoolTask {
+ public:
+  LatencyWorkerPoolTaskImpl(internal::RasterWorkerPoolTask* task,
+                            CompletionEvent* did_run)
+      : task_(task),
+        did_run_(did_run) {
+  }
+
+  // Overridden from internal::WorkerPoolTask:
+  virtual void RunOnWorkerThread(unsigned thread_index) OVERRIDE {
+    SkBitmap bitmap;
+    bitmap.setConfig(SkBitmap::kARGB_8888_Config,
+                     task_->resource()->size().width(),
+                     task_->resource()->size().height());
+    bitmap.allocPixels();
+    SkDevice device(bitmap);
+    task_->RunOnWorkerThread(&device, thread_index);
+    did_run_->Signal();
+  }
+  virtual void CompleteOnOriginThread() OVERRIDE {
+    task_->DidRun(!HasFinishedRunning());
+    task_->WillComplete();
+    task_->CompleteOnOriginThread();
+    task_->DidComplete();
+  }
+
+ private:
+  virtual ~LatencyWorkerPoolTaskImpl() {}
+
+  scoped_refptr<internal::RasterWorkerPoolTask> task_;
+  CompletionEvent* did_run_;
+
+  DISALLOW_COPY_AND_ASSIGN(LatencyWorkerPoolTaskImpl);
+};
+
+// Rasterizes tiles one at a time into plain bitmaps, so that the time
+// taken by a single tile can be measured with the other worker
+// threads idle.
+class LatencyRasterWorkerPool : public RasterWorkerPool {
+ public:
+  LatencyRasterWorkerPool()
+      : RasterWorkerPool(NULL, kLatencyNumRasterThreads) {}
+  virtual ~LatencyRasterWorkerPool() {}
+
+  // Overridden from RasterWorkerPool:
+  virtual void ScheduleTasks(RasterTask::Queue* queue) OVERRIDE {
+    NOTREACHED();
+  }
+  virtual void OnRasterTasksFinished() OVERRIDE {
+    NOTREACHED();
+  }
+  virtual void OnRasterTasksRequiredForActivationFinished() OVERRIDE {
+    NOTREACHED();
+  }
+
+  // Runs the single raster task in |queue| and returns once it has
+  // finished running and completed.
+  void RunTask(RasterTask::Queue* queue) {
+    SetRasterTasks(queue);
+    DCHECK_EQ(1u, raster_tasks().size());
+
+    scoped_refptr<internal::RasterWorkerPoolTask> raster_task(
+        raster_tasks().front());
+    CompletionEvent did_run;
+    scoped_refptr<internal::WorkerPoolTask> latency_task(
+        new LatencyWorkerPoolTaskImpl(raster_task.get(), &did_run));
+    TaskGraph graph;
+    CreateGraphNodeForTask(latency_task.get(), 0u, &graph);
+    SetTaskGraph(&graph);
+
+    did_run.Wait();
+    // The worker thread may not have handed the task back yet.
+    while (true) {
+      CheckForCompletedTasks();
+      if (raster_task->HasCompleted())
+        break;
+      base::PlatformThread::YieldCurrentThread();
+    }
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(LatencyRasterWorkerPool);
+};
+
 class RasterWorkerPoolPerfTest : public testing::Test {
  public:
   RasterWorkerPoolPerfTest() : num_runs_(0) {}
@@ -235,6 +336,109 @@ TEST_F(RasterWorkerPoolPerfTest, BuildTaskGraph) {
   RunBuildTaskGraphTest("build_task_graph_1000_16", 1000, 16);
 }
 
+class RasterWorkerPoolLatencyPerfTest : public testing::Test {
+ public:
+  RasterWorkerPoolLatencyPerfTest()
+      : rendering_stats_(RenderingStatsInstrumentation::Create()) {}
+
+  // Overridden from testing::Test:
+  virtual void SetUp() OVERRIDE {
+    // Overlapping blurred rects make every tile expensive to
+    // rasterize and keep it from being analyzed as a solid color.
+    gfx::Rect layer_rect(kLatencyTileSize, kLatencyTileSize);
+    for (int i = 0; i < 200; ++i) {
+      SkPaint paint;
+      paint.setColor(SkColorSetARGB(128, i * 37 % 256, i * 91 % 256, 255));
+      skia::RefPtr<SkMaskFilter> blur = skia::AdoptRef(
+          SkBlurMaskFilter::Create(8, SkBlurMaskFilter::kNormal_BlurStyle));
+      paint.setMaskFilter(blur.get());
+      client_.add_draw_rect(
+          gfx::RectF(i * 13 % 384, i * 29 % 384, 128, 128), paint);
+    }
+
+    scoped_refptr<PicturePile> pile(new PicturePile);
+    pile->Resize(layer_rect.size());
+    pile->SetTileGridSize(gfx::Size(256, 256));
+    pile->set_num_raster_threads(kLatencyNumRasterThreads);
+    pile->Update(&client_,
+                 SK_ColorWHITE,
+                 false,
+                 Region(layer_rect),
+                 layer_rect,
+                 rendering_stats_.get());
+    picture_pile_ = PicturePileImpl::CreateFromOther(pile.get());
+  }
+
+  void RunRasterLatencyTest(const std::string test_name,
+                            bool parallel_tile_raster) {
+    LatencyRasterWorkerPool raster_worker_pool;
+    raster_worker_pool.SetTaskHelpersEnabled(parallel_tile_raster);
+
+    gfx::Rect content_rect(kLatencyTileSize, kLatencyTileSize);
+    Resource resource(1, content_rect.size(), GL_RGBA);
+    base::TimeDelta total_latency;
+    base::TimeDelta worst_latency;
+    for (int i = 0; i < kWarmupRuns + kLatencyRuns; ++i) {
+      RasterWorkerPool::Task::Set dependencies;
+      RasterWorkerPool::RasterTask::Queue tasks;
+      tasks.Append(
+          RasterWorkerPool::CreateRasterTask(
+              &resource,
+              picture_pile_.get(),
+              content_rect,
+              1.0,
+              HIGH_QUALITY_RASTER_MODE,
+              false,
+              TileResolution(),
+              1,
+              NULL,
+              1,
+              rendering_stats_.get(),
+              base::Bind(
+                  &RasterWorkerPoolLatencyPerfTest::OnRasterTaskCompleted),
+              &dependencies),
+          false);
+
+      base::TimeTicks start_time = base::TimeTicks::HighResNow();
+      raster_worker_pool.RunTask(&tasks);
+      base::TimeDelta latency = base::TimeTicks::HighResNow() - start_time;
+
+      if (i < kWarmupRuns)
+        continue;
+      total_latency += latency;
+      worst_latency = std::max(worst_latency, latency);
+    }
+
+    raster_worker_pool.Shutdown();
+
+    // Format matches chrome/test/perf/perf_test.h:PrintResult
+    printf("*RESULT %s_mean: %.2f ms\n",
+           test_name.c_str(),
+           total_latency.InMillisecondsF() / kLatencyRuns);
+    printf("*RESULT %s_worst: %.2f ms\n",
+           test_name.c_str(),
+           worst_latency.InMillisecondsF());
+  }
+
+ protected:
+  static void OnRasterTaskCompleted(const PicturePileImpl::Analysis& analysis,
+                                    bool was_canceled) {
+    EXPECT_FALSE(analysis.is_solid_color);
+    EXPECT_FALSE(was_canceled);
+  }
+
+  FakeContentLayerClient client_;
+  scoped_ptr<RenderingStatsInstrumentation> rendering_stats_;
+  scoped_refptr<PicturePileImpl> picture_pile_;
+};
+
+// Measures how long one expensive tile takes when it is the only
+// work available, with and without idle threads helping.
+TEST_F(RasterWorkerPoolLatencyPerfTest, SingleTileLatency) {
+  RunRasterLatencyTest("single_tile_raster_latency", false);
+  RunRasterLatencyTest("single_tile_raster_latency_parallel", true);
+}
+
 }  // namespace
 
 }  // namespace cc
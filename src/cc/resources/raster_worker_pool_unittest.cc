@@ -4,16 +4,25 @@
 
 #include "cc/resources/raster_worker_pool.h"
 
+#include <string.h>
+
 #include <vector>
 
+#include "base/threading/platform_thread.h"
+#include "cc/base/completion_event.h"
+#include "cc/base/region.h"
+#include "cc/debug/rendering_stats_instrumentation.h"
 #include "cc/resources/image_raster_worker_pool.h"
 #include "cc/resources/picture_pile.h"
 #include "cc/resources/picture_pile_impl.h"
 #include "cc/resources/pixel_buffer_raster_worker_pool.h"
+#include "cc/resources/resource.h"
 #include "cc/resources/resource_provider.h"
 #include "cc/resources/scoped_resource.h"
+#include "cc/test/fake_content_layer_client.h"
 #include "cc/test/fake_output_surface.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkDevice.h"
 
 namespace cc {
 
@@ -275,6 +284,213 @@ class RasterWorkerPoolTestFailedMapResource : public RasterWorkerPoolTest {
 
 PIXEL_BUFFER_AND_IMAGE_TEST_F(RasterWorkerPoolTestFailedMapResource);
 
+const size_t kBandTestNumRasterThreads = 4;
+
+// Runs a raster task into a bitmap instead of a resource.
+class BitmapWorkerPoolTaskImpl : public internal::WorkerPoolTask {
+ public:
+  BitmapWorkerPoolTaskImpl(internal::RasterWorkerPoolTask* task,
+                           SkBitmap* bitmap,
+                           CompletionEvent* did_run)
+      : task_(task),
+        bitmap_(bitmap),
+        did_run_(did_run) {
+  }
+
+  // Overridden from internal::WorkerPoolTask:
+  virtual void RunOnWorkerThread(unsigned thread_index) OVERRIDE {
+    SkDevice device(*bitmap_);
+    task_->RunOnWorkerThread(&device, thread_index);
+    did_run_->Signal();
+  }
+  virtual void CompleteOnOriginThread() OVERRIDE {
+    task_->DidRun(!HasFinishedRunning());
+    task_->WillComplete();
+    task_->CompleteOnOriginThread();
+    task_->DidComplete();
+  }
+
+ private:
+  virtual ~BitmapWorkerPoolTaskImpl() {}
+
+  scoped_refptr<internal::RasterWorkerPoolTask> task_;
+  SkBitmap* bitmap_;
+  CompletionEvent* did_run_;
+
+  DISALLOW_COPY_AND_ASSIGN(BitmapWorkerPoolTaskImpl);
+};
+
+// Rasterizes single tiles into bitmaps so that their pixels can be
+// compared.
+class BitmapRasterWorkerPool : public RasterWorkerPool {
+ public:
+  BitmapRasterWorkerPool()
+      : RasterWorkerPool(NULL, kBandTestNumRasterThreads) {}
+  virtual ~BitmapRasterWorkerPool() {}
+
+  // Overridden from RasterWorkerPool:
+  virtual void ScheduleTasks(RasterTask::Queue* queue) OVERRIDE {
+    NOTREACHED();
+  }
+  virtual void OnRasterTasksFinished() OVERRIDE {
+    NOTREACHED();
+  }
+  virtual void OnRasterTasksRequiredForActivationFinished() OVERRIDE {
+    NOTREACHED();
+  }
+
+  // Runs the single raster task in |queue| into |bitmap| and returns
+  // once it has completed.
+  void RunTask(RasterTask::Queue* queue, SkBitmap* bitmap) {
+    SetRasterTasks(queue);
+    DCHECK_EQ(1u, raster_tasks().size());
+
+    scoped_refptr<internal::RasterWorkerPoolTask> raster_task(
+        raster_tasks().front());
+    CompletionEvent did_run;
+    scoped_refptr<internal::WorkerPoolTask> bitmap_task(
+        new BitmapWorkerPoolTaskImpl(raster_task.get(), bitmap, &did_run));
+    TaskGraph graph;
+    CreateGraphNodeForTask(bitmap_task.get(), 0u, &graph);
+    SetTaskGraph(&graph);
+
+    did_run.Wait();
+    // The worker thread may not have handed the task back yet.
+    while (true) {
+      CheckForCompletedTasks();
+      if (raster_task->HasCompleted())
+        break;
+      base::PlatformThread::YieldCurrentThread();
+    }
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(BitmapRasterWorkerPool);
+};
+
+class RasterWorkerPoolBandTest : public testing::Test {
+ public:
+  RasterWorkerPoolBandTest()
+      : rendering_stats_(RenderingStatsInstrumentation::Create()) {}
+
+  // Overridden from testing::Test:
+  virtual void SetUp() OVERRIDE {
+    // Antialiased rects at fractional positions, so that edges that
+    // cross band boundaries would show any seams.
+    gfx::Rect layer_rect(512, 512);
+    for (int i = 0; i < 40; ++i) {
+      SkPaint paint;
+      paint.setAntiAlias(true);
+      paint.setColor(SkColorSetARGB(160, i * 37 % 256, i * 91 % 256, 255));
+      client_.add_draw_rect(
+          gfx::RectF(i * 37 % 400 + 0.3f, i * 53 % 400 + 0.6f, 97.4f, 83.6f),
+          paint);
+    }
+
+    scoped_refptr<PicturePile> pile(new PicturePile);
+    pile->Resize(layer_rect.size());
+    pile->SetTileGridSize(gfx::Size(256, 256));
+    pile->set_num_raster_threads(kBandTestNumRasterThreads);
+    pile->Update(&client_,
+                 SK_ColorWHITE,
+                 false,
+                 Region(layer_rect),
+                 layer_rect,
+                 rendering_stats_.get());
+    picture_pile_ = PicturePileImpl::CreateFromOther(pile.get());
+  }
+  virtual void TearDown() OVERRIDE {
+    RasterWorkerPool::SetRasterBandCountForTesting(0);
+  }
+
+  void Raster(gfx::Rect content_rect,
+              float contents_scale,
+              int num_bands,
+              SkBitmap* bitmap) {
+    RasterWorkerPool::SetRasterBandCountForTesting(num_bands);
+    BitmapRasterWorkerPool raster_worker_pool;
+    raster_worker_pool.SetTaskHelpersEnabled(true);
+
+    Resource resource(1, content_rect.size(), GL_RGBA);
+    RasterWorkerPool::Task::Set dependencies;
+    RasterWorkerPool::RasterTask::Queue tasks;
+    tasks.Append(
+        RasterWorkerPool::CreateRasterTask(
+            &resource,
+            picture_pile_.get(),
+            content_rect,
+            contents_scale,
+            HIGH_QUALITY_RASTER_MODE,
+            false,
+            TileResolution(),
+            1,
+            NULL,
+            1,
+            rendering_stats_.get(),
+            base::Bind(&RasterWorkerPoolBandTest::OnRasterTaskCompleted),
+            &dependencies),
+        false);
+
+    bitmap->setConfig(SkBitmap::kARGB_8888_Config,
+                      content_rect.width(),
+                      content_rect.height());
+    bitmap->allocPixels();
+    bitmap->eraseARGB(0, 0, 0, 0);
+    raster_worker_pool.RunTask(&tasks, bitmap);
+    raster_worker_pool.Shutdown();
+  }
+
+ protected:
+  static void OnRasterTaskCompleted(const PicturePileImpl::Analysis& analysis,
+                                    bool was_canceled) {
+    EXPECT_FALSE(analysis.is_solid_color);
+    EXPECT_FALSE(was_canceled);
+  }
+
+  FakeContentLayerClient client_;
+  scoped_ptr<RenderingStatsInstrumentation> rendering_stats_;
+  scoped_refptr<PicturePileImpl> picture_pile_;
+};
+
+struct BandTestCase {
+  int x, y, width, height;
+  float contents_scale;
+  int num_bands;
+};
+
+const BandTestCase kBandTestCases[] = {
+  // Bands of 64 rows each.
+  { 0, 0, 256, 256, 1.f, 4 },
+  // 301 rows don't split evenly into 4 or 3 bands, and the tile
+  // doesn't start at the origin.
+  { 37, 101, 300, 301, 1.f, 4 },
+  { 37, 101, 300, 301, 1.f, 3 },
+  { 0, 256, 257, 259, 1.5f, 3 },
+  { 128, 200, 256, 299, 1.3f, 2 },
+};
+
+TEST_F(RasterWorkerPoolBandTest, BandedMatchesUnbanded) {
+  for (size_t i = 0; i < arraysize(kBandTestCases); ++i) {
+    const BandTestCase& test_case = kBandTestCases[i];
+    gfx::Rect content_rect(
+        test_case.x, test_case.y, test_case.width, test_case.height);
+    SkBitmap unbanded;
+    Raster(content_rect, test_case.contents_scale, 1, &unbanded);
+    SkBitmap banded;
+    Raster(content_rect,
+           test_case.contents_scale,
+           test_case.num_bands,
+           &banded);
+
+    SkAutoLockPixels lock_unbanded(unbanded);
+    SkAutoLockPixels lock_banded(banded);
+    ASSERT_EQ(unbanded.getSize(), banded.getSize());
+    EXPECT_EQ(0, memcmp(unbanded.getPixels(),
+                        banded.getPixels(),
+                        unbanded.getSize())) << "case " << i;
+  }
+}
+
 }  // namespace
 
 }  // namespace cc
@@ -54,11 +54,16 @@ class CC_EXPORT Tile : public base::RefCounted<Tile> {
   }
 
   void SetPriority(WhichTree tree, const TilePriority& priority) {
+    if (priority_[tree] != priority)
+      managed_state_.priority_changed = true;
     priority_[tree] = priority;
   }
 
   void mark_required_for_activation() {
+    if (priority_[PENDING_TREE].required_for_activation)
+      return;
     priority_[PENDING_TREE].required_for_activation = true;
+    managed_state_.priority_changed = true;
   }
 
   bool required_for_activation() const {
@@ -122,6 +127,7 @@ class CC_EXPORT Tile : public base::RefCounted<Tile> {
   friend class TileManager;
   friend class FakeTileManager;
   friend class BinComparator;
+  friend class PrioritizedTileSet;
   ManagedTileState& managed_state() { return managed_state_; }
   const ManagedTileState& managed_state() const { return managed_state_; }
 
@@ -14,11 +14,13 @@
 #include "base/metrics/histogram.h"
 #include "cc/debug/devtools_instrumentation.h"
 #include "cc/debug/traced_value.h"
+#include "cc/resources/decoded_image_cache.h"
 #include "cc/resources/image_raster_worker_pool.h"
 #include "cc/resources/pixel_buffer_raster_worker_pool.h"
 #include "cc/resources/tile.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "ui/gfx/rect_conversions.h"
+#include "ui/gfx/vector2d.h"
 
 namespace cc {
 
@@ -79,12 +81,21 @@ inline ManagedTileBin BinFromTilePriority(const TilePriority& prio,
   return EVENTUALLY_BIN;
 }
 
+// Compressed copies of evicted tiles may use up to this fraction of the
+// memory the tiles themselves are allowed.
+const size_t kCompressedMemoryLimitDivisor = 2u;
+
 // Limit to the number of raster tasks that can be scheduled.
 // This is high enough to not cause unnecessary scheduling but
 // gives us an insurance that we're not spending a huge amount
 // of time scheduling one enormous set of tasks.
 const size_t kMaxRasterTasks = 256u;
 
+// Limit to the number of evicted tiles compressed, and to the number of
+// tiles restored from their compressed copies, in one call. Both copy the
+// pixels synchronously, so this bounds the time spent in ManageTiles().
+const size_t kMaxCompressedTileOperations = 16u;
+
 }  // namespace
 
 RasterTaskCompletionStats::RasterTaskCompletionStats()
@@ -106,18 +117,24 @@ scoped_ptr<TileManager> TileManager::Create(
     ResourceProvider* resource_provider,
     size_t num_raster_threads,
     RenderingStatsInstrumentation* rendering_stats_instrumentation,
-    bool use_map_image) {
-  return make_scoped_ptr(
+    bool use_map_image,
+    bool parallel_tile_raster,
+    bool compress_evicted_tiles) {
+  scoped_ptr<RasterWorkerPool> raster_worker_pool =
+      use_map_image ?
+      ImageRasterWorkerPool::Create(resource_provider, num_raster_threads) :
+      PixelBufferRasterWorkerPool::Create(resource_provider,
+                                          num_raster_threads);
+  raster_worker_pool->SetTaskHelpersEnabled(parallel_tile_raster);
+  scoped_ptr<TileManager> tile_manager(
       new TileManager(client,
                       resource_provider,
-                      use_map_image ?
-                      ImageRasterWorkerPool::Create(
-                          resource_provider, num_raster_threads) :
-                      PixelBufferRasterWorkerPool::Create(
-                          resource_provider, num_raster_threads),
+                      raster_worker_pool.Pass(),
                       num_raster_threads,
                       rendering_stats_instrumentation,
                       resource_provider->best_texture_format()));
+  tile_manager->SetCompressEvictedTiles(compress_evicted_tiles);
+  return tile_manager.Pass();
 }
 
 TileManager::TileManager(
@@ -128,15 +145,21 @@ TileManager::TileManager(
     RenderingStatsInstrumentation* rendering_stats_instrumentation,
     GLenum texture_format)
     : client_(client),
+      resource_provider_(resource_provider),
       resource_pool_(ResourcePool::Create(resource_provider)),
       raster_worker_pool_(raster_worker_pool.Pass()),
+      prioritized_memory_limit_policy_(global_state_.memory_limit_policy),
+      prioritized_tree_priority_(global_state_.tree_priority),
       all_tiles_that_need_to_be_rasterized_have_memory_(true),
       all_tiles_required_for_activation_have_memory_(true),
       all_tiles_required_for_activation_have_been_initialized_(true),
       ever_exceeded_memory_budget_(false),
       rendering_stats_instrumentation_(rendering_stats_instrumentation),
       did_initialize_visible_tile_(false),
-      texture_format_(texture_format) {
+      texture_format_(texture_format),
+      compress_evicted_tiles_(false),
+      compressed_memory_usage_bytes_(0),
+      decoded_image_cache_(DecodedImageCache::GetInstance()) {
   raster_worker_pool_->SetClient(this);
 }
 
@@ -145,9 +168,8 @@ TileManager::~TileManager() {
   // our memory usage to drop to zero.
   global_state_ = GlobalStateThatImpactsTilePriority();
 
-  // Clear |sorted_tiles_| so that tiles kept alive by it can be freed.
-  sorted_tiles_.clear();
   DCHECK_EQ(0u, tiles_.size());
+  DCHECK_EQ(0u, prioritized_tiles_.size());
 
   TileVector empty;
   ScheduleTasks(empty);
@@ -165,6 +187,11 @@ void TileManager::SetGlobalState(
       global_state_.memory_limit_in_bytes,
       global_state_.unused_memory_limit_in_bytes,
       global_state_.num_resources_limit);
+
+  // Tiles are being dropped, so decoded images are unlikely to be needed
+  // soon either.
+  if (global_state_.memory_limit_policy == ALLOW_NOTHING)
+    decoded_image_cache_->DiscardUnusedImages();
 }
 
 void TileManager::RegisterTile(Tile* tile) {
@@ -176,6 +203,8 @@ void TileManager::RegisterTile(Tile* tile) {
 
 void TileManager::UnregisterTile(Tile* tile) {
   FreeResourcesForTile(tile);
+  FreeCompressedResourcesForTile(tile);
+  prioritized_tiles_.RemoveTile(tile);
 
   DCHECK(tiles_.find(tile->id()) != tiles_.end());
   tiles_.erase(tile->id());
@@ -196,7 +225,7 @@ void TileManager::DidFinishRunningTasks() {
   raster_worker_pool_->CheckForCompletedTasks();
 
   TileVector tiles_that_need_to_be_rasterized;
-  AssignGpuMemoryToTiles(sorted_tiles_, &tiles_that_need_to_be_rasterized);
+  AssignGpuMemoryToTiles(&tiles_that_need_to_be_rasterized);
 
   // |tiles_that_need_to_be_rasterized| will be empty when we reach a
   // steady memory state. Keep scheduling tasks until we reach this state.
@@ -233,59 +262,42 @@ void TileManager::DidFinishRunningTasksRequiredForActivation() {
   client_->NotifyReadyToActivate();
 }
 
-class BinComparator {
- public:
-  bool operator()(const scoped_refptr<Tile> a,
-                  const scoped_refptr<Tile> b) const {
-    const ManagedTileState& ams = a->managed_state();
-    const ManagedTileState& bms = b->managed_state();
-
-    if (ams.visible_and_ready_to_draw != bms.visible_and_ready_to_draw)
-      return ams.visible_and_ready_to_draw;
-
-    if (ams.bin[HIGH_PRIORITY_BIN] != bms.bin[HIGH_PRIORITY_BIN])
-      return ams.bin[HIGH_PRIORITY_BIN] < bms.bin[HIGH_PRIORITY_BIN];
-
-    if (ams.bin[LOW_PRIORITY_BIN] != bms.bin[LOW_PRIORITY_BIN])
-      return ams.bin[LOW_PRIORITY_BIN] < bms.bin[LOW_PRIORITY_BIN];
-
-    if (ams.required_for_activation != bms.required_for_activation)
-      return ams.required_for_activation;
-
-    if (ams.resolution != bms.resolution)
-      return ams.resolution < bms.resolution;
-
-    if (ams.time_to_needed_in_seconds !=  bms.time_to_needed_in_seconds)
-      return ams.time_to_needed_in_seconds < bms.time_to_needed_in_seconds;
-
-    if (ams.distance_to_visible_in_pixels !=
-        bms.distance_to_visible_in_pixels) {
-      return ams.distance_to_visible_in_pixels <
-             bms.distance_to_visible_in_pixels;
-    }
-
-    gfx::Rect a_rect = a->content_rect();
-    gfx::Rect b_rect = b->content_rect();
-    if (a_rect.y() != b_rect.y())
-      return a_rect.y() < b_rect.y();
-    return a_rect.x() < b_rect.x();
-  }
-};
-
-void TileManager::GetTilesWithAssignedBins(TileRefVector* tiles) {
-  TRACE_EVENT0("cc", "TileManager::GetTilesWithAssignedBins");
-
-  DCHECK_EQ(0u, tiles->size());
-  tiles->reserve(tiles_.size());
+void TileManager::UpdatePrioritizedTiles() {
+  TRACE_EVENT0("cc", "TileManager::UpdatePrioritizedTiles");
 
   const TileMemoryLimitPolicy memory_policy = global_state_.memory_limit_policy;
   const TreePriority tree_priority = global_state_.tree_priority;
 
+  // Bins depend on the global state as well as on the tile's priority.
+  bool all_bins_changed = memory_policy != prioritized_memory_limit_policy_ ||
+                          tree_priority != prioritized_tree_priority_;
+  prioritized_memory_limit_policy_ = memory_policy;
+  prioritized_tree_priority_ = tree_priority;
+
   // For each tree, bin into different categories of tiles.
   for (TileMap::const_iterator it = tiles_.begin(); it != tiles_.end(); ++it) {
     Tile* tile = it->second;
     ManagedTileState& mts = tile->managed_state();
 
+    if (!mts.priority_changed && !all_bins_changed) {
+      if (mts.is_in_never_bin_on_both_trees()) {
+        FreeResourcesForTile(tile);
+        FreeCompressedResourcesForTile(tile);
+        continue;
+      }
+
+      // Only readiness can have changed, when a raster task completed or a
+      // resource was freed since the last update.
+      bool visible_and_ready_to_draw =
+          mts.tree_bin[ACTIVE_TREE] == NOW_BIN && tile->IsReadyToDraw();
+      if (mts.visible_and_ready_to_draw != visible_and_ready_to_draw) {
+        mts.visible_and_ready_to_draw = visible_and_ready_to_draw;
+        prioritized_tiles_.InsertTile(tile);
+      }
+      continue;
+    }
+    mts.priority_changed = false;
+
     TilePriority prio[NUM_BIN_PRIORITIES];
     switch (tree_priority) {
       case SAME_PRIORITY_FOR_BOTH_TREES:
@@ -328,37 +340,23 @@ void TileManager::GetTilesWithAssignedBins(TileRefVector* tiles) {
         mts.tree_bin[ACTIVE_TREE] == NOW_BIN && tile->IsReadyToDraw();
 
     // Skip and free resources for tiles in the NEVER_BIN on both trees.
-    if (mts.is_in_never_bin_on_both_trees())
+    if (mts.is_in_never_bin_on_both_trees()) {
       FreeResourcesForTile(tile);
-    else
-      tiles->push_back(make_scoped_refptr(tile));
+      FreeCompressedResourcesForTile(tile);
+      prioritized_tiles_.RemoveTile(tile);
+    } else {
+      prioritized_tiles_.InsertTile(tile);
+    }
   }
 }
 
-void TileManager::SortTiles(TileRefVector* tiles) {
-  TRACE_EVENT0("cc", "TileManager::SortTiles");
-
-  // Sort by bin, resolution and time until needed.
-  std::sort(tiles->begin(), tiles->end(), BinComparator());
-}
-
-void TileManager::GetSortedTilesWithAssignedBins(TileRefVector* tiles) {
-  TRACE_EVENT0("cc", "TileManager::GetSortedTilesWithAssignedBins");
-
-  GetTilesWithAssignedBins(tiles);
-  SortTiles(tiles);
-}
-
 void TileManager::ManageTiles() {
   TRACE_EVENT0("cc", "TileManager::ManageTiles");
 
-  // Clear |sorted_tiles_| so that tiles kept alive by it can be freed.
-  sorted_tiles_.clear();
-
-  GetSortedTilesWithAssignedBins(&sorted_tiles_);
+  UpdatePrioritizedTiles();
 
   TileVector tiles_that_need_to_be_rasterized;
-  AssignGpuMemoryToTiles(sorted_tiles_, &tiles_that_need_to_be_rasterized);
+  AssignGpuMemoryToTiles(&tiles_that_need_to_be_rasterized);
   CleanUpUnusedImageDecodeTasks();
 
   TRACE_EVENT_INSTANT1(
@@ -445,6 +443,8 @@ scoped_ptr<base::Value> TileManager::GetMemoryRequirementsAsValue() const {
   requirements->SetInteger("memory_nice_to_have_bytes",
                            memory_nice_to_have_bytes);
   requirements->SetInteger("memory_used_bytes", memory_used_bytes);
+  requirements->SetInteger("compressed_memory_used_bytes",
+                           compressed_memory_usage_bytes_);
   return requirements.PassAs<base::Value>();
 }
 
@@ -468,7 +468,6 @@ RasterMode TileManager::DetermineRasterMode(const Tile* tile) const {
 }
 
 void TileManager::AssignGpuMemoryToTiles(
-    const TileRefVector& sorted_tiles,
     TileVector* tiles_that_need_to_be_rasterized) {
   TRACE_EVENT0("cc", "TileManager::AssignGpuMemoryToTiles");
 
@@ -476,11 +475,14 @@ void TileManager::AssignGpuMemoryToTiles(
   // the needs-to-be-rasterized queue.
   size_t bytes_releasable = 0;
   size_t resources_releasable = 0;
-  for (TileRefVector::const_iterator it = sorted_tiles.begin();
-       it != sorted_tiles.end();
+  size_t smallest_tile_bytes = std::numeric_limits<size_t>::max();
+  for (PrioritizedTileSet::Iterator it(&prioritized_tiles_, false);
+       it;
        ++it) {
-    const Tile* tile = it->get();
+    const Tile* tile = *it;
     const ManagedTileState& mts = tile->managed_state();
+    smallest_tile_bytes =
+        std::min(smallest_tile_bytes, tile->bytes_consumed_if_allocated());
     for (int mode = 0; mode < NUM_RASTER_MODES; ++mode) {
       if (mts.tile_versions[mode].resource_) {
         bytes_releasable += tile->bytes_consumed_if_allocated();
@@ -509,13 +511,30 @@ void TileManager::AssignGpuMemoryToTiles(
   size_t bytes_that_exceeded_memory_budget = 0;
   size_t bytes_left = bytes_allocatable;
   size_t resources_left = resources_allocatable;
+  size_t compressed_memory_limit =
+      global_state_.memory_limit_in_bytes / kCompressedMemoryLimitDivisor;
+  size_t tiles_compressed = 0;
+  size_t tiles_restored = 0;
   bool oomed = false;
-  for (TileRefVector::const_iterator it = sorted_tiles.begin();
-       it != sorted_tiles.end();
+  for (PrioritizedTileSet::Iterator it(&prioritized_tiles_, true);
+       it;
        ++it) {
-    Tile* tile = it->get();
+    Tile* tile = *it;
     ManagedTileState& mts = tile->managed_state();
 
+    // Once we're OOM and not even the smallest tile fits, every remaining
+    // tile that needs memory is OOM whatever its priority, so stop sorting
+    // the tiles that are left. While evicted tiles can still be compressed
+    // the order matters, as the compressed budget should go to the highest
+    // priority ones.
+    bool can_compress =
+        compress_evicted_tiles_ &&
+        tiles_compressed < kMaxCompressedTileOperations &&
+        compressed_memory_usage_bytes_ < compressed_memory_limit;
+    if (oomed && (resources_left == 0 || bytes_left < smallest_tile_bytes) &&
+        !can_compress)
+      it.DisablePriorityOrdering();
+
     mts.raster_mode = DetermineRasterMode(tile);
 
     ManagedTileState::TileVersion& tile_version =
@@ -528,6 +547,7 @@ void TileManager::AssignGpuMemoryToTiles(
     // If the tile is not needed, free it up.
     if (mts.is_in_never_bin_on_both_trees()) {
       FreeResourcesForTile(tile);
+      FreeCompressedResourcesForTile(tile);
       continue;
     }
 
@@ -545,17 +565,21 @@ void TileManager::AssignGpuMemoryToTiles(
     // Allow lower priority tiles with initialized resources to keep
     // their memory by only assigning memory to new raster tasks if
     // they can be scheduled.
+    bool needs_new_resource = false;
     if (tiles_that_need_to_be_rasterized->size() < kMaxRasterTasks) {
       // If we don't have the required version, and it's not in flight
       // then we'll have to pay to create a new task.
       if (!tile_version.resource_ && tile_version.raster_task_.is_null()) {
         tile_bytes += tile->bytes_consumed_if_allocated();
         tile_resources++;
+        needs_new_resource = true;
       }
     }
 
     // Tile is OOM.
     if (tile_bytes > bytes_left || tile_resources > resources_left) {
+      if (can_compress && CompressResourceForTile(tile))
+        tiles_compressed++;
       FreeResourcesForTile(tile);
 
       // This tile was already on screen and now its resources have been
@@ -572,6 +596,17 @@ void TileManager::AssignGpuMemoryToTiles(
 
       if (tile_version.resource_)
         continue;
+
+      // Getting the pixels back from a compressed copy is much cheaper
+      // than a raster task, so do it right away. Like raster tasks, this
+      // waits until all higher priority tiles have memory. Past the limit
+      // the tile is rasterized instead.
+      if (tile_version.compressed_ && needs_new_resource && !oomed &&
+          tiles_restored < kMaxCompressedTileOperations) {
+        RestoreResourceForTile(tile);
+        tiles_restored++;
+        continue;
+      }
     }
 
     DCHECK(!tile_version.resource_);
@@ -668,6 +703,104 @@ void TileManager::FreeUnusedResourcesForTile(Tile* tile) {
   }
 }
 
+void TileManager::SetCompressEvictedTiles(bool compress_evicted_tiles) {
+  // Only bitmap resources can have their pixels read back cheaply.
+  compress_evicted_tiles_ =
+      compress_evicted_tiles &&
+      resource_provider_ &&
+      resource_provider_->default_resource_type() == ResourceProvider::Bitmap;
+  if (compress_evicted_tiles_)
+    return;
+
+  for (TileMap::iterator it = tiles_.begin(); it != tiles_.end(); ++it)
+    FreeCompressedResourcesForTile(it->second);
+}
+
+bool TileManager::CompressResourceForTile(Tile* tile) {
+  if (!compress_evicted_tiles_)
+    return false;
+
+  ManagedTileState& mts = tile->managed_state();
+  ManagedTileState::TileVersion& tile_version =
+      mts.tile_versions[mts.raster_mode];
+  if (tile_version.mode_ != ManagedTileState::TileVersion::RESOURCE_MODE ||
+      !tile_version.resource_ ||
+      tile_version.compressed_)
+    return false;
+
+  size_t compressed_memory_limit =
+      global_state_.memory_limit_in_bytes / kCompressedMemoryLimitDivisor;
+  if (compressed_memory_usage_bytes_ >= compressed_memory_limit)
+    return false;
+
+  scoped_ptr<CompressedBitmap> compressed;
+  {
+    ResourceProvider::ScopedReadLockSoftware lock(
+        resource_provider_, tile_version.resource_->id());
+    compressed = CompressedBitmap::Create(*lock.sk_bitmap());
+  }
+  if (!compressed ||
+      compressed_memory_usage_bytes_ + compressed->bytes() >
+          compressed_memory_limit)
+    return false;
+
+  compressed_memory_usage_bytes_ += compressed->bytes();
+  tile_version.compressed_ = compressed.Pass();
+  return true;
+}
+
+void TileManager::RestoreResourceForTile(Tile* tile) {
+  ManagedTileState& mts = tile->managed_state();
+  ManagedTileState::TileVersion& tile_version =
+      mts.tile_versions[mts.raster_mode];
+  DCHECK(tile_version.compressed_);
+  DCHECK(tile_version.raster_task_.is_null());
+
+  scoped_ptr<CompressedBitmap> compressed = tile_version.compressed_.Pass();
+  compressed_memory_usage_bytes_ -= compressed->bytes();
+
+  std::vector<uint8_t> pixels(4 * compressed->size().GetArea());
+  compressed->Decompress(&pixels[0]);
+  InitializeTileWithPixels(tile, &pixels[0]);
+}
+
+void TileManager::InitializeTileWithPixels(Tile* tile, const uint8_t* pixels) {
+  ManagedTileState& mts = tile->managed_state();
+  ManagedTileState::TileVersion& tile_version =
+      mts.tile_versions[mts.raster_mode];
+  DCHECK(!tile_version.resource_);
+
+  gfx::Size size = tile->tile_size_.size();
+  scoped_ptr<ResourcePool::Resource> resource =
+      resource_pool_->AcquireResource(size, texture_format_);
+  resource_provider_->SetPixels(resource->id(),
+                                pixels,
+                                gfx::Rect(size),
+                                gfx::Rect(size),
+                                gfx::Vector2d());
+
+  tile_version.set_use_resource();
+  tile_version.resource_ = resource.Pass();
+
+  FreeUnusedResourcesForTile(tile);
+  if (tile->priority(ACTIVE_TREE).distance_to_visible_in_pixels == 0)
+    did_initialize_visible_tile_ = true;
+}
+
+void TileManager::FreeCompressedResourceForTile(Tile* tile, RasterMode mode) {
+  ManagedTileState& mts = tile->managed_state();
+  if (mts.tile_versions[mode].compressed_) {
+    compressed_memory_usage_bytes_ -=
+        mts.tile_versions[mode].compressed_->bytes();
+    mts.tile_versions[mode].compressed_.reset();
+  }
+}
+
+void TileManager::FreeCompressedResourcesForTile(Tile* tile) {
+  for (int mode = 0; mode < NUM_RASTER_MODES; ++mode)
+    FreeCompressedResourceForTile(tile, static_cast<RasterMode>(mode));
+}
+
 void TileManager::ScheduleTasks(
     const TileVector& tiles_that_need_to_be_rasterized) {
   TRACE_EVENT1("cc", "TileManager::ScheduleTasks",
@@ -720,7 +853,10 @@ RasterWorkerPool::RasterTask TileManager::CreateRasterTask(Tile* tile) {
   const Resource* const_resource = resource.get();
 
   // Create and queue all image decode tasks that this tile depends on.
+  // The raster task refs every image it draws in |decoded_image_cache_|,
+  // so that images stay decoded until it has run.
   RasterWorkerPool::Task::Set decode_tasks;
+  PixelRefVector pixel_refs;
   PixelRefTaskMap& existing_pixel_refs = image_decode_tasks_[tile->layer_id()];
   for (PicturePileImpl::PixelRefIterator iter(tile->content_rect(),
                                               tile->contents_scale(),
@@ -729,6 +865,10 @@ RasterWorkerPool::RasterTask TileManager::CreateRasterTask(Tile* tile) {
     skia::LazyPixelRef* pixel_ref = *iter;
     uint32_t id = pixel_ref->getGenerationID();
 
+    pixel_refs.push_back(pixel_ref);
+    if (decoded_image_cache_->RefImage(pixel_ref))
+      continue;
+
     // Append existing image decode task if available.
     PixelRefTaskMap::iterator decode_task_it = existing_pixel_refs.find(id);
     if (decode_task_it != existing_pixel_refs.end()) {
@@ -759,7 +899,8 @@ RasterWorkerPool::RasterTask TileManager::CreateRasterTask(Tile* tile) {
                  base::Unretained(this),
                  tile->id(),
                  base::Passed(&resource),
-                 mts.raster_mode),
+                 mts.raster_mode,
+                 pixel_refs),
       &decode_tasks);
 }
 
@@ -767,10 +908,11 @@ void TileManager::OnImageDecodeTaskCompleted(
     int layer_id,
     skia::LazyPixelRef* pixel_ref,
     bool was_canceled) {
-  // If the task was canceled, we need to clean it up
-  // from |image_decode_tasks_|.
+  // Once the image is in |decoded_image_cache_|, raster tasks no longer
+  // need to depend on a decode task for it. If the task was canceled, a
+  // new one will be created when needed.
   if (!was_canceled)
-    return;
+    decoded_image_cache_->DidDecodeImage(pixel_ref);
 
   LayerPixelRefTaskMap::iterator layer_it =
       image_decode_tasks_.find(layer_id);
@@ -790,8 +932,15 @@ void TileManager::OnRasterTaskCompleted(
     Tile::Id tile_id,
     scoped_ptr<ResourcePool::Resource> resource,
     RasterMode raster_mode,
+    const PixelRefVector& pixel_refs,
     const PicturePileImpl::Analysis& analysis,
     bool was_canceled) {
+  for (PixelRefVector::const_iterator pixel_ref_it = pixel_refs.begin();
+       pixel_ref_it != pixel_refs.end();
+       ++pixel_ref_it) {
+    decoded_image_cache_->UnrefImage(*pixel_ref_it);
+  }
+
   TileMap::iterator it = tiles_.find(tile_id);
   if (it == tiles_.end()) {
     ++update_visible_tiles_stats_.canceled_count;
@@ -814,6 +963,7 @@ void TileManager::OnRasterTaskCompleted(
 
   ++update_visible_tiles_stats_.completed_count;
 
+  FreeCompressedResourceForTile(tile, raster_mode);
   tile_version.set_has_text(analysis.has_text);
   if (analysis.is_solid_color) {
     tile_version.set_solid_color(analysis.solid_color);
@@ -16,11 +16,13 @@
 #include "cc/resources/managed_tile_state.h"
 #include "cc/resources/memory_history.h"
 #include "cc/resources/picture_pile_impl.h"
+#include "cc/resources/prioritized_tile_set.h"
 #include "cc/resources/raster_worker_pool.h"
 #include "cc/resources/resource_pool.h"
 #include "cc/resources/tile.h"
 
 namespace cc {
+class DecodedImageCache;
 class ResourceProvider;
 
 class CC_EXPORT TileManagerClient {
@@ -51,7 +53,9 @@ class CC_EXPORT TileManager : public RasterWorkerPoolClient {
       ResourceProvider* resource_provider,
       size_t num_raster_threads,
       RenderingStatsInstrumentation* rendering_stats_instrumentation,
-      bool use_map_image);
+      bool use_map_image,
+      bool parallel_tile_raster,
+      bool compress_evicted_tiles);
   virtual ~TileManager();
 
   const GlobalStateThatImpactsTilePriority& GlobalState() const {
@@ -78,6 +82,15 @@ class CC_EXPORT TileManager : public RasterWorkerPoolClient {
     return all_tiles_required_for_activation_have_been_initialized_;
   }
 
+  // When enabled, rasterized tiles that lose their memory to higher priority
+  // tiles keep a compressed copy of their pixels, and get them back from it
+  // instead of being rasterized again. Only has an effect with software
+  // (bitmap) resources, whose pixels can be read back cheaply.
+  void SetCompressEvictedTiles(bool compress_evicted_tiles);
+  size_t compressed_memory_usage_bytes() const {
+    return compressed_memory_usage_bytes_;
+  }
+
  protected:
   TileManager(TileManagerClient* client,
               ResourceProvider* resource_provider,
@@ -98,19 +111,23 @@ class CC_EXPORT TileManager : public RasterWorkerPoolClient {
   virtual void DidFinishRunningTasksRequiredForActivation() OVERRIDE;
 
   typedef std::vector<Tile*> TileVector;
-  typedef std::vector<scoped_refptr<Tile> > TileRefVector;
   typedef std::set<Tile*> TileSet;
+  typedef std::vector<skia::LazyPixelRef*> PixelRefVector;
 
   // Virtual for test
   virtual void ScheduleTasks(
       const TileVector& tiles_that_need_to_be_rasterized);
 
-  void AssignGpuMemoryToTiles(
-      const TileRefVector& sorted_tiles,
-      TileVector* tiles_that_need_to_be_rasterized);
-  void GetTilesWithAssignedBins(TileRefVector* tiles);
-  void SortTiles(TileRefVector* tiles);
-  void GetSortedTilesWithAssignedBins(TileRefVector* tiles);
+  // Assigns memory to the tiles in |prioritized_tiles_|, highest priority
+  // first, until the budget runs out.
+  void AssignGpuMemoryToTiles(TileVector* tiles_that_need_to_be_rasterized);
+  // Recomputes the bins of the tiles whose priority has changed, and moves
+  // them to their new place in |prioritized_tiles_|.
+  void UpdatePrioritizedTiles();
+
+  // Gives |tile| a resource holding |pixels| for its current raster mode,
+  // as a completed raster task would.
+  void InitializeTileWithPixels(Tile* tile, const uint8_t* pixels);
 
  private:
   void OnImageDecodeTaskCompleted(
@@ -121,6 +138,7 @@ class CC_EXPORT TileManager : public RasterWorkerPoolClient {
       Tile::Id tile,
       scoped_ptr<ResourcePool::Resource> resource,
       RasterMode raster_mode,
+      const PixelRefVector& pixel_refs,
       const PicturePileImpl::Analysis& analysis,
       bool was_canceled);
 
@@ -129,12 +147,17 @@ class CC_EXPORT TileManager : public RasterWorkerPoolClient {
   void FreeResourceForTile(Tile* tile, RasterMode mode);
   void FreeResourcesForTile(Tile* tile);
   void FreeUnusedResourcesForTile(Tile* tile);
+  bool CompressResourceForTile(Tile* tile);
+  void RestoreResourceForTile(Tile* tile);
+  void FreeCompressedResourceForTile(Tile* tile, RasterMode mode);
+  void FreeCompressedResourcesForTile(Tile* tile);
   RasterWorkerPool::Task CreateImageDecodeTask(
       Tile* tile, skia::LazyPixelRef* pixel_ref);
   RasterWorkerPool::RasterTask CreateRasterTask(Tile* tile);
   scoped_ptr<base::Value> GetMemoryRequirementsAsValue() const;
 
   TileManagerClient* client_;
+  ResourceProvider* resource_provider_;
   scoped_ptr<ResourcePool> resource_pool_;
   scoped_ptr<RasterWorkerPool> raster_worker_pool_;
   GlobalStateThatImpactsTilePriority global_state_;
@@ -142,7 +165,11 @@ class CC_EXPORT TileManager : public RasterWorkerPoolClient {
   typedef base::hash_map<Tile::Id, Tile*> TileMap;
   TileMap tiles_;
 
-  TileRefVector sorted_tiles_;
+  PrioritizedTileSet prioritized_tiles_;
+  // The global state |prioritized_tiles_| was last binned with. Bins are
+  // recomputed for all tiles when this changes.
+  TileMemoryLimitPolicy prioritized_memory_limit_policy_;
+  TreePriority prioritized_tree_priority_;
 
   bool all_tiles_that_need_to_be_rasterized_have_memory_;
   bool all_tiles_required_for_activation_have_memory_;
@@ -157,6 +184,12 @@ class CC_EXPORT TileManager : public RasterWorkerPoolClient {
 
   GLenum texture_format_;
 
+  bool compress_evicted_tiles_;
+  size_t compressed_memory_usage_bytes_;
+
+  // Decoded images are shared with the tile managers of other layer trees.
+  DecodedImageCache* decoded_image_cache_;
+
   typedef base::hash_map<uint32_t, RasterWorkerPool::Task> PixelRefTaskMap;
   typedef base::hash_map<int, PixelRefTaskMap> LayerPixelRefTaskMap;
   LayerPixelRefTaskMap image_decode_tasks_;
@@ -2,7 +2,11 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
+#include <set>
+
 #include "base/time/time.h"
+#include "cc/output/software_output_device.h"
 #include "cc/resources/tile.h"
 #include "cc/resources/tile_priority.h"
 #include "cc/test/fake_output_surface.h"
@@ -10,6 +14,7 @@
 #include "cc/test/fake_tile_manager_client.h"
 
 #include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
 
 namespace cc {
 
@@ -19,6 +24,19 @@ static const int kTimeLimitMillis = 2000;
 static const int kWarmupRuns = 5;
 static const int kTimeCheckInterval = 10;
 
+static const int kViewportHeight = 1000;
+static const int kTilesPerRow = 10;
+static const float kScrollPixelsPerFrame = 16.f;
+static const float kScrollPixelsPerSecond = 1000.f;
+static const float kInterestDistancePixels = 3000.f;
+
+// The long scroll reads down a page in |kLongScrollPixelsPerFrame| steps,
+// going back up one viewport after every three, with memory for fewer tiles
+// than the interest area holds.
+static const int kLongScrollTileCount = 2000;
+static const int kLongScrollPixelsPerFrame = 64;
+static const int kLongScrollMemoryLimitInTiles = 100;
+
 class FakePicturePileImpl : public PicturePileImpl {
  public:
   FakePicturePileImpl() {
@@ -149,6 +167,159 @@ class TileManagerPerfTest : public testing::Test {
     CreateBinTiles(count - 3 * count_per_bin, TilePriority(), tiles);
   }
 
+  // Creates a column of |count| tiles, |kTilesPerRow| wide, as a layer
+  // scrolled by the user would have.
+  void CreateGridTiles(int count, TileVector* tiles) {
+    gfx::Size tile_size = settings_.default_tile_size;
+    for (int i = 0; i < count; ++i) {
+      gfx::Rect content_rect(i % kTilesPerRow * tile_size.width(),
+                             i / kTilesPerRow * tile_size.height(),
+                             tile_size.width(),
+                             tile_size.height());
+      scoped_refptr<Tile> tile =
+          make_scoped_refptr(new Tile(tile_manager_.get(),
+                                      picture_pile_.get(),
+                                      tile_size,
+                                      content_rect,
+                                      gfx::Rect(),
+                                      1.0,
+                                      0,
+                                      0,
+                                      true));
+      tiles->push_back(tile);
+    }
+  }
+
+  // Gives the tiles the priorities a layer scrolled to |scroll_offset| would
+  // give them. Tiles outside the interest area keep an infinite distance, so
+  // their priority doesn't change from frame to frame.
+  void SetScrollPriorities(const TileVector& tiles, float scroll_offset) {
+    for (TileVector::const_iterator it = tiles.begin();
+         it != tiles.end();
+         ++it) {
+      gfx::Rect rect = (*it)->content_rect();
+      float distance =
+          std::max(0.f,
+                   std::max(scroll_offset - rect.bottom(),
+                            rect.y() - (scroll_offset + kViewportHeight)));
+      TilePriority priority;
+      if (distance < kInterestDistancePixels) {
+        priority = TilePriority(HIGH_RESOLUTION,
+                                distance / kScrollPixelsPerSecond,
+                                distance);
+      }
+      (*it)->SetPriority(ACTIVE_TREE, priority);
+      (*it)->SetPriority(PENDING_TREE, priority);
+    }
+  }
+
+  void RunScrollTest(const std::string test_name, unsigned tile_count) {
+    start_time_ = base::TimeTicks();
+    num_runs_ = 0;
+    TileVector tiles;
+    CreateGridTiles(tile_count, &tiles);
+    float scroll_offset = 0.f;
+    do {
+      SetScrollPriorities(tiles, scroll_offset);
+      tile_manager_->ManageTiles();
+      scroll_offset += kScrollPixelsPerFrame;
+    } while (DidRun());
+
+    AfterTest(test_name);
+  }
+
+  // Page-like contents: a white background with some dark bars.
+  SkBitmap CreateContents() {
+    gfx::Size tile_size = settings_.default_tile_size;
+    SkBitmap contents;
+    contents.setConfig(SkBitmap::kARGB_8888_Config,
+                       tile_size.width(),
+                       tile_size.height());
+    contents.allocPixels();
+    contents.eraseColor(SK_ColorWHITE);
+    for (int y = 4; y < tile_size.height(); y += 12)
+      contents.eraseArea(SkIRect::MakeXYWH(8, y, y % 200 + 20, 8),
+                         SK_ColorBLACK);
+    return contents;
+  }
+
+  // Scrolls a long page with software resources, rasterizing whatever the
+  // tile manager asks for, and reports peak memory and how many tiles had to
+  // be rasterized more than once.
+  void RunLongScrollTest(const std::string test_name,
+                         bool compress_evicted_tiles) {
+    tile_manager_.reset(NULL);
+    resource_provider_.reset(NULL);
+    output_surface_ = FakeOutputSurface::CreateSoftware(
+        make_scoped_ptr(new SoftwareOutputDevice));
+    resource_provider_ = ResourceProvider::Create(output_surface_.get(), 0);
+    tile_manager_ = make_scoped_ptr(
+        new FakeTileManager(&tile_manager_client_, resource_provider_.get()));
+    tile_manager_->SetCompressEvictedTiles(compress_evicted_tiles);
+
+    GlobalStateThatImpactsTilePriority state;
+    gfx::Size tile_size = settings_.default_tile_size;
+    state.memory_limit_in_bytes = kLongScrollMemoryLimitInTiles * 4 *
+                                  tile_size.width() * tile_size.height();
+    state.num_resources_limit = kLongScrollMemoryLimitInTiles;
+    state.memory_limit_policy = ALLOW_ANYTHING;
+    state.tree_priority = SMOOTHNESS_TAKES_PRIORITY;
+    tile_manager_->SetGlobalState(state);
+
+    SkBitmap contents = CreateContents();
+    TileVector tiles;
+    CreateGridTiles(kLongScrollTileCount, &tiles);
+    const int page_height =
+        kLongScrollTileCount / kTilesPerRow * tile_size.height();
+
+    std::set<Tile*> rasterized_tiles;
+    size_t raster_count = 0;
+    size_t reraster_count = 0;
+    size_t peak_tile_memory = 0;
+    size_t peak_compressed_memory = 0;
+    int scroll_offset = 0;
+    int frame = 0;
+    const int frames_per_viewport = kViewportHeight / kLongScrollPixelsPerFrame;
+    while (scroll_offset + kViewportHeight < page_height) {
+      SetScrollPriorities(tiles, scroll_offset);
+      tile_manager_->AssignMemoryToTiles();
+      for (size_t i = 0; i < tile_manager_->tiles_for_raster.size(); ++i) {
+        Tile* tile = tile_manager_->tiles_for_raster[i];
+        tile_manager_->RasterizeTile(tile, contents);
+        ++raster_count;
+        if (!rasterized_tiles.insert(tile).second)
+          ++reraster_count;
+      }
+      peak_tile_memory = std::max(
+          peak_tile_memory,
+          tile_manager_->memory_stats_from_last_assign().bytes_allocated);
+      peak_compressed_memory =
+          std::max(peak_compressed_memory,
+                   tile_manager_->compressed_memory_usage_bytes());
+
+      // Three viewports down, then one back up.
+      if (frame++ % (4 * frames_per_viewport) < 3 * frames_per_viewport)
+        scroll_offset += kLongScrollPixelsPerFrame;
+      else
+        scroll_offset -= kLongScrollPixelsPerFrame;
+    }
+    tiles.clear();
+
+    // Format matches chrome/test/perf/perf_test.h:PrintResult
+    printf("*RESULT %s_peak_tile_memory: %.2f MB\n",
+           test_name.c_str(),
+           peak_tile_memory / (1024.0 * 1024.0));
+    printf("*RESULT %s_peak_compressed_memory: %.2f MB\n",
+           test_name.c_str(),
+           peak_compressed_memory / (1024.0 * 1024.0));
+    printf("*RESULT %s_rasters: %u tiles\n",
+           test_name.c_str(),
+           static_cast<unsigned>(raster_count));
+    printf("*RESULT %s_rerasters: %u tiles\n",
+           test_name.c_str(),
+           static_cast<unsigned>(reraster_count));
+  }
+
   void RunManageTilesTest(const std::string test_name,
                           unsigned tile_count) {
     start_time_ = base::TimeTicks();
@@ -181,6 +352,17 @@ TEST_F(TileManagerPerfTest, ManageTiles) {
   RunManageTilesTest("manage_tiles_10000", 10000);
 }
 
+TEST_F(TileManagerPerfTest, ScrollManageTiles) {
+  RunScrollTest("scroll_manage_tiles_1000", 1000);
+  RunScrollTest("scroll_manage_tiles_10000", 10000);
+  RunScrollTest("scroll_manage_tiles_50000", 50000);
+}
+
+TEST_F(TileManagerPerfTest, LongScrollCompressEvictedTiles) {
+  RunLongScrollTest("long_scroll", false);
+  RunLongScrollTest("long_scroll_compressed", true);
+}
+
 }  // namespace
 
 }  // namespace cc
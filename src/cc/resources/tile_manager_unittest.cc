@@ -2,12 +2,14 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "cc/output/software_output_device.h"
 #include "cc/resources/tile.h"
 #include "cc/resources/tile_priority.h"
 #include "cc/test/fake_output_surface.h"
 #include "cc/test/fake_tile_manager.h"
 #include "cc/test/fake_tile_manager_client.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
 
 namespace cc {
 namespace {
@@ -359,6 +361,60 @@ TEST_P(TileManagerTest, TotalOOMMemoryToActive) {
   EXPECT_EQ(0, AssignedMemoryCount(pending_tree_tiles));
 }
 
+TEST_P(TileManagerTest, PriorityChangeMovesTiles) {
+  // 5 tiles in the now bin and 5 in the never bin, with enough memory for
+  // 5 tiles. Swapping their priorities moves the memory to the other tiles.
+
+  Initialize(5, ALLOW_ANYTHING, SMOOTHNESS_TAKES_PRIORITY);
+  TileVector first_tiles =
+      CreateTiles(5, TilePriorityForNowBin(), TilePriority());
+  TileVector second_tiles = CreateTiles(5, TilePriority(), TilePriority());
+
+  tile_manager()->AssignMemoryToTiles();
+
+  EXPECT_EQ(5, AssignedMemoryCount(first_tiles));
+  EXPECT_EQ(0, AssignedMemoryCount(second_tiles));
+
+  for (size_t i = 0; i < first_tiles.size(); ++i) {
+    first_tiles[i]->SetPriority(ACTIVE_TREE, TilePriority());
+    second_tiles[i]->SetPriority(ACTIVE_TREE, TilePriorityForNowBin());
+  }
+  tile_manager()->AssignMemoryToTiles();
+
+  EXPECT_EQ(0, AssignedMemoryCount(first_tiles));
+  EXPECT_EQ(5, AssignedMemoryCount(second_tiles));
+
+  // Assigning again without any priority change gives the same result.
+  tile_manager()->AssignMemoryToTiles();
+
+  EXPECT_EQ(0, AssignedMemoryCount(first_tiles));
+  EXPECT_EQ(5, AssignedMemoryCount(second_tiles));
+}
+
+TEST_P(TileManagerTest, RequiredForActivationChangeReordersTiles) {
+  // 10 tiles in the soon bin on both trees, with enough memory for 5 tiles.
+  // Tiles marked required for activation after the first assignment are
+  // sorted ahead of the others within their bin.
+
+  Initialize(5, ALLOW_ANYTHING, NEW_CONTENT_TAKES_PRIORITY);
+  TileVector other_tiles = CreateTiles(
+      5, TilePriorityForSoonBin(), TilePriorityForSoonBin());
+  TileVector required_tiles = CreateTiles(
+      5, TilePriorityForSoonBin(), TilePriorityForSoonBin());
+
+  tile_manager()->AssignMemoryToTiles();
+
+  EXPECT_EQ(5, AssignedMemoryCount(other_tiles) +
+               AssignedMemoryCount(required_tiles));
+
+  for (size_t i = 0; i < required_tiles.size(); ++i)
+    required_tiles[i]->mark_required_for_activation();
+  tile_manager()->AssignMemoryToTiles();
+
+  EXPECT_EQ(0, AssignedMemoryCount(other_tiles));
+  EXPECT_EQ(5, AssignedMemoryCount(required_tiles));
+}
+
 
 
 TEST_P(TileManagerTest, RasterAsLCD) {
@@ -506,6 +562,225 @@ TEST_P(TileManagerTest, TextReRasterAsNoLCD) {
   EXPECT_EQ(0, TilesWithLCDCount(pending_tree_tiles));
 }
 
+class TileManagerCompressionTest : public testing::Test {
+ public:
+  typedef std::vector<scoped_refptr<Tile> > TileVector;
+
+  virtual void SetUp() OVERRIDE {
+    output_surface_ = FakeOutputSurface::CreateSoftware(
+        make_scoped_ptr(new SoftwareOutputDevice));
+    resource_provider_ = ResourceProvider::Create(output_surface_.get(), 0);
+    tile_manager_ = make_scoped_ptr(
+        new FakeTileManager(&tile_manager_client_, resource_provider_.get()));
+    tile_manager_->SetCompressEvictedTiles(true);
+    SetMemoryLimitInTiles(1);
+    picture_pile_ = make_scoped_refptr(new FakePicturePileImpl());
+  }
+
+  void SetMemoryLimitInTiles(int tile_count) {
+    GlobalStateThatImpactsTilePriority state;
+    gfx::Size tile_size = settings_.default_tile_size;
+    state.memory_limit_in_bytes =
+        tile_count * 4 * tile_size.width() * tile_size.height();
+    state.num_resources_limit = 100;
+    state.memory_limit_policy = ALLOW_ANYTHING;
+    state.tree_priority = SMOOTHNESS_TAKES_PRIORITY;
+    tile_manager_->SetGlobalState(state);
+  }
+
+  virtual void TearDown() OVERRIDE {
+    tile_manager_.reset(NULL);
+    picture_pile_ = NULL;
+
+    testing::Test::TearDown();
+  }
+
+  scoped_refptr<Tile> CreateTile(TilePriority active_priority) {
+    scoped_refptr<Tile> tile =
+        make_scoped_refptr(new Tile(tile_manager_.get(),
+                                    picture_pile_.get(),
+                                    settings_.default_tile_size,
+                                    gfx::Rect(),
+                                    gfx::Rect(),
+                                    1.0,
+                                    0,
+                                    0,
+                                    true));
+    tile->SetPriority(ACTIVE_TREE, active_priority);
+    tile->SetPriority(PENDING_TREE, TilePriority());
+    return tile;
+  }
+
+  // Page-like contents: a white background with some dark bars.
+  SkBitmap CreateContents() {
+    gfx::Size tile_size = settings_.default_tile_size;
+    SkBitmap contents;
+    contents.setConfig(SkBitmap::kARGB_8888_Config,
+                       tile_size.width(),
+                       tile_size.height());
+    contents.allocPixels();
+    contents.eraseColor(SK_ColorWHITE);
+    for (int y = 4; y < tile_size.height(); y += 12)
+      contents.eraseArea(SkIRect::MakeXYWH(8, y, y % 200 + 20, 8),
+                         SK_ColorBLACK);
+    return contents;
+  }
+
+  // Contents that compress to a little over half their size: noise in the
+  // top 60% of the rows and white below.
+  SkBitmap CreateNoisyContents() {
+    SkBitmap contents = CreateContents();
+    SkAutoLockPixels lock(contents);
+    uint32_t seed = 1u;
+    for (int y = 0; y < contents.height() * 6 / 10; ++y) {
+      for (int x = 0; x < contents.width(); ++x) {
+        seed = seed * 1664525u + 1013904223u;
+        *contents.getAddr32(x, y) = seed | 0xff000000u;
+      }
+    }
+    return contents;
+  }
+
+  bool TileHasContents(Tile* tile, const SkBitmap& contents) {
+    ResourceProvider::ScopedReadLockSoftware lock(
+        resource_provider_.get(),
+        tile->GetTileVersionForDrawing().get_resource_id());
+    const SkBitmap* bitmap = lock.sk_bitmap();
+    SkAutoLockPixels bitmap_lock(*bitmap);
+    SkAutoLockPixels contents_lock(contents);
+    for (int y = 0; y < contents.height(); ++y) {
+      for (int x = 0; x < contents.width(); ++x) {
+        if (*bitmap->getAddr32(x, y) != *contents.getAddr32(x, y))
+          return false;
+      }
+    }
+    return true;
+  }
+
+  FakeTileManager* tile_manager() {
+    return tile_manager_.get();
+  }
+
+ private:
+  FakeTileManagerClient tile_manager_client_;
+  LayerTreeSettings settings_;
+  scoped_ptr<FakeTileManager> tile_manager_;
+  scoped_refptr<FakePicturePileImpl> picture_pile_;
+  scoped_ptr<FakeOutputSurface> output_surface_;
+  scoped_ptr<ResourceProvider> resource_provider_;
+};
+
+TEST_F(TileManagerCompressionTest, EvictedTileIsRestoredWithoutRaster) {
+  SkBitmap contents = CreateContents();
+
+  scoped_refptr<Tile> first = CreateTile(TilePriorityForNowBin());
+  tile_manager()->AssignMemoryToTiles();
+  EXPECT_TRUE(tile_manager()->HasBeenAssignedMemory(first.get()));
+  tile_manager()->RasterizeTile(first.get(), contents);
+  EXPECT_TRUE(first->IsReadyToDraw());
+
+  // A higher priority tile takes the memory of the first one, which keeps a
+  // compressed copy of its pixels.
+  first->SetPriority(ACTIVE_TREE, TilePriorityForSoonBin());
+  scoped_refptr<Tile> second = CreateTile(TilePriorityForNowBin());
+  tile_manager()->AssignMemoryToTiles();
+  EXPECT_TRUE(tile_manager()->HasBeenAssignedMemory(second.get()));
+  EXPECT_FALSE(first->IsReadyToDraw());
+  EXPECT_LT(0u, tile_manager()->compressed_memory_usage_bytes());
+
+  // Once the memory is available again, the first tile gets its pixels back
+  // without being rasterized.
+  second->SetPriority(ACTIVE_TREE, TilePriority());
+  tile_manager()->AssignMemoryToTiles();
+  EXPECT_FALSE(tile_manager()->HasBeenAssignedMemory(first.get()));
+  EXPECT_TRUE(first->IsReadyToDraw());
+  EXPECT_EQ(0u, tile_manager()->compressed_memory_usage_bytes());
+  EXPECT_TRUE(TileHasContents(first.get(), contents));
+}
+
+TEST_F(TileManagerCompressionTest, DisablingFreesCompressedTiles) {
+  scoped_refptr<Tile> first = CreateTile(TilePriorityForNowBin());
+  tile_manager()->AssignMemoryToTiles();
+  tile_manager()->RasterizeTile(first.get(), CreateContents());
+
+  first->SetPriority(ACTIVE_TREE, TilePriorityForSoonBin());
+  scoped_refptr<Tile> second = CreateTile(TilePriorityForNowBin());
+  tile_manager()->AssignMemoryToTiles();
+  EXPECT_LT(0u, tile_manager()->compressed_memory_usage_bytes());
+
+  tile_manager()->SetCompressEvictedTiles(false);
+  EXPECT_EQ(0u, tile_manager()->compressed_memory_usage_bytes());
+
+  // Without a compressed copy, the tile has to be rasterized again.
+  second->SetPriority(ACTIVE_TREE, TilePriority());
+  tile_manager()->AssignMemoryToTiles();
+  EXPECT_TRUE(tile_manager()->HasBeenAssignedMemory(first.get()));
+  EXPECT_FALSE(first->IsReadyToDraw());
+}
+
+TEST_F(TileManagerCompressionTest, CompressedMemoryGoesToHighestPriority) {
+  // Room for two tiles, and for one compressed copy of the noisy contents.
+  SetMemoryLimitInTiles(2);
+  SkBitmap contents = CreateNoisyContents();
+  scoped_refptr<Tile> far = CreateTile(TilePriorityForSoonBin());
+  scoped_refptr<Tile> near =
+      CreateTile(TilePriority(HIGH_RESOLUTION, 0.5, 100.0));
+  tile_manager()->AssignMemoryToTiles();
+  tile_manager()->RasterizeTile(far.get(), contents);
+  tile_manager()->RasterizeTile(near.get(), contents);
+
+  // More tiles are needed now than there is memory for, so both soon tiles
+  // are evicted after the tiles that come before them went OOM. Only the
+  // nearer one gets the compressed copy.
+  TileVector now_tiles;
+  for (int i = 0; i < 4; ++i)
+    now_tiles.push_back(CreateTile(TilePriorityForNowBin()));
+  tile_manager()->AssignMemoryToTiles();
+  EXPECT_FALSE(far->IsReadyToDraw());
+  EXPECT_FALSE(near->IsReadyToDraw());
+
+  for (size_t i = 0; i < now_tiles.size(); ++i)
+    now_tiles[i]->SetPriority(ACTIVE_TREE, TilePriority());
+  tile_manager()->AssignMemoryToTiles();
+  EXPECT_TRUE(near->IsReadyToDraw());
+  EXPECT_TRUE(TileHasContents(near.get(), contents));
+  EXPECT_TRUE(tile_manager()->HasBeenAssignedMemory(far.get()));
+}
+
+TEST_F(TileManagerCompressionTest, CompressionAndRestoreAreLimitedPerCall) {
+  const int kTileCount = 40;
+  SetMemoryLimitInTiles(kTileCount);
+  SkBitmap contents = CreateContents();
+  TileVector soon_tiles;
+  for (int i = 0; i < kTileCount; ++i)
+    soon_tiles.push_back(CreateTile(TilePriorityForSoonBin()));
+  tile_manager()->AssignMemoryToTiles();
+  for (size_t i = 0; i < soon_tiles.size(); ++i)
+    tile_manager()->RasterizeTile(soon_tiles[i].get(), contents);
+
+  TileVector now_tiles;
+  for (int i = 0; i < kTileCount; ++i)
+    now_tiles.push_back(CreateTile(TilePriorityForNowBin()));
+  tile_manager()->AssignMemoryToTiles();
+
+  // Only some of the tiles get their pixels back right away; the others are
+  // rasterized.
+  for (size_t i = 0; i < now_tiles.size(); ++i)
+    now_tiles[i]->SetPriority(ACTIVE_TREE, TilePriority());
+  tile_manager()->AssignMemoryToTiles();
+  int restored_count = 0;
+  for (size_t i = 0; i < soon_tiles.size(); ++i) {
+    if (soon_tiles[i]->IsReadyToDraw()) {
+      restored_count++;
+      EXPECT_TRUE(TileHasContents(soon_tiles[i].get(), contents));
+    } else {
+      EXPECT_TRUE(tile_manager()->HasBeenAssignedMemory(soon_tiles[i].get()));
+    }
+  }
+  EXPECT_LT(0, restored_count);
+  EXPECT_GT(kTileCount, restored_count);
+}
+
 // If true, the max tile limit should be applied as bytes; if false,
 // as num_resources_limit.
 INSTANTIATE_TEST_CASE_P(TileManagerTests,
@@ -10,9 +10,11 @@
 #include "base/bind.h"
 #include "base/containers/hash_tables.h"
 #include "base/debug/trace_event.h"
+#include "base/lazy_instance.h"
 #include "base/strings/stringprintf.h"
 #include "base/synchronization/condition_variable.h"
 #include "base/threading/simple_thread.h"
+#include "base/threading/thread_local.h"
 #include "base/threading/thread_restrictions.h"
 #include "cc/base/scoped_ptr_deque.h"
 
@@ -65,6 +67,12 @@ bool WorkerPoolTask::HasCompleted() const {
   return did_complete_;
 }
 
+WorkerPoolTaskHelper::WorkerPoolTaskHelper() {
+}
+
+WorkerPoolTaskHelper::~WorkerPoolTaskHelper() {
+}
+
 GraphNode::GraphNode(internal::WorkerPoolTask* task, unsigned priority)
     : task_(task),
       priority_(priority),
@@ -97,7 +105,20 @@ class WorkerPool::Inner : public base::DelegateSimpleThread::Delegate {
   // Collect all completed tasks in |completed_tasks|.
   void CollectCompletedTasks(TaskVector* completed_tasks);
 
+  void SetTaskHelpersEnabled(bool enabled);
+  unsigned GetIdleThreadCount() const;
+  void AddTaskHelper(internal::WorkerPoolTaskHelper* helper);
+  void RemoveTaskHelper(internal::WorkerPoolTaskHelper* helper);
+
+  // Returns the instance whose worker is the current thread, or NULL.
+  static Inner* Current();
+
  private:
+  typedef std::deque<scoped_refptr<internal::WorkerPoolTaskHelper> >
+      TaskHelperDeque;
+
+  void RemoveTaskHelperLocked(internal::WorkerPoolTaskHelper* helper);
+
   class PriorityComparator {
    public:
     bool operator()(const internal::GraphNode* a,
@@ -131,6 +152,15 @@ class WorkerPool::Inner : public base::DelegateSimpleThread::Delegate {
   // are pending.
   bool shutdown_;
 
+  // Set if running tasks may hand work to idle threads.
+  bool task_helpers_enabled_;
+
+  // Number of worker threads waiting on |has_ready_to_run_tasks_cv_|.
+  unsigned num_idle_threads_;
+
+  // Work offered by running tasks to idle worker threads, oldest first.
+  TaskHelperDeque task_helpers_;
+
   // This set contains all pending tasks.
   GraphNodeMap pending_tasks_;
 
@@ -148,15 +178,24 @@ class WorkerPool::Inner : public base::DelegateSimpleThread::Delegate {
 
   ScopedPtrDeque<base::DelegateSimpleThread> workers_;
 
+  // The instance whose worker is running on the current thread.
+  static base::LazyInstance<base::ThreadLocalPointer<Inner> >::Leaky current_;
+
   DISALLOW_COPY_AND_ASSIGN(Inner);
 };
 
+// static
+base::LazyInstance<base::ThreadLocalPointer<WorkerPool::Inner> >::Leaky
+    WorkerPool::Inner::current_ = LAZY_INSTANCE_INITIALIZER;
+
 WorkerPool::Inner::Inner(
     size_t num_threads, const std::string& thread_name_prefix)
     : lock_(),
       has_ready_to_run_tasks_cv_(&lock_),
       next_thread_index_(0),
-      shutdown_(false) {
+      shutdown_(false),
+      task_helpers_enabled_(false),
+      num_idle_threads_(0) {
   base::AutoLock lock(lock_);
 
   while (workers_.size() < num_threads) {
@@ -184,6 +223,7 @@ WorkerPool::Inner::~Inner() {
   DCHECK_EQ(0u, ready_to_run_tasks_.size());
   DCHECK_EQ(0u, running_tasks_.size());
   DCHECK_EQ(0u, completed_tasks_.size());
+  DCHECK_EQ(0u, task_helpers_.size());
 }
 
 void WorkerPool::Inner::Shutdown() {
@@ -304,7 +344,58 @@ void WorkerPool::Inner::CollectCompletedTasks(TaskVector* completed_tasks) {
   completed_tasks->swap(completed_tasks_);
 }
 
+void WorkerPool::Inner::SetTaskHelpersEnabled(bool enabled) {
+  base::AutoLock lock(lock_);
+
+  task_helpers_enabled_ = enabled;
+}
+
+unsigned WorkerPool::Inner::GetIdleThreadCount() const {
+  base::AutoLock lock(lock_);
+
+  return task_helpers_enabled_ ? num_idle_threads_ : 0;
+}
+
+void WorkerPool::Inner::AddTaskHelper(internal::WorkerPoolTaskHelper* helper) {
+  base::AutoLock lock(lock_);
+
+  if (!task_helpers_enabled_)
+    return;
+
+  task_helpers_.push_back(helper);
+
+  // Wake up idle workers so they can help.
+  has_ready_to_run_tasks_cv_.Broadcast();
+}
+
+void WorkerPool::Inner::RemoveTaskHelper(
+    internal::WorkerPoolTaskHelper* helper) {
+  base::AutoLock lock(lock_);
+
+  RemoveTaskHelperLocked(helper);
+}
+
+void WorkerPool::Inner::RemoveTaskHelperLocked(
+    internal::WorkerPoolTaskHelper* helper) {
+  lock_.AssertAcquired();
+
+  for (TaskHelperDeque::iterator it = task_helpers_.begin();
+       it != task_helpers_.end(); ++it) {
+    if (it->get() == helper) {
+      task_helpers_.erase(it);
+      return;
+    }
+  }
+}
+
+// static
+WorkerPool::Inner* WorkerPool::Inner::Current() {
+  return current_.Pointer()->Get();
+}
+
 void WorkerPool::Inner::Run() {
+  current_.Pointer()->Set(this);
+
   base::AutoLock lock(lock_);
 
   // Get a unique thread index.
@@ -312,12 +403,31 @@ void WorkerPool::Inner::Run() {
 
   while (true) {
     if (ready_to_run_tasks_.empty()) {
+      // Help a running task if one has offered work.
+      if (!task_helpers_.empty()) {
+        scoped_refptr<internal::WorkerPoolTaskHelper> helper(
+            task_helpers_.front());
+
+        {
+          base::AutoUnlock unlock(lock_);
+
+          helper->RunOnWorkerThread(thread_index);
+        }
+
+        // All of the helper's work has been claimed, so stop offering
+        // it to other threads.
+        RemoveTaskHelperLocked(helper.get());
+        continue;
+      }
+
       // Exit when shutdown is set and no more tasks are pending.
       if (shutdown_ && pending_tasks_.empty())
         break;
 
       // Wait for more tasks.
+      ++num_idle_threads_;
       has_ready_to_run_tasks_cv_.Wait();
+      --num_idle_threads_;
       continue;
     }
 
@@ -371,6 +481,8 @@ void WorkerPool::Inner::Run() {
   // We noticed we should exit. Wake up the next worker so it knows it should
   // exit as well (because the Shutdown() code only signals once).
   has_ready_to_run_tasks_cv_.Signal();
+
+  current_.Pointer()->Set(NULL);
 }
 
 WorkerPool::WorkerPool(size_t num_threads,
@@ -420,6 +532,33 @@ void WorkerPool::ProcessCompletedTasks(
   in_dispatch_completion_callbacks_ = false;
 }
 
+void WorkerPool::SetTaskHelpersEnabled(bool enabled) {
+  inner_->SetTaskHelpersEnabled(enabled);
+}
+
+// static
+unsigned WorkerPool::GetIdleThreadCountForCurrentTask() {
+  Inner* inner = Inner::Current();
+  DCHECK(inner);
+  return inner ? inner->GetIdleThreadCount() : 0;
+}
+
+// static
+void WorkerPool::AddTaskHelper(internal::WorkerPoolTaskHelper* helper) {
+  Inner* inner = Inner::Current();
+  DCHECK(inner);
+  if (inner)
+    inner->AddTaskHelper(helper);
+}
+
+// static
+void WorkerPool::RemoveTaskHelper(internal::WorkerPoolTaskHelper* helper) {
+  Inner* inner = Inner::Current();
+  DCHECK(inner);
+  if (inner)
+    inner->RemoveTaskHelper(helper);
+}
+
 void WorkerPool::SetTaskGraph(TaskGraph* graph) {
   TRACE_EVENT1("cc", "WorkerPool::SetTaskGraph",
                "num_tasks", graph->size());
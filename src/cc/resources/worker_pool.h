@@ -47,6 +47,23 @@ class CC_EXPORT WorkerPoolTask
   bool did_complete_;
 };
 
+// Work split off from a running WorkerPoolTask so that worker threads
+// with no tasks ready to run can help finish it. See
+// WorkerPool::AddTaskHelper().
+class CC_EXPORT WorkerPoolTaskHelper
+    : public base::RefCountedThreadSafe<WorkerPoolTaskHelper> {
+ public:
+  // Runs pieces of the work until no unclaimed pieces are left. Called
+  // concurrently on each worker thread that helps.
+  virtual void RunOnWorkerThread(unsigned thread_index) = 0;
+
+ protected:
+  friend class base::RefCountedThreadSafe<WorkerPoolTaskHelper>;
+
+  WorkerPoolTaskHelper();
+  virtual ~WorkerPoolTaskHelper();
+};
+
 class CC_EXPORT GraphNode {
  public:
   typedef std::vector<GraphNode*> Vector;
@@ -108,6 +125,23 @@ class CC_EXPORT WorkerPool {
   // Force a check for completed tasks.
   virtual void CheckForCompletedTasks();
 
+  // Allows running tasks to hand work to idle worker threads through
+  // AddTaskHelper(). Disabled by default.
+  void SetTaskHelpersEnabled(bool enabled);
+
+  // The following must be called from WorkerPoolTask::RunOnWorkerThread()
+  // and apply to the pool running the calling task.
+
+  // Returns the number of worker threads waiting for tasks, or 0 if
+  // task helpers are disabled.
+  static unsigned GetIdleThreadCountForCurrentTask();
+
+  // Offers |helper| to worker threads that have no tasks ready to run
+  // until RemoveTaskHelper() is called, or until a thread returns from
+  // running it. Tasks ready to run are always preferred over helpers.
+  static void AddTaskHelper(internal::WorkerPoolTaskHelper* helper);
+  static void RemoveTaskHelper(internal::WorkerPoolTaskHelper* helper);
+
  protected:
   // A task graph contains a unique set of tasks with edges between
   // dependencies pointing in the direction of the dependents. Each task
@@ -6,6 +6,7 @@
 
 #include <vector>
 
+#include "base/threading/platform_thread.h"
 #include "cc/base/completion_event.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -60,11 +61,12 @@ class FakeWorkerPool : public WorkerPool {
     unsigned dependent_count;
     unsigned priority;
   };
-  FakeWorkerPool() : WorkerPool(1, "test") {}
+  explicit FakeWorkerPool(size_t num_threads)
+      : WorkerPool(num_threads, "test") {}
   virtual ~FakeWorkerPool() {}
 
   static scoped_ptr<FakeWorkerPool> Create() {
-    return make_scoped_ptr(new FakeWorkerPool);
+    return make_scoped_ptr(new FakeWorkerPool(1));
   }
 
   void ScheduleTasks(const std::vector<Task>& tasks) {
@@ -389,6 +391,104 @@ TEST_F(WorkerPoolTest, Priority) {
   EXPECT_EQ(0u, on_task_completed_ids()[2]);
 }
 
+class FakeWorkerPoolTaskHelper : public internal::WorkerPoolTaskHelper {
+ public:
+  FakeWorkerPoolTaskHelper() : run_count_(0) {}
+
+  // Overridden from internal::WorkerPoolTaskHelper:
+  virtual void RunOnWorkerThread(unsigned thread_index) OVERRIDE {
+    ++run_count_;
+    did_run_.Signal();
+  }
+
+  void WaitForRun() { did_run_.Wait(); }
+  int run_count() const { return run_count_; }
+
+ private:
+  virtual ~FakeWorkerPoolTaskHelper() {}
+
+  int run_count_;
+  CompletionEvent did_run_;
+
+  DISALLOW_COPY_AND_ASSIGN(FakeWorkerPoolTaskHelper);
+};
+
+class WorkerPoolTaskHelperTest : public testing::Test {
+ public:
+  WorkerPoolTaskHelperTest() : idle_thread_count_(0) {}
+
+  // Overridden from testing::Test:
+  virtual void TearDown() OVERRIDE {
+    worker_pool_->Shutdown();
+    worker_pool_->CheckForCompletedTasks();
+  }
+
+  // Runs as a task, waits for the other worker thread to become idle
+  // and then hands |helper_| to it.
+  void RunTaskWithHelper() {
+    while (!WorkerPool::GetIdleThreadCountForCurrentTask())
+      base::PlatformThread::YieldCurrentThread();
+    idle_thread_count_ = WorkerPool::GetIdleThreadCountForCurrentTask();
+
+    WorkerPool::AddTaskHelper(helper_.get());
+    helper_->WaitForRun();
+    WorkerPool::RemoveTaskHelper(helper_.get());
+  }
+
+  // Runs as a task and records how many idle threads it could use.
+  void RunTaskWithoutHelper() {
+    idle_thread_count_ = WorkerPool::GetIdleThreadCountForCurrentTask();
+  }
+
+ protected:
+  scoped_ptr<FakeWorkerPool> worker_pool_;
+  scoped_refptr<FakeWorkerPoolTaskHelper> helper_;
+  unsigned idle_thread_count_;
+};
+
+TEST_F(WorkerPoolTaskHelperTest, IdleThreadRunsHelper) {
+  worker_pool_ = make_scoped_ptr(new FakeWorkerPool(2));
+  worker_pool_->SetTaskHelpersEnabled(true);
+  helper_ = make_scoped_refptr(new FakeWorkerPoolTaskHelper);
+
+  worker_pool_->ScheduleTasks(
+      std::vector<FakeWorkerPool::Task>(
+          1,
+          FakeWorkerPool::Task(
+              base::Bind(&WorkerPoolTaskHelperTest::RunTaskWithHelper,
+                         base::Unretained(this)),
+              base::Closure(),
+              base::Closure(),
+              1u,
+              0u)));
+  worker_pool_->WaitForTasksToComplete();
+  worker_pool_->CheckForCompletedTasks();
+
+  EXPECT_EQ(1u, idle_thread_count_);
+  EXPECT_EQ(1, helper_->run_count());
+}
+
+TEST_F(WorkerPoolTaskHelperTest, DisabledByDefault) {
+  worker_pool_ = make_scoped_ptr(new FakeWorkerPool(2));
+
+  // Start from a nonzero count so that the task has to clear it.
+  idle_thread_count_ = 1;
+  worker_pool_->ScheduleTasks(
+      std::vector<FakeWorkerPool::Task>(
+          1,
+          FakeWorkerPool::Task(
+              base::Bind(&WorkerPoolTaskHelperTest::RunTaskWithoutHelper,
+                         base::Unretained(this)),
+              base::Closure(),
+              base::Closure(),
+              1u,
+              0u)));
+  worker_pool_->WaitForTasksToComplete();
+  worker_pool_->CheckForCompletedTasks();
+
+  EXPECT_EQ(0u, idle_thread_count_);
+}
+
 }  // namespace
 
 }  // namespace cc
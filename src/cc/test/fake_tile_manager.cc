@@ -5,6 +5,7 @@
 #include "cc/test/fake_tile_manager.h"
 
 #include "cc/resources/raster_worker_pool.h"
+#include "third_party/skia/include/core/SkBitmap.h"
 
 namespace cc {
 
@@ -42,10 +43,15 @@ FakeTileManager::~FakeTileManager() {}
 
 void FakeTileManager::AssignMemoryToTiles() {
   tiles_for_raster.clear();
-  all_tiles.clear();
 
-  GetSortedTilesWithAssignedBins(&all_tiles);
-  AssignGpuMemoryToTiles(all_tiles, &tiles_for_raster);
+  UpdatePrioritizedTiles();
+  AssignGpuMemoryToTiles(&tiles_for_raster);
+}
+
+void FakeTileManager::RasterizeTile(Tile* tile, const SkBitmap& contents) {
+  SkAutoLockPixels lock(contents);
+  InitializeTileWithPixels(
+      tile, static_cast<const uint8_t*>(contents.getPixels()));
 }
 
 bool FakeTileManager::HasBeenAssignedMemory(Tile* tile) {
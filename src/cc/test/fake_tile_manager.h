@@ -10,6 +10,8 @@
 
 #include "cc/resources/tile_manager.h"
 
+class SkBitmap;
+
 namespace cc {
 
 class FakeTileManager : public TileManager {
@@ -20,11 +22,13 @@ class FakeTileManager : public TileManager {
 
   bool HasBeenAssignedMemory(Tile* tile);
   void AssignMemoryToTiles();
+  // Gives |tile| the pixels of |contents| as if it had been rasterized.
+  // Requires a |resource_provider|.
+  void RasterizeTile(Tile* tile, const SkBitmap& contents);
 
   virtual ~FakeTileManager();
 
   std::vector<Tile*> tiles_for_raster;
-  std::vector<scoped_refptr<Tile> > all_tiles;
 };
 
 }  // namespace cc
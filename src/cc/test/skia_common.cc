@@ -32,7 +32,8 @@ SkPixelRef* TestPixelRef::deepCopy(
 
 
 TestLazyPixelRef::TestLazyPixelRef(int width, int height)
-    : pixels_(new char[4 * width * height]) {}
+    : pixels_(new char[4 * width * height]),
+      decoded_size_in_bytes_(4 * width * height) {}
 
 TestLazyPixelRef::~TestLazyPixelRef() {}
 
@@ -50,6 +51,10 @@ bool TestLazyPixelRef::MaybeDecoded() {
   return true;
 }
 
+size_t TestLazyPixelRef::DecodedSizeInBytes() const {
+  return decoded_size_in_bytes_;
+}
+
 SkPixelRef* TestLazyPixelRef::deepCopy(
     SkBitmap::Config config,
     const SkIRect* subset) {
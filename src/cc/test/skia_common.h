@@ -48,8 +48,10 @@ class TestLazyPixelRef : public skia::LazyPixelRef {
       SkBitmap::Config config,
       const SkIRect* subset) OVERRIDE;
   virtual void Decode() OVERRIDE {}
+  virtual size_t DecodedSizeInBytes() const OVERRIDE;
  private:
   scoped_ptr<char[]> pixels_;
+  size_t decoded_size_in_bytes_;
 };
 
 void DrawPicture(unsigned char* buffer,
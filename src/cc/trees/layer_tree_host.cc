@@ -958,6 +958,8 @@ void LayerTreeHost::PaintLayerContents(
       root_layer_->render_surface()->content_rect(), record_metrics_for_frame);
   occlusion_tracker.set_minimum_tracking_size(
       settings_.minimum_occlusion_tracking_size);
+  occlusion_tracker.set_maximum_tracking_rects(
+      settings_.maximum_occlusion_tracking_rects);
 
   PrioritizeTextures(render_surface_layer_list,
                      occlusion_tracker.overdraw_metrics());
@@ -781,6 +781,153 @@ static inline void RemoveSurfaceForEarlyExit(
   layer_to_remove->ClearRenderSurface();
 }
 
+// Unchanged subtrees are only reused on the impl side, where layers track
+// their changes (see LayerImpl::SetNeedsDrawPropertiesUpdate()).
+typedef SubtreeDrawPropertiesCache<LayerImpl, RenderSurfaceImpl>
+    LayerImplSubtreeCache;
+typedef SubtreeDrawPropertiesCache<Layer, RenderSurface> LayerSubtreeCache;
+
+static inline LayerImplSubtreeCache* GetSubtreeDrawPropertiesCache(
+    LayerImpl* layer) {
+  if (!layer->subtree_draw_properties_cache())
+    layer->CreateSubtreeDrawPropertiesCache();
+  return layer->subtree_draw_properties_cache();
+}
+
+static inline LayerSubtreeCache* GetSubtreeDrawPropertiesCache(Layer* layer) {
+  return NULL;
+}
+
+// Returns true if the draw properties in |layer|'s subtree can change without
+// any layer in it noting the change, so the subtree must not be reused.
+static bool DrawPropertiesCanChangeUnnoticed(LayerImpl* layer) {
+  // Animations can start and finish without changing the animated value.
+  if (layer->TransformIsAnimating() || layer->OpacityIsAnimating())
+    return true;
+
+  // The delegate changes the scroll offset without telling the layer.
+  if (layer->scroll_offset_delegate())
+    return true;
+
+  // Fixed-position layers are adjusted using the size delta and the draw
+  // transform of their container, which is outside of the subtree.
+  if (layer->position_constraint().is_fixed_position())
+    return true;
+
+  // Copy requests are taken from the layer once it has been drawn.
+  if (layer->HasCopyRequest())
+    return true;
+
+  // Sorting and delegated render passes change lists that are not rebuilt
+  // when the subtree is reused.
+  if (layer->preserves_3d() || layer->HasDelegatedContent() ||
+      layer->HasContributingDelegatedRenderPasses())
+    return true;
+
+  // The back face is tested with the parent's draw transform.
+  if (layer->use_parent_backface_visibility() && layer->parent() &&
+      !layer->parent()->double_sided())
+    return true;
+
+  return false;
+}
+
+static bool CanReuseSubtree(LayerImpl* layer,
+                            const LayerImplSubtreeCache& cache,
+                            const LayerImplSubtreeCache::Inputs& inputs) {
+  return !IsRootLayer(layer) &&
+         cache.reusable &&
+         !layer->needs_draw_properties_update() &&
+         !layer->descendant_needs_draw_properties_update() &&
+         cache.inputs.Matches(inputs);
+}
+
+static bool CanReuseSubtree(Layer* layer,
+                            const LayerSubtreeCache& cache,
+                            const LayerSubtreeCache::Inputs& inputs) {
+  return false;
+}
+
+// Adds an unchanged subtree to the lists the way it was added when it was
+// last computed, and updates its tile priorities, which is needed for every
+// frame. Nothing is added to a NULL list, which is the case for the subtree of
+// a surface that was removed, and for the layer list of a reused surface, as
+// that still holds the layers of its subtree.
+static void AddUnchangedSubtreeToLists(
+    LayerImpl* layer,
+    LayerImplList* render_surface_layer_list,
+    LayerImplList* layer_list) {
+  const LayerImplSubtreeCache* cache = layer->subtree_draw_properties_cache();
+  DCHECK(cache);
+  if (cache->outcome == LayerImplSubtreeCache::SUBTREE_SKIPPED)
+    return;
+
+  if (cache->outcome == LayerImplSubtreeCache::SURFACE_REMOVED) {
+    render_surface_layer_list = NULL;
+    layer_list = NULL;
+  }
+
+  LayerImplList* descendants = layer_list;
+  if (layer->render_surface()) {
+    if (render_surface_layer_list)
+      render_surface_layer_list->push_back(layer);
+    descendants = NULL;
+  }
+
+  if (descendants && cache->added_to_layer_list)
+    descendants->push_back(layer);
+
+  for (size_t i = 0; i < layer->children().size(); ++i) {
+    LayerImpl* child =
+        LayerTreeHostCommon::get_child_as_raw_ptr(layer->children(), i);
+    AddUnchangedSubtreeToLists(child, render_surface_layer_list, descendants);
+    if (descendants && child->render_surface() &&
+        !child->subtree_draw_properties_cache()->
+            drawable_content_rect_of_subtree.IsEmpty())
+      descendants->push_back(child);
+  }
+
+  if (cache->outcome == LayerImplSubtreeCache::SUBTREE_ADDED)
+    UpdateTilePrioritiesForLayer(layer);
+}
+
+static void AddUnchangedSubtreeToLists(
+    Layer* layer,
+    RenderSurfaceLayerList* render_surface_layer_list,
+    RenderSurfaceLayerList* layer_list) {
+  NOTREACHED();
+}
+
+// Records how the update of |layer|'s subtree ended. Called on every way out
+// of CalculateDrawPropertiesInternal that did not reuse the subtree.
+static void FinishSubtreeUpdate(LayerImpl* layer,
+                                LayerImplSubtreeCache* cache,
+                                LayerImplSubtreeCache::Outcome outcome,
+                                gfx::Rect drawable_content_rect_of_subtree) {
+  cache->outcome = outcome;
+  cache->drawable_content_rect_of_subtree = drawable_content_rect_of_subtree;
+  cache->reusable = !DrawPropertiesCanChangeUnnoticed(layer);
+
+  // Children are only visited when the subtree wasn't skipped.
+  if (outcome != LayerImplSubtreeCache::SUBTREE_SKIPPED) {
+    for (size_t i = 0; cache->reusable && i < layer->children().size(); ++i) {
+      LayerImpl* child =
+          LayerTreeHostCommon::get_child_as_raw_ptr(layer->children(), i);
+      DCHECK(child->subtree_draw_properties_cache());
+      cache->reusable = child->subtree_draw_properties_cache()->reusable;
+    }
+  }
+
+  layer->DidUpdateDrawProperties();
+}
+
+static void FinishSubtreeUpdate(Layer* layer,
+                                LayerSubtreeCache* cache,
+                                LayerSubtreeCache::Outcome outcome,
+                                gfx::Rect drawable_content_rect_of_subtree) {
+  NOTREACHED();
+}
+
 struct PreCalculateMetaInformationRecursiveData {
   bool layer_or_descendant_has_copy_request;
 
@@ -881,6 +1028,7 @@ static void CalculateDrawPropertiesInternal(
     bool subtree_can_use_lcd_text,
     bool subtree_can_adjust_raster_scales,
     bool subtree_is_visible_from_ancestor,
+    bool reuse_unchanged_subtrees,
     gfx::Rect* drawable_content_rect_of_subtree) {
   // This function computes the new matrix transformations recursively for this
   // layer and all its descendants. It also computes the appropriate render
@@ -1012,6 +1160,62 @@ static void CalculateDrawPropertiesInternal(
   // this subtree should be considered empty.
   *drawable_content_rect_of_subtree = gfx::Rect();
 
+  // If no layer in the subtree changed and it is placed as it was in the last
+  // update, add it to the lists again instead of recomputing it. Otherwise
+  // remember what it is computed from, and FinishSubtreeUpdate() records the
+  // result on the way out.
+  typedef SubtreeDrawPropertiesCache<LayerType, RenderSurfaceType>
+      SubtreeCache;
+  SubtreeCache* subtree_cache =
+      reuse_unchanged_subtrees ? GetSubtreeDrawPropertiesCache(layer) : NULL;
+  if (subtree_cache) {
+    typename SubtreeCache::Inputs inputs;
+    inputs.parent_matrix = parent_matrix;
+    inputs.full_hierarchy_matrix = full_hierarchy_matrix;
+    inputs.scroll_compensation_matrix = current_scroll_compensation_matrix;
+    inputs.fixed_container = current_fixed_container;
+    inputs.clip_rect_from_ancestor =
+        clip_rect_from_ancestor_in_ancestor_target_space;
+    inputs.clip_rect_of_target_surface =
+        clip_rect_of_target_surface_from_ancestor_in_target_space;
+    inputs.ancestor_clips_subtree = ancestor_clips_subtree;
+    inputs.nearest_ancestor_that_moves_pixels =
+        nearest_ancestor_that_moves_pixels;
+    inputs.max_texture_size = max_texture_size;
+    inputs.device_scale_factor = device_scale_factor;
+    inputs.page_scale_factor = page_scale_factor;
+    inputs.page_scale_application_layer = page_scale_application_layer;
+    inputs.in_subtree_of_page_scale_application_layer =
+        in_subtree_of_page_scale_application_layer;
+    inputs.subtree_can_use_lcd_text = subtree_can_use_lcd_text;
+    inputs.subtree_can_adjust_raster_scales = subtree_can_adjust_raster_scales;
+    inputs.subtree_is_visible_from_ancestor = subtree_is_visible_from_ancestor;
+    if (LayerType* parent = layer->parent()) {
+      inputs.parent_draw_opacity = parent->draw_opacity();
+      inputs.parent_draw_opacity_is_animating =
+          parent->draw_opacity_is_animating();
+      inputs.parent_screen_space_opacity_is_animating =
+          parent->screen_space_opacity_is_animating();
+      inputs.parent_draw_transform_is_animating =
+          parent->draw_transform_is_animating();
+      inputs.parent_screen_space_transform_is_animating =
+          parent->screen_space_transform_is_animating();
+      inputs.parent_render_target = parent->render_target();
+      inputs.parent_target_clip_rect =
+          parent->render_target()->render_surface()->clip_rect();
+    }
+
+    if (CanReuseSubtree(layer, *subtree_cache, inputs)) {
+      AddUnchangedSubtreeToLists(layer, render_surface_layer_list, layer_list);
+      *drawable_content_rect_of_subtree =
+          subtree_cache->drawable_content_rect_of_subtree;
+      return;
+    }
+
+    subtree_cache->inputs = inputs;
+    subtree_cache->added_to_layer_list = false;
+  }
+
   // Layers with a copy request are always visible, as well as un-hiding their
   // subtree. Otherise, layers that are marked as hidden will hide themselves
   // and their subtree.
@@ -1021,8 +1225,13 @@ static void CalculateDrawPropertiesInternal(
     layer_is_visible = true;
 
   // The root layer cannot skip CalcDrawProperties.
-  if (!IsRootLayer(layer) && SubtreeShouldBeSkipped(layer, layer_is_visible))
+  if (!IsRootLayer(layer) && SubtreeShouldBeSkipped(layer, layer_is_visible)) {
+    if (subtree_cache) {
+      FinishSubtreeUpdate(
+          layer, subtree_cache, SubtreeCache::SUBTREE_SKIPPED, gfx::Rect());
+    }
     return;
+  }
 
   // As this function proceeds, these are the properties for the current
   // layer that actually get computed. To avoid unnecessary copies
@@ -1165,8 +1374,13 @@ static void CalculateDrawPropertiesInternal(
     // Check back-face visibility before continuing with this surface and its
     // subtree
     if (!layer->double_sided() && TransformToParentIsKnown(layer) &&
-        IsSurfaceBackFaceVisible(layer, combined_transform))
+        IsSurfaceBackFaceVisible(layer, combined_transform)) {
+      if (subtree_cache) {
+        FinishSubtreeUpdate(
+            layer, subtree_cache, SubtreeCache::SUBTREE_SKIPPED, gfx::Rect());
+      }
       return;
+    }
 
     RenderSurfaceType* render_surface = CreateOrReuseRenderSurface(layer);
 
@@ -1390,8 +1604,11 @@ static void CalculateDrawPropertiesInternal(
   // and should be included in the sorting process.
   size_t sorting_start_index = descendants.size();
 
-  if (!LayerShouldBeSkipped(layer, layer_is_visible))
+  if (!LayerShouldBeSkipped(layer, layer_is_visible)) {
     descendants.push_back(layer);
+    if (subtree_cache)
+      subtree_cache->added_to_layer_list = true;
+  }
 
   gfx::Transform next_scroll_compensation_matrix =
       ComputeScrollCompensationMatrixForChildren(
@@ -1431,6 +1648,7 @@ static void CalculateDrawPropertiesInternal(
         subtree_can_use_lcd_text,
         subtree_can_adjust_raster_scales,
         layer_is_visible,
+        reuse_unchanged_subtrees,
         &drawable_content_rect_of_child_subtree);
     if (!drawable_content_rect_of_child_subtree.IsEmpty()) {
       accumulated_drawable_content_rect_of_children.Union(
@@ -1443,6 +1661,10 @@ static void CalculateDrawPropertiesInternal(
   if (layer->render_surface() && !IsRootLayer(layer) &&
       layer->render_surface()->layer_list().empty()) {
     RemoveSurfaceForEarlyExit(layer, render_surface_layer_list);
+    if (subtree_cache) {
+      FinishSubtreeUpdate(
+          layer, subtree_cache, SubtreeCache::SURFACE_REMOVED, gfx::Rect());
+    }
     return;
   }
 
@@ -1516,6 +1738,10 @@ static void CalculateDrawPropertiesInternal(
 
     if (clipped_content_rect.IsEmpty()) {
       RemoveSurfaceForEarlyExit(layer, render_surface_layer_list);
+      if (subtree_cache) {
+        FinishSubtreeUpdate(
+            layer, subtree_cache, SubtreeCache::SURFACE_REMOVED, gfx::Rect());
+      }
       return;
     }
 
@@ -1569,8 +1795,13 @@ static void CalculateDrawPropertiesInternal(
   SavePaintPropertiesLayer(layer);
 
   // If neither this layer nor any of its children were added, early out.
-  if (sorting_start_index == descendants.size())
+  if (sorting_start_index == descendants.size()) {
+    if (subtree_cache) {
+      FinishSubtreeUpdate(
+          layer, subtree_cache, SubtreeCache::SUBTREE_ADDED, gfx::Rect());
+    }
     return;
+  }
 
   // If preserves-3d then sort all the descendants in 3D so that they can be
   // drawn from back to front. If the preserves-3d property is also set on the
@@ -1594,6 +1825,13 @@ static void CalculateDrawPropertiesInternal(
     layer->render_target()->render_surface()->
         AddContributingDelegatedRenderPassLayer(layer);
   }
+
+  if (subtree_cache) {
+    FinishSubtreeUpdate(layer,
+                        subtree_cache,
+                        SubtreeCache::SUBTREE_ADDED,
+                        *drawable_content_rect_of_subtree);
+  }
 }
 
 void LayerTreeHostCommon::CalculateDrawProperties(
@@ -1639,6 +1877,7 @@ void LayerTreeHostCommon::CalculateDrawProperties(
       inputs->can_use_lcd_text,
       inputs->can_adjust_raster_scales,
       subtree_is_visible,
+      false,
       &total_drawable_content_rect);
 
   // The dummy layer list should not have been used.
@@ -1693,6 +1932,7 @@ void LayerTreeHostCommon::CalculateDrawProperties(
       inputs->can_use_lcd_text,
       inputs->can_adjust_raster_scales,
       subtree_is_visible,
+      inputs->reuse_unchanged_subtrees,
       &total_drawable_content_rect);
 
   // The dummy layer list should not have been used.
@@ -50,7 +50,8 @@ class CC_EXPORT LayerTreeHostCommon {
           max_texture_size(max_texture_size),
           can_use_lcd_text(can_use_lcd_text),
           can_adjust_raster_scales(can_adjust_raster_scales),
-          render_surface_layer_list(render_surface_layer_list) {}
+          render_surface_layer_list(render_surface_layer_list),
+          reuse_unchanged_subtrees(false) {}
 
     LayerType* root_layer;
     gfx::Size device_viewport_size;
@@ -62,6 +63,9 @@ class CC_EXPORT LayerTreeHostCommon {
     bool can_use_lcd_text;
     bool can_adjust_raster_scales;
     RenderSurfaceLayerListType* render_surface_layer_list;
+    // Only used for LayerImpl trees: skips recomputing subtrees in which no
+    // layer has changed, and that are placed the same as in the last update.
+    bool reuse_unchanged_subtrees;
   };
 
   template <typename LayerType, typename RenderSurfaceLayerListType>
@@ -4272,6 +4272,138 @@ TEST_F(LayerTreeHostCommonTest,
 }
 
 
+TEST_F(LayerTreeHostCommonTest, ReuseUnchangedSubtrees) {
+  FakeImplProxy proxy;
+  FakeLayerTreeHostImpl host_impl(&proxy);
+  scoped_ptr<LayerImpl> root = LayerImpl::Create(host_impl.active_tree(), 1);
+  scoped_ptr<LayerImpl> surface = LayerImpl::Create(host_impl.active_tree(), 2);
+  scoped_ptr<LayerImpl> surface_child =
+      LayerImpl::Create(host_impl.active_tree(), 3);
+  scoped_ptr<LayerImpl> child = LayerImpl::Create(host_impl.active_tree(), 4);
+
+  gfx::Transform identity_matrix;
+  SetLayerPropertiesForTesting(root.get(),
+                               identity_matrix,
+                               identity_matrix,
+                               gfx::PointF(),
+                               gfx::PointF(),
+                               gfx::Size(100, 100),
+                               false);
+  SetLayerPropertiesForTesting(surface.get(),
+                               identity_matrix,
+                               identity_matrix,
+                               gfx::PointF(),
+                               gfx::PointF(10.f, 10.f),
+                               gfx::Size(50, 50),
+                               false);
+  SetLayerPropertiesForTesting(surface_child.get(),
+                               identity_matrix,
+                               identity_matrix,
+                               gfx::PointF(),
+                               gfx::PointF(5.f, 5.f),
+                               gfx::Size(20, 20),
+                               false);
+  SetLayerPropertiesForTesting(child.get(),
+                               identity_matrix,
+                               identity_matrix,
+                               gfx::PointF(),
+                               gfx::PointF(60.f, 60.f),
+                               gfx::Size(30, 30),
+                               false);
+  root->SetDrawsContent(true);
+  surface->SetDrawsContent(true);
+  surface->SetForceRenderSurface(true);
+  surface_child->SetDrawsContent(true);
+  child->SetDrawsContent(true);
+
+  LayerImpl* surface_ptr = surface.get();
+  LayerImpl* surface_child_ptr = surface_child.get();
+  LayerImpl* child_ptr = child.get();
+  surface->AddChild(surface_child.Pass());
+  root->AddChild(surface.Pass());
+  root->AddChild(child.Pass());
+
+  LayerImplList render_surface_layer_list;
+  {
+    LayerTreeHostCommon::CalcDrawPropsImplInputsForTesting inputs(
+        root.get(), root->bounds(), &render_surface_layer_list);
+    inputs.can_adjust_raster_scales = true;
+    inputs.reuse_unchanged_subtrees = true;
+    LayerTreeHostCommon::CalculateDrawProperties(&inputs);
+  }
+  ASSERT_EQ(2u, render_surface_layer_list.size());
+  EXPECT_EQ(root.get(), render_surface_layer_list[0]);
+  EXPECT_EQ(surface_ptr, render_surface_layer_list[1]);
+  EXPECT_EQ(3u, root->render_surface()->layer_list().size());
+  EXPECT_EQ(2u, surface_ptr->render_surface()->layer_list().size());
+  EXPECT_FALSE(root->needs_draw_properties_update());
+  EXPECT_FALSE(root->descendant_needs_draw_properties_update());
+
+  // Moving |child| marks the path to it, but not the surface's subtree.
+  child_ptr->SetPosition(gfx::PointF(40.f, 60.f));
+  EXPECT_TRUE(child_ptr->needs_draw_properties_update());
+  EXPECT_TRUE(root->descendant_needs_draw_properties_update());
+  EXPECT_FALSE(surface_ptr->needs_draw_properties_update());
+  EXPECT_FALSE(surface_ptr->descendant_needs_draw_properties_update());
+
+  render_surface_layer_list.clear();
+  {
+    LayerTreeHostCommon::CalcDrawPropsImplInputsForTesting inputs(
+        root.get(), root->bounds(), &render_surface_layer_list);
+    inputs.can_adjust_raster_scales = true;
+    inputs.reuse_unchanged_subtrees = true;
+    LayerTreeHostCommon::CalculateDrawProperties(&inputs);
+  }
+  EXPECT_FALSE(child_ptr->needs_draw_properties_update());
+  EXPECT_FALSE(root->descendant_needs_draw_properties_update());
+  EXPECT_RECT_EQ(gfx::Rect(40, 60, 30, 30), child_ptr->drawable_content_rect());
+
+  // The reused surface is listed as before, and still holds its layers.
+  ASSERT_EQ(2u, render_surface_layer_list.size());
+  EXPECT_EQ(surface_ptr, render_surface_layer_list[1]);
+  ASSERT_EQ(3u, root->render_surface()->layer_list().size());
+  EXPECT_EQ(root.get(), root->render_surface()->layer_list()[0]);
+  EXPECT_EQ(surface_ptr, root->render_surface()->layer_list()[1]);
+  EXPECT_EQ(child_ptr, root->render_surface()->layer_list()[2]);
+  ASSERT_EQ(2u, surface_ptr->render_surface()->layer_list().size());
+  EXPECT_EQ(surface_ptr, surface_ptr->render_surface()->layer_list()[0]);
+  EXPECT_EQ(surface_child_ptr, surface_ptr->render_surface()->layer_list()[1]);
+
+  // A change inside the surface recomputes the surface's subtree.
+  surface_child_ptr->SetHideLayerAndSubtree(true);
+  render_surface_layer_list.clear();
+  {
+    LayerTreeHostCommon::CalcDrawPropsImplInputsForTesting inputs(
+        root.get(), root->bounds(), &render_surface_layer_list);
+    inputs.can_adjust_raster_scales = true;
+    inputs.reuse_unchanged_subtrees = true;
+    LayerTreeHostCommon::CalculateDrawProperties(&inputs);
+  }
+  ASSERT_EQ(2u, render_surface_layer_list.size());
+  ASSERT_EQ(1u, surface_ptr->render_surface()->layer_list().size());
+  EXPECT_EQ(surface_ptr, surface_ptr->render_surface()->layer_list()[0]);
+
+  // Unchanged layers are recomputed when their inputs change, here by moving
+  // the whole tree with the device transform.
+  gfx::Transform device_transform;
+  device_transform.Translate(5.0, 5.0);
+  render_surface_layer_list.clear();
+  {
+    LayerTreeHostCommon::CalcDrawPropsImplInputsForTesting inputs(
+        root.get(), root->bounds(), device_transform,
+        &render_surface_layer_list);
+    inputs.can_adjust_raster_scales = true;
+    inputs.reuse_unchanged_subtrees = true;
+    LayerTreeHostCommon::CalculateDrawProperties(&inputs);
+  }
+  gfx::Transform expected_surface_draw_transform;
+  expected_surface_draw_transform.Translate(15.0, 15.0);
+  EXPECT_TRANSFORMATION_MATRIX_EQ(
+      expected_surface_draw_transform,
+      surface_ptr->render_surface()->draw_transform());
+  EXPECT_RECT_EQ(gfx::Rect(45, 65, 30, 30), child_ptr->drawable_content_rect());
+}
+
 TEST_F(LayerTreeHostCommonTest, HitTestingForEmptyLayerList) {
   // Hit testing on an empty render_surface_layer_list should return a null
   // pointer.
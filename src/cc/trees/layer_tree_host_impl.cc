@@ -616,6 +616,8 @@ bool LayerTreeHostImpl::CalculateRenderPasses(FrameData* frame) {
       record_metrics_for_frame);
   occlusion_tracker.set_minimum_tracking_size(
       settings_.minimum_occlusion_tracking_size);
+  occlusion_tracker.set_maximum_tracking_rects(
+      settings_.maximum_occlusion_tracking_rects);
 
   if (debug_state_.show_occluding_rects) {
     occlusion_tracker.set_occluding_screen_space_rects_container(
@@ -1579,7 +1581,9 @@ void LayerTreeHostImpl::CreateAndSetTileManager(
                                       resource_provider,
                                       settings_.num_raster_threads,
                                       rendering_stats_instrumentation_,
-                                      using_map_image);
+                                      using_map_image,
+                                      settings_.parallel_tile_raster,
+                                      settings_.compress_evicted_tiles);
   UpdateTileManagerMemoryPolicy(ActualManagedMemoryPolicy());
   need_to_update_visible_tiles_before_draw_ = false;
 }
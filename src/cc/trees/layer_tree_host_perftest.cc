@@ -8,7 +8,9 @@
 #include "base/files/file_path.h"
 #include "base/path_service.h"
 #include "base/strings/string_piece.h"
+#include "cc/debug/rendering_stats_instrumentation.h"
 #include "cc/layers/content_layer.h"
+#include "cc/layers/layer_impl.h"
 #include "cc/layers/nine_patch_layer.h"
 #include "cc/layers/solid_color_layer.h"
 #include "cc/test/fake_content_layer_client.h"
@@ -31,10 +33,16 @@ class LayerTreeHostPerfTest : public LayerTreeTest {
         num_commits_(0),
         full_damage_each_frame_(false),
         animation_driven_drawing_(false),
-        measure_commit_cost_(false) {
+        measure_commit_cost_(false),
+        measure_tile_analysis_cost_(false) {
     fake_content_layer_client_.set_paint_all_opaque(true);
   }
 
+  virtual void InitializeSettings(LayerTreeSettings* settings) OVERRIDE {
+    if (measure_tile_analysis_cost_)
+      settings->initial_debug_state.SetRecordRenderingStats(true);
+  }
+
   virtual void BeginTest() OVERRIDE {
     BuildTree();
     PostSetNeedsCommitToMainThread();
@@ -76,6 +84,16 @@ class LayerTreeHostPerfTest : public LayerTreeTest {
       impl->SetFullRootLayerDamage();
   }
 
+  virtual void DidCommitAndDrawFrame() OVERRIDE {
+    // The host is gone by the time AfterTest() runs, so keep the latest
+    // stats around.
+    if (measure_tile_analysis_cost_) {
+      rendering_stats_ =
+          layer_tree_host()->rendering_stats_instrumentation()->
+              GetRenderingStats();
+    }
+  }
+
   virtual void BuildTree() {}
 
   virtual void AfterTest() OVERRIDE {
@@ -92,6 +110,12 @@ class LayerTreeHostPerfTest : public LayerTreeTest {
              num_commits_,
              total_commit_time_.InMillisecondsF() / num_commits_);
     }
+    if (measure_tile_analysis_cost_) {
+      printf("*RESULT %s: tiles analyzed: %d, %.2f ms analysis\n",
+             test_name_.c_str(),
+             static_cast<int>(rendering_stats_.total_tiles_analyzed),
+             rendering_stats_.total_tile_analysis_time.InMillisecondsF());
+    }
   }
 
  protected:
@@ -107,6 +131,9 @@ class LayerTreeHostPerfTest : public LayerTreeTest {
   bool measure_commit_cost_;
   base::TimeTicks commit_start_time_;
   base::TimeDelta total_commit_time_;
+
+  bool measure_tile_analysis_cost_;
+  RenderingStats rendering_stats_;
 };
 
 
@@ -211,6 +238,14 @@ TEST_F(ScrollingLayerTreePerfTest, LongScrollablePage) {
   RunTest(false, false, false);
 }
 
+// Main-thread scrolling with impl-side painting. Tiles scrolling into view
+// are analyzed before they are rasterized.
+TEST_F(ScrollingLayerTreePerfTest, LongScrollablePageImplSidePainting) {
+  measure_tile_analysis_cost_ = true;
+  ReadTestFile("long_scrollable_page");
+  RunTest(true, false, true);
+}
+
 class ImplSidePaintingPerfTest : public LayerTreeHostPerfTestJsonReader {
  protected:
   // Run test with impl-side painting.
@@ -221,6 +256,7 @@ class ImplSidePaintingPerfTest : public LayerTreeHostPerfTestJsonReader {
 TEST_F(ImplSidePaintingPerfTest, HeavyPage) {
   animation_driven_drawing_ = true;
   measure_commit_cost_ = true;
+  measure_tile_analysis_cost_ = true;
   ReadTestFile("heavy_layer_tree");
   RunTestWithImplSidePainting();
 }
@@ -284,9 +320,72 @@ class PageScaleImplSidePaintingPerfTest : public ImplSidePaintingPerfTest {
 
 TEST_F(PageScaleImplSidePaintingPerfTest, HeavyPage) {
   measure_commit_cost_ = true;
+  measure_tile_analysis_cost_ = true;
   ReadTestFile("heavy_layer_tree");
   RunTestWithImplSidePainting();
 }
 
+// A flat page of many small layers of which only one moves each frame, on
+// the impl thread. Compares recomputing all draw properties against reusing
+// them for the layers that did not change.
+class ManyLayersOneMovingPerfTest : public LayerTreeHostPerfTest {
+ public:
+  ManyLayersOneMovingPerfTest() : incremental_(false) {}
+
+  void RunMovingLayerTest(const std::string& name, bool incremental) {
+    test_name_ = name;
+    incremental_ = incremental;
+    RunTest(true, false, false);
+  }
+
+  virtual void InitializeSettings(LayerTreeSettings* settings) OVERRIDE {
+    LayerTreeHostPerfTest::InitializeSettings(settings);
+    settings->incremental_draw_properties = incremental_;
+  }
+
+  virtual void BuildTree() OVERRIDE {
+    static const int kNumLayers = 5000;
+    static const int kLayersPerRow = 100;
+    static const int kLayerSize = 10;
+
+    layer_tree_host()->SetViewportSize(gfx::Size(
+        kLayersPerRow * kLayerSize, kNumLayers / kLayersPerRow * kLayerSize));
+    scoped_refptr<Layer> root = Layer::Create();
+    root->SetBounds(layer_tree_host()->device_viewport_size());
+    for (int i = 0; i < kNumLayers; ++i) {
+      scoped_refptr<SolidColorLayer> layer = SolidColorLayer::Create();
+      layer->SetPosition(gfx::PointF(i % kLayersPerRow * kLayerSize,
+                                     i / kLayersPerRow * kLayerSize));
+      layer->SetBounds(gfx::Size(kLayerSize - 1, kLayerSize - 1));
+      layer->SetBackgroundColor(SK_ColorGREEN);
+      layer->SetIsDrawable(true);
+      root->AddChild(layer);
+    }
+    layer_tree_host()->SetRootLayer(root);
+  }
+
+  virtual void AnimateLayers(LayerTreeHostImpl* host_impl,
+                             base::TimeTicks monotonic_time) OVERRIDE {
+    LayerImpl* root = host_impl->active_tree()->root_layer();
+    if (!root || root->children().empty())
+      return;
+    LayerImpl* moving_layer = root->children()[root->children().size() / 2];
+    gfx::PointF position = moving_layer->position();
+    position.set_x(position.x() + (num_draws_ % 2 ? 1.f : -1.f));
+    moving_layer->SetPosition(position);
+  }
+
+ private:
+  bool incremental_;
+};
+
+TEST_F(ManyLayersOneMovingPerfTest, FullUpdate) {
+  RunMovingLayerTest("5000_layers_one_moving_full", false);
+}
+
+TEST_F(ManyLayersOneMovingPerfTest, Incremental) {
+  RunMovingLayerTest("5000_layers_one_moving_incremental", true);
+}
+
 }  // namespace
 }  // namespace cc
@@ -308,6 +308,7 @@ void LayerTreeImpl::UpdateDrawProperties() {
         settings().can_use_lcd_text,
         settings().layer_transforms_should_scale_layer_contents,
         &render_surface_layer_list_);
+    inputs.reuse_unchanged_subtrees = settings().incremental_draw_properties;
     LayerTreeHostCommon::CalculateDrawProperties(&inputs);
   }
 
@@ -47,6 +47,7 @@ LayerTreeSettings::LayerTreeSettings()
       default_tile_size(gfx::Size(256, 256)),
       max_untiled_layer_size(gfx::Size(512, 512)),
       minimum_occlusion_tracking_size(gfx::Size(160, 160)),
+      maximum_occlusion_tracking_rects(64),
       use_pinch_zoom_scrollbars(false),
       use_pinch_virtual_viewport(false),
       // At 256x256 tiles, 128 tiles cover an area of 2048x4096 pixels.
@@ -56,6 +57,9 @@ LayerTreeSettings::LayerTreeSettings()
       force_direct_layer_drawing(false),
       strict_layer_property_change_checking(false),
       use_map_image(false),
+      parallel_tile_raster(false),
+      compress_evicted_tiles(false),
+      incremental_draw_properties(false),
       compositor_name("ChromiumCompositor"),
       ignore_root_layer_flings(false) {
   // TODO(danakj): Renable surface caching when we can do it more realiably.
@@ -54,6 +54,7 @@ class CC_EXPORT LayerTreeSettings {
   gfx::Size default_tile_size;
   gfx::Size max_untiled_layer_size;
   gfx::Size minimum_occlusion_tracking_size;
+  size_t maximum_occlusion_tracking_rects;
   bool use_pinch_zoom_scrollbars;
   bool use_pinch_virtual_viewport;
   size_t max_tiles_for_interest_area;
@@ -62,6 +63,9 @@ class CC_EXPORT LayerTreeSettings {
   bool force_direct_layer_drawing;  // With Skia GPU backend.
   bool strict_layer_property_change_checking;
   bool use_map_image;
+  bool parallel_tile_raster;
+  bool compress_evicted_tiles;
+  bool incremental_draw_properties;
   std::string compositor_name;
   bool ignore_root_layer_flings;
 
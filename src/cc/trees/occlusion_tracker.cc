@@ -22,6 +22,7 @@ OcclusionTrackerBase<LayerType, RenderSurfaceType>::OcclusionTrackerBase(
     gfx::Rect screen_space_clip_rect, bool record_metrics_for_frame)
     : screen_space_clip_rect_(screen_space_clip_rect),
       overdraw_metrics_(OverdrawMetrics::Create(record_metrics_for_frame)),
+      maximum_tracking_rects_(0),
       prevent_occlusion_(false),
       occluding_screen_space_rects_(NULL),
       non_occluding_screen_space_rects_(NULL) {}
@@ -149,6 +150,31 @@ static inline bool LayerIsHidden(const LayerType* layer) {
          (layer->parent() && LayerIsHidden(layer->parent()));
 }
 
+static bool HasLargerArea(const gfx::Rect& a, const gfx::Rect& b) {
+  return static_cast<int64>(a.width()) * a.height() >
+         static_cast<int64>(b.width()) * b.height();
+}
+
+// Keeps only the |max_rects| largest rects of |occlusion|. Dropping rects
+// only loses occlusion, so this never culls anything that is visible.
+static void ReduceToLargestRects(Region* occlusion, size_t max_rects) {
+  if (!max_rects ||
+      static_cast<size_t>(occlusion->GetRegionComplexity()) <= max_rects)
+    return;
+
+  std::vector<gfx::Rect> rects;
+  for (Region::Iterator it(*occlusion); it.has_rect(); it.next())
+    rects.push_back(it.rect());
+  if (rects.size() <= max_rects)
+    return;
+  std::partial_sort(
+      rects.begin(), rects.begin() + max_rects, rects.end(), HasLargerArea);
+
+  occlusion->Clear();
+  for (size_t i = 0; i < max_rects; ++i)
+    occlusion->Union(rects[i]);
+}
+
 template <typename LayerType, typename RenderSurfaceType>
 void OcclusionTrackerBase<LayerType, RenderSurfaceType>::EnterRenderTarget(
     const LayerType* new_target) {
@@ -216,6 +242,7 @@ void OcclusionTrackerBase<LayerType, RenderSurfaceType>::EnterRenderTarget(
           false,
           gfx::Rect(),
           old_target_to_new_target_transform));
+  LimitOcclusionComplexity();
 }
 
 template <typename LayerType, typename RenderSurfaceType>
@@ -380,6 +407,7 @@ void OcclusionTrackerBase<LayerType, RenderSurfaceType>::LeaveToRenderTarget(
       stack_.back().occlusion_from_outside_target.Clear();
     }
   }
+  LimitOcclusionComplexity();
 
   if (!old_target->background_filters().HasFilterThatMovesPixels())
     return;
@@ -475,6 +503,7 @@ void OcclusionTrackerBase<LayerType, RenderSurfaceType>::
         gfx::ToEnclosedRect(screen_space_quad.BoundingBox());
     occluding_screen_space_rects_->push_back(screen_space_rect);
   }
+  LimitOcclusionComplexity();
 
   if (!non_occluding_screen_space_rects_)
     return;
@@ -506,6 +535,15 @@ void OcclusionTrackerBase<LayerType, RenderSurfaceType>::
   }
 }
 
+template <typename LayerType, typename RenderSurfaceType>
+void OcclusionTrackerBase<LayerType, RenderSurfaceType>::
+    LimitOcclusionComplexity() {
+  ReduceToLargestRects(&stack_.back().occlusion_from_inside_target,
+                       maximum_tracking_rects_);
+  ReduceToLargestRects(&stack_.back().occlusion_from_outside_target,
+                       maximum_tracking_rects_);
+}
+
 template <typename LayerType, typename RenderSurfaceType>
 bool OcclusionTrackerBase<LayerType, RenderSurfaceType>::Occluded(
     const LayerType* render_target,
@@ -547,12 +585,14 @@ bool OcclusionTrackerBase<LayerType, RenderSurfaceType>::Occluded(
   // Layers can't clip across surfaces, so count this as internal occlusion.
   if (is_clipped)
     unoccluded_region_in_target_surface.Intersect(clip_rect_in_target);
-  unoccluded_region_in_target_surface.Subtract(
-      stack_.back().occlusion_from_inside_target);
+  stack_.back().inside_target_index.SubtractFrom(
+      stack_.back().occlusion_from_inside_target,
+      &unoccluded_region_in_target_surface);
   gfx::RectF unoccluded_rect_in_target_surface_without_outside_occlusion =
       unoccluded_region_in_target_surface.bounds();
-  unoccluded_region_in_target_surface.Subtract(
-      stack_.back().occlusion_from_outside_target);
+  stack_.back().outside_target_index.SubtractFrom(
+      stack_.back().occlusion_from_outside_target,
+      &unoccluded_region_in_target_surface);
 
   // Treat other clipping as occlusion from outside the surface.
   // TODO(danakj): Clip to visibleContentRect?
@@ -617,12 +657,14 @@ gfx::Rect OcclusionTrackerBase<LayerType, RenderSurfaceType>::
   // Layers can't clip across surfaces, so count this as internal occlusion.
   if (is_clipped)
     unoccluded_region_in_target_surface.Intersect(clip_rect_in_target);
-  unoccluded_region_in_target_surface.Subtract(
-      stack_.back().occlusion_from_inside_target);
+  stack_.back().inside_target_index.SubtractFrom(
+      stack_.back().occlusion_from_inside_target,
+      &unoccluded_region_in_target_surface);
   gfx::RectF unoccluded_rect_in_target_surface_without_outside_occlusion =
       unoccluded_region_in_target_surface.bounds();
-  unoccluded_region_in_target_surface.Subtract(
-      stack_.back().occlusion_from_outside_target);
+  stack_.back().outside_target_index.SubtractFrom(
+      stack_.back().occlusion_from_outside_target,
+      &unoccluded_region_in_target_surface);
 
   // Treat other clipping as occlusion from outside the surface.
   // TODO(danakj): Clip to visibleContentRect?
@@ -703,15 +745,17 @@ gfx::Rect OcclusionTrackerBase<LayerType, RenderSurfaceType>::
     unoccluded_region_in_target_surface.Intersect(surface->clip_rect());
   if (has_occlusion) {
     const StackObject& second_last = stack_[stack_.size() - 2];
-    unoccluded_region_in_target_surface.Subtract(
-        second_last.occlusion_from_inside_target);
+    second_last.inside_target_index.SubtractFrom(
+        second_last.occlusion_from_inside_target,
+        &unoccluded_region_in_target_surface);
   }
   gfx::RectF unoccluded_rect_in_target_surface_without_outside_occlusion =
       unoccluded_region_in_target_surface.bounds();
   if (has_occlusion) {
     const StackObject& second_last = stack_[stack_.size() - 2];
-    unoccluded_region_in_target_surface.Subtract(
-        second_last.occlusion_from_outside_target);
+    second_last.outside_target_index.SubtractFrom(
+        second_last.occlusion_from_outside_target,
+        &unoccluded_region_in_target_surface);
   }
 
   // Treat other clipping as occlusion from outside the target surface.
@@ -10,6 +10,7 @@
 #include "base/basictypes.h"
 #include "cc/base/cc_export.h"
 #include "cc/base/region.h"
+#include "cc/base/region_query_index.h"
 #include "cc/layers/layer_iterator.h"
 #include "ui/gfx/rect.h"
 
@@ -97,6 +98,13 @@ class CC_EXPORT OcclusionTrackerBase {
     minimum_tracking_size_ = size;
   }
 
+  // Bounds the number of rects kept for the occlusion in each surface, so
+  // that queries stay cheap on complex pages. When there are more, only the
+  // largest ones are kept. Zero, the default, keeps every rect.
+  void set_maximum_tracking_rects(size_t max_rects) {
+    maximum_tracking_rects_ = max_rects;
+  }
+
   // The following is used for visualization purposes.
   void set_occluding_screen_space_rects_container(
       std::vector<gfx::Rect>* rects) {
@@ -114,6 +122,10 @@ class CC_EXPORT OcclusionTrackerBase {
     const LayerType* target;
     Region occlusion_from_outside_target;
     Region occlusion_from_inside_target;
+
+    // Used by the queries to find the occlusion near a rect quickly.
+    mutable RegionQueryIndex outside_target_index;
+    mutable RegionQueryIndex inside_target_index;
   };
 
   // The stack holds occluded regions for subtrees in the
@@ -152,9 +164,14 @@ class CC_EXPORT OcclusionTrackerBase {
   // Add the layer's occlusion to the tracked state.
   void MarkOccludedBehindLayer(const LayerType* layer);
 
+  // Drops the smallest rects of the occlusion at the top of the stack if it
+  // has more than |maximum_tracking_rects_|.
+  void LimitOcclusionComplexity();
+
   gfx::Rect screen_space_clip_rect_;
   scoped_ptr<class OverdrawMetrics> overdraw_metrics_;
   gfx::Size minimum_tracking_size_;
+  size_t maximum_tracking_rects_;
   bool prevent_occlusion_;
 
   // This is used for visualizing the occlusion tracking process.
@@ -4380,6 +4380,59 @@ class OcclusionTrackerTestMinimumTrackingSize
 
 ALL_OCCLUSIONTRACKER_TEST(OcclusionTrackerTestMinimumTrackingSize);
 
+template <class Types>
+class OcclusionTrackerTestMaximumTrackingRects
+    : public OcclusionTrackerTest<Types> {
+ protected:
+  explicit OcclusionTrackerTestMaximumTrackingRects(bool opaque_layers)
+      : OcclusionTrackerTest<Types>(opaque_layers) {}
+  void RunMyTest() {
+    typename Types::ContentLayerType* parent = this->CreateRoot(
+        this->identity_matrix, gfx::PointF(), gfx::Size(400, 400));
+    typename Types::LayerType* small = this->CreateDrawingLayer(
+        parent, this->identity_matrix, gfx::PointF(), gfx::Size(100, 10), true);
+    typename Types::LayerType* large =
+        this->CreateDrawingLayer(parent,
+                                 this->identity_matrix,
+                                 gfx::PointF(0.f, 50.f),
+                                 gfx::Size(100, 30),
+                                 true);
+    typename Types::LayerType* medium =
+        this->CreateDrawingLayer(parent,
+                                 this->identity_matrix,
+                                 gfx::PointF(0.f, 100.f),
+                                 gfx::Size(100, 20),
+                                 true);
+    this->CalcDrawEtc(parent);
+
+    TestOcclusionTrackerWithClip<typename Types::LayerType,
+                                 typename Types::RenderSurfaceType> occlusion(
+        gfx::Rect(0, 0, 1000, 1000));
+    occlusion.set_maximum_tracking_rects(2);
+
+    this->VisitLayer(medium, &occlusion);
+    this->VisitLayer(large, &occlusion);
+
+    Region expected_occlusion = gfx::Rect(0, 50, 100, 30);
+    expected_occlusion.Union(gfx::Rect(0, 100, 100, 20));
+    EXPECT_EQ(expected_occlusion.ToString(),
+              occlusion.occlusion_from_inside_target().ToString());
+
+    // A third rect is more than the tracker keeps, so the smallest one is
+    // dropped.
+    this->VisitLayer(small, &occlusion);
+
+    EXPECT_EQ(gfx::Rect().ToString(),
+              occlusion.occlusion_from_outside_target().ToString());
+    EXPECT_EQ(expected_occlusion.ToString(),
+              occlusion.occlusion_from_inside_target().ToString());
+    EXPECT_FALSE(occlusion.OccludedLayer(small, gfx::Rect(0, 0, 100, 10)));
+    EXPECT_TRUE(occlusion.OccludedLayer(small, gfx::Rect(0, 50, 100, 30)));
+  }
+};
+
+ALL_OCCLUSIONTRACKER_TEST(OcclusionTrackerTestMaximumTrackingRects);
+
 template <class Types>
 class OcclusionTrackerTestViewportClipIsExternalOcclusion
     : public OcclusionTrackerTest<Types> {
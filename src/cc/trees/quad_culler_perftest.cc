@@ -0,0 +1,195 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/trees/quad_culler.h"
+
+#include <string>
+
+#include "base/time/time.h"
+#include "cc/base/math_util.h"
+#include "cc/base/scoped_ptr_vector.h"
+#include "cc/layers/append_quads_data.h"
+#include "cc/layers/layer_iterator.h"
+#include "cc/layers/render_surface_impl.h"
+#include "cc/layers/tiled_layer_impl.h"
+#include "cc/resources/layer_tiling_data.h"
+#include "cc/test/fake_impl_proxy.h"
+#include "cc/test/fake_layer_tree_host_impl.h"
+#include "cc/trees/occlusion_tracker.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/gfx/transform.h"
+
+namespace cc {
+namespace {
+
+static const int kTimeLimitMillis = 2000;
+static const int kWarmupRuns = 5;
+static const int kTimeCheckInterval = 10;
+
+static const int kTileSize = 100;
+static const int kPageSize = 4000;
+
+class TestOcclusionTrackerImpl : public OcclusionTrackerImpl {
+ public:
+  explicit TestOcclusionTrackerImpl(gfx::Rect scissor_rect_in_screen)
+      : OcclusionTrackerImpl(scissor_rect_in_screen, false),
+        scissor_rect_in_screen_(scissor_rect_in_screen) {}
+
+ protected:
+  virtual gfx::Rect LayerScissorRectInTargetSurface(
+      const LayerImpl* layer) const {
+    return scissor_rect_in_screen_;
+  }
+
+ private:
+  gfx::Rect scissor_rect_in_screen_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestOcclusionTrackerImpl);
+};
+
+typedef LayerIterator<LayerImpl,
+                      LayerImplList,
+                      RenderSurfaceImpl,
+                      LayerIteratorActions::FrontToBack> LayerIteratorType;
+
+// Culls the quads of a page made of a large tiled root layer with thousands
+// of tiles, covered by many small opaque layers that leave the occlusion
+// made up of many rects.
+class QuadCullerPerfTest : public testing::Test {
+ public:
+  QuadCullerPerfTest()
+      : host_impl_(&proxy_),
+        layer_id_(1),
+        num_runs_(0) {}
+
+  scoped_ptr<TiledLayerImpl> MakeLayer(TiledLayerImpl* parent,
+                                       gfx::Rect layer_rect) {
+    scoped_ptr<TiledLayerImpl> layer =
+        TiledLayerImpl::Create(host_impl_.active_tree(), layer_id_++);
+    scoped_ptr<LayerTilingData> tiler = LayerTilingData::Create(
+        gfx::Size(kTileSize, kTileSize), LayerTilingData::NO_BORDER_TEXELS);
+    tiler->SetBounds(layer_rect.size());
+    layer->SetTilingData(*tiler);
+    layer->set_skips_draw(false);
+    gfx::Transform draw_transform;
+    draw_transform.Translate(layer_rect.x(), layer_rect.y());
+    layer->draw_properties().target_space_transform = draw_transform;
+    layer->draw_properties().screen_space_transform = draw_transform;
+    layer->draw_properties().visible_content_rect =
+        gfx::Rect(layer_rect.size());
+    layer->draw_properties().opacity = 1.f;
+    layer->SetContentsOpaque(true);
+    layer->SetBounds(layer_rect.size());
+    layer->SetContentBounds(layer_rect.size());
+
+    ResourceProvider::ResourceId resource_id = 1;
+    for (int i = 0; i < tiler->num_tiles_x(); ++i) {
+      for (int j = 0; j < tiler->num_tiles_y(); ++j) {
+        layer->PushTileProperties(
+            i, j, resource_id++, tiler->tile_bounds(i, j), false);
+      }
+    }
+
+    if (!parent) {
+      layer->CreateRenderSurface();
+      layer->render_surface()->SetContentRect(layer_rect);
+      render_surface_layer_list_.push_back(layer.get());
+      layer->render_surface()->layer_list().push_back(layer.get());
+    } else {
+      layer->draw_properties().render_target = parent->render_target();
+      parent->render_surface()->layer_list().push_back(layer.get());
+    }
+    layer->draw_properties().drawable_content_rect = layer_rect;
+
+    return layer.Pass();
+  }
+
+  void BuildPage() {
+    root_ = MakeLayer(NULL, gfx::Rect(kPageSize, kPageSize));
+    // Staggered rows of small layers, so no two of them line up and the
+    // occlusion they leave behind can't be merged into fewer rects.
+    for (int y = 0; y + 80 < kPageSize; y += 97) {
+      for (int x = (y / 97) % 7 * 13; x + 80 < kPageSize; x += 131)
+        children_.push_back(MakeLayer(root_.get(), gfx::Rect(x, y, 80, 60)));
+    }
+  }
+
+  bool DidRun() {
+    ++num_runs_;
+    if (num_runs_ == kWarmupRuns)
+      start_time_ = base::TimeTicks::HighResNow();
+
+    if (!start_time_.is_null() && (num_runs_ % kTimeCheckInterval) == 0) {
+      base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start_time_;
+      if (elapsed >= base::TimeDelta::FromMilliseconds(kTimeLimitMillis)) {
+        elapsed_ = elapsed;
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  void AppendAllQuads(size_t maximum_tracking_rects) {
+    QuadList quad_list;
+    SharedQuadStateList shared_state_list;
+    TestOcclusionTrackerImpl occlusion_tracker(
+        gfx::Rect(kPageSize, kPageSize));
+    occlusion_tracker.set_maximum_tracking_rects(maximum_tracking_rects);
+
+    LayerIteratorType end = LayerIteratorType::End(&render_surface_layer_list_);
+    for (LayerIteratorType it =
+             LayerIteratorType::Begin(&render_surface_layer_list_);
+         it != end;
+         ++it) {
+      occlusion_tracker.EnterLayer(it, false);
+      if (it.represents_itself()) {
+        QuadCuller quad_culler(&quad_list,
+                               &shared_state_list,
+                               *it,
+                               occlusion_tracker,
+                               false,
+                               false);
+        AppendQuadsData data;
+        it->AppendQuads(&quad_culler, &data);
+      }
+      occlusion_tracker.LeaveLayer(it);
+    }
+  }
+
+  void RunAppendQuadsTest(const std::string& test_name,
+                          size_t maximum_tracking_rects) {
+    BuildPage();
+    do {
+      AppendAllQuads(maximum_tracking_rects);
+    } while (DidRun());
+
+    // Format matches chrome/test/perf/perf_test.h:PrintResult
+    printf("*RESULT %s: %.2f ms/frame\n",
+           test_name.c_str(),
+           elapsed_.InMillisecondsF() / (num_runs_ - kWarmupRuns));
+  }
+
+ protected:
+  FakeImplProxy proxy_;
+  FakeLayerTreeHostImpl host_impl_;
+  int layer_id_;
+  LayerImplList render_surface_layer_list_;
+  scoped_ptr<TiledLayerImpl> root_;
+  ScopedPtrVector<TiledLayerImpl> children_;
+  base::TimeTicks start_time_;
+  base::TimeDelta elapsed_;
+  int num_runs_;
+};
+
+TEST_F(QuadCullerPerfTest, AppendQuadsFullOcclusion) {
+  RunAppendQuadsTest("append_quads_full_occlusion", 0);
+}
+
+TEST_F(QuadCullerPerfTest, AppendQuadsBoundedOcclusion) {
+  RunAppendQuadsTest("append_quads_bounded_occlusion", 64);
+}
+
+}  // namespace
+}  // namespace cc
@@ -4,8 +4,10 @@
 
 #include "chrome/browser/history/in_memory_url_index.h"
 
+#include "base/bind.h"
 #include "base/debug/trace_event.h"
 #include "base/file_util.h"
+#include "base/metrics/histogram.h"
 #include "base/strings/utf_string_conversions.h"
 #include "chrome/browser/bookmarks/bookmark_model.h"
 #include "chrome/browser/bookmarks/bookmark_model_factory.h"
@@ -27,11 +29,19 @@ using in_memory_url_index::InMemoryURLIndexCacheItem;
 
 namespace history {
 
+// Pending journal records are written out once they reach this size.
+const size_t kJournalFlushThreshold = 16 * 1024;
+
+// Once the journal grows past this size the cache file is rewritten instead,
+// bounding the replay work at startup.
+const int64 kMaxJournalSize = 2 * 1024 * 1024;
+
 // Called by DoSaveToCacheFile to delete any old cache file at |path| when
 // there is no private data to save. Runs on the FILE thread.
 void DeleteCacheFile(const base::FilePath& path) {
   DCHECK(!content::BrowserThread::CurrentlyOn(content::BrowserThread::UI));
   base::DeleteFile(path, false);
+  base::DeleteFile(URLIndexPrivateData::GetJournalFilePath(path), false);
 }
 
 // Initializes a whitelist of URL schemes.
@@ -100,8 +110,12 @@ InMemoryURLIndex::InMemoryURLIndex(Profile* profile,
       save_cache_observer_(NULL),
       shutdown_(false),
       restored_(false),
-      needs_to_be_cached_(false) {
+      needs_to_be_cached_(false),
+      journal_size_(-1),
+      pending_file_tasks_(0),
+      first_query_pending_(false) {
   InitializeSchemeWhitelist(&scheme_whitelist_);
+  private_data_->set_journal(&pending_journal_);
   if (profile) {
     // TODO(mrossetti): Register for language change notifications.
     content::Source<Profile> source(profile);
@@ -120,17 +134,23 @@ InMemoryURLIndex::InMemoryURLIndex()
       save_cache_observer_(NULL),
       shutdown_(false),
       restored_(false),
-      needs_to_be_cached_(false) {
+      needs_to_be_cached_(false),
+      journal_size_(-1),
+      pending_file_tasks_(0),
+      first_query_pending_(false) {
   InitializeSchemeWhitelist(&scheme_whitelist_);
+  private_data_->set_journal(&pending_journal_);
 }
 
 InMemoryURLIndex::~InMemoryURLIndex() {
   // If there was a history directory (which there won't be for some unit tests)
   // then insure that the cache has already been saved.
   DCHECK(history_dir_.empty() || !needs_to_be_cached_);
+  private_data_->set_journal(NULL);
 }
 
 void InMemoryURLIndex::Init() {
+  init_time_ = base::TimeTicks::Now();
   PostRestoreFromCacheFileTask();
 }
 
@@ -142,7 +162,26 @@ void InMemoryURLIndex::ShutDown() {
   if (!GetCacheFilePath(&path))
     return;
   private_data_->CancelPendingUpdates();
-  URLIndexPrivateData::WritePrivateDataToCacheFileTask(private_data_, path);
+  if (pending_file_tasks_ > 0) {
+    // A save still queued on the FILE thread would delete anything appended
+    // to the journal ahead of it, and a queued flush would race with the
+    // append, so rewrite the whole cache once they have run.
+    content::BrowserThread::PostTask(
+        content::BrowserThread::FILE, FROM_HERE,
+        base::Bind(base::IgnoreResult(
+                       &URLIndexPrivateData::WritePrivateDataToCacheFileTask),
+                   private_data_->Duplicate(), path));
+  } else {
+    // If the cache file on disk is current apart from a modest journal, just
+    // append the outstanding changes instead of rewriting the whole cache.
+    int64 journal_size = journal_size_ + pending_journal_.size();
+    if (journal_size_ < 0 || journal_size > kMaxJournalSize ||
+        !URLIndexPrivateData::AppendToJournalFileTask(path,
+                                                      pending_journal_)) {
+      URLIndexPrivateData::WritePrivateDataToCacheFileTask(private_data_, path);
+    }
+  }
+  pending_journal_.clear();
   needs_to_be_cached_ = false;
 }
 
@@ -162,11 +201,17 @@ bool InMemoryURLIndex::GetCacheFilePath(base::FilePath* file_path) {
 ScoredHistoryMatches InMemoryURLIndex::HistoryItemsForTerms(
     const string16& term_string,
     size_t cursor_position) {
-  return private_data_->HistoryItemsForTerms(
+  ScoredHistoryMatches matches = private_data_->HistoryItemsForTerms(
       term_string,
       cursor_position,
       languages_,
       BookmarkModelFactory::GetForProfile(profile_));
+  if (first_query_pending_) {
+    first_query_pending_ = false;
+    UMA_HISTOGRAM_TIMES("History.InMemoryURLIndexInitToFirstQueryTime",
+                        base::TimeTicks::Now() - init_time_);
+  }
+  return matches;
 }
 
 // Updating --------------------------------------------------------------------
@@ -206,8 +251,12 @@ void InMemoryURLIndex::OnURLVisited(const URLVisitedDetails* details) {
   HistoryService* service =
       HistoryServiceFactory::GetForProfile(profile_,
                                            Profile::EXPLICIT_ACCESS);
-  needs_to_be_cached_ |= private_data_->UpdateURL(
-      service, details->row, languages_, scheme_whitelist_);
+  if (private_data_->UpdateURL(service, details->row, languages_,
+                               scheme_whitelist_)) {
+    private_data_->AppendUpdateToJournal(details->row, &pending_journal_);
+    needs_to_be_cached_ = true;
+  }
+  MaybeFlushJournal();
 }
 
 void InMemoryURLIndex::OnURLsModified(const URLsModifiedDetails* details) {
@@ -215,20 +264,32 @@ void InMemoryURLIndex::OnURLsModified(const URLsModifiedDetails* details) {
       HistoryServiceFactory::GetForProfile(profile_,
                                            Profile::EXPLICIT_ACCESS);
   for (URLRows::const_iterator row = details->changed_urls.begin();
-       row != details->changed_urls.end(); ++row)
-    needs_to_be_cached_ |=
-        private_data_->UpdateURL(service, *row, languages_, scheme_whitelist_);
+       row != details->changed_urls.end(); ++row) {
+    if (private_data_->UpdateURL(service, *row, languages_,
+                                 scheme_whitelist_)) {
+      private_data_->AppendUpdateToJournal(*row, &pending_journal_);
+      needs_to_be_cached_ = true;
+    }
+  }
+  MaybeFlushJournal();
 }
 
 void InMemoryURLIndex::OnURLsDeleted(const URLsDeletedDetails* details) {
   if (details->all_history) {
     ClearPrivateData();
+    URLIndexPrivateData::AppendClearToJournal(&pending_journal_);
     needs_to_be_cached_ = true;
   } else {
     for (URLRows::const_iterator row = details->rows.begin();
-         row != details->rows.end(); ++row)
-      needs_to_be_cached_ |= private_data_->DeleteURL(row->url());
+         row != details->rows.end(); ++row) {
+      if (private_data_->DeleteURL(row->url())) {
+        URLIndexPrivateData::AppendDeleteToJournal(row->url(),
+                                                   &pending_journal_);
+        needs_to_be_cached_ = true;
+      }
+    }
   }
+  MaybeFlushJournal();
 }
 
 // Restoring from Cache --------------------------------------------------------
@@ -248,15 +309,22 @@ void InMemoryURLIndex::PostRestoreFromCacheFileTask() {
   content::BrowserThread::PostTaskAndReplyWithResult
       <scoped_refptr<URLIndexPrivateData> >(
       content::BrowserThread::FILE, FROM_HERE,
-      base::Bind(&URLIndexPrivateData::RestoreFromFile, path, languages_),
+      base::Bind(&URLIndexPrivateData::RestoreFromFile, path, languages_,
+                 scheme_whitelist_),
       base::Bind(&InMemoryURLIndex::OnCacheLoadDone, AsWeakPtr()));
 }
 
 void InMemoryURLIndex::OnCacheLoadDone(
     scoped_refptr<URLIndexPrivateData> private_data) {
   if (private_data.get() && !private_data->Empty()) {
-    private_data_ = private_data;
+    SetPrivateData(private_data);
     restored_ = true;
+    first_query_pending_ = !init_time_.is_null();
+    // The restored data already includes the replayed journal, so further
+    // changes can be appended to it.
+    journal_size_ = private_data_->restored_journal_size();
+    if (journal_size_ > kMaxJournalSize)
+      PostSaveToCacheFileTask();  // Fold the journal into the cache file.
     if (restore_cache_observer_)
       restore_cache_observer_->OnCacheRestoreFinished(true);
   } else if (profile_) {
@@ -268,6 +336,8 @@ void InMemoryURLIndex::OnCacheLoadDone(
       return;
     content::BrowserThread::PostBlockingPoolTask(
         FROM_HERE, base::Bind(DeleteCacheFile, path));
+    journal_size_ = -1;
+    pending_journal_.clear();
     HistoryService* service =
         HistoryServiceFactory::GetForProfileWithoutCreating(profile_);
     if (service && service->backend_loaded()) {
@@ -296,7 +366,7 @@ void InMemoryURLIndex::DoneRebuidingPrivateDataFromHistoryDB(
     scoped_refptr<URLIndexPrivateData> private_data) {
   DCHECK(content::BrowserThread::CurrentlyOn(content::BrowserThread::UI));
   if (succeeded) {
-    private_data_ = private_data;
+    SetPrivateData(private_data);
     PostSaveToCacheFileTask();  // Cache the newly rebuilt index.
   } else {
     private_data_->Clear();  // Dump the old private data.
@@ -309,9 +379,19 @@ void InMemoryURLIndex::DoneRebuidingPrivateDataFromHistoryDB(
 }
 
 void InMemoryURLIndex::RebuildFromHistory(HistoryDatabase* history_db) {
-  private_data_ = URLIndexPrivateData::RebuildFromHistory(history_db,
-                                                          languages_,
-                                                          scheme_whitelist_);
+  SetPrivateData(URLIndexPrivateData::RebuildFromHistory(history_db,
+                                                         languages_,
+                                                         scheme_whitelist_));
+}
+
+void InMemoryURLIndex::SetPrivateData(
+    const scoped_refptr<URLIndexPrivateData>& private_data) {
+  // Visits still arriving for the old data must not reach the journal.
+  if (private_data_.get())
+    private_data_->set_journal(NULL);
+  private_data_ = private_data;
+  if (private_data_.get())
+    private_data_->set_journal(&pending_journal_);
 }
 
 // Saving to Cache -------------------------------------------------------------
@@ -327,6 +407,11 @@ void InMemoryURLIndex::PostSaveToCacheFileTask() {
     // completion closure below.
     scoped_refptr<URLIndexPrivateData> private_data_copy =
         private_data_->Duplicate();
+    // The copy contains every change journaled so far; the save removes the
+    // journal file, and records made after this point start a new one.
+    pending_journal_.clear();
+    journal_size_ = 0;
+    ++pending_file_tasks_;
     content::BrowserThread::PostTaskAndReplyWithResult<bool>(
         content::BrowserThread::FILE, FROM_HERE,
         base::Bind(&URLIndexPrivateData::WritePrivateDataToCacheFileTask,
@@ -341,8 +426,52 @@ void InMemoryURLIndex::PostSaveToCacheFileTask() {
 }
 
 void InMemoryURLIndex::OnCacheSaveDone(bool succeeded) {
+  DCHECK_GT(pending_file_tasks_, 0);
+  --pending_file_tasks_;
+  if (!succeeded)
+    journal_size_ = -1;  // There is no cache file to journal against.
   if (save_cache_observer_)
     save_cache_observer_->OnCacheSaveFinished(succeeded);
 }
 
+// Journaling Changes ----------------------------------------------------------
+
+void InMemoryURLIndex::MaybeFlushJournal() {
+  if (pending_journal_.size() >= kJournalFlushThreshold)
+    PostFlushJournalTask();
+}
+
+void InMemoryURLIndex::PostFlushJournalTask() {
+  base::FilePath path;
+  if (pending_journal_.empty() || !GetCacheFilePath(&path) || shutdown_)
+    return;
+  if (journal_size_ < 0) {
+    // Without a cache file the journal would have nothing to apply to; the
+    // changes will be captured by the next full save.
+    pending_journal_.clear();
+    return;
+  }
+  journal_size_ += pending_journal_.size();
+  if (journal_size_ > kMaxJournalSize) {
+    PostSaveToCacheFileTask();
+    return;
+  }
+  std::string journal;
+  journal.swap(pending_journal_);
+  ++pending_file_tasks_;
+  content::BrowserThread::PostTaskAndReplyWithResult<bool>(
+      content::BrowserThread::FILE, FROM_HERE,
+      base::Bind(&URLIndexPrivateData::AppendToJournalFileTask, path, journal),
+      base::Bind(&InMemoryURLIndex::OnJournalFlushDone, AsWeakPtr()));
+}
+
+void InMemoryURLIndex::OnJournalFlushDone(bool succeeded) {
+  DCHECK_GT(pending_file_tasks_, 0);
+  --pending_file_tasks_;
+  // A journal missing records must not be replayed over the cache file; the
+  // next full save replaces both.
+  if (!succeeded)
+    journal_size_ = -1;
+}
+
 }  // namespace history
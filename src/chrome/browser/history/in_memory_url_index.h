@@ -17,6 +17,7 @@
 #include "base/memory/ref_counted.h"
 #include "base/memory/weak_ptr.h"
 #include "base/strings/string16.h"
+#include "base/time/time.h"
 #include "chrome/browser/autocomplete/autocomplete_match.h"
 #include "chrome/browser/autocomplete/history_provider_util.h"
 #include "chrome/browser/common/cancelable_request.h"
@@ -204,6 +205,9 @@ class InMemoryURLIndex : public content::NotificationObserver,
   // Used for unit testing only.
   void RebuildFromHistory(HistoryDatabase* history_db);
 
+  // Replaces |private_data_| and points its journal at |pending_journal_|.
+  void SetPrivateData(const scoped_refptr<URLIndexPrivateData>& private_data);
+
   // Determines if the private data was successfully reloaded from the cache
   // file or if the private data must be rebuilt from the history database.
   // |private_data_ptr|'s data will be NULL if the cache file load failed. If
@@ -229,6 +233,16 @@ class InMemoryURLIndex : public content::NotificationObserver,
   // |succeeded| is true on a successful save.
   void OnCacheSaveDone(bool succeeded);
 
+  // Posts a task appending |pending_journal_| to the cache journal.
+  void PostFlushJournalTask();
+
+  // Called once a journal flush posted by PostFlushJournalTask() has run.
+  // |succeeded| is false if the records could not be appended.
+  void OnJournalFlushDone(bool succeeded);
+
+  // Flushes |pending_journal_| once enough changes have accumulated.
+  void MaybeFlushJournal();
+
   // Handles notifications of history changes.
   virtual void Observe(int notification_type,
                        const content::NotificationSource& source,
@@ -289,6 +303,23 @@ class InMemoryURLIndex : public content::NotificationObserver,
   // http://crbug.com/83659
   bool needs_to_be_cached_;
 
+  // Journal records for changes made since the last flush of the journal.
+  std::string pending_journal_;
+
+  // Bytes appended to the journal since the cache file was last written, or
+  // -1 if there is no usable cache file for the journal to apply to.
+  int64 journal_size_;
+
+  // Number of cache saves and journal flushes posted to the FILE thread which
+  // have not yet completed. ShutDown() must not write the cache or journal
+  // ahead of them.
+  int pending_file_tasks_;
+
+  // When Init() was called, and whether the first query served from data
+  // restored from the cache file has yet to be timed against it.
+  base::TimeTicks init_time_;
+  bool first_query_pending_;
+
   DISALLOW_COPY_AND_ASSIGN(InMemoryURLIndex);
 };
 
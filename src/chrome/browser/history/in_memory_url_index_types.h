@@ -12,6 +12,7 @@
 #include "base/strings/string16.h"
 #include "chrome/browser/autocomplete/history_provider_util.h"
 #include "chrome/browser/history/history_types.h"
+#include "chrome/browser/history/sorted_id_set.h"
 #include "url/gurl.h"
 
 namespace history {
@@ -140,12 +141,15 @@ typedef size_t WordID;
 typedef std::map<string16, WordID> WordMap;
 
 // A map from character to the word_ids of words containing that character.
-typedef std::set<WordID> WordIDSet;  // An index into the WordList.
+// The ID sets are sorted vectors rather than std::sets: a heavy history
+// profile holds millions of entries across these posting lists, and a tree
+// node per entry dominated the index's memory footprint.
+typedef SortedIDSet<WordID> WordIDSet;  // An index into the WordList.
 typedef std::map<char16, WordIDSet> CharWordIDMap;
 
 // A map from word (by word_id) to history items containing that word.
 typedef history::URLID HistoryID;
-typedef std::set<HistoryID> HistoryIDSet;
+typedef SortedIDSet<HistoryID> HistoryIDSet;
 typedef std::vector<HistoryID> HistoryIDVector;
 typedef std::map<WordID, HistoryIDSet> WordIDHistoryMap;
 typedef std::map<HistoryID, WordIDSet> HistoryIDWordMap;
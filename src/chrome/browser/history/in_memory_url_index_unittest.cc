@@ -13,6 +13,7 @@
 #include "base/path_service.h"
 #include "base/strings/string16.h"
 #include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
 #include "chrome/browser/autocomplete/autocomplete_provider.h"
 #include "chrome/browser/chrome_notification_types.h"
@@ -102,6 +103,7 @@ class InMemoryURLIndexTest : public testing::Test {
   bool GetCacheFilePath(base::FilePath* file_path) const;
   void PostRestoreFromCacheFileTask();
   void PostSaveToCacheFileTask();
+  void PostFlushJournalTask();
   void Observe(int notification_type,
                const content::NotificationSource& source,
                const content::NotificationDetails& details);
@@ -163,6 +165,10 @@ void InMemoryURLIndexTest::PostSaveToCacheFileTask() {
   url_index_->PostSaveToCacheFileTask();
 }
 
+void InMemoryURLIndexTest::PostFlushJournalTask() {
+  url_index_->PostFlushJournalTask();
+}
+
 void InMemoryURLIndexTest::Observe(
     int notification_type,
     const content::NotificationSource& source,
@@ -667,6 +673,38 @@ TEST_F(InMemoryURLIndexTest, HugeResultSet) {
             private_data.post_scoring_item_count_);
 }
 
+TEST_F(InMemoryURLIndexTest, ParallelScoring) {
+  // Create enough varied qualifying items to be scored in several chunks.
+  for (URLID row_id = 5000; row_id < 5400; ++row_id) {
+    URLRow new_row(GURL(base::StringPrintf(
+        "http://www.brokeandaloneinmanitoba.com/%d", row_id)), row_id);
+    new_row.set_visit_count(row_id % 37 + 1);
+    new_row.set_typed_count(row_id % 3);
+    new_row.set_last_visit(base::Time::Now() -
+                           base::TimeDelta::FromDays(row_id % 29));
+    EXPECT_TRUE(UpdateURL(new_row));
+  }
+
+  URLIndexPrivateData& private_data(*GetPrivateData());
+  private_data.max_scoring_helpers_ = 0;
+  ScoredHistoryMatches serial_matches =
+      url_index_->HistoryItemsForTerms(ASCIIToUTF16("broke"), string16::npos);
+  private_data.max_scoring_helpers_ = 3;
+  ScoredHistoryMatches parallel_matches =
+      url_index_->HistoryItemsForTerms(ASCIIToUTF16("broke"), string16::npos);
+
+  // Matches of equal score may come in either order, so compare scores.
+  ASSERT_EQ(AutocompleteProvider::kMaxMatches, serial_matches.size());
+  ASSERT_EQ(serial_matches.size(), parallel_matches.size());
+  for (size_t i = 0; i < serial_matches.size(); ++i) {
+    EXPECT_EQ(serial_matches[i].raw_score, parallel_matches[i].raw_score);
+    if (i > 0) {
+      EXPECT_FALSE(ScoredHistoryMatch::MatchScoreGreater(
+          parallel_matches[i], parallel_matches[i - 1]));
+    }
+  }
+}
+
 TEST_F(InMemoryURLIndexTest, TitleSearch) {
   // Signal if someone has changed the test DB.
   EXPECT_EQ(29U, GetPrivateData()->history_info_map_.size());
@@ -1057,6 +1095,157 @@ TEST_F(InMemoryURLIndexTest, CacheSaveRestore) {
   ExpectPrivateDataEqual(*old_data.get(), new_data);
 }
 
+TEST_F(InMemoryURLIndexTest, CacheJournalReplay) {
+  base::ScopedTempDir temp_directory;
+  ASSERT_TRUE(temp_directory.CreateUniqueTempDir());
+  set_history_dir(temp_directory.path());
+
+  // Save the cache, then delete a row and journal the change.
+  CacheFileSaverObserver save_observer(&message_loop_);
+  url_index_->set_save_cache_observer(&save_observer);
+  PostSaveToCacheFileTask();
+  message_loop_.Run();
+  EXPECT_TRUE(save_observer.succeeded_);
+
+  ScoredHistoryMatches matches = url_index_->HistoryItemsForTerms(
+      ASCIIToUTF16("DrudgeReport"), string16::npos);
+  ASSERT_EQ(1U, matches.size());
+  URLsDeletedDetails deleted_details;
+  deleted_details.all_history = false;
+  deleted_details.rows.push_back(matches[0].url_info);
+  Observe(chrome::NOTIFICATION_HISTORY_URLS_DELETED,
+          content::Source<InMemoryURLIndexTest>(this),
+          content::Details<history::HistoryDetails>(&deleted_details));
+  PostFlushJournalTask();
+  message_loop_.RunUntilIdle();
+
+  base::FilePath cache_path;
+  ASSERT_TRUE(GetCacheFilePath(&cache_path));
+  EXPECT_TRUE(base::PathExists(
+      URLIndexPrivateData::GetJournalFilePath(cache_path)));
+  scoped_refptr<URLIndexPrivateData> old_data(GetPrivateData()->Duplicate());
+
+  // Restoring must apply the journal on top of the saved cache.
+  ClearPrivateData();
+  HistoryIndexRestoreObserver restore_observer(
+      base::Bind(&base::MessageLoop::Quit, base::Unretained(&message_loop_)));
+  url_index_->set_restore_cache_observer(&restore_observer);
+  PostRestoreFromCacheFileTask();
+  message_loop_.Run();
+  EXPECT_TRUE(restore_observer.succeeded());
+
+  EXPECT_GT(GetPrivateData()->restored_journal_size(), 0);
+  EXPECT_TRUE(url_index_->HistoryItemsForTerms(
+      ASCIIToUTF16("DrudgeReport"), string16::npos).empty());
+  ExpectPrivateDataEqual(*old_data.get(), *GetPrivateData());
+
+  // A full save folds the journal into the cache file.
+  PostSaveToCacheFileTask();
+  message_loop_.Run();
+  EXPECT_TRUE(save_observer.succeeded_);
+  EXPECT_FALSE(base::PathExists(
+      URLIndexPrivateData::GetJournalFilePath(cache_path)));
+}
+
+TEST_F(InMemoryURLIndexTest, CacheJournalReplayUpdatedVisits) {
+  base::ScopedTempDir temp_directory;
+  ASSERT_TRUE(temp_directory.CreateUniqueTempDir());
+  set_history_dir(temp_directory.path());
+
+  CacheFileSaverObserver save_observer(&message_loop_);
+  url_index_->set_save_cache_observer(&save_observer);
+  PostSaveToCacheFileTask();
+  message_loop_.Run();
+  EXPECT_TRUE(save_observer.succeeded_);
+
+  // Visit a URL the saved cache knows nothing about. Its visits are fetched
+  // from the history database after the row itself has been journaled.
+  EXPECT_TRUE(url_index_->HistoryItemsForTerms(
+      ASCIIToUTF16("brokeandalone"), string16::npos).empty());
+  URLRow new_row(GURL("http://www.brokeandaloneinmanitoba.com/"));
+  new_row.set_last_visit(base::Time::Now());
+  new_row.set_typed_count(1);
+  new_row.set_visit_count(1);
+  URLID new_row_id = history_database_->AddURL(new_row);
+  ASSERT_NE(0, new_row_id);
+  new_row.set_id(new_row_id);
+  VisitRow visit(new_row_id, new_row.last_visit(), 0,
+                 content::PAGE_TRANSITION_TYPED, 0);
+  ASSERT_NE(0, history_database_->AddVisit(&visit, SOURCE_BROWSED));
+
+  URLVisitedDetails visited_details;
+  visited_details.transition = content::PAGE_TRANSITION_TYPED;
+  visited_details.row = new_row;
+  Observe(chrome::NOTIFICATION_HISTORY_URL_VISITED,
+          content::Source<InMemoryURLIndexTest>(this),
+          content::Details<history::HistoryDetails>(&visited_details));
+  profile_.BlockUntilHistoryProcessesPendingRequests();
+
+  ScoredHistoryMatches matches = url_index_->HistoryItemsForTerms(
+      ASCIIToUTF16("brokeandalone"), string16::npos);
+  ASSERT_EQ(1U, matches.size());
+  const int raw_score = matches[0].raw_score;
+  EXPECT_GT(raw_score, 0);
+  PostFlushJournalTask();
+  message_loop_.RunUntilIdle();
+  scoped_refptr<URLIndexPrivateData> old_data(GetPrivateData()->Duplicate());
+
+  // After a restart the row must still score on its visits.
+  ClearPrivateData();
+  HistoryIndexRestoreObserver restore_observer(
+      base::Bind(&base::MessageLoop::Quit, base::Unretained(&message_loop_)));
+  url_index_->set_restore_cache_observer(&restore_observer);
+  PostRestoreFromCacheFileTask();
+  message_loop_.Run();
+  EXPECT_TRUE(restore_observer.succeeded());
+
+  EXPECT_GT(GetPrivateData()->restored_journal_size(), 0);
+  matches = url_index_->HistoryItemsForTerms(ASCIIToUTF16("brokeandalone"),
+                                             string16::npos);
+  ASSERT_EQ(1U, matches.size());
+  EXPECT_EQ(raw_score, matches[0].raw_score);
+  ExpectPrivateDataEqual(*old_data.get(), *GetPrivateData());
+}
+
+TEST_F(InMemoryURLIndexTest, ShutDownWithSaveQueued) {
+  base::ScopedTempDir temp_directory;
+  ASSERT_TRUE(temp_directory.CreateUniqueTempDir());
+  set_history_dir(temp_directory.path());
+
+  CacheFileSaverObserver save_observer(&message_loop_);
+  url_index_->set_save_cache_observer(&save_observer);
+  PostSaveToCacheFileTask();
+  message_loop_.Run();
+  EXPECT_TRUE(save_observer.succeeded_);
+
+  // Queue another save, then delete a row and shut down before it has run.
+  url_index_->set_save_cache_observer(NULL);
+  PostSaveToCacheFileTask();
+  ScoredHistoryMatches matches = url_index_->HistoryItemsForTerms(
+      ASCIIToUTF16("DrudgeReport"), string16::npos);
+  ASSERT_EQ(1U, matches.size());
+  URLsDeletedDetails deleted_details;
+  deleted_details.all_history = false;
+  deleted_details.rows.push_back(matches[0].url_info);
+  Observe(chrome::NOTIFICATION_HISTORY_URLS_DELETED,
+          content::Source<InMemoryURLIndexTest>(this),
+          content::Details<history::HistoryDetails>(&deleted_details));
+  url_index_->ShutDown();
+  message_loop_.RunUntilIdle();
+
+  // The queued save must not have discarded the deletion.
+  base::FilePath cache_path;
+  ASSERT_TRUE(GetCacheFilePath(&cache_path));
+  scoped_refptr<URLIndexPrivateData> restored_data(
+      URLIndexPrivateData::RestoreFromFile(cache_path, url_index_->languages_,
+                                           scheme_whitelist()));
+  ASSERT_TRUE(restored_data.get());
+  EXPECT_TRUE(restored_data->HistoryItemsForTerms(
+      ASCIIToUTF16("DrudgeReport"), string16::npos, url_index_->languages_,
+      NULL).empty());
+  ExpectPrivateDataEqual(*GetPrivateData(), *restored_data.get());
+}
+
 TEST_F(InMemoryURLIndexTest, RebuildFromHistoryIfCacheOld) {
   base::ScopedTempDir temp_directory;
   ASSERT_TRUE(temp_directory.CreateUniqueTempDir());
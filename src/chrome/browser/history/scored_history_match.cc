@@ -33,10 +33,7 @@ int ScoredHistoryMatch::max_assigned_score_for_non_inlineable_matches = -1;
 ScoredHistoryMatch::ScoredHistoryMatch()
     : raw_score(0),
       can_inline(false) {
-  if (!initialized_) {
-    InitializeAlsoDoHUPLikeScoringFieldAndMaxScoreField();
-    initialized_ = true;
-  }
+  Init();
 }
 
 ScoredHistoryMatch::ScoredHistoryMatch(const URLRow& row,
@@ -50,10 +47,7 @@ ScoredHistoryMatch::ScoredHistoryMatch(const URLRow& row,
     : HistoryMatch(row, 0, false, false),
       raw_score(0),
       can_inline(false) {
-  if (!initialized_) {
-    InitializeAlsoDoHUPLikeScoringFieldAndMaxScoreField();
-    initialized_ = true;
-  }
+  Init();
 
   GURL gurl = row.url();
   if (!gurl.is_valid())
@@ -204,6 +198,28 @@ ScoredHistoryMatch::ScoredHistoryMatch(const URLRow& row,
 
 ScoredHistoryMatch::~ScoredHistoryMatch() {}
 
+// static
+void ScoredHistoryMatch::Init() {
+  if (initialized_)
+    return;
+  // Because the below is not thread safe, we check that we're only
+  // initializing from one thread: the UI thread.  Specifically, we check
+  // "if we've heard of the UI thread then we'd better be on it."  The first
+  // part is necessary so unit tests pass.  (Many unit tests don't set up the
+  // threading naming system; hence CurrentlyOn(UI thread) will fail.)  Once
+  // initialized, the statics are only read, so matches may then be scored
+  // on any thread.
+  DCHECK(
+      !content::BrowserThread::IsWellKnownThread(content::BrowserThread::UI) ||
+      content::BrowserThread::CurrentlyOn(content::BrowserThread::UI));
+  InitializeAlsoDoHUPLikeScoringFieldAndMaxScoreField();
+  raw_term_score_to_topicality_score = new float[kMaxRawTermScore];
+  FillInTermScoreToTopicalityScoreArray();
+  days_ago_to_recency_score = new float[kDaysToPrecomputeRecencyScoresFor];
+  FillInDaysAgoToRecencyScoreArray();
+  initialized_ = true;
+}
+
 // Comparison function for sorting ScoredMatches by their scores with
 // intelligent tie-breaking.
 bool ScoredHistoryMatch::MatchScoreGreater(const ScoredHistoryMatch& m1,
@@ -250,19 +266,7 @@ float ScoredHistoryMatch::GetTopicalityScore(
     const TermMatches& url_matches,
     const TermMatches& title_matches,
     const RowWordStarts& word_starts) {
-  // Because the below thread is not thread safe, we check that we're
-  // only calling it from one thread: the UI thread.  Specifically,
-  // we check "if we've heard of the UI thread then we'd better
-  // be on it."  The first part is necessary so unit tests pass.  (Many
-  // unit tests don't set up the threading naming system; hence
-  // CurrentlyOn(UI thread) will fail.)
-  DCHECK(
-      !content::BrowserThread::IsWellKnownThread(content::BrowserThread::UI) ||
-      content::BrowserThread::CurrentlyOn(content::BrowserThread::UI));
-  if (raw_term_score_to_topicality_score == NULL) {
-    raw_term_score_to_topicality_score = new float[kMaxRawTermScore];
-    FillInTermScoreToTopicalityScoreArray();
-  }
+  Init();
   // A vector that accumulates per-term scores.  The strongest match--a
   // match in the hostname at a word boundary--is worth 10 points.
   // Everything else is less.  In general, a match that's not at a word
@@ -394,19 +398,7 @@ float* ScoredHistoryMatch::days_ago_to_recency_score = NULL;
 
 // static
 float ScoredHistoryMatch::GetRecencyScore(int last_visit_days_ago) {
-  // Because the below thread is not thread safe, we check that we're
-  // only calling it from one thread: the UI thread.  Specifically,
-  // we check "if we've heard of the UI thread then we'd better
-  // be on it."  The first part is necessary so unit tests pass.  (Many
-  // unit tests don't set up the threading naming system; hence
-  // CurrentlyOn(UI thread) will fail.)
-  DCHECK(
-      !content::BrowserThread::IsWellKnownThread(content::BrowserThread::UI) ||
-      content::BrowserThread::CurrentlyOn(content::BrowserThread::UI));
-  if (days_ago_to_recency_score == NULL) {
-    days_ago_to_recency_score = new float[kDaysToPrecomputeRecencyScoresFor];
-    FillInDaysAgoToRecencyScoreArray();
-  }
+  Init();
   // Lookup the score in days_ago_to_recency_score, treating
   // everything older than what we've precomputed as the oldest thing
   // we've precomputed.  The std::max is to protect against corruption
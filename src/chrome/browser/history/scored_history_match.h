@@ -43,6 +43,11 @@ struct ScoredHistoryMatch : public history::HistoryMatch {
                      BookmarkService* bookmark_service);
   ~ScoredHistoryMatch();
 
+  // Initializes the static scoring tables and field trial state below if
+  // that hasn't been done yet. This is done lazily on first use, but must be
+  // done on the UI thread before matches are scored on any other thread.
+  static void Init();
+
   // Compares two matches by score.  Functor supporting URLIndexPrivateData's
   // HistoryItemsForTerms function.  Looks at particular fields within
   // with url_info to make tie-breaking a bit smarter.
@@ -104,8 +109,8 @@ struct ScoredHistoryMatch : public history::HistoryMatch {
   // |days_ago_to_recency_score| is a simple array mapping how long
   // ago a page was visited (in days) to the recency score we should
   // assign it.  This allows easy lookups of scores without requiring
-  // math.  This is initialized upon first use of GetRecencyScore(),
-  // which calls FillInDaysAgoToRecencyScoreArray(),
+  // math.  This is initialized by Init(), which calls
+  // FillInDaysAgoToRecencyScoreArray().
   static const int kDaysToPrecomputeRecencyScoresFor = 366;
   static float* days_ago_to_recency_score;
 
@@ -115,8 +120,8 @@ struct ScoredHistoryMatch : public history::HistoryMatch {
   // hits for the term, weighted by how important the hit is:
   // hostname, path, etc.) to the topicality score we should assign
   // it.  This allows easy lookups of scores without requiring math.
-  // This is initialized upon first use of GetTopicalityScore(),
-  // which calls FillInTermScoreToTopicalityScoreArray().
+  // This is initialized by Init(), which calls
+  // FillInTermScoreToTopicalityScoreArray().
   static const int kMaxRawTermScore = 30;
   static float* raw_term_score_to_topicality_score;
 
@@ -0,0 +1,177 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CHROME_BROWSER_HISTORY_SORTED_ID_SET_H_
+#define CHROME_BROWSER_HISTORY_SORTED_ID_SET_H_
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "base/logging.h"
+
+namespace history {
+
+// A set of integral IDs stored as a sorted, duplicate-free vector. It supports
+// the subset of the std::set interface used by the InMemoryURLIndex, but
+// stores each element in sizeof(T) bytes instead of a tree node, and keeps
+// elements contiguous so that intersections stream through memory.
+//
+// Lookups are O(log n). Inserting an element larger than all current elements
+// is amortized O(1), which is the common case when indexing history rows in
+// ID order; other insertions and erasures are O(n). Only const iteration is
+// offered so that callers can't break the ordering invariant.
+template <typename T>
+class SortedIDSet {
+ public:
+  typedef T key_type;
+  typedef T value_type;
+  typedef typename std::vector<T>::const_iterator iterator;
+  typedef typename std::vector<T>::const_iterator const_iterator;
+  typedef typename std::vector<T>::size_type size_type;
+
+  SortedIDSet() {}
+
+  const_iterator begin() const { return values_.begin(); }
+  const_iterator end() const { return values_.end(); }
+  bool empty() const { return values_.empty(); }
+  size_type size() const { return values_.size(); }
+  void clear() { values_.clear(); }
+  void swap(SortedIDSet& other) { values_.swap(other.values_); }
+
+  // Number of bytes of heap storage in use, for memory accounting.
+  size_t EstimateMemoryUsage() const { return values_.capacity() * sizeof(T); }
+
+  const_iterator find(const T& value) const {
+    const_iterator it = std::lower_bound(begin(), end(), value);
+    return (it != end() && *it == value) ? it : end();
+  }
+
+  size_type count(const T& value) const { return find(value) != end(); }
+
+  std::pair<iterator, bool> insert(const T& value) {
+    if (values_.empty() || values_.back() < value) {
+      values_.push_back(value);
+      return std::make_pair(values_.end() - 1, true);
+    }
+    typename std::vector<T>::iterator it =
+        std::lower_bound(values_.begin(), values_.end(), value);
+    if (*it == value)
+      return std::make_pair(iterator(it), false);
+    return std::make_pair(iterator(values_.insert(it, value)), true);
+  }
+
+  // The hint is ignored; this overload exists so that std::inserter can be
+  // used with the <algorithm> set operations.
+  iterator insert(iterator /* hint */, const T& value) {
+    return insert(value).first;
+  }
+
+  template <typename InputIterator>
+  void insert(InputIterator first, InputIterator last) {
+    size_type old_size = values_.size();
+    values_.insert(values_.end(), first, last);
+    typename std::vector<T>::iterator middle = values_.begin() + old_size;
+    std::sort(middle, values_.end());
+    std::inplace_merge(values_.begin(), middle, values_.end());
+    values_.erase(std::unique(values_.begin(), values_.end()), values_.end());
+  }
+
+  size_type erase(const T& value) {
+    typename std::vector<T>::iterator it =
+        std::lower_bound(values_.begin(), values_.end(), value);
+    if (it == values_.end() || *it != value)
+      return 0;
+    values_.erase(it);
+    return 1;
+  }
+
+  // Replaces the contents with |values|, which must already be sorted and
+  // free of duplicates. |values| is left empty.
+  void SwapSortedValues(std::vector<T>* values) {
+    DCHECK(IsSortedAndUnique(*values));
+    values_.swap(*values);
+    values->clear();
+  }
+
+  bool operator==(const SortedIDSet& other) const {
+    return values_ == other.values_;
+  }
+  bool operator!=(const SortedIDSet& other) const {
+    return values_ != other.values_;
+  }
+
+ private:
+  static bool IsSortedAndUnique(const std::vector<T>& values) {
+    for (size_t i = 1; i < values.size(); ++i) {
+      if (!(values[i - 1] < values[i]))
+        return false;
+    }
+    return true;
+  }
+
+  std::vector<T> values_;
+};
+
+// Returns the intersection of |a| and |b|. When one set is much smaller than
+// the other, each of its elements is located in the larger set with a
+// galloping (exponential then binary) search instead of a linear merge, so
+// the cost is O(small * log(large / small)).
+template <typename T>
+SortedIDSet<T> IntersectSortedIDSets(const SortedIDSet<T>& a,
+                                     const SortedIDSet<T>& b) {
+  const SortedIDSet<T>& small = a.size() <= b.size() ? a : b;
+  const SortedIDSet<T>& large = a.size() <= b.size() ? b : a;
+  std::vector<T> result;
+  if (small.empty())
+    return SortedIDSet<T>();
+  result.reserve(small.size());
+
+  // Below this size ratio a straight merge touches fewer cache lines than
+  // repeated searches.
+  const size_t kGallopRatio = 16;
+  typename SortedIDSet<T>::const_iterator s = small.begin();
+  typename SortedIDSet<T>::const_iterator l = large.begin();
+  if (large.size() / small.size() < kGallopRatio) {
+    while (s != small.end() && l != large.end()) {
+      if (*s < *l) {
+        ++s;
+      } else if (*l < *s) {
+        ++l;
+      } else {
+        result.push_back(*s);
+        ++s;
+        ++l;
+      }
+    }
+  } else {
+    for (; s != small.end(); ++s) {
+      // Gallop forward until |high| is at or past *s. Everything before
+      // |low| is known to be less than *s.
+      typename SortedIDSet<T>::const_iterator low = l;
+      typename SortedIDSet<T>::const_iterator high = l;
+      size_t step = 1;
+      while (high != large.end() && *high < *s) {
+        low = high + 1;
+        high += std::min<size_t>(step, large.end() - high);
+        step *= 2;
+      }
+      l = std::lower_bound(low, high, *s);
+      if (l == large.end())
+        break;
+      if (*l == *s) {
+        result.push_back(*s);
+        ++l;
+      }
+    }
+  }
+
+  SortedIDSet<T> intersection;
+  intersection.SwapSortedValues(&result);
+  return intersection;
+}
+
+}  // namespace history
+
+#endif  // CHROME_BROWSER_HISTORY_SORTED_ID_SET_H_
@@ -0,0 +1,85 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/browser/history/sorted_id_set.h"
+
+#include <algorithm>
+#include <iterator>
+#include <set>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace history {
+
+typedef SortedIDSet<int> IntSet;
+
+TEST(SortedIDSetTest, InsertFindErase) {
+  IntSet set;
+  EXPECT_TRUE(set.insert(5).second);
+  EXPECT_TRUE(set.insert(1).second);
+  EXPECT_TRUE(set.insert(9).second);
+  EXPECT_FALSE(set.insert(5).second);
+  ASSERT_EQ(3u, set.size());
+
+  const int kExpected[] = { 1, 5, 9 };
+  EXPECT_TRUE(std::equal(set.begin(), set.end(), kExpected));
+  EXPECT_EQ(1u, set.count(5));
+  EXPECT_EQ(0u, set.count(4));
+  EXPECT_TRUE(set.find(4) == set.end());
+
+  EXPECT_EQ(1u, set.erase(5));
+  EXPECT_EQ(0u, set.erase(5));
+  EXPECT_EQ(2u, set.size());
+}
+
+TEST(SortedIDSetTest, RangeInsertMergesAndDeduplicates) {
+  IntSet set;
+  set.insert(3);
+  set.insert(7);
+  const int kValues[] = { 8, 3, 1, 7, 1 };
+  set.insert(kValues, kValues + arraysize(kValues));
+  const int kExpected[] = { 1, 3, 7, 8 };
+  ASSERT_EQ(arraysize(kExpected), set.size());
+  EXPECT_TRUE(std::equal(set.begin(), set.end(), kExpected));
+}
+
+TEST(SortedIDSetTest, WorksWithStdInserter) {
+  std::set<int> a;
+  std::set<int> b;
+  for (int i = 0; i < 100; ++i) {
+    a.insert(i * 2);
+    b.insert(i * 3);
+  }
+  IntSet result;
+  std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                        std::inserter(result, result.begin()));
+  EXPECT_EQ(34u, result.size());
+  EXPECT_EQ(0, *result.begin());
+}
+
+TEST(SortedIDSetTest, Intersect) {
+  // Exercise both the merge and the galloping paths.
+  const size_t kLargeSizes[] = { 10, 1000 };
+  for (size_t s = 0; s < arraysize(kLargeSizes); ++s) {
+    IntSet small;
+    IntSet large;
+    std::set<int> expected;
+    for (int i = 0; i < 10; ++i)
+      small.insert(i * 37);
+    for (size_t i = 0; i < kLargeSizes[s]; ++i)
+      large.insert(static_cast<int>(i * 5));
+    std::set_intersection(small.begin(), small.end(),
+                          large.begin(), large.end(),
+                          std::inserter(expected, expected.begin()));
+
+    IntSet result = IntersectSortedIDSets(small, large);
+    ASSERT_EQ(expected.size(), result.size());
+    EXPECT_TRUE(std::equal(result.begin(), result.end(), expected.begin()));
+    EXPECT_TRUE(result == IntersectSortedIDSets(large, small));
+  }
+
+  EXPECT_TRUE(IntersectSortedIDSets(IntSet(), IntSet()).empty());
+}
+
+}  // namespace history
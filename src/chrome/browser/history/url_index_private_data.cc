@@ -12,12 +12,18 @@
 #include <string>
 #include <vector>
 
+#include "base/atomicops.h"
 #include "base/basictypes.h"
+#include "base/bind.h"
 #include "base/file_util.h"
+#include "base/files/memory_mapped_file.h"
 #include "base/i18n/case_conversion.h"
 #include "base/metrics/histogram.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/sys_info.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/worker_pool.h"
 #include "base/time/time.h"
 #include "chrome/browser/autocomplete/autocomplete_provider.h"
 #include "chrome/browser/autocomplete/url_prefix.h"
@@ -41,9 +47,30 @@
 using google::protobuf::RepeatedField;
 using google::protobuf::RepeatedPtrField;
 using in_memory_url_index::InMemoryURLIndexCacheItem;
+using in_memory_url_index::InMemoryURLIndexJournalEntry;
 
 namespace {
 static const size_t kMaxVisitsToStoreInCache = 10u;
+
+// Candidate sets are scored in chunks of this many history items. Chunks are
+// small so that the thread which asked for the scores never spins long for
+// a helper to finish the last one.
+const size_t kScoringChunkSize = 50;
+
+// The maximum number of worker pool tasks which help score one candidate
+// set, in addition to the calling thread.
+const size_t kMaxScoringHelpers = 3;
+
+// Serializes |entry| onto the end of |journal|, preceded by its size.
+void AppendJournalEntry(const InMemoryURLIndexJournalEntry& entry,
+                        std::string* journal) {
+  std::string data;
+  if (!entry.SerializeToString(&data))
+    return;
+  uint32 size = static_cast<uint32>(data.size());
+  journal->append(reinterpret_cast<const char*>(&size), sizeof(size));
+  journal->append(data);
+}
 }  // anonymous namespace
 
 namespace history {
@@ -143,11 +170,16 @@ UpdateRecentVisitsFromHistoryDBTask::~UpdateRecentVisitsFromHistoryDBTask() {
 // URLIndexPrivateData ---------------------------------------------------------
 
 URLIndexPrivateData::URLIndexPrivateData()
-    : restored_cache_version_(0),
+    : journal_(NULL),
+      restored_cache_version_(0),
+      restored_journal_size_(0),
       saved_cache_version_(kCurrentCacheFileVersion),
       pre_filter_item_count_(0),
       post_filter_item_count_(0),
-      post_scoring_item_count_(0) {
+      post_scoring_item_count_(0),
+      max_scoring_helpers_(std::min<size_t>(
+          kMaxScoringHelpers,
+          std::max(base::SysInfo::NumberOfProcessors() - 1, 0))) {
 }
 
 ScoredHistoryMatches URLIndexPrivateData::HistoryItemsForTerms(
@@ -204,10 +236,8 @@ ScoredHistoryMatches URLIndexPrivateData::HistoryItemsForTerms(
   // time as the user's ultimately desired result could easily be eliminated
   // in this early rough filter.
   bool was_trimmed = (pre_filter_item_count_ > kItemsToScoreLimit);
+  HistoryIDVector history_ids(history_id_set.begin(), history_id_set.end());
   if (was_trimmed) {
-    HistoryIDVector history_ids;
-    std::copy(history_id_set.begin(), history_id_set.end(),
-              std::back_inserter(history_ids));
     // Trim down the set by sorting by typed-count, visit-count, and last
     // visit.
     HistoryItemFactorGreater
@@ -216,10 +246,8 @@ ScoredHistoryMatches URLIndexPrivateData::HistoryItemsForTerms(
                       history_ids.begin() + kItemsToScoreLimit,
                       history_ids.end(),
                       item_factor_functor);
-    history_id_set.clear();
-    std::copy(history_ids.begin(), history_ids.begin() + kItemsToScoreLimit,
-              std::inserter(history_id_set, history_id_set.end()));
-    post_filter_item_count_ = history_id_set.size();
+    history_ids.resize(kItemsToScoreLimit);
+    post_filter_item_count_ = history_ids.size();
   }
 
   // Pass over all of the candidates filtering out any without a proper
@@ -244,9 +272,8 @@ ScoredHistoryMatches URLIndexPrivateData::HistoryItemsForTerms(
     // but this is such a rare edge case that it's not worth the time.
     return scored_items;
   }
-  scored_items = std::for_each(history_id_set.begin(), history_id_set.end(),
-      AddHistoryMatch(*this, languages, bookmark_service, lower_raw_string,
-                      lower_raw_terms, base::Time::Now())).ScoredMatches();
+  scored_items = ScoreHistoryItems(history_ids, languages, bookmark_service,
+                                   lower_raw_string, lower_raw_terms);
 
   // Select and sort only the top kMaxMatches results.
   if (scored_items.size() > AutocompleteProvider::kMaxMatches) {
@@ -350,6 +377,11 @@ void URLIndexPrivateData::UpdateRecentVisits(
       visits->push_back(std::make_pair(recent_visits[i].visit_time,
                                        recent_visits[i].transition));
     }
+    // The visits usually arrive after the row's update has been journaled,
+    // so record them as well or a restored index would score the row on
+    // stale visits.
+    if (journal_)
+      AppendUpdateToJournal(row_pos->second.url_row, journal_);
   }
   // Else: Oddly, the URL doesn't seem to exist in the private index.
   // Ignore this update.  This can happen if, for instance, the user
@@ -394,19 +426,22 @@ bool URLIndexPrivateData::DeleteURL(const GURL& url) {
 // static
 scoped_refptr<URLIndexPrivateData> URLIndexPrivateData::RestoreFromFile(
     const base::FilePath& file_path,
-    const std::string& languages) {
+    const std::string& languages,
+    const std::set<std::string>& scheme_whitelist) {
   base::TimeTicks beginning_time = base::TimeTicks::Now();
   if (!base::PathExists(file_path))
     return NULL;
-  std::string data;
-  // If there is no cache file then simply give up. This will cause us to
-  // attempt to rebuild from the history database.
-  if (!file_util::ReadFileToString(file_path, &data))
+  // Parse straight out of a mapping of the file rather than first copying
+  // the whole cache into a string. If there is no cache file then simply
+  // give up. This will cause us to attempt to rebuild from the history
+  // database.
+  base::MemoryMappedFile cache_file;
+  if (!cache_file.Initialize(file_path))
     return NULL;
 
   scoped_refptr<URLIndexPrivateData> restored_data(new URLIndexPrivateData);
   InMemoryURLIndexCacheItem index_cache;
-  if (!index_cache.ParseFromArray(data.c_str(), data.size())) {
+  if (!index_cache.ParseFromArray(cache_file.data(), cache_file.length())) {
     LOG(WARNING) << "Failed to parse URLIndexPrivateData cache data read from "
                  << file_path.value();
     return restored_data;
@@ -417,9 +452,18 @@ scoped_refptr<URLIndexPrivateData> URLIndexPrivateData::RestoreFromFile(
 
   UMA_HISTOGRAM_TIMES("History.InMemoryURLIndexRestoreCacheTime",
                       base::TimeTicks::Now() - beginning_time);
+
+  base::TimeTicks journal_beginning_time = base::TimeTicks::Now();
+  restored_data->ReplayJournal(GetJournalFilePath(file_path), languages,
+                               scheme_whitelist);
+  UMA_HISTOGRAM_TIMES("History.InMemoryURLIndexReplayJournalTime",
+                      base::TimeTicks::Now() - journal_beginning_time);
+  UMA_HISTOGRAM_COUNTS("History.InMemoryURLJournalSize",
+                       restored_data->restored_journal_size_);
+
   UMA_HISTOGRAM_COUNTS("History.InMemoryURLHistoryItems",
                        restored_data->history_id_word_map_.size());
-  UMA_HISTOGRAM_COUNTS("History.InMemoryURLCacheSize", data.size());
+  UMA_HISTOGRAM_COUNTS("History.InMemoryURLCacheSize", cache_file.length());
   UMA_HISTOGRAM_COUNTS_10000("History.InMemoryURLWords",
                              restored_data->word_map_.size());
   UMA_HISTOGRAM_COUNTS_10000("History.InMemoryURLChars",
@@ -429,6 +473,78 @@ scoped_refptr<URLIndexPrivateData> URLIndexPrivateData::RestoreFromFile(
   return restored_data;
 }
 
+// static
+base::FilePath URLIndexPrivateData::GetJournalFilePath(
+    const base::FilePath& cache_path) {
+  return cache_path.AddExtension(FILE_PATH_LITERAL("journal"));
+}
+
+void URLIndexPrivateData::AppendUpdateToJournal(const URLRow& row,
+                                                std::string* journal) const {
+  InMemoryURLIndexJournalEntry entry;
+  entry.set_type(InMemoryURLIndexJournalEntry::UPDATE_ROW);
+  HistoryInfoMapEntry* row_entry = entry.mutable_row();
+  row_entry->set_history_id(row.id());
+  row_entry->set_visit_count(row.visit_count());
+  row_entry->set_typed_count(row.typed_count());
+  row_entry->set_last_visit(row.last_visit().ToInternalValue());
+  row_entry->set_url(row.url().spec());
+  row_entry->set_title(UTF16ToUTF8(row.title()));
+  HistoryInfoMap::const_iterator pos =
+      history_info_map_.find(static_cast<HistoryID>(row.id()));
+  if (pos != history_info_map_.end()) {
+    const VisitInfoVector& visits(pos->second.visits);
+    for (VisitInfoVector::const_iterator visit_iter = visits.begin();
+         visit_iter != visits.end(); ++visit_iter) {
+      HistoryInfoMapEntry_VisitInfo* visit_info = row_entry->add_visits();
+      visit_info->set_visit_time(visit_iter->first.ToInternalValue());
+      visit_info->set_transition_type(visit_iter->second);
+    }
+  }
+  AppendJournalEntry(entry, journal);
+}
+
+// static
+void URLIndexPrivateData::AppendDeleteToJournal(const GURL& url,
+                                                std::string* journal) {
+  InMemoryURLIndexJournalEntry entry;
+  entry.set_type(InMemoryURLIndexJournalEntry::DELETE_ROW);
+  HistoryInfoMapEntry* row_entry = entry.mutable_row();
+  // Only the URL is meaningful; the remaining fields are required.
+  row_entry->set_history_id(0);
+  row_entry->set_visit_count(0);
+  row_entry->set_typed_count(0);
+  row_entry->set_last_visit(0);
+  row_entry->set_url(url.spec());
+  AppendJournalEntry(entry, journal);
+}
+
+// static
+void URLIndexPrivateData::AppendClearToJournal(std::string* journal) {
+  InMemoryURLIndexJournalEntry entry;
+  entry.set_type(InMemoryURLIndexJournalEntry::CLEAR_ALL);
+  AppendJournalEntry(entry, journal);
+}
+
+// static
+bool URLIndexPrivateData::AppendToJournalFileTask(
+    const base::FilePath& cache_path,
+    const std::string& journal) {
+  DCHECK(!cache_path.empty());
+  if (journal.empty())
+    return true;
+  base::FilePath journal_path = GetJournalFilePath(cache_path);
+  int size = journal.size();
+  int written = base::PathExists(journal_path) ?
+      file_util::AppendToFile(journal_path, journal.data(), size) :
+      file_util::WriteFile(journal_path, journal.data(), size);
+  if (written != size) {
+    LOG(WARNING) << "Failed to append to " << journal_path.value();
+    return false;
+  }
+  return true;
+}
+
 // static
 scoped_refptr<URLIndexPrivateData> URLIndexPrivateData::RebuildFromHistory(
     HistoryDatabase* history_db,
@@ -487,6 +603,7 @@ scoped_refptr<URLIndexPrivateData> URLIndexPrivateData::Duplicate() const {
   data_copy->word_starts_map_ = word_starts_map_;
   return data_copy;
   // Not copied:
+  //    journal_
   //    search_term_cache_
   //    pre_filter_item_count_
   //    post_filter_item_count_
@@ -535,11 +652,8 @@ HistoryIDSet URLIndexPrivateData::HistoryIDSetFromWords(
     if (iter == words.begin()) {
       history_id_set.swap(term_history_set);
     } else {
-      HistoryIDSet new_history_id_set;
-      std::set_intersection(history_id_set.begin(), history_id_set.end(),
-                            term_history_set.begin(), term_history_set.end(),
-                            std::inserter(new_history_id_set,
-                                          new_history_id_set.begin()));
+      HistoryIDSet new_history_id_set =
+          IntersectSortedIDSets(history_id_set, term_history_set);
       history_id_set.swap(new_history_id_set);
     }
   }
@@ -612,42 +726,47 @@ HistoryIDSet URLIndexPrivateData::HistoryIDsForTerm(
       if (prefix_chars.empty()) {
         word_id_set.swap(leftover_set);
       } else {
-        WordIDSet new_word_id_set;
-        std::set_intersection(word_id_set.begin(), word_id_set.end(),
-                              leftover_set.begin(), leftover_set.end(),
-                              std::inserter(new_word_id_set,
-                                            new_word_id_set.begin()));
+        WordIDSet new_word_id_set =
+            IntersectSortedIDSets(word_id_set, leftover_set);
         word_id_set.swap(new_word_id_set);
       }
     }
 
     // We must filter the word list because the resulting word set surely
     // contains words which do not have the search term as a proper subset.
-    for (WordIDSet::iterator word_set_iter = word_id_set.begin();
-         word_set_iter != word_id_set.end(); ) {
-      if (word_list_[*word_set_iter].find(term) == string16::npos)
-        word_id_set.erase(word_set_iter++);
-      else
-        ++word_set_iter;
+    std::vector<WordID> matching_word_ids;
+    matching_word_ids.reserve(word_id_set.size());
+    for (WordIDSet::const_iterator word_set_iter = word_id_set.begin();
+         word_set_iter != word_id_set.end(); ++word_set_iter) {
+      if (word_list_[*word_set_iter].find(term) != string16::npos)
+        matching_word_ids.push_back(*word_set_iter);
     }
+    word_id_set.SwapSortedValues(&matching_word_ids);
   } else {
     word_id_set = WordIDSetForTermChars(Char16SetFromString16(term));
   }
 
   // If any words resulted then we can compose a set of history IDs by unioning
   // the sets from each word.
+  // Concatenating the posting lists and sorting once is far cheaper than
+  // merging them into the result one at a time.
   HistoryIDSet history_id_set;
   if (!word_id_set.empty()) {
-    for (WordIDSet::iterator word_id_iter = word_id_set.begin();
+    HistoryIDVector history_ids;
+    for (WordIDSet::const_iterator word_id_iter = word_id_set.begin();
          word_id_iter != word_id_set.end(); ++word_id_iter) {
       WordID word_id = *word_id_iter;
       WordIDHistoryMap::iterator word_iter = word_id_history_map_.find(word_id);
       if (word_iter != word_id_history_map_.end()) {
         HistoryIDSet& word_history_id_set(word_iter->second);
-        history_id_set.insert(word_history_id_set.begin(),
-                              word_history_id_set.end());
+        history_ids.insert(history_ids.end(), word_history_id_set.begin(),
+                           word_history_id_set.end());
       }
     }
+    std::sort(history_ids.begin(), history_ids.end());
+    history_ids.erase(std::unique(history_ids.begin(), history_ids.end()),
+                      history_ids.end());
+    history_id_set.SwapSortedValues(&history_ids);
   }
 
   // Record a new cache entry for this word if the term is longer than
@@ -682,11 +801,8 @@ WordIDSet URLIndexPrivateData::WordIDSetForTermChars(
       word_id_set = char_word_id_set;
     } else {
       // Subsequent character results get intersected in.
-      WordIDSet new_word_id_set;
-      std::set_intersection(word_id_set.begin(), word_id_set.end(),
-                            char_word_id_set.begin(), char_word_id_set.end(),
-                            std::inserter(new_word_id_set,
-                                          new_word_id_set.begin()));
+      WordIDSet new_word_id_set =
+          IntersectSortedIDSets(word_id_set, char_word_id_set);
       word_id_set.swap(new_word_id_set);
     }
   }
@@ -742,10 +858,11 @@ bool URLIndexPrivateData::IndexRow(
                                               kMaxVisitsToStoreInCache,
                                               &recent_visits))
       UpdateRecentVisits(row_id, recent_visits);
-  } else {
-    DCHECK(history_service);
+  } else if (history_service) {
     ScheduleUpdateRecentVisits(history_service, row_id);
   }
+  // Otherwise the row is being replayed from the cache journal, whose visits
+  // are filled in by the caller.
 
   return true;
 }
@@ -882,6 +999,24 @@ void URLIndexPrivateData::RemoveRowWordsFromIndex(const URLRow& row) {
   }
 }
 
+ScoredHistoryMatches URLIndexPrivateData::ScoreHistoryItems(
+    const HistoryIDVector& history_ids,
+    const std::string& languages,
+    BookmarkService* bookmark_service,
+    const string16& lower_string,
+    const String16Vector& lower_terms) {
+  base::Time now = base::Time::Now();
+  if (history_ids.size() < 2 * kScoringChunkSize || !max_scoring_helpers_) {
+    return std::for_each(history_ids.begin(), history_ids.end(),
+        AddHistoryMatch(*this, languages, bookmark_service, lower_string,
+                        lower_terms, now)).ScoredMatches();
+  }
+  scoped_refptr<ScoringJob> job(new ScoringJob(
+      *this, history_ids, languages, bookmark_service, lower_string,
+      lower_terms, now));
+  return job->Run(max_scoring_helpers_);
+}
+
 void URLIndexPrivateData::ResetSearchTermCache() {
   for (SearchTermCacheMap::iterator iter = search_term_cache_.begin();
        iter != search_term_cache_.end(); ++iter)
@@ -903,6 +1038,8 @@ bool URLIndexPrivateData::SaveToFile(const base::FilePath& file_path) {
     LOG(WARNING) << "Failed to write " << file_path.value();
     return false;
   }
+  // Everything recorded in the journal is now part of the cache file.
+  base::DeleteFile(GetJournalFilePath(file_path), false);
   UMA_HISTOGRAM_TIMES("History.InMemoryURLIndexSaveCacheTime",
                       base::TimeTicks::Now() - beginning_time);
   return true;
@@ -1247,6 +1384,87 @@ bool URLIndexPrivateData::RestoreWordStartsMap(
   return true;
 }
 
+void URLIndexPrivateData::ReplayJournal(
+    const base::FilePath& journal_path,
+    const std::string& languages,
+    const std::set<std::string>& scheme_whitelist) {
+  std::string journal;
+  if (!file_util::ReadFileToString(journal_path, &journal))
+    return;
+  restored_journal_size_ = journal.size();
+
+  size_t offset = 0;
+  while (journal.size() - offset >= sizeof(uint32)) {
+    uint32 size;
+    memcpy(&size, journal.data() + offset, sizeof(size));
+    offset += sizeof(size);
+    if (journal.size() - offset < size)
+      break;
+    InMemoryURLIndexJournalEntry entry;
+    if (!entry.ParseFromArray(journal.data() + offset, size))
+      break;
+    offset += size;
+    ReplayJournalEntry(entry, languages, scheme_whitelist);
+  }
+  if (offset != journal.size())
+    LOG(WARNING) << "Ignoring damaged tail of " << journal_path.value();
+}
+
+void URLIndexPrivateData::ReplayJournalEntry(
+    const InMemoryURLIndexJournalEntry& entry,
+    const std::string& languages,
+    const std::set<std::string>& scheme_whitelist) {
+  switch (entry.type()) {
+    case InMemoryURLIndexJournalEntry::UPDATE_ROW: {
+      if (!entry.has_row())
+        return;
+      const HistoryInfoMapEntry& row_entry(entry.row());
+      URLRow row(GURL(row_entry.url()), row_entry.history_id());
+      row.set_visit_count(row_entry.visit_count());
+      row.set_typed_count(row_entry.typed_count());
+      row.set_last_visit(base::Time::FromInternalValue(row_entry.last_visit()));
+      if (row_entry.has_title())
+        row.set_title(UTF8ToUTF16(row_entry.title()));
+
+      // Re-index the row from scratch with the visits recorded alongside
+      // it, or, for records without any, whatever visits were known for it.
+      // This makes replaying a record idempotent.
+      HistoryID history_id = static_cast<HistoryID>(row.id());
+      VisitInfoVector visits;
+      visits.reserve(row_entry.visits_size());
+      for (int i = 0; i < row_entry.visits_size(); ++i) {
+        visits.push_back(std::make_pair(
+            base::Time::FromInternalValue(row_entry.visits(i).visit_time()),
+            static_cast<content::PageTransition>(
+                row_entry.visits(i).transition_type())));
+      }
+      HistoryInfoMap::iterator pos = history_info_map_.find(history_id);
+      if (pos != history_info_map_.end()) {
+        if (visits.empty())
+          visits.swap(pos->second.visits);
+        RemoveRowFromIndex(pos->second.url_row);
+      }
+      if (RowQualifiesAsSignificant(row, base::Time()) &&
+          IndexRow(NULL, NULL, row, languages, scheme_whitelist))
+        history_info_map_[history_id].visits.swap(visits);
+      break;
+    }
+    case InMemoryURLIndexJournalEntry::DELETE_ROW:
+      if (entry.has_row())
+        DeleteURL(GURL(entry.row().url()));
+      break;
+    case InMemoryURLIndexJournalEntry::CLEAR_ALL: {
+      // Unlike Clear(), keep the rebuild time so that an old index is still
+      // rebuilt from history on schedule.
+      base::Time last_rebuilt = last_time_rebuilt_from_history_;
+      Clear();
+      last_time_rebuilt_from_history_ = last_rebuilt;
+      break;
+    }
+  }
+  search_term_cache_.clear();
+}
+
 // static
 bool URLIndexPrivateData::URLSchemeIsWhitelisted(
     const GURL& gurl,
@@ -1301,8 +1519,148 @@ void URLIndexPrivateData::AddHistoryMatch::operator()(
     ScoredHistoryMatch match(hist_item, visits, languages_, lower_string_,
                              lower_terms_, starts_pos->second, now_,
                              bookmark_service_);
-    if (match.raw_score > 0)
+    if (match.raw_score <= 0)
+      return;
+    if (scored_matches_.size() < AutocompleteProvider::kMaxMatches) {
       scored_matches_.push_back(match);
+      std::push_heap(scored_matches_.begin(), scored_matches_.end(),
+                     ScoredHistoryMatch::MatchScoreGreater);
+    } else if (ScoredHistoryMatch::MatchScoreGreater(match,
+                                                     scored_matches_.front())) {
+      // Replace the worst match kept so far.
+      std::pop_heap(scored_matches_.begin(), scored_matches_.end(),
+                    ScoredHistoryMatch::MatchScoreGreater);
+      scored_matches_.back() = match;
+      std::push_heap(scored_matches_.begin(), scored_matches_.end(),
+                     ScoredHistoryMatch::MatchScoreGreater);
+    }
+  }
+}
+
+ScoredHistoryMatches
+    URLIndexPrivateData::AddHistoryMatch::ScoredMatches() const {
+  ScoredHistoryMatches matches(scored_matches_);
+  std::sort_heap(matches.begin(), matches.end(),
+                 ScoredHistoryMatch::MatchScoreGreater);
+  return matches;
+}
+
+
+// URLIndexPrivateData::ScoringJob ---------------------------------------------
+
+// Scores a vector of candidates in chunks of kScoringChunkSize. The chunks are
+// claimed in turn by the thread calling Run() and by helper tasks on the
+// worker pool. The caller therefore never waits for a helper which hasn't
+// started running; it only waits for chunks already being scored, and if no
+// helper runs in time the caller simply scores every chunk itself.
+//
+// Helpers touch the private data, the candidates and the search terms only
+// while scoring a claimed chunk, and Run() doesn't return until every chunk
+// is done, so those may safely be referenced rather than copied. The job
+// itself is reference counted since a helper may start after Run() returns.
+class URLIndexPrivateData::ScoringJob
+    : public base::RefCountedThreadSafe<ScoringJob> {
+ public:
+  ScoringJob(const URLIndexPrivateData& private_data,
+             const HistoryIDVector& history_ids,
+             const std::string& languages,
+             BookmarkService* bookmark_service,
+             const string16& lower_string,
+             const String16Vector& lower_terms,
+             base::Time now);
+
+  // Scores all chunks with the help of up to |max_helpers| worker pool tasks
+  // and returns the best AutocompleteProvider::kMaxMatches matches of each.
+  ScoredHistoryMatches Run(size_t max_helpers);
+
+ private:
+  friend class base::RefCountedThreadSafe<ScoringJob>;
+  ~ScoringJob();
+
+  // Claims and scores chunks until there are none left.
+  void ScoreChunks();
+
+  const URLIndexPrivateData& private_data_;
+  const HistoryIDVector& history_ids_;
+  const std::string& languages_;
+  BookmarkService* bookmark_service_;
+  const string16& lower_string_;
+  const String16Vector& lower_terms_;
+  const base::Time now_;
+
+  const base::subtle::Atomic32 chunk_count_;
+  base::subtle::Atomic32 next_chunk_;
+  base::subtle::Atomic32 finished_chunks_;
+
+  // The matches kept for each chunk. Each is written only by the thread
+  // which claimed the chunk.
+  std::vector<ScoredHistoryMatches> chunk_matches_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScoringJob);
+};
+
+URLIndexPrivateData::ScoringJob::ScoringJob(
+    const URLIndexPrivateData& private_data,
+    const HistoryIDVector& history_ids,
+    const std::string& languages,
+    BookmarkService* bookmark_service,
+    const string16& lower_string,
+    const String16Vector& lower_terms,
+    base::Time now)
+    : private_data_(private_data),
+      history_ids_(history_ids),
+      languages_(languages),
+      bookmark_service_(bookmark_service),
+      lower_string_(lower_string),
+      lower_terms_(lower_terms),
+      now_(now),
+      chunk_count_(static_cast<base::subtle::Atomic32>(
+          (history_ids.size() + kScoringChunkSize - 1) / kScoringChunkSize)),
+      next_chunk_(0),
+      finished_chunks_(0),
+      chunk_matches_(chunk_count_) {
+}
+
+URLIndexPrivateData::ScoringJob::~ScoringJob() {}
+
+ScoredHistoryMatches URLIndexPrivateData::ScoringJob::Run(size_t max_helpers) {
+  // The scoring tables and URL prefix list are built on first use; make sure
+  // that has happened before another thread reads them.
+  ScoredHistoryMatch::Init();
+  URLPrefix::GetURLPrefixes();
+  size_t helpers = std::min(max_helpers, static_cast<size_t>(chunk_count_ - 1));
+  for (size_t i = 0; i < helpers; ++i) {
+    base::WorkerPool::PostTask(
+        FROM_HERE, base::Bind(&ScoringJob::ScoreChunks, this), false);
+  }
+  ScoreChunks();
+
+  // All chunks have been claimed; wait for helpers still scoring theirs.
+  // This is at most one chunk's worth of work, so spin rather than block.
+  while (base::subtle::Acquire_Load(&finished_chunks_) != chunk_count_)
+    base::PlatformThread::YieldCurrentThread();
+
+  ScoredHistoryMatches matches;
+  for (size_t i = 0; i < chunk_matches_.size(); ++i)
+    matches.insert(matches.end(), chunk_matches_[i].begin(),
+                   chunk_matches_[i].end());
+  return matches;
+}
+
+void URLIndexPrivateData::ScoringJob::ScoreChunks() {
+  for (;;) {
+    base::subtle::Atomic32 chunk =
+        base::subtle::NoBarrier_AtomicIncrement(&next_chunk_, 1) - 1;
+    if (chunk >= chunk_count_)
+      return;
+    size_t begin = chunk * kScoringChunkSize;
+    size_t end = std::min(begin + kScoringChunkSize, history_ids_.size());
+    chunk_matches_[chunk] = std::for_each(
+        history_ids_.begin() + begin, history_ids_.begin() + end,
+        AddHistoryMatch(private_data_, languages_, bookmark_service_,
+                        lower_string_, lower_terms_, now_)).ScoredMatches();
+    // Publishes |chunk_matches_[chunk]| to the thread in Run().
+    base::subtle::Barrier_AtomicIncrement(&finished_chunks_, 1);
   }
 }
 
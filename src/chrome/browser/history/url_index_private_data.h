@@ -23,6 +23,7 @@ class HistoryQuickProviderTest;
 
 namespace in_memory_url_index {
 class InMemoryURLIndexCacheItem;
+class InMemoryURLIndexJournalEntry;
 }
 
 namespace history {
@@ -87,8 +88,9 @@ class URLIndexPrivateData
                  const std::set<std::string>& scheme_whitelist);
 
   // Updates the entry for |url_id| in the index, replacing its
-  // recent visits information with |recent_visits|.  If |url_id|
-  // is not in the index, does nothing.
+  // recent visits information with |recent_visits|, and records the change
+  // in the journal set by set_journal().  If |url_id| is not in the index,
+  // does nothing.
   void UpdateRecentVisits(URLID url_id,
                           const VisitVector& recent_visits);
 
@@ -106,13 +108,34 @@ class URLIndexPrivateData
   bool DeleteURL(const GURL& url);
 
   // Constructs a new object by restoring its contents from the cache file
-  // at |path|. Returns the new URLIndexPrivateData which on success will
+  // at |path|, then replaying any changes recorded in the accompanying
+  // journal file. Returns the new URLIndexPrivateData which on success will
   // contain the restored data but upon failure will be empty.  |languages|
-  // is used to break URLs and page titles into words.  This function
-  // should be run on the the file thread.
+  // is used to break URLs and page titles into words and |scheme_whitelist|
+  // filters rows replayed from the journal.  This function should be run on
+  // the the file thread.
   static scoped_refptr<URLIndexPrivateData> RestoreFromFile(
       const base::FilePath& path,
-      const std::string& languages);
+      const std::string& languages,
+      const std::set<std::string>& scheme_whitelist);
+
+  // Returns the path of the journal accompanying the cache file at
+  // |cache_path|.
+  static base::FilePath GetJournalFilePath(const base::FilePath& cache_path);
+
+  // Append to |journal| a record of a change to the index: |row| having been
+  // updated by UpdateURL(), |url| having been deleted, or all history having
+  // been cleared. Updates carry the recent visits currently indexed for |row|
+  // so that replaying them restores its score.
+  void AppendUpdateToJournal(const URLRow& row, std::string* journal) const;
+  static void AppendDeleteToJournal(const GURL& url, std::string* journal);
+  static void AppendClearToJournal(std::string* journal);
+
+  // Appends the records in |journal| to the journal of the cache file at
+  // |cache_path| and returns success. This function should be run on the file
+  // thread.
+  static bool AppendToJournalFileTask(const base::FilePath& cache_path,
+                                      const std::string& journal);
 
   // Constructs a new object by rebuilding its contents from the history
   // database in |history_db|. Returns the new URLIndexPrivateData which on
@@ -139,6 +162,13 @@ class URLIndexPrivateData
   // Returns true if there is no data in the index.
   bool Empty() const;
 
+  // Sets the journal onto which UpdateRecentVisits() appends the refreshed
+  // visits of indexed rows. |journal| is not owned and may be NULL.
+  void set_journal(std::string* journal) { journal_ = journal; }
+
+  // Returns the size of the journal replayed by RestoreFromFile().
+  int64 restored_journal_size() const { return restored_journal_size_; }
+
   // Initializes all index data members in preparation for restoring the index
   // from the cache or a complete rebuild from the history database.
   void Clear();
@@ -148,10 +178,14 @@ class URLIndexPrivateData
   ~URLIndexPrivateData();
 
   friend class AddHistoryMatch;
+  class ScoringJob;
+  friend class ScoringJob;
   friend class ::HistoryQuickProviderTest;
   friend class InMemoryURLIndexTest;
+  friend class URLIndexPrivateDataPerfTest;
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, CacheSaveRestore);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, HugeResultSet);
+  FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, ParallelScoring);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, ReadVisitsFromHistory);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, RebuildFromHistoryIfCacheOld);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, Scoring);
@@ -192,7 +226,8 @@ class URLIndexPrivateData
   typedef std::map<string16, SearchTermCacheItem> SearchTermCacheMap;
 
   // A helper class which performs the final filter on each candidate
-  // history URL match, inserting accepted matches into |scored_matches_|.
+  // history URL match, keeping the best AutocompleteProvider::kMaxMatches
+  // accepted matches in a heap so that the rest are never sorted.
   class AddHistoryMatch : public std::unary_function<HistoryID, void> {
    public:
     AddHistoryMatch(const URLIndexPrivateData& private_data,
@@ -205,12 +240,15 @@ class URLIndexPrivateData
 
     void operator()(const HistoryID history_id);
 
-    ScoredHistoryMatches ScoredMatches() const { return scored_matches_; }
+    // Returns the kept matches, best first.
+    ScoredHistoryMatches ScoredMatches() const;
 
    private:
     const URLIndexPrivateData& private_data_;
     const std::string& languages_;
     BookmarkService* bookmark_service_;
+    // A heap ordered by ScoredHistoryMatch::MatchScoreGreater, so the front is
+    // the worst match kept.
     ScoredHistoryMatches scored_matches_;
     const string16& lower_string_;
     const String16Vector& lower_terms_;
@@ -293,10 +331,30 @@ class URLIndexPrivateData
   // Clears |used_| for each item in the search term cache.
   void ResetSearchTermCache();
 
+  // Scores the candidates in |history_ids| against |lower_terms| and returns
+  // the best AutocompleteProvider::kMaxMatches of them, not yet sorted. Large
+  // candidate sets are scored in chunks shared with the worker pool.
+  ScoredHistoryMatches ScoreHistoryItems(const HistoryIDVector& history_ids,
+                                         const std::string& languages,
+                                         BookmarkService* bookmark_service,
+                                         const string16& lower_string,
+                                         const String16Vector& lower_terms);
+
   // Caches the index private data and writes the cache file to the profile
-  // directory.  Called by WritePrivateDataToCacheFileTask.
+  // directory, then removes the journal whose changes it now contains.
+  // Called by WritePrivateDataToCacheFileTask.
   bool SaveToFile(const base::FilePath& file_path);
 
+  // Applies the records in the journal file at |journal_path|. Stops quietly
+  // at a truncated or corrupt record, which is what an interrupted append
+  // leaves behind.
+  void ReplayJournal(const base::FilePath& journal_path,
+                     const std::string& languages,
+                     const std::set<std::string>& scheme_whitelist);
+  void ReplayJournalEntry(const imui::InMemoryURLIndexJournalEntry& entry,
+                          const std::string& languages,
+                          const std::set<std::string>& scheme_whitelist);
+
   // Encode a data structure into the protobuf |cache|.
   void SavePrivateData(imui::InMemoryURLIndexCacheItem* cache) const;
   void SaveWordList(imui::InMemoryURLIndexCacheItem* cache) const;
@@ -329,6 +387,9 @@ class URLIndexPrivateData
   // Allows canceling pending requests to update recent visits information.
   CancelableRequestConsumer recent_visits_consumer_;
 
+  // The journal of the owning InMemoryURLIndex, if any. Not owned.
+  std::string* journal_;
+
   // Start of data members that are cached -------------------------------------
 
   // The version of the cache file most recently used to restore this instance
@@ -336,6 +397,9 @@ class URLIndexPrivateData
   // database this will be 0.
   int restored_cache_version_;
 
+  // The size in bytes of the journal replayed on top of the restored cache.
+  int64 restored_journal_size_;
+
   // The last time the data was rebuilt from the history database.
   base::Time last_time_rebuilt_from_history_;
 
@@ -391,6 +455,10 @@ class URLIndexPrivateData
   size_t pre_filter_item_count_;    // After word index is queried.
   size_t post_filter_item_count_;   // After trimming large result set.
   size_t post_scoring_item_count_;  // After performing final filter/scoring.
+
+  // The number of worker pool tasks which may help score a large candidate
+  // set. Zero scores everything on the calling thread.
+  size_t max_scoring_helpers_;
 };
 
 }  // namespace history
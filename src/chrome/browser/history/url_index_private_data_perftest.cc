@@ -0,0 +1,201 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/browser/history/url_index_private_data.h"
+
+#include <set>
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/format_macros.h"
+#include "base/logging.h"
+#include "base/perftimer.h"
+#include "base/rand_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
+#include "base/strings/utf_string_conversions.h"
+#include "base/time/time.h"
+#include "chrome/browser/history/history_types.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace history {
+
+namespace {
+
+const int kURLCount = 100000;
+const int kVocabularySize = 20000;
+const int kWordsPerTitle = 6;
+const char kLanguages[] = "en,ja,hi,zh";
+
+// Builds a pronounceable pseudo-word so that character and prefix
+// distributions resemble real URLs and titles.
+std::string MakeWord(int n) {
+  static const char kSyllables[][4] = {
+    "ka", "to", "mi", "ne", "ru", "sa", "lo", "pe", "di", "vu",
+    "cha", "bre", "ost", "ing", "qua", "zen", "for", "ix", "ul", "ap",
+  };
+  std::string word;
+  do {
+    word += kSyllables[n % arraysize(kSyllables)];
+    n /= arraysize(kSyllables);
+  } while (n);
+  return word;
+}
+
+}  // namespace
+
+class URLIndexPrivateDataPerfTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    data_ = new URLIndexPrivateData;
+  }
+
+  // Indexes a synthetic history the way IndexRow() does, minus the visit
+  // lookups which need a history database.
+  void BuildIndex() {
+    for (int i = 1; i <= kURLCount; ++i) {
+      std::string host = MakeWord(base::RandInt(0, kVocabularySize / 10));
+      std::string path = MakeWord(base::RandInt(0, kVocabularySize - 1)) + "/" +
+                         base::IntToString(i);
+      URLRow row(GURL("http://www." + host + ".com/" + path), i);
+      std::string title;
+      for (int w = 0; w < kWordsPerTitle; ++w) {
+        // Skew towards common words, as in real titles.
+        int max_word = w ? kVocabularySize - 1 : 100;
+        title += MakeWord(base::RandInt(0, max_word)) + " ";
+      }
+      row.set_title(UTF8ToUTF16(title));
+      row.set_typed_count(base::RandInt(0, 3));
+      row.set_visit_count(base::RandInt(1, 20));
+      row.set_last_visit(base::Time::Now() -
+                         base::TimeDelta::FromDays(base::RandInt(0, 60)));
+
+      HistoryID history_id = static_cast<HistoryID>(i);
+      data_->history_info_map_[history_id].url_row = row;
+      RowWordStarts word_starts;
+      data_->AddRowWordsToIndex(row, &word_starts, kLanguages);
+      data_->word_starts_map_[history_id] = word_starts;
+    }
+  }
+
+  // Bytes held by the posting lists, i.e. the part of the index whose
+  // representation changed from std::set to SortedIDSet.
+  size_t PostingListBytes() const {
+    size_t bytes = 0;
+    size_t entries = 0;
+    for (CharWordIDMap::const_iterator it = data_->char_word_map_.begin();
+         it != data_->char_word_map_.end(); ++it) {
+      bytes += it->second.EstimateMemoryUsage();
+      entries += it->second.size();
+    }
+    for (WordIDHistoryMap::const_iterator it =
+             data_->word_id_history_map_.begin();
+         it != data_->word_id_history_map_.end(); ++it) {
+      bytes += it->second.EstimateMemoryUsage();
+      entries += it->second.size();
+    }
+    for (HistoryIDWordMap::const_iterator it =
+             data_->history_id_word_map_.begin();
+         it != data_->history_id_word_map_.end(); ++it) {
+      bytes += it->second.EstimateMemoryUsage();
+      entries += it->second.size();
+    }
+    LOG(INFO) << base::StringPrintf(
+        "%" PRIuS " posting list entries in %" PRIuS " bytes", entries, bytes);
+    return bytes;
+  }
+
+  void TimeQueries(const char* name, const char* const* queries,
+                   size_t query_count) {
+    PerfTimeLogger timer(name);
+    for (size_t i = 0; i < query_count; ++i) {
+      // Each query simulates typing one more character, so the term cache
+      // is exercised the same way the omnibox does.
+      data_->HistoryItemsForTerms(ASCIIToUTF16(queries[i]), string16::npos,
+                                  kLanguages, NULL);
+    }
+    timer.Done();
+  }
+
+  scoped_refptr<URLIndexPrivateData> data_;
+};
+
+TEST_F(URLIndexPrivateDataPerfTest, BuildAndQuery) {
+  {
+    PerfTimeLogger timer("InMemoryURLIndex_build_100k");
+    BuildIndex();
+    timer.Done();
+  }
+  EXPECT_GT(PostingListBytes(), 0u);
+
+  const char* const kTypedQueries[] = {
+    "k", "ka", "kat", "kato", "katom", "katomi",
+    "c", "ch", "cha", "chab", "chabr", "chabre",
+  };
+  TimeQueries("InMemoryURLIndex_typed_queries", kTypedQueries,
+              arraysize(kTypedQueries));
+
+  const char* const kMultiWordQueries[] = {
+    "ka to", "mi ne ru", "www com", "sa lo pe di", "ing qua",
+  };
+  TimeQueries("InMemoryURLIndex_multi_word_queries", kMultiWordQueries,
+              arraysize(kMultiWordQueries));
+}
+
+// Measures omnibox latency as each character of a query is typed, with
+// candidates scored serially and then shared with the worker pool.
+TEST_F(URLIndexPrivateDataPerfTest, TypedCharacterScoring) {
+  BuildIndex();
+  const char* const kTypedSequences[] = {
+    "w", "ww", "www", "k", "ka", "kat", "s", "sa", "sal", "salo",
+  };
+  const size_t default_helpers = data_->max_scoring_helpers_;
+
+  data_->max_scoring_helpers_ = 0;
+  TimeQueries("InMemoryURLIndex_typed_chars_serial", kTypedSequences,
+              arraysize(kTypedSequences));
+
+  data_->max_scoring_helpers_ = default_helpers;
+  TimeQueries(base::StringPrintf("InMemoryURLIndex_typed_chars_%" PRIuS
+                                 "_helpers", default_helpers).c_str(),
+              kTypedSequences, arraysize(kTypedSequences));
+}
+
+// Measures startup on a large profile: restoring the index from its cache
+// file and journal, then serving the first query from the restored data, as
+// reported by History.InMemoryURLIndexInitToFirstQueryTime.
+TEST_F(URLIndexPrivateDataPerfTest, RestoreToFirstQuery) {
+  BuildIndex();
+  data_->last_time_rebuilt_from_history_ = base::Time::Now();
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath cache_path =
+      temp_dir.path().Append(FILE_PATH_LITERAL("History Provider Cache"));
+  ASSERT_TRUE(URLIndexPrivateData::WritePrivateDataToCacheFileTask(
+      data_, cache_path));
+
+  // Leave a journal of recent visits behind, as a session would.
+  std::string journal;
+  for (int i = 1; i <= kURLCount / 100; ++i)
+    data_->AppendUpdateToJournal(data_->history_info_map_[i].url_row,
+                                 &journal);
+  ASSERT_TRUE(URLIndexPrivateData::AppendToJournalFileTask(cache_path,
+                                                           journal));
+
+  std::set<std::string> scheme_whitelist;
+  scheme_whitelist.insert("http");
+  PerfTimeLogger timer("InMemoryURLIndex_restore_to_first_query_100k");
+  scoped_refptr<URLIndexPrivateData> restored_data =
+      URLIndexPrivateData::RestoreFromFile(cache_path, kLanguages,
+                                           scheme_whitelist);
+  ASSERT_TRUE(restored_data.get());
+  restored_data->HistoryItemsForTerms(ASCIIToUTF16("ka"), string16::npos,
+                                      kLanguages, NULL);
+  timer.Done();
+  EXPECT_GT(restored_data->restored_journal_size(), 0);
+}
+
+}  // namespace history
@@ -7,10 +7,18 @@
 #include <algorithm>
 #include <math.h>
 
+#include "base/bits.h"
 #include "base/file_util.h"
 #include "base/logging.h"
 #include "base/md5.h"
 #include "base/metrics/histogram.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_FAMILY) && \
+    (defined(__SSE2__) || defined(ARCH_CPU_X86_64))
+#define PREFIX_SET_USE_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace {
 
@@ -29,10 +37,35 @@ typedef struct {
   uint32 deltas_size;
 } FileHeader;
 
-// For |std::upper_bound()| to find a prefix w/in a vector of pairs.
-bool PrefixLess(const std::pair<SBPrefix,size_t>& a,
-                const std::pair<SBPrefix,size_t>& b) {
-  return a.first < b.first;
+// Alignment of |PrefixSet::block_prefixes_|, the size of a cache line.
+const size_t kBlockAlignment = 64;
+
+// Returns the number of the 16 sorted prefixes at |block| which are
+// not greater than |prefix|.
+size_t CountBlockPrefixesNotGreater(const SBPrefix* block, SBPrefix prefix) {
+#if defined(PREFIX_SET_USE_SSE2)
+  // |SBPrefix| is signed, matching the signed SSE2 compare.
+  const __m128i* lanes = reinterpret_cast<const __m128i*>(block);
+  const __m128i target = _mm_set1_epi32(prefix);
+  const __m128i greater01 =
+      _mm_packs_epi32(_mm_cmpgt_epi32(_mm_load_si128(lanes), target),
+                      _mm_cmpgt_epi32(_mm_load_si128(lanes + 1), target));
+  const __m128i greater23 =
+      _mm_packs_epi32(_mm_cmpgt_epi32(_mm_load_si128(lanes + 2), target),
+                      _mm_cmpgt_epi32(_mm_load_si128(lanes + 3), target));
+  const uint32 greater_mask =
+      _mm_movemask_epi8(_mm_packs_epi16(greater01, greater23));
+
+  // The block is sorted, so the prefixes which are not greater are a
+  // run of low bits.
+  const uint32 not_greater_mask = ~greater_mask & 0xFFFF;
+  return base::bits::Log2Floor(not_greater_mask + 1);
+#else
+  size_t count = 0;
+  while (count < 16 && block[count] <= prefix)
+    ++count;
+  return count;
+#endif
 }
 
 }  // namespace
@@ -89,6 +122,8 @@ PrefixSet::PrefixSet(const std::vector<SBPrefix>& sorted_prefixes) {
                               bits_used / unique_prefixes,
                               kMaxBitsPerPrefix);
   }
+
+  BuildBlockIndex();
 }
 
 PrefixSet::PrefixSet(std::vector<std::pair<SBPrefix,size_t> > *index,
@@ -96,37 +131,68 @@ PrefixSet::PrefixSet(std::vector<std::pair<SBPrefix,size_t> > *index,
   DCHECK(index && deltas);
   index_.swap(*index);
   deltas_.swap(*deltas);
+
+  BuildBlockIndex();
 }
 
 PrefixSet::~PrefixSet() {}
 
-bool PrefixSet::Exists(SBPrefix prefix) const {
+void PrefixSet::BuildBlockIndex() {
   if (index_.empty())
-    return false;
+    return;
+
+  const size_t block_count = (index_.size() + kBlockSize - 1) / kBlockSize;
+  const size_t padded_size = block_count * kBlockSize;
+  block_prefixes_.reset(static_cast<SBPrefix*>(
+      base::AlignedAlloc(padded_size * sizeof(SBPrefix), kBlockAlignment)));
+  block_firsts_.reserve(block_count);
+
+  for (size_t ii = 0; ii < index_.size(); ++ii) {
+    block_prefixes_.get()[ii] = index_[ii].first;
+    if (ii % kBlockSize == 0)
+      block_firsts_.push_back(index_[ii].first);
+  }
+  std::fill(block_prefixes_.get() + index_.size(),
+            block_prefixes_.get() + padded_size, kint32max);
+}
 
-  // Find the first position after |prefix| in |index_|.
-  std::vector<std::pair<SBPrefix,size_t> >::const_iterator
-      iter = std::upper_bound(index_.begin(), index_.end(),
-                              std::pair<SBPrefix,size_t>(prefix, 0),
-                              PrefixLess);
+size_t PrefixSet::FindIndexEntry(SBPrefix prefix) const {
+  // Find the last block starting at or before |prefix|.
+  std::vector<SBPrefix>::const_iterator iter =
+      std::upper_bound(block_firsts_.begin(), block_firsts_.end(), prefix);
 
   // |prefix| comes before anything that's in the set.
-  if (iter == index_.begin())
+  if (iter == block_firsts_.begin())
+    return index_.size();
+
+  const size_t block = (iter - block_firsts_.begin()) - 1;
+  const size_t count = CountBlockPrefixesNotGreater(
+      block_prefixes_.get() + block * kBlockSize, prefix);
+  DCHECK_GT(count, 0u);
+
+  // The padding compares not greater than |kint32max|.
+  return std::min(block * kBlockSize + count, index_.size()) - 1;
+}
+
+bool PrefixSet::Exists(SBPrefix prefix) const {
+  if (index_.empty())
     return false;
 
-  // Capture the upper bound of our target entry's deltas.
-  const size_t bound = (iter == index_.end() ? deltas_.size() : iter->second);
+  const size_t ii = FindIndexEntry(prefix);
+  if (ii == index_.size())
+    return false;
 
-  // Back up to the entry our target is in.
-  --iter;
+  // Capture the upper bound of our target entry's deltas.
+  const size_t bound =
+      (ii + 1 < index_.size() ? index_[ii + 1].second : deltas_.size());
 
   // All prefixes in |index_| are in the set.
-  SBPrefix current = iter->first;
+  SBPrefix current = index_[ii].first;
   if (current == prefix)
     return true;
 
   // Scan forward accumulating deltas while a match is possible.
-  for (size_t di = iter->second; di < bound && current < prefix; ++di) {
+  for (size_t di = index_[ii].second; di < bound && current < prefix; ++di) {
     current += deltas_[di];
   }
 
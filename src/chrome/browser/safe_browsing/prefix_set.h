@@ -37,6 +37,14 @@
 // 2^16 apart, which would need 512k (versus 256k to store the raw
 // data).
 //
+// |Exists()| runs for every URL checked, so the prefixes of |index_|
+// are also copied into a cache-line-blocked search structure when the
+// set is constructed or loaded.  A small summary holding the first
+// prefix of each block locates the block, and the block is searched
+// with a handful of vector compares instead of further binary search
+// steps through |index_|.  This costs 4 bytes per |index_| entry, or
+// about 3% of the set's memory, and is not persisted.
+//
 // The on-disk format looks like:
 //         4 byte magic number
 //         4 byte version number
@@ -51,6 +59,8 @@
 
 #include <vector>
 
+#include "base/memory/aligned_memory.h"
+#include "base/memory/scoped_ptr.h"
 #include "chrome/browser/safe_browsing/safe_browsing_util.h"
 
 namespace base {
@@ -81,11 +91,23 @@ class PrefixSet {
   // for |Exists()| under control.
   static const size_t kMaxRun = 100;
 
+  // Number of |index_| prefixes in each block of |block_prefixes_|.
+  // Sixteen prefixes fill one 64-byte cache line.
+  static const size_t kBlockSize = 16;
+
   // Helper for |LoadFile()|.  Steals the contents of |index| and
   // |deltas| using |swap()|.
   PrefixSet(std::vector<std::pair<SBPrefix,size_t> > *index,
             std::vector<uint16> *deltas);
 
+  // Builds |block_prefixes_| and |block_firsts_| from |index_|.
+  void BuildBlockIndex();
+
+  // Returns the position in |index_| of the last entry whose prefix
+  // is not greater than |prefix|, or |index_.size()| if there is
+  // none.
+  size_t FindIndexEntry(SBPrefix prefix) const;
+
   // Top-level index of prefix to offset in |deltas_|.  Each pair
   // indicates a base prefix and where the deltas from that prefix
   // begin in |deltas_|.  The deltas for a pair end at the next pair's
@@ -97,6 +119,13 @@ class PrefixSet {
   // |index_|, or the end of |deltas_| for the last |index_| pair.
   std::vector<uint16> deltas_;
 
+  // The prefixes from |index_| in blocks of |kBlockSize|, aligned to a
+  // cache line.  The last block is padded with |kint32max|.
+  scoped_ptr_malloc<SBPrefix, base::ScopedPtrAlignedFree> block_prefixes_;
+
+  // The first prefix of each block in |block_prefixes_|.
+  std::vector<SBPrefix> block_firsts_;
+
   DISALLOW_COPY_AND_ASSIGN(PrefixSet);
 };
 
@@ -0,0 +1,62 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/browser/safe_browsing/prefix_set.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "base/perftimer.h"
+#include "base/rand_util.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+// Roughly the number of add prefixes in a full safe-browsing database.
+const size_t kPrefixCount = 650000;
+
+const size_t kLookupCount = 10 * 1000 * 1000;
+
+// Times |kLookupCount| calls to |Exists()| on |prefixes| and logs the
+// lookup rate.  Returns the number of hits so the lookups can't be
+// optimized away.
+size_t TimeLookups(const char* name,
+                   const safe_browsing::PrefixSet& prefix_set,
+                   const std::vector<SBPrefix>& queries) {
+  size_t hits = 0;
+  PerfTimer timer;
+  for (size_t i = 0; i < kLookupCount; ++i) {
+    if (prefix_set.Exists(queries[i % queries.size()]))
+      ++hits;
+  }
+  const base::TimeDelta elapsed = timer.Elapsed();
+  LogPerfResult(name, kLookupCount / elapsed.InSecondsF(), "lookups/s");
+  return hits;
+}
+
+}  // namespace
+
+TEST(PrefixSetPerfTest, Exists) {
+  std::vector<SBPrefix> prefixes;
+  for (size_t i = 0; i < kPrefixCount; ++i)
+    prefixes.push_back(static_cast<SBPrefix>(base::RandUint64()));
+  std::sort(prefixes.begin(), prefixes.end());
+  safe_browsing::PrefixSet prefix_set(prefixes);
+
+  // Nearly every prefix checked while browsing is a miss, so time
+  // random misses separately from hits.
+  const size_t kQueryCount = 1 << 16;
+  std::vector<SBPrefix> misses;
+  std::vector<SBPrefix> hits;
+  for (size_t i = 0; i < kQueryCount; ++i) {
+    misses.push_back(static_cast<SBPrefix>(base::RandUint64()));
+    hits.push_back(prefixes[base::RandGenerator(prefixes.size())]);
+  }
+
+  EXPECT_EQ(kLookupCount,
+            TimeLookups("PrefixSet_Exists_Hits", prefix_set, hits));
+  EXPECT_GT(kLookupCount / 100,
+            TimeLookups("PrefixSet_Exists_Misses", prefix_set, misses));
+}
@@ -236,6 +236,34 @@ TEST_F(PrefixSetTest, AllBig) {
                          prefixes_copy.begin()));
 }
 
+// Sets whose index entries partially or exactly fill the blocks used
+// to search the index, including sets which end at |kint32max|, the
+// value the last block is padded with.
+TEST_F(PrefixSetTest, IndexBlockBoundaries) {
+  const unsigned kDelta = 10 * 1000 * 1000;
+
+  for (size_t count = 1; count <= 50; ++count) {
+    for (int end_at_max = 0; end_at_max < 2; ++end_at_max) {
+      // Deltas over 2^16 give every prefix its own index entry.
+      std::vector<SBPrefix> prefixes;
+      const unsigned first = end_at_max ? kint32max - (count - 1) * kDelta : 0;
+      for (size_t i = 0; i < count; ++i)
+        prefixes.push_back(static_cast<SBPrefix>(first + i * kDelta));
+      safe_browsing::PrefixSet prefix_set(prefixes);
+
+      for (size_t i = 0; i < prefixes.size(); ++i) {
+        EXPECT_TRUE(prefix_set.Exists(prefixes[i]));
+        EXPECT_FALSE(prefix_set.Exists(prefixes[i] - 1));
+        if (prefixes[i] != kint32max)
+          EXPECT_FALSE(prefix_set.Exists(prefixes[i] + 1));
+      }
+      if (!end_at_max)
+        EXPECT_FALSE(prefix_set.Exists(kint32max));
+      EXPECT_FALSE(prefix_set.Exists(kint32min));
+    }
+  }
+}
+
 // Use artificial inputs to test various edge cases in Exists().
 // Items before the lowest item aren't present.  Items after the
 // largest item aren't present.  Create a sequence of items with
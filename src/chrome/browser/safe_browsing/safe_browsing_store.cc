@@ -120,6 +120,22 @@ void RemoveDeleted(ItemsT* items, const base::hash_set<int32>& del_set) {
   items->erase(end_iter, items->end());
 }
 
+// Sort |items| by |less| unless they are already in order, which is
+// the usual case for data merged by SafeBrowsingStoreFile.
+template <typename ItemsT, typename LessT>
+void SortIfNeeded(ItemsT* items, LessT less) {
+  typename ItemsT::iterator iter = items->begin();
+  if (iter == items->end())
+    return;
+  for (typename ItemsT::iterator next = iter + 1; next != items->end();
+       iter = next++) {
+    if (less(*next, *iter)) {
+      std::sort(items->begin(), items->end(), less);
+      return;
+    }
+  }
+}
+
 enum MissTypes {
   MISS_TYPE_ALL,
   MISS_TYPE_FALSE,
@@ -176,14 +192,12 @@ void SBProcessSubs(SBAddPrefixes* add_prefixes,
   // clear how things are working.
 
   // Sort the inputs by the SBAddPrefix bits.
-  std::sort(add_prefixes->begin(), add_prefixes->end(),
-            SBAddPrefixLess<SBAddPrefix,SBAddPrefix>);
-  std::sort(sub_prefixes->begin(), sub_prefixes->end(),
-            SBAddPrefixLess<SBSubPrefix,SBSubPrefix>);
-  std::sort(add_full_hashes->begin(), add_full_hashes->end(),
-            SBAddPrefixHashLess<SBAddFullHash,SBAddFullHash>);
-  std::sort(sub_full_hashes->begin(), sub_full_hashes->end(),
-            SBAddPrefixHashLess<SBSubFullHash,SBSubFullHash>);
+  SortIfNeeded(add_prefixes, SBAddPrefixLess<SBAddPrefix,SBAddPrefix>);
+  SortIfNeeded(sub_prefixes, SBAddPrefixLess<SBSubPrefix,SBSubPrefix>);
+  SortIfNeeded(add_full_hashes,
+               SBAddPrefixHashLess<SBAddFullHash,SBAddFullHash>);
+  SortIfNeeded(sub_full_hashes,
+               SBAddPrefixHashLess<SBSubFullHash,SBSubFullHash>);
 
   // Factor out the prefix subs.
   SBAddPrefixes removed_adds;
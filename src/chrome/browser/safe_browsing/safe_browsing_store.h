@@ -133,12 +133,11 @@ bool SBAddPrefixHashLess(const T& a, const U& b) {
 // matched items from all vectors.  Additionally remove items from
 // deleted chunks.
 //
-// TODO(shess): Since the prefixes are uniformly-distributed hashes,
-// there aren't many ways to organize the inputs for efficient
-// processing.  For this reason, the vectors are sorted and processed
-// in parallel.  At this time this code does the sorting internally,
-// but it might make sense to make sorting an API requirement so that
-// the storage can optimize for it.
+// Since the prefixes are uniformly-distributed hashes, there aren't
+// many ways to organize the inputs for efficient processing.  For
+// this reason, the vectors are sorted and processed in parallel.
+// Inputs which are already sorted (as SafeBrowsingStoreFile arranges)
+// are only checked, not re-sorted.
 void SBProcessSubs(SBAddPrefixes* add_prefixes,
                    SBSubPrefixes* sub_prefixes,
                    std::vector<SBAddFullHash>* add_full_hashes,
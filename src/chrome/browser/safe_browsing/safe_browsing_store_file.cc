@@ -4,6 +4,8 @@
 
 #include "chrome/browser/safe_browsing/safe_browsing_store_file.h"
 
+#include <algorithm>
+
 #include "base/md5.h"
 #include "base/metrics/histogram.h"
 
@@ -81,6 +83,11 @@ bool WriteItem(const T& item, FILE* fp, base::MD5Context* context) {
   return true;
 }
 
+// Number of bytes to move through stdio and the checksum at a time.
+// Folding a whole buffer into the checksum at once is much cheaper
+// than folding in each item separately.
+const size_t kIOBufferSize = 4096;
+
 // Read |count| items into |values| from |fp|, and fold them into the
 // checksum in |context|.  Returns true on success.
 template <typename CT>
@@ -89,14 +96,29 @@ bool ReadToContainer(CT* values, size_t count, FILE* fp,
   if (!count)
     return true;
 
-  for (size_t i = 0; i < count; ++i) {
-    typename CT::value_type value;
-    if (!ReadItem(&value, fp, context))
+  typedef typename CT::value_type ValueType;
+  const size_t buffer_items =
+      std::min(count, std::max(kIOBufferSize / sizeof(ValueType),
+                               static_cast<size_t>(1)));
+  std::vector<ValueType> buffer(buffer_items);
+
+  while (count > 0) {
+    const size_t c = std::min(buffer_items, count);
+    const size_t ret = fread(&buffer[0], sizeof(ValueType), c, fp);
+    if (ret != c)
       return false;
 
+    if (context) {
+      base::MD5Update(context,
+                      base::StringPiece(reinterpret_cast<char*>(&buffer[0]),
+                                        c * sizeof(ValueType)));
+    }
+
     // push_back() is more obvious, but coded this way std::set can
     // also be read.
-    values->insert(values->end(), value);
+    for (size_t i = 0; i < c; ++i)
+      values->insert(values->end(), buffer[i]);
+    count -= c;
   }
 
   return true;
@@ -110,14 +132,56 @@ bool WriteContainer(const CT& values, FILE* fp,
   if (values.empty())
     return true;
 
-  for (typename CT::const_iterator iter = values.begin();
-       iter != values.end(); ++iter) {
-    if (!WriteItem(*iter, fp, context))
+  typedef typename CT::value_type ValueType;
+  const size_t buffer_items =
+      std::min(values.size(), std::max(kIOBufferSize / sizeof(ValueType),
+                                       static_cast<size_t>(1)));
+  std::vector<ValueType> buffer;
+  buffer.reserve(buffer_items);
+
+  typename CT::const_iterator iter = values.begin();
+  while (iter != values.end()) {
+    buffer.clear();
+    for (; iter != values.end() && buffer.size() < buffer_items; ++iter)
+      buffer.push_back(*iter);
+
+    const size_t ret = fwrite(&buffer[0], sizeof(ValueType), buffer.size(), fp);
+    if (ret != buffer.size())
       return false;
+
+    if (context) {
+      base::MD5Update(context,
+                      base::StringPiece(
+                          reinterpret_cast<const char*>(&buffer[0]),
+                          buffer.size() * sizeof(ValueType)));
+    }
   }
   return true;
 }
 
+// Sort |items| by |less|, given that the first |sorted_count| items
+// were read from the store file and are usually already sorted.  In
+// that case only the items appended by the update are sorted, and
+// then merged with the rest.
+template <typename CT, typename LessT>
+void SortAppendedItems(CT* items, size_t sorted_count, LessT less) {
+  DCHECK_LE(sorted_count, items->size());
+  const typename CT::iterator middle = items->begin() + sorted_count;
+
+  bool head_sorted = true;
+  for (typename CT::iterator iter = items->begin();
+       head_sorted && iter != middle && iter + 1 != middle; ++iter) {
+    head_sorted = !less(*(iter + 1), *iter);
+  }
+  if (!head_sorted) {
+    std::sort(items->begin(), items->end(), less);
+    return;
+  }
+
+  std::sort(middle, items->end(), less);
+  std::inplace_merge(items->begin(), middle, items->end(), less);
+}
+
 // Delete the chunks in |deleted| from |chunks|.
 void DeleteChunksFromSet(const base::hash_set<int32>& deleted,
                          std::set<int32>* chunks) {
@@ -542,6 +606,14 @@ bool SafeBrowsingStoreFile::DoUpdate(
   }
   DCHECK(!file_.get());
 
+  // The data from |file_| was written in sorted order by the previous
+  // update.  Remember where it ends so that only the new data needs
+  // to be sorted.
+  const size_t add_prefixes_sorted = add_prefixes.size();
+  const size_t sub_prefixes_sorted = sub_prefixes.size();
+  const size_t add_full_hashes_sorted = add_full_hashes.size();
+  const size_t sub_full_hashes_sorted = sub_full_hashes.size();
+
   // Rewind the temporary storage.
   if (!FileRewind(new_file_.get()))
     return false;
@@ -578,13 +650,6 @@ bool SafeBrowsingStoreFile::DoUpdate(
     if (expected_size > size)
       return false;
 
-    // TODO(shess): If the vectors were kept sorted, then this code
-    // could use std::inplace_merge() to merge everything together in
-    // sorted order.  That might still be slower than just sorting at
-    // the end if there were a large number of chunks.  In that case
-    // some sort of recursive binary merge might be in order (merge
-    // chunks pairwise, merge those chunks pairwise, and so on, then
-    // merge the result with the main list).
     if (!ReadToContainer(&add_prefixes, header.add_prefix_count,
                          new_file_.get(), NULL) ||
         !ReadToContainer(&sub_prefixes, header.sub_prefix_count,
@@ -600,6 +665,17 @@ bool SafeBrowsingStoreFile::DoUpdate(
   add_full_hashes.insert(add_full_hashes.end(),
                          pending_adds.begin(), pending_adds.end());
 
+  // Merge the new data into the sorted data from |file_|, so that
+  // |SBProcessSubs()| does not need to sort everything again.
+  SortAppendedItems(&add_prefixes, add_prefixes_sorted,
+                    SBAddPrefixLess<SBAddPrefix,SBAddPrefix>);
+  SortAppendedItems(&sub_prefixes, sub_prefixes_sorted,
+                    SBAddPrefixLess<SBSubPrefix,SBSubPrefix>);
+  SortAppendedItems(&add_full_hashes, add_full_hashes_sorted,
+                    SBAddPrefixHashLess<SBAddFullHash,SBAddFullHash>);
+  SortAppendedItems(&sub_full_hashes, sub_full_hashes_sorted,
+                    SBAddPrefixHashLess<SBSubFullHash,SBSubFullHash>);
+
   // Check how often a prefix was checked which wasn't in the
   // database.
   SBCheckPrefixMisses(add_prefixes, prefix_misses);
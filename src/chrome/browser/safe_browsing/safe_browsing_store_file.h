@@ -91,7 +91,9 @@
 // - Write new chunks to the temp file.
 // - When the transaction is finished:
 //   - Read the rest of the original file's data into buffers.
-//   - Rewind the temp file and merge the new data into buffers.
+//   - Rewind the temp file and merge the new data into buffers.  The
+//     original file's data was written in sorted order, so only the
+//     new data needs to be sorted before it is merged.
 //   - Process buffers for deletions and apply subs.
 //   - Rewind and write the buffers out to temp file.
 //   - Delete original file.
@@ -0,0 +1,110 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/browser/safe_browsing/safe_browsing_store_file.h"
+
+#include "base/bind.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/perftimer.h"
+#include "base/process/process_metrics.h"
+#include "base/rand_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+// Roughly the size of a full malware plus phishing database.
+const int kDatabasePrefixCount = 2000000;
+
+// A typical update adds a few dozen chunks.
+const int kPrefixesPerChunk = 1000;
+const int kUpdateAddChunkCount = 20;
+const int kUpdateSubChunkCount = 5;
+
+// Writes |add_chunk_count| add chunks starting at |first_add_chunk|,
+// and |sub_chunk_count| sub chunks which knock out prefixes from the
+// earliest add chunks, then commits the update.
+void RunUpdate(SafeBrowsingStoreFile* store,
+               int first_add_chunk, int add_chunk_count,
+               int first_sub_chunk, int sub_chunk_count,
+               SBAddPrefixes* add_prefixes_result) {
+  ASSERT_TRUE(store->BeginUpdate());
+
+  for (int i = 0; i < add_chunk_count; ++i) {
+    const int chunk_id = first_add_chunk + i;
+    ASSERT_TRUE(store->BeginChunk());
+    store->SetAddChunk(chunk_id);
+    for (int j = 0; j < kPrefixesPerChunk; ++j) {
+      ASSERT_TRUE(store->WriteAddPrefix(
+          chunk_id, static_cast<SBPrefix>(base::RandUint64())));
+    }
+    ASSERT_TRUE(store->FinishChunk());
+  }
+
+  for (int i = 0; i < sub_chunk_count; ++i) {
+    const int chunk_id = first_sub_chunk + i;
+    ASSERT_TRUE(store->BeginChunk());
+    store->SetSubChunk(chunk_id);
+    for (int j = 0; j < kPrefixesPerChunk; ++j) {
+      ASSERT_TRUE(store->WriteSubPrefix(
+          chunk_id, i + 1, static_cast<SBPrefix>(base::RandUint64())));
+    }
+    ASSERT_TRUE(store->FinishChunk());
+  }
+
+  std::vector<SBAddFullHash> pending_adds;
+  std::set<SBPrefix> prefix_misses;
+  std::vector<SBAddFullHash> add_full_hashes_result;
+  ASSERT_TRUE(store->FinishUpdate(pending_adds, prefix_misses,
+                                  add_prefixes_result,
+                                  &add_full_hashes_result));
+}
+
+}  // namespace
+
+// Times a typical periodic update against a large existing store, and
+// reports the process's peak memory use afterwards.
+TEST(SafeBrowsingStoreFilePerfTest, UpdateLargeStore) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const base::FilePath filename =
+      temp_dir.path().AppendASCII("SafeBrowsingPerfStore");
+
+  scoped_ptr<SafeBrowsingStoreFile> store(new SafeBrowsingStoreFile());
+  store->Init(filename, base::Closure());
+
+  const int database_chunk_count = kDatabasePrefixCount / kPrefixesPerChunk;
+  {
+    SBAddPrefixes add_prefixes_result;
+    PerfTimeLogger timer("SafeBrowsingStoreFile_InitialUpdate");
+    RunUpdate(store.get(), 1, database_chunk_count, 1, 0,
+              &add_prefixes_result);
+    timer.Done();
+    EXPECT_EQ(static_cast<size_t>(kDatabasePrefixCount),
+              add_prefixes_result.size());
+  }
+
+  scoped_ptr<base::ProcessMetrics> metrics(
+      base::ProcessMetrics::CreateProcessMetrics(
+          base::GetCurrentProcessHandle()));
+  const size_t peak_before_update = metrics->GetPeakWorkingSetSize();
+
+  {
+    SBAddPrefixes add_prefixes_result;
+    PerfTimeLogger timer("SafeBrowsingStoreFile_IncrementalUpdate");
+    RunUpdate(store.get(), database_chunk_count + 1, kUpdateAddChunkCount,
+              1, kUpdateSubChunkCount, &add_prefixes_result);
+    timer.Done();
+    EXPECT_LE(static_cast<size_t>(kDatabasePrefixCount),
+              add_prefixes_result.size());
+  }
+
+  const size_t peak_after_update = metrics->GetPeakWorkingSetSize();
+  LogPerfResult("SafeBrowsingStoreFile_PeakWorkingSet",
+                peak_after_update / 1024.0, "KB");
+  LogPerfResult("SafeBrowsingStoreFile_IncrementalUpdatePeakGrowth",
+                (peak_after_update - peak_before_update) / 1024.0, "KB");
+
+  EXPECT_TRUE(store->Delete());
+}
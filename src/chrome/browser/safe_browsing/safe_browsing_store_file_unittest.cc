@@ -193,4 +193,63 @@ TEST_F(SafeBrowsingStoreFileTest, CheckValidityChecksum) {
   EXPECT_TRUE(store_->CancelUpdate());
 }
 
+// Updates merge new data into the sorted data already in the store,
+// including data larger than the I/O buffers, and subs in a later
+// update knock out adds stored by an earlier one.
+TEST_F(SafeBrowsingStoreFileTest, MergeAcrossUpdates) {
+  const int kAddChunk = 1;
+  const int kLaterAddChunk = 3;
+  const int kSubChunk = 2;
+  const SBPrefix kPrefixCount = 3000;
+
+  std::vector<SBAddFullHash> pending_adds;
+  std::set<SBPrefix> prefix_misses;
+  SBAddPrefixes add_prefixes_result;
+  std::vector<SBAddFullHash> add_full_hashes_result;
+
+  // Store the even prefixes in descending order.
+  ASSERT_TRUE(store_->BeginUpdate());
+  EXPECT_TRUE(store_->BeginChunk());
+  store_->SetAddChunk(kAddChunk);
+  for (SBPrefix prefix = kPrefixCount * 2; prefix > 0; prefix -= 2)
+    EXPECT_TRUE(store_->WriteAddPrefix(kAddChunk, prefix));
+  EXPECT_TRUE(store_->FinishChunk());
+  ASSERT_TRUE(store_->FinishUpdate(pending_adds, prefix_misses,
+                                   &add_prefixes_result,
+                                   &add_full_hashes_result));
+  EXPECT_EQ(static_cast<size_t>(kPrefixCount), add_prefixes_result.size());
+
+  // Add the odd prefixes to the same chunk and a later one, and knock
+  // out every fourth even prefix.
+  ASSERT_TRUE(store_->BeginUpdate());
+  EXPECT_TRUE(store_->BeginChunk());
+  store_->SetAddChunk(kLaterAddChunk);
+  for (SBPrefix prefix = 1; prefix < kPrefixCount * 2; prefix += 2) {
+    EXPECT_TRUE(store_->WriteAddPrefix(
+        prefix % 4 == 1 ? kAddChunk : kLaterAddChunk, prefix));
+  }
+  store_->SetSubChunk(kSubChunk);
+  for (SBPrefix prefix = 4; prefix <= kPrefixCount * 2; prefix += 4)
+    EXPECT_TRUE(store_->WriteSubPrefix(kSubChunk, kAddChunk, prefix));
+  EXPECT_TRUE(store_->FinishChunk());
+  add_prefixes_result.clear();
+  ASSERT_TRUE(store_->FinishUpdate(pending_adds, prefix_misses,
+                                   &add_prefixes_result,
+                                   &add_full_hashes_result));
+
+  // The result is in order, with the subbed prefixes removed.
+  ASSERT_EQ(static_cast<size_t>(kPrefixCount * 2 - kPrefixCount / 2),
+            add_prefixes_result.size());
+  for (size_t i = 1; i < add_prefixes_result.size(); ++i) {
+    EXPECT_TRUE(SBAddPrefixLess(add_prefixes_result[i - 1],
+                                add_prefixes_result[i]));
+  }
+  for (size_t i = 0; i < add_prefixes_result.size(); ++i) {
+    EXPECT_NE(0, add_prefixes_result[i].prefix % 4);
+    EXPECT_EQ(add_prefixes_result[i].prefix % 4 == 3 ? kLaterAddChunk :
+                  kAddChunk,
+              add_prefixes_result[i].chunk_id);
+  }
+}
+
 }  // namespace
@@ -153,6 +153,18 @@ void VisitedLinkEventListener::Add(VisitedLinkMaster::Fingerprint fingerprint) {
   }
 }
 
+void VisitedLinkEventListener::Delete(
+    const VisitedLinkMaster::Fingerprints& fingerprints) {
+  pending_visited_links_.insert(pending_visited_links_.end(),
+                                fingerprints.begin(), fingerprints.end());
+
+  if (!coalesce_timer_.IsRunning()) {
+    coalesce_timer_.Start(FROM_HERE,
+        TimeDelta::FromMilliseconds(kCommitIntervalMs), this,
+        &VisitedLinkEventListener::CommitVisitedLinks);
+  }
+}
+
 void VisitedLinkEventListener::Reset() {
   pending_visited_links_.clear();
   coalesce_timer_.Stop();
@@ -37,6 +37,8 @@ class VisitedLinkEventListener : public VisitedLinkMaster::Listener,
 
   virtual void NewTable(base::SharedMemory* table_memory) OVERRIDE;
   virtual void Add(VisitedLinkMaster::Fingerprint fingerprint) OVERRIDE;
+  virtual void Delete(
+      const VisitedLinkMaster::Fingerprints& fingerprints) OVERRIDE;
   virtual void Reset() OVERRIDE;
 
  private:
@@ -48,6 +50,9 @@ class VisitedLinkEventListener : public VisitedLinkMaster::Listener,
                        const content::NotificationDetails& details) OVERRIDE;
 
   base::OneShotTimer<VisitedLinkEventListener> coalesce_timer_;
+
+  // Links added or deleted since the last commit. Either way the renderers
+  // only need to recalculate the coloring state of these links.
   VisitedLinkCommon::Fingerprints pending_visited_links_;
 
   content::NotificationRegistrar registrar_;
@@ -55,6 +55,10 @@ const unsigned VisitedLinkMaster::kDefaultTableSize = 16381;
 
 const size_t VisitedLinkMaster::kBigDeleteThreshold = 64;
 
+// 256K entries, or 2MB of fingerprints. Smaller tables rehash in well under a
+// millisecond.
+const int32 VisitedLinkMaster::kBackgroundResizeThreshold = 262127;
+
 namespace {
 
 // Fills the given salt structure with some quasi-random values
@@ -129,10 +133,14 @@ void AsyncClose(FILE** file) {
 // will be called on the history thread by the history system for every URL
 // in the database.
 //
-// The builder will store the fingerprints for those URLs, and then marshalls
-// back to the main thread where the VisitedLinkMaster will be notified. The
-// master then replaces its table with a new table containing the computed
-// fingerprints.
+// The builder will store the fingerprints for those URLs, and then builds a
+// new table containing them on the same thread. It then marshalls back to the
+// main thread where the VisitedLinkMaster will be notified. The master then
+// replaces its table with the new one, after applying any changes made while
+// the table was being built.
+//
+// Resizing a large table works the same way, except the builder is given the
+// fingerprints from the current table and runs on the blocking pool.
 //
 // The builder must remain active while the history system is using it.
 // Sometimes, the master will be deleted before the rebuild is complete, in
@@ -150,6 +158,10 @@ class VisitedLinkMaster::TableBuilder
   // table will be being rebuilt simultaneously on the other thread.
   void DisownMaster();
 
+  // Takes the fingerprints to build the table from, instead of collecting
+  // them through OnURL. Called on the main thread before the builder runs.
+  void SetFingerprints(Fingerprints* fingerprints);
+
   // VisitedLinkDelegate::URLEnumerator
   virtual void OnURL(const GURL& url) OVERRIDE;
   virtual void OnComplete(bool succeed) OVERRIDE;
@@ -157,6 +169,9 @@ class VisitedLinkMaster::TableBuilder
  private:
   virtual ~TableBuilder() {}
 
+  // Builds |table_memory_| from |fingerprints_|. Called by OnComplete.
+  void BuildTable();
+
   // OnComplete mashals to this function on the main thread to do the
   // notification.
   void OnCompleteMainThread();
@@ -173,6 +188,11 @@ class VisitedLinkMaster::TableBuilder
   // Stores the fingerprints we computed on the background thread.
   VisitedLinkCommon::Fingerprints fingerprints_;
 
+  // The table built from |fingerprints_|, and the number of fingerprints in
+  // it. Ownership of the table passes to the master on completion.
+  scoped_ptr<base::SharedMemory> table_memory_;
+  int32 used_count_;
+
   DISALLOW_COPY_AND_ASSIGN(TableBuilder);
 };
 
@@ -225,6 +245,7 @@ void VisitedLinkMaster::InitMembers() {
   shared_memory_serial_ = 0;
   used_items_ = 0;
   table_size_override_ = 0;
+  background_resize_threshold_ = kBackgroundResizeThreshold;
   suppress_rebuild_ = false;
   sequence_token_ = BrowserThread::GetBlockingPool()->GetSequenceToken();
 
@@ -316,9 +337,14 @@ void VisitedLinkMaster::AddURLs(const std::vector<GURL>& url) {
 }
 
 void VisitedLinkMaster::DeleteAllURLs() {
-  // Any pending modifications are invalid.
+  // Any pending modifications are invalid, and so is any table being built
+  // from the old contents.
   added_since_rebuild_.clear();
   deleted_since_rebuild_.clear();
+  if (table_builder_.get()) {
+    table_builder_->DisownMaster();
+    table_builder_ = NULL;
+  }
 
   // Clear the hash table.
   used_items_ = 0;
@@ -340,44 +366,55 @@ void VisitedLinkMaster::DeleteURLs(URLIterator* urls) {
   if (!urls->HasNextURL())
     return;
 
-  listener_->Reset();
+  // Compute the deleted URLs' fingerprints.
+  std::set<Fingerprint> deleted_fingerprints;
+  while (urls->HasNextURL()) {
+    const GURL& url(urls->NextURL());
+    if (!url.is_valid())
+      continue;
+    deleted_fingerprints.insert(
+        ComputeURLFingerprint(url.spec().data(), url.spec().size(), salt_));
+  }
 
-  if (table_builder_.get()) {
-    // A rebuild is in progress, save this deletion in the temporary list so
-    // it can be added once rebuild is complete.
-    while (urls->HasNextURL()) {
-      const GURL& url(urls->NextURL());
-      if (!url.is_valid())
-        continue;
+  // A few deletions are sent to the renderers individually so they only
+  // recalculate the state of those links; otherwise they reset everything.
+  bool notify_individually = deleted_fingerprints.size() <= kBigDeleteThreshold;
+  Fingerprints notify_fingerprints;
+  if (notify_individually) {
+    for (std::set<Fingerprint>::const_iterator i =
+             deleted_fingerprints.begin();
+         i != deleted_fingerprints.end(); ++i) {
+      if (IsVisited(*i))
+        notify_fingerprints.push_back(*i);
+    }
+  } else {
+    listener_->Reset();
+  }
 
-      Fingerprint fingerprint =
-          ComputeURLFingerprint(url.spec().data(), url.spec().size(), salt_);
-      deleted_since_rebuild_.insert(fingerprint);
+  if (table_builder_.get()) {
+    // A rebuild is in progress, save these deletions in the temporary list so
+    // they can be applied once rebuild is complete.
+    for (std::set<Fingerprint>::const_iterator i =
+             deleted_fingerprints.begin();
+         i != deleted_fingerprints.end(); ++i) {
+      deleted_since_rebuild_.insert(*i);
 
       // If the URL was just added and now we're deleting it, it may be in the
       // list of things added since the last rebuild. Delete it from that list.
-      std::set<Fingerprint>::iterator found =
-          added_since_rebuild_.find(fingerprint);
+      std::set<Fingerprint>::iterator found = added_since_rebuild_.find(*i);
       if (found != added_since_rebuild_.end())
         added_since_rebuild_.erase(found);
 
       // Delete the URLs from the in-memory table, but don't bother writing
       // to disk since it will be replaced soon.
-      DeleteFingerprint(fingerprint, false);
+      DeleteFingerprint(*i, false);
     }
-    return;
+  } else {
+    DeleteFingerprintsFromCurrentTable(deleted_fingerprints);
   }
 
-  // Compute the deleted URLs' fingerprints and delete them
-  std::set<Fingerprint> deleted_fingerprints;
-  while (urls->HasNextURL()) {
-    const GURL& url(urls->NextURL());
-    if (!url.is_valid())
-      continue;
-    deleted_fingerprints.insert(
-        ComputeURLFingerprint(url.spec().data(), url.spec().size(), salt_));
-  }
-  DeleteFingerprintsFromCurrentTable(deleted_fingerprints);
+  if (!notify_fingerprints.empty())
+    listener_->Delete(notify_fingerprints);
 }
 
 // See VisitedLinkCommon::IsVisited which should be in sync with this algorithm
@@ -669,31 +706,18 @@ bool VisitedLinkMaster::GetDatabaseFileName(base::FilePath* filename) {
 // Initializes the shared memory structure. The salt should already be filled
 // in so that it can be written to the shared memory
 bool VisitedLinkMaster::CreateURLTable(int32 num_entries, bool init_to_empty) {
-  // The table is the size of the table followed by the entries.
-  uint32 alloc_size = num_entries * sizeof(Fingerprint) + sizeof(SharedHeader);
-
   // Create the shared memory object.
-  shared_memory_ = new base::SharedMemory();
+  shared_memory_ = AllocateTableMemory(num_entries, salt_);
   if (!shared_memory_)
     return false;
 
-  if (!shared_memory_->CreateAndMapAnonymous(alloc_size)) {
-    delete shared_memory_;
-    shared_memory_ = NULL;
-    return false;
-  }
-
   if (init_to_empty) {
-    memset(shared_memory_->memory(), 0, alloc_size);
+    memset(static_cast<char*>(shared_memory_->memory()) + sizeof(SharedHeader),
+           0, num_entries * sizeof(Fingerprint));
     used_items_ = 0;
   }
   table_length_ = num_entries;
 
-  // Save the header for other processes to read.
-  SharedHeader* header = static_cast<SharedHeader*>(shared_memory_->memory());
-  header->length = table_length_;
-  memcpy(header->salt, salt_, LINK_SALT_LENGTH);
-
   // Our table pointer is just the data immediately following the size.
   hash_table_ = reinterpret_cast<Fingerprint*>(
       static_cast<char*>(shared_memory_->memory()) + sizeof(SharedHeader));
@@ -701,6 +725,40 @@ bool VisitedLinkMaster::CreateURLTable(int32 num_entries, bool init_to_empty) {
   return true;
 }
 
+// static
+base::SharedMemory* VisitedLinkMaster::AllocateTableMemory(
+    int32 num_entries,
+    const uint8 salt[LINK_SALT_LENGTH]) {
+  // The table is the size of the table followed by the entries.
+  uint32 alloc_size = num_entries * sizeof(Fingerprint) + sizeof(SharedHeader);
+
+  scoped_ptr<base::SharedMemory> shared_memory(new base::SharedMemory());
+  if (!shared_memory->CreateAndMapAnonymous(alloc_size))
+    return NULL;
+
+  // Save the header for other processes to read.
+  SharedHeader* header = static_cast<SharedHeader*>(shared_memory->memory());
+  header->length = num_entries;
+  memcpy(header->salt, salt, LINK_SALT_LENGTH);
+  return shared_memory.release();
+}
+
+void VisitedLinkMaster::InstallTable(base::SharedMemory* table_memory,
+                                     int32 used_count) {
+  shared_memory_serial_++;
+  delete shared_memory_;
+  shared_memory_ = table_memory;
+  SharedHeader* header = static_cast<SharedHeader*>(shared_memory_->memory());
+  table_length_ = header->length;
+  hash_table_ = reinterpret_cast<Fingerprint*>(
+      static_cast<char*>(shared_memory_->memory()) + sizeof(SharedHeader));
+  used_items_ = used_count;
+
+#ifndef NDEBUG
+  DebugValidate();
+#endif
+}
+
 bool VisitedLinkMaster::BeginReplaceURLTable(int32 num_entries) {
   base::SharedMemory *old_shared_memory = shared_memory_;
   Fingerprint* old_hash_table = hash_table_;
@@ -757,6 +815,15 @@ bool VisitedLinkMaster::ResizeTableIfNecessary() {
 }
 
 void VisitedLinkMaster::ResizeTable(int32 new_size) {
+  if (std::max(table_length_, new_size) >= background_resize_threshold_ &&
+      !table_builder_.get()) {
+    ResizeTableInBackground();
+    return;
+  }
+  ResizeTableNow(new_size);
+}
+
+void VisitedLinkMaster::ResizeTableNow(int32 new_size) {
   DCHECK(shared_memory_ && shared_memory_->memory() && hash_table_);
   shared_memory_serial_++;
 
@@ -795,7 +862,27 @@ void VisitedLinkMaster::ResizeTable(int32 new_size) {
     WriteFullTable();
 }
 
-uint32 VisitedLinkMaster::NewTableSizeForCount(int32 item_count) const {
+void VisitedLinkMaster::ResizeTableInBackground() {
+  DCHECK(!table_builder_.get());
+
+  // Collecting the fingerprints is a sequential scan; hashing them into the
+  // new table is the slow part, and that happens on the blocking pool.
+  Fingerprints fingerprints;
+  fingerprints.reserve(used_items_);
+  for (int32 i = 0; i < table_length_; i++) {
+    if (hash_table_[i])
+      fingerprints.push_back(hash_table_[i]);
+  }
+
+  table_builder_ = new TableBuilder(this, salt_);
+  table_builder_->SetFingerprints(&fingerprints);
+  BrowserThread::GetBlockingPool()->PostWorkerTask(
+      FROM_HERE,
+      base::Bind(&TableBuilder::OnComplete, table_builder_, true));
+}
+
+// static
+uint32 VisitedLinkMaster::NewTableSizeForCount(int32 item_count) {
   // These table sizes are selected to be the maximum prime number less than
   // a "convenient" multiple of 1K.
   static const int table_sizes[] = {
@@ -840,44 +927,54 @@ bool VisitedLinkMaster::RebuildTableFromDelegate() {
 // See the TableBuilder declaration above for how this works.
 void VisitedLinkMaster::OnTableRebuildComplete(
     bool success,
-    const std::vector<Fingerprint>& fingerprints) {
-  if (success) {
-    // Replace the old table with a new blank one.
-    shared_memory_serial_++;
-
-    // We are responsible for freeing it AFTER it has been replaced if
-    // replacement succeeds.
-    base::SharedMemory* old_shared_memory = shared_memory_;
-
-    int new_table_size = NewTableSizeForCount(
-        static_cast<int>(fingerprints.size() + added_since_rebuild_.size()));
-    if (BeginReplaceURLTable(new_table_size)) {
-      // Free the old table.
-      delete old_shared_memory;
-
-      // Add the stored fingerprints to the hash table.
-      for (size_t i = 0; i < fingerprints.size(); i++)
-        AddFingerprint(fingerprints[i], false);
-
-      // Also add anything that was added while we were asynchronously
-      // generating the new table.
-      for (std::set<Fingerprint>::iterator i = added_since_rebuild_.begin();
-           i != added_since_rebuild_.end(); ++i)
-        AddFingerprint(*i, false);
-      added_since_rebuild_.clear();
-
-      // Now handle deletions.
-      DeleteFingerprintsFromCurrentTable(deleted_since_rebuild_);
-      deleted_since_rebuild_.clear();
-
-      // Send an update notification to all child processes.
-      listener_->NewTable(shared_memory_);
-
-      if (persist_to_disk_)
-        WriteFullTable();
+    base::SharedMemory* table_memory,
+    int32 used_count) {
+  table_builder_ = NULL;  // Will release our reference to the builder.
+
+  if (success && table_memory) {
+    InstallTable(table_memory, used_count);
+
+    // The new table was sized for the fingerprints it was built from. If
+    // many URLs were added meanwhile, grow it before adding them.
+    int32 needed_count =
+        used_items_ + static_cast<int32>(added_since_rebuild_.size());
+    if (static_cast<int32>(NewTableSizeForCount(needed_count)) >
+        table_length_) {
+      ResizeTableNow(NewTableSizeForCount(needed_count));
     }
+
+    // Also add anything that was added while we were asynchronously
+    // generating the new table.
+    for (std::set<Fingerprint>::iterator i = added_since_rebuild_.begin();
+         i != added_since_rebuild_.end(); ++i)
+      AddFingerprint(*i, false);
+
+    // Now handle deletions.
+    for (std::set<Fingerprint>::iterator i = deleted_since_rebuild_.begin();
+         i != deleted_since_rebuild_.end(); ++i)
+      DeleteFingerprint(*i, false);
+
+    added_since_rebuild_.clear();
+    deleted_since_rebuild_.clear();
+
+    // Send an update notification to all child processes.
+    listener_->NewTable(shared_memory_);
+
+    // The deletions may have left the table too empty. The resize writes the
+    // new table to disk itself.
+    if (!ResizeTableIfNecessary() && persist_to_disk_)
+      WriteFullTable();
+  } else {
+    // The changes made meanwhile are already in the current table.
+    delete table_memory;
+    added_since_rebuild_.clear();
+    deleted_since_rebuild_.clear();
+
+    // A failed resize leaves those changes unwritten. A failed rebuild from
+    // history has no file yet, and must not leave an incomplete one behind.
+    if (persist_to_disk_ && file_)
+      WriteFullTable();
   }
-  table_builder_ = NULL;  // Will release our reference to the builder.
 
   // Notify the unit test that the rebuild is complete (will be NULL in prod.)
   if (!rebuild_complete_task_.is_null()) {
@@ -952,7 +1049,8 @@ VisitedLinkMaster::TableBuilder::TableBuilder(
     VisitedLinkMaster* master,
     const uint8 salt[LINK_SALT_LENGTH])
     : master_(master),
-      success_(true) {
+      success_(true),
+      used_count_(0) {
   fingerprints_.reserve(4096);
   memcpy(salt_, salt, LINK_SALT_LENGTH * sizeof(uint8));
 }
@@ -963,6 +1061,11 @@ void VisitedLinkMaster::TableBuilder::DisownMaster() {
   master_ = NULL;
 }
 
+void VisitedLinkMaster::TableBuilder::SetFingerprints(
+    Fingerprints* fingerprints) {
+  fingerprints_.swap(*fingerprints);
+}
+
 void VisitedLinkMaster::TableBuilder::OnURL(const GURL& url) {
   if (!url.is_empty()) {
     fingerprints_.push_back(VisitedLinkMaster::ComputeURLFingerprint(
@@ -973,6 +1076,8 @@ void VisitedLinkMaster::TableBuilder::OnURL(const GURL& url) {
 void VisitedLinkMaster::TableBuilder::OnComplete(bool success) {
   success_ = success;
   DLOG_IF(WARNING, !success) << "Unable to rebuild visited links";
+  if (success_)
+    BuildTable();
 
   // Marshal to the main thread to notify the VisitedLinkMaster that the
   // rebuild is complete.
@@ -981,9 +1086,39 @@ void VisitedLinkMaster::TableBuilder::OnComplete(bool success) {
       base::Bind(&TableBuilder::OnCompleteMainThread, this));
 }
 
+void VisitedLinkMaster::TableBuilder::BuildTable() {
+  int32 table_length = NewTableSizeForCount(fingerprints_.size());
+  table_memory_.reset(AllocateTableMemory(table_length, salt_));
+  if (!table_memory_) {
+    success_ = false;
+    return;
+  }
+  Fingerprint* hash_table = reinterpret_cast<Fingerprint*>(
+      static_cast<char*>(table_memory_->memory()) + sizeof(SharedHeader));
+  memset(hash_table, 0, table_length * sizeof(Fingerprint));
+
+  // Linear probing, as in VisitedLinkMaster::AddFingerprint. The table is
+  // sized so that it is at most a third full.
+  used_count_ = 0;
+  for (size_t i = 0; i < fingerprints_.size(); i++) {
+    Fingerprint fingerprint = fingerprints_[i];
+    Hash hash = HashFingerprint(fingerprint, table_length);
+    while (hash_table[hash] && hash_table[hash] != fingerprint)
+      hash = (hash >= table_length - 1) ? 0 : hash + 1;
+    if (!hash_table[hash]) {
+      hash_table[hash] = fingerprint;
+      used_count_++;
+    }
+  }
+  // The fingerprints aren't needed once the table is built.
+  Fingerprints().swap(fingerprints_);
+}
+
 void VisitedLinkMaster::TableBuilder::OnCompleteMainThread() {
-  if (master_)
-    master_->OnTableRebuildComplete(success_, fingerprints_);
+  if (master_) {
+    master_->OnTableRebuildComplete(success_, table_memory_.release(),
+                                    used_count_);
+  }
 }
 
 }  // namespace visitedlink
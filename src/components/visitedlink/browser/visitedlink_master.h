@@ -55,6 +55,10 @@ class VisitedLinkMaster : public VisitedLinkCommon {
     // (hash) of the link.
     virtual void Add(Fingerprint fingerprint) = 0;
 
+    // Called when a few links have been deleted. Only the coloring state of
+    // these links needs to be recalculated.
+    virtual void Delete(const Fingerprints& fingerprints) = 0;
+
     // Called when link coloring state has been reset. This may occur when
     // entire or parts of history were deleted.
     virtual void Reset() = 0;
@@ -148,6 +152,16 @@ class VisitedLinkMaster : public VisitedLinkCommon {
     return listener_.get();
   }
 
+  // Sets the table length from which resizes happen in the background.
+  void set_background_resize_threshold(int32 table_length) {
+    background_resize_threshold_ = table_length;
+  }
+
+  // Returns true while a new table is being built in the background.
+  bool is_building_table() const {
+    return table_builder_.get() != NULL;
+  }
+
   // Call to cause the entire database file to be re-written from scratch
   // to disk. Used by the performance tester.
   void RewriteFile() {
@@ -159,8 +173,9 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   FRIEND_TEST_ALL_PREFIXES(VisitedLinkTest, Delete);
   FRIEND_TEST_ALL_PREFIXES(VisitedLinkTest, BigDelete);
   FRIEND_TEST_ALL_PREFIXES(VisitedLinkTest, BigImport);
+  FRIEND_TEST_ALL_PREFIXES(VisitedLinkTest, BackgroundResizing);
 
-  // Object to rebuild the table on the history thread (see the .cc file).
+  // Object to build a new table off the main thread (see the .cc file).
   class TableBuilder;
 
   // Byte offsets of values in the header.
@@ -185,8 +200,14 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   // When the user is deleting a boatload of URLs, we don't really want to do
   // individual writes for each of them. When the count exceeds this threshold,
   // we will write the whole table to disk at once instead of individual items.
+  // Deletions up to this size are also sent to the renderers individually
+  // instead of resetting all link coloring state.
   static const size_t kBigDeleteThreshold;
 
+  // Tables at least this long are resized on a background thread, since
+  // rehashing them would block the main thread for a noticeable time.
+  static const int32 kBackgroundResizeThreshold;
+
   // Backend for the constructors initializing the members.
   void InitMembers();
 
@@ -276,6 +297,17 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   // a file).
   bool CreateURLTable(int32 num_entries, bool init_to_empty);
 
+  // Allocates and maps shared memory for a table of |num_entries| entries and
+  // fills in the header; the caller initializes the entries. Returns NULL on
+  // failure. This touches no member state, so it may be called on any thread.
+  static base::SharedMemory* AllocateTableMemory(
+      int32 num_entries,
+      const uint8 salt[LINK_SALT_LENGTH]);
+
+  // Replaces the current table with |table_memory|, which holds |used_count|
+  // fingerprints. The old table is freed.
+  void InstallTable(base::SharedMemory* table_memory, int32 used_count);
+
   // A wrapper for CreateURLTable, this will allocate a new table, initialized
   // to empty. The caller is responsible for saving the shared memory pointer
   // and handles before this call (they will be replaced with new ones) and
@@ -296,11 +328,21 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   bool ResizeTableIfNecessary();
 
   // Resizes the table (growing or shrinking) as necessary to accomodate the
-  // current count.
+  // current count. Large tables are rebuilt in the background while lookups
+  // and updates continue on the current one; the new table is published when
+  // it is complete.
   void ResizeTable(int32 new_size);
 
+  // Rehashes the current table into a new one of |new_size| entries on the
+  // calling thread.
+  void ResizeTableNow(int32 new_size);
+
+  // Hands a snapshot of the current fingerprints to a TableBuilder which
+  // builds the resized table on the blocking pool.
+  void ResizeTableInBackground();
+
   // Returns the desired table size for |item_count| URLs.
-  uint32 NewTableSizeForCount(int32 item_count) const;
+  static uint32 NewTableSizeForCount(int32 item_count);
 
   // Computes the table load as fraction. For example, if 1/4 of the entries are
   // full, this value will be 0.25
@@ -317,12 +359,14 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   // the database because something failed.
   bool RebuildTableFromDelegate();
 
-  // Callback that the table rebuilder uses when the rebuild is complete.
-  // |success| is true if the fingerprint generation succeeded, in which case
-  // |fingerprints| will contain the computed fingerprints. On failure, there
-  // will be no fingerprints.
+  // Callback that the table builder uses when a rebuild or resize is
+  // complete. |success| is true if the fingerprint generation succeeded, in
+  // which case |table_memory| holds a table of |used_count| fingerprints,
+  // ownership of which is passed to this object. On failure |table_memory|
+  // will be NULL.
   void OnTableRebuildComplete(bool success,
-                              const std::vector<Fingerprint>& fingerprints);
+                              base::SharedMemory* table_memory,
+                              int32 used_count);
 
   // Increases or decreases the given hash value by one, wrapping around as
   // necessary. Used for probing.
@@ -361,12 +405,15 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   base::SequencedWorkerPool::SequenceToken sequence_token_;
 
   // When non-NULL, indicates we are in database rebuild mode and points to
-  // the class collecting fingerprint information from the history system.
+  // the class collecting fingerprint information from the history system, or
+  // from the current table when resizing it in the background.
   // The pointer is owned by this class, but it must remain valid while the
   // history query is running. We must only delete it when the query is done.
   scoped_refptr<TableBuilder> table_builder_;
 
   // Indicates URLs added and deleted since we started rebuilding the table.
+  // These changes are also made to the current table, so lookups stay
+  // correct while the new table is being built.
   std::set<Fingerprint> added_since_rebuild_;
   std::set<Fingerprint> deleted_since_rebuild_;
 
@@ -414,6 +461,10 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   // When nonzero, overrides the table size for new databases for testing
   int32 table_size_override_;
 
+  // Tables at least this long are resized in the background. This is
+  // kBackgroundResizeThreshold except in tests.
+  int32 background_resize_threshold_;
+
   // When set, indicates the task that should be run after the next rebuild from
   // history is complete.
   base::Closure rebuild_complete_task_;
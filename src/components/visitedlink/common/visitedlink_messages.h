@@ -18,8 +18,8 @@
 IPC_MESSAGE_CONTROL1(ChromeViewMsg_VisitedLink_NewTable,
                      base::SharedMemoryHandle)
 
-// History system notification that a link has been added and the link
-// coloring state for the given hash must be re-calculated.
+// History system notification that links have been added or deleted and the
+// link coloring state for the given hashes must be re-calculated.
 IPC_MESSAGE_CONTROL1(ChromeViewMsg_VisitedLink_Add, std::vector<uint64>)
 
 // History system notification that one or more history items have been
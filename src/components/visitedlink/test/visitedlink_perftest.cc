@@ -10,9 +10,12 @@
 #include "base/files/file_path.h"
 #include "base/memory/shared_memory.h"
 #include "base/perftimer.h"
+#include "base/run_loop.h"
 #include "base/strings/stringprintf.h"
 #include "base/test/test_file_util.h"
+#include "base/time/time.h"
 #include "components/visitedlink/browser/visitedlink_master.h"
+#include "content/public/test/test_browser_thread_bundle.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "url/gurl.h"
 
@@ -25,6 +28,7 @@ namespace {
 // how we generate URLs, note that the two strings should be the same length
 const int add_count = 10000;
 const int load_test_add_count = 250000;
+const int resize_test_add_count = 1000000;
 const char added_prefix[] = "http://www.google.com/stuff/something/foo?session=85025602345625&id=1345142319023&seq=";
 const char unadded_prefix[] = "http://www.google.org/stuff/something/foo?session=39586739476365&id=2347624314402&seq=";
 
@@ -39,6 +43,7 @@ class DummyVisitedLinkEventListener : public VisitedLinkMaster::Listener {
   DummyVisitedLinkEventListener() {}
   virtual void NewTable(base::SharedMemory* table) OVERRIDE {}
   virtual void Add(VisitedLinkCommon::Fingerprint) OVERRIDE {}
+  virtual void Delete(const VisitedLinkCommon::Fingerprints&) OVERRIDE {}
   virtual void Reset() OVERRIDE {}
 };
 
@@ -70,6 +75,35 @@ class VisitedLink : public testing::Test {
   }
 };
 
+// Adds |count| URLs to |master| one at a time, as the UI thread would, and
+// logs the longest time a single add blocked for. Resizes happen along the
+// way; when they are done in the background, the new tables are picked up as
+// the message loop runs.
+void TimeAddBlocking(VisitedLinkMaster* master, int count,
+                     const std::string& name) {
+  TimeDelta total;
+  TimeDelta longest;
+  for (int i = 0; i < count; i++) {
+    GURL url(TestURL(added_prefix, i));
+    base::TimeTicks start = base::TimeTicks::HighResNow();
+    master->AddURL(url);
+    TimeDelta elapsed = base::TimeTicks::HighResNow() - start;
+    total += elapsed;
+    longest = std::max(longest, elapsed);
+    if (i % 1000 == 0)
+      base::RunLoop().RunUntilIdle();
+  }
+  while (master->is_building_table()) {
+    base::RunLoop run_loop;
+    master->set_rebuild_complete_task(run_loop.QuitClosure());
+    run_loop.Run();
+  }
+  LogPerfResult(("Visited_link_add_total_" + name).c_str(),
+                total.InMillisecondsF(), "ms");
+  LogPerfResult(("Visited_link_add_longest_block_" + name).c_str(),
+                longest.InMillisecondsF(), "ms");
+}
+
 } // namespace
 
 // This test tests adding many things to a database, and how long it takes
@@ -196,4 +230,25 @@ TEST_F(VisitedLink, TestLoad) {
                 hot_sum / hot_load_times.size(), "ms");
 }
 
+// Measures how long the UI thread is blocked while growing a table to 1M
+// links, with resizes done synchronously and in the background.
+TEST_F(VisitedLink, TestResizeBlocking) {
+  content::TestBrowserThreadBundle thread_bundle;
+  {
+    VisitedLinkMaster master(new DummyVisitedLinkEventListener(),
+                             NULL, false, true, db_path_, 0);
+    ASSERT_TRUE(master.Init());
+    master.set_background_resize_threshold(kint32max);
+    TimeAddBlocking(&master, resize_test_add_count, "sync_resize");
+    EXPECT_EQ(resize_test_add_count, master.GetUsedCount());
+  }
+  {
+    VisitedLinkMaster master(new DummyVisitedLinkEventListener(),
+                             NULL, false, true, db_path_, 0);
+    ASSERT_TRUE(master.Init());
+    TimeAddBlocking(&master, resize_test_add_count, "background_resize");
+    EXPECT_EQ(resize_test_add_count, master.GetUsedCount());
+  }
+}
+
 }  // namespace visitedlink
@@ -107,7 +107,8 @@ class TrackingVisitedLinkEventListener : public VisitedLinkMaster::Listener {
  public:
   TrackingVisitedLinkEventListener()
       : reset_count_(0),
-        add_count_(0) {}
+        add_count_(0),
+        delete_count_(0) {}
 
   virtual void NewTable(base::SharedMemory* table) OVERRIDE {
     if (table) {
@@ -120,19 +121,26 @@ class TrackingVisitedLinkEventListener : public VisitedLinkMaster::Listener {
     }
   }
   virtual void Add(VisitedLinkCommon::Fingerprint) OVERRIDE { add_count_++; }
+  virtual void Delete(
+      const VisitedLinkCommon::Fingerprints& fingerprints) OVERRIDE {
+    delete_count_ += fingerprints.size();
+  }
   virtual void Reset() OVERRIDE { reset_count_++; }
 
   void SetUp() {
     reset_count_ = 0;
     add_count_ = 0;
+    delete_count_ = 0;
   }
 
   int reset_count() const { return reset_count_; }
   int add_count() const { return add_count_; }
+  int delete_count() const { return delete_count_; }
 
  private:
   int reset_count_;
   int add_count_;
+  int delete_count_;
 };
 
 class VisitedLinkTest : public testing::Test {
@@ -400,6 +408,52 @@ TEST_F(VisitedLinkTest, Resizing) {
   Reload();
 }
 
+// Tests that resizing in the background keeps the table usable while the new
+// table is built, and publishes a table with every change made meanwhile.
+TEST_F(VisitedLinkTest, BackgroundResizing) {
+  const int32 initial_size = 17;
+  ASSERT_TRUE(InitVisited(initial_size, true));
+  master_->set_background_resize_threshold(1);
+
+  VisitedLinkSlave slave;
+  base::SharedMemoryHandle new_handle = base::SharedMemory::NULLHandle();
+  master_->shared_memory()->ShareToProcess(
+      base::GetCurrentProcessHandle(), &new_handle);
+  slave.OnUpdateVisitedLinks(new_handle);
+  g_slaves.push_back(&slave);
+
+  // Fill the table past the resize point, then keep adding and delete one
+  // URL while the new table is being built.
+  int i = 0;
+  while (!master_->is_building_table())
+    master_->AddURL(TestURL(i++));
+  EXPECT_EQ(initial_size, master_->table_length_);
+  EXPECT_TRUE(master_->IsVisited(TestURL(0)));
+  for (; i < g_test_count; i++)
+    master_->AddURL(TestURL(i));
+  URLs urls_to_delete;
+  urls_to_delete.push_back(TestURL(0));
+  TestURLIterator iterator(urls_to_delete);
+  master_->DeleteURLs(&iterator);
+
+  while (master_->is_building_table()) {
+    base::RunLoop run_loop;
+    master_->set_rebuild_complete_task(run_loop.QuitClosure());
+    run_loop.Run();
+  }
+
+  EXPECT_GT(master_->table_length_, initial_size);
+  EXPECT_EQ(g_test_count - 1, master_->GetUsedCount());
+  EXPECT_FALSE(master_->IsVisited(TestURL(0)));
+  EXPECT_FALSE(slave.IsVisited(TestURL(0)));
+  for (i = 1; i < g_test_count; i++) {
+    EXPECT_TRUE(master_->IsVisited(TestURL(i)));
+    EXPECT_TRUE(slave.IsVisited(TestURL(i)));
+  }
+  master_->DebugValidate();
+  g_slaves.clear();
+}
+
 // Tests that if the database doesn't exist, it will be rebuilt from history.
 TEST_F(VisitedLinkTest, Rebuild) {
   // Add half of our URLs to history. This needs to be done before we
@@ -487,9 +541,10 @@ TEST_F(VisitedLinkTest, Listener) {
 
   // Verify that VisitedLinkMaster::Listener::Add was called for each added URL.
   EXPECT_EQ(g_test_count, listener->add_count());
-  // Verify that VisitedLinkMaster::Listener::Reset was called both when one and
-  // all URLs are deleted.
-  EXPECT_EQ(2, listener->reset_count());
+  // Verify that VisitedLinkMaster::Listener::Delete was called for the single
+  // deleted URL, and Reset only when all URLs are deleted.
+  EXPECT_EQ(1, listener->delete_count());
+  EXPECT_EQ(1, listener->reset_count());
 }
 
 class VisitCountingContext : public content::TestBrowserContext {
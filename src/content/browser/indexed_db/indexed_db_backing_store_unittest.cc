@@ -4,13 +4,17 @@
 
 #include "content/browser/indexed_db/indexed_db_backing_store.h"
 
+#include "base/compiler_specific.h"
 #include "base/file_util.h"
 #include "base/files/scoped_temp_dir.h"
 #include "base/logging.h"
 #include "base/strings/string16.h"
+#include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
 #include "content/browser/indexed_db/indexed_db_factory.h"
+#include "content/browser/indexed_db/indexed_db_index_writer.h"
 #include "content/browser/indexed_db/indexed_db_leveldb_coding.h"
+#include "content/common/indexed_db/indexed_db_key_range.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "third_party/WebKit/public/platform/WebIDBTypes.h"
 #include "url/gurl.h"
@@ -318,6 +322,144 @@ TEST_F(IndexedDBBackingStoreTest, CreateDatabase) {
   }
 }
 
+const int64 kPopulationDatabaseId = 1;
+const int64 kPopulationObjectStoreId = 1;
+const int64 kPopulationIndexId = kMinimumIndexId;
+// With ~2KB index keys this is well past the 16MB the index population
+// buffer holds before it is flushed.
+const int kPopulationRecordCount = 10000;
+
+// Index keys sort in the reverse order of their records, so every flush has
+// to reorder the entries it writes.
+IndexedDBKey PopulationIndexKey(int record) {
+  return IndexedDBKey(
+      ASCIIToUTF16(base::StringPrintf("%05d", kPopulationRecordCount - record)
+                   + std::string(1024, 'x')));
+}
+
+// Populates an index over kPopulationRecordCount records the way
+// IndexedDBDatabase::SetIndexKeys does for a non-unique index: entries go
+// through an IndexPopulationBuffer, which is flushed into |transaction|
+// whenever it fills up and once more at the end.
+class IndexedDBIndexPopulationTest : public IndexedDBBackingStoreTest {
+ public:
+  virtual void SetUp() OVERRIDE {
+    IndexedDBBackingStoreTest::SetUp();
+    IndexedDBBackingStore::Transaction transaction(backing_store_);
+    transaction.Begin();
+    for (int i = 0; i < kPopulationRecordCount; ++i) {
+      IndexedDBBackingStore::RecordIdentifier record;
+      ASSERT_TRUE(backing_store_->PutRecord(
+          &transaction,
+          kPopulationDatabaseId,
+          kPopulationObjectStoreId,
+          IndexedDBKey(i, WebKit::WebIDBKeyTypeNumber),
+          m_value1,
+          &record));
+    }
+    ASSERT_TRUE(transaction.Commit());
+  }
+
+ protected:
+  void PopulateIndex(IndexedDBBackingStore::Transaction* transaction,
+                     IndexPopulationBuffer* buffer) {
+    scoped_ptr<IndexedDBBackingStore::Cursor> cursor =
+        backing_store_->OpenObjectStoreCursor(transaction,
+                                              kPopulationDatabaseId,
+                                              kPopulationObjectStoreId,
+                                              IndexedDBKeyRange(),
+                                              indexed_db::CURSOR_NEXT);
+    ASSERT_TRUE(cursor);
+    int flushes = 0;
+    do {
+      buffer->Add(kPopulationDatabaseId,
+                  kPopulationObjectStoreId,
+                  kPopulationIndexId,
+                  PopulationIndexKey(static_cast<int>(cursor->key().number())),
+                  cursor->record_identifier());
+      if (buffer->IsFull()) {
+        ASSERT_TRUE(buffer->Flush(backing_store_, transaction));
+        EXPECT_TRUE(buffer->empty());
+        ++flushes;
+      }
+    } while (cursor->Continue());
+    // The test is only meaningful if the cap was hit part way through.
+    EXPECT_GT(flushes, 0);
+    EXPECT_FALSE(buffer->empty());
+  }
+
+  bool IndexIsEmpty() {
+    IndexedDBBackingStore::Transaction transaction(backing_store_);
+    transaction.Begin();
+    scoped_ptr<IndexedDBBackingStore::Cursor> cursor =
+        backing_store_->OpenIndexKeyCursor(&transaction,
+                                           kPopulationDatabaseId,
+                                           kPopulationObjectStoreId,
+                                           kPopulationIndexId,
+                                           IndexedDBKeyRange(),
+                                           indexed_db::CURSOR_NEXT);
+    bool empty = !cursor;
+    cursor.reset();
+    transaction.Commit();
+    return empty;
+  }
+};
+
+TEST_F(IndexedDBIndexPopulationTest, EntriesPastBufferCapAreCommitted) {
+  {
+    IndexedDBBackingStore::Transaction transaction(backing_store_);
+    transaction.Begin();
+    IndexPopulationBuffer buffer;
+    PopulateIndex(&transaction, &buffer);
+    ASSERT_TRUE(buffer.Flush(backing_store_, &transaction));
+    EXPECT_TRUE(transaction.Commit());
+  }
+
+  IndexedDBBackingStore::Transaction transaction(backing_store_);
+  transaction.Begin();
+  for (int i = 0; i < kPopulationRecordCount; ++i) {
+    scoped_ptr<IndexedDBKey> primary_key;
+    ASSERT_TRUE(backing_store_->GetPrimaryKeyViaIndex(&transaction,
+                                                      kPopulationDatabaseId,
+                                                      kPopulationObjectStoreId,
+                                                      kPopulationIndexId,
+                                                      PopulationIndexKey(i),
+                                                      &primary_key));
+    ASSERT_TRUE(primary_key) << "record " << i;
+    EXPECT_TRUE(primary_key->IsEqual(
+        IndexedDBKey(i, WebKit::WebIDBKeyTypeNumber))) << "record " << i;
+  }
+
+  scoped_ptr<IndexedDBBackingStore::Cursor> cursor =
+      backing_store_->OpenIndexKeyCursor(&transaction,
+                                         kPopulationDatabaseId,
+                                         kPopulationObjectStoreId,
+                                         kPopulationIndexId,
+                                         IndexedDBKeyRange(),
+                                         indexed_db::CURSOR_NEXT);
+  ASSERT_TRUE(cursor);
+  int count = 1;
+  while (cursor->Continue())
+    ++count;
+  EXPECT_EQ(kPopulationRecordCount, count);
+  cursor.reset();
+  EXPECT_TRUE(transaction.Commit());
+}
+
+TEST_F(IndexedDBIndexPopulationTest, AbortWritesNothing) {
+  {
+    IndexedDBBackingStore::Transaction transaction(backing_store_);
+    transaction.Begin();
+    IndexPopulationBuffer buffer;
+    PopulateIndex(&transaction, &buffer);
+    // What IndexedDBTransaction::Abort does: the entries flushed so far are
+    // rolled back with the transaction, and the rest are dropped.
+    buffer.Clear();
+    transaction.Rollback();
+  }
+  EXPECT_TRUE(IndexIsEmpty());
+}
+
 class MockIDBFactory : public IndexedDBFactory {
  public:
   scoped_refptr<IndexedDBBackingStore> TestOpenBackingStore(
@@ -140,10 +140,17 @@ void IndexedDBCursor::CursorPrefetchIterationOperation::Perform(
 
   if (cursor_->cursor_)
     cursor_->saved_cursor_.reset(cursor_->cursor_->Clone());
-  const size_t max_size_estimate = 10 * 1024 * 1024;
+  const base::TimeTicks now = base::TimeTicks::Now();
+  const int number_to_fetch =
+      cursor_->prefetch_policy_.NextBatchSize(number_to_fetch_, now);
+  const size_t max_size_estimate = IndexedDBPrefetchPolicy::kMaxBatchBytes;
   size_t size_estimate = 0;
 
-  for (int i = 0; i < number_to_fetch_; ++i) {
+  found_keys.reserve(number_to_fetch);
+  found_primary_keys.reserve(number_to_fetch);
+  found_values.reserve(number_to_fetch);
+
+  for (int i = 0; i < number_to_fetch; ++i) {
     if (!cursor_->cursor_ || !cursor_->cursor_->Continue()) {
       cursor_->cursor_.reset();
       break;
@@ -157,10 +164,11 @@ void IndexedDBCursor::CursorPrefetchIterationOperation::Perform(
         found_values.push_back(std::string());
         break;
       case indexed_db::CURSOR_KEY_AND_VALUE: {
-        std::string value;
-        value.swap(*cursor_->cursor_->Value());
-        size_estimate += value.size();
-        found_values.push_back(value);
+        // Swap the value in rather than copying it; the backing store cursor
+        // doesn't need it once it has advanced.
+        found_values.push_back(std::string());
+        found_values.back().swap(*cursor_->cursor_->Value());
+        size_estimate += found_values.back().size();
         break;
       }
       default:
@@ -173,6 +181,8 @@ void IndexedDBCursor::CursorPrefetchIterationOperation::Perform(
       break;
   }
 
+  cursor_->prefetch_policy_.DidFetch(found_keys.size(), size_estimate, now);
+
   if (!found_keys.size()) {
     callbacks_->OnSuccess(static_cast<std::string*>(NULL));
     return;
@@ -182,8 +192,10 @@ void IndexedDBCursor::CursorPrefetchIterationOperation::Perform(
       found_keys, found_primary_keys, found_values);
 }
 
-void IndexedDBCursor::PrefetchReset(int used_prefetches, int) {
+void IndexedDBCursor::PrefetchReset(int used_prefetches,
+                                    int unused_prefetches) {
   IDB_TRACE("IndexedDBCursor::PrefetchReset");
+  prefetch_policy_.DidReset(used_prefetches, unused_prefetches);
   cursor_.swap(saved_cursor_);
   saved_cursor_.reset();
 
@@ -12,6 +12,7 @@
 #include "base/memory/scoped_ptr.h"
 #include "content/browser/indexed_db/indexed_db_backing_store.h"
 #include "content/browser/indexed_db/indexed_db_database.h"
+#include "content/browser/indexed_db/indexed_db_prefetch_policy.h"
 #include "content/common/indexed_db/indexed_db_key_range.h"
 
 namespace content {
@@ -59,6 +60,9 @@ class CONTENT_EXPORT IndexedDBCursor
   // Must be destroyed before transaction_.
   scoped_ptr<IndexedDBBackingStore::Cursor> saved_cursor_;
 
+  // Sizes prefetch batches by observed iteration rate and record size.
+  IndexedDBPrefetchPolicy prefetch_policy_;
+
   bool closed_;
 };
 
@@ -0,0 +1,121 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/compiler_specific.h"
+#include "base/logging.h"
+#include "base/perftimer.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "content/browser/indexed_db/indexed_db_backing_store.h"
+#include "content/browser/indexed_db/indexed_db_prefetch_policy.h"
+#include "content/common/indexed_db/indexed_db_key.h"
+#include "content/common/indexed_db/indexed_db_key_range.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/WebKit/public/platform/WebIDBTypes.h"
+
+namespace content {
+
+namespace {
+
+const int64 kDatabaseId = 1;
+const int64 kObjectStoreId = 1;
+const int kRecordCount = 1000000;
+const size_t kValueSize = 100;
+
+// Fixed-size batches matching the renderer's historical maximum.
+const int kFixedBatchSize = 100;
+
+class IndexedDBCursorPerfTest : public testing::Test {
+ public:
+  virtual void SetUp() OVERRIDE {
+    backing_store_ = IndexedDBBackingStore::OpenInMemory(std::string());
+    ASSERT_TRUE(backing_store_);
+
+    IndexedDBBackingStore::Transaction transaction(backing_store_);
+    transaction.Begin();
+    const std::string value(kValueSize, 'x');
+    for (int i = 0; i < kRecordCount; ++i) {
+      IndexedDBBackingStore::RecordIdentifier record;
+      ASSERT_TRUE(backing_store_->PutRecord(
+          &transaction,
+          kDatabaseId,
+          kObjectStoreId,
+          IndexedDBKey(i, WebKit::WebIDBKeyTypeNumber),
+          value,
+          &record));
+    }
+    ASSERT_TRUE(transaction.Commit());
+  }
+
+  // Iterates the whole object store the way a prefetching cursor does:
+  // batches of records are copied out of the backing store cursor, and the
+  // next batch is requested once the previous one has been consumed.
+  void IterateInBatches(const char* name, bool adaptive) {
+    IndexedDBBackingStore::Transaction transaction(backing_store_);
+    transaction.Begin();
+    scoped_ptr<IndexedDBBackingStore::Cursor> cursor =
+        backing_store_->OpenObjectStoreCursor(&transaction,
+                                              kDatabaseId,
+                                              kObjectStoreId,
+                                              IndexedDBKeyRange(),
+                                              indexed_db::CURSOR_NEXT);
+    ASSERT_TRUE(cursor);
+
+    IndexedDBPrefetchPolicy policy;
+    int records = 1;  // The cursor is positioned on the first record.
+    int batches = 0;
+    base::TimeTicks start = base::TimeTicks::Now();
+    {
+      PerfTimeLogger timer(name);
+      bool done = false;
+      while (!done) {
+        base::TimeTicks now = base::TimeTicks::Now();
+        int batch_size = adaptive
+                             ? policy.NextBatchSize(kFixedBatchSize, now)
+                             : kFixedBatchSize;
+        std::vector<IndexedDBKey> keys;
+        std::vector<std::string> values;
+        keys.reserve(batch_size);
+        values.reserve(batch_size);
+        size_t size_estimate = 0;
+        for (int i = 0; i < batch_size; ++i) {
+          if (!cursor->Continue()) {
+            done = true;
+            break;
+          }
+          keys.push_back(cursor->key());
+          values.push_back(std::string());
+          values.back().swap(*cursor->Value());
+          size_estimate += values.back().size() + keys.back().size_estimate();
+        }
+        policy.DidFetch(keys.size(), size_estimate, now);
+        records += keys.size();
+        ++batches;
+      }
+      timer.Done();
+    }
+    double seconds = (base::TimeTicks::Now() - start).InSecondsF();
+    EXPECT_EQ(kRecordCount, records);
+    LOG(INFO) << base::StringPrintf("%s: %d batches, %.0f records/sec",
+                                    name,
+                                    batches,
+                                    records / seconds);
+    transaction.Commit();
+  }
+
+ protected:
+  scoped_refptr<IndexedDBBackingStore> backing_store_;
+};
+
+}  // namespace
+
+TEST_F(IndexedDBCursorPerfTest, FixedBatches) {
+  IterateInBatches("IndexedDB_cursor_fixed_prefetch", false);
+}
+
+TEST_F(IndexedDBCursorPerfTest, AdaptiveBatches) {
+  IterateInBatches("IndexedDB_cursor_adaptive_prefetch", true);
+}
+
+}  // namespace content
@@ -1221,14 +1221,31 @@ void IndexedDBDatabase::SetIndexKeys(int64 transaction_id,
     return;
   }
 
+  // Entries for non-unique indexes are buffered until SetIndexesReady so the
+  // population cursor isn't invalidated by every write. Unique indexes must
+  // be written immediately so later records are checked against them.
   for (size_t i = 0; i < index_writers.size(); ++i) {
     IndexWriter* index_writer = index_writers[i];
+    if (!index_writer->unique()) {
+      index_writer->BufferIndexKeys(record_identifier,
+                                    id(),
+                                    object_store_id,
+                                    transaction->index_population_buffer());
+      continue;
+    }
     index_writer->WriteIndexKeys(record_identifier,
                                  store,
                                  transaction->BackingStoreTransaction(),
                                  id(),
                                  object_store_id);
   }
+
+  if (transaction->index_population_buffer()->IsFull() &&
+      !transaction->FlushIndexPopulationBuffer()) {
+    transaction->Abort(IndexedDBDatabaseError(
+        WebKit::WebIDBDatabaseExceptionUnknownError,
+        "Internal error: backing store error populating index keys."));
+  }
 }
 
 void IndexedDBDatabase::SetIndexesReady(int64 transaction_id,
@@ -1246,6 +1263,12 @@ void IndexedDBDatabase::SetIndexesReady(int64 transaction_id,
 
 void SetIndexesReadyOperation::Perform(IndexedDBTransaction* transaction) {
   IDB_TRACE("SetIndexesReadyOperation");
+  if (!transaction->FlushIndexPopulationBuffer()) {
+    transaction->Abort(IndexedDBDatabaseError(
+        WebKit::WebIDBDatabaseExceptionUnknownError,
+        "Internal error: backing store error populating index keys."));
+    return;
+  }
   for (size_t i = 0; i < index_count_; ++i)
     transaction->DidCompletePreemptiveEvent();
 }
@@ -4,6 +4,8 @@
 
 #include "content/browser/indexed_db/indexed_db_index_writer.h"
 
+#include <algorithm>
+
 #include "base/logging.h"
 #include "base/strings/utf_string_conversions.h"
 #include "content/browser/indexed_db/indexed_db_backing_store.h"
@@ -15,6 +17,11 @@
 
 namespace content {
 
+// Buffered entries are written out early once they take up this much memory,
+// so that populating an index over a very large object store doesn't hold
+// all of its entries at once.
+static const size_t kMaxIndexPopulationBufferSize = 16 * 1024 * 1024;
+
 IndexWriter::IndexWriter(
     const IndexedDBIndexMetadata& index_metadata)
     : index_metadata_(index_metadata) {}
@@ -80,6 +87,21 @@ void IndexWriter::WriteIndexKeys(
   }
 }
 
+void IndexWriter::BufferIndexKeys(
+    const IndexedDBBackingStore::RecordIdentifier& record_identifier,
+    int64 database_id,
+    int64 object_store_id,
+    IndexPopulationBuffer* buffer) const {
+  DCHECK(!index_metadata_.unique);
+  for (size_t i = 0; i < index_keys_.size(); ++i) {
+    buffer->Add(database_id,
+                object_store_id,
+                index_metadata_.id,
+                index_keys_[i],
+                record_identifier);
+  }
+}
+
 bool IndexWriter::AddingKeyAllowed(
     IndexedDBBackingStore* backing_store,
     IndexedDBBackingStore::Transaction* transaction,
@@ -166,4 +188,76 @@ bool MakeIndexWriters(
   return true;
 }
 
+IndexPopulationBuffer::Entry::Entry()
+    : database_id(0), object_store_id(0), index_id(0), version(0) {}
+
+IndexPopulationBuffer::Entry::~Entry() {}
+
+IndexPopulationBuffer::IndexPopulationBuffer() : size_estimate_(0) {}
+
+IndexPopulationBuffer::~IndexPopulationBuffer() {}
+
+void IndexPopulationBuffer::Add(
+    int64 database_id,
+    int64 object_store_id,
+    int64 index_id,
+    const IndexedDBKey& index_key,
+    const IndexedDBBackingStore::RecordIdentifier& record_identifier) {
+  entries_.push_back(Entry());
+  Entry& entry = entries_.back();
+  entry.database_id = database_id;
+  entry.object_store_id = object_store_id;
+  entry.index_id = index_id;
+  entry.index_key = index_key;
+  entry.encoded_primary_key = record_identifier.primary_key();
+  entry.version = record_identifier.version();
+  size_estimate_ += sizeof(Entry) + index_key.size_estimate() +
+                    entry.encoded_primary_key.size();
+}
+
+bool IndexPopulationBuffer::IsFull() const {
+  return size_estimate_ >= kMaxIndexPopulationBufferSize;
+}
+
+void IndexPopulationBuffer::Clear() {
+  entries_.clear();
+  size_estimate_ = 0;
+}
+
+// static
+bool IndexPopulationBuffer::EntryLessThan(const Entry& a, const Entry& b) {
+  if (a.database_id != b.database_id)
+    return a.database_id < b.database_id;
+  if (a.object_store_id != b.object_store_id)
+    return a.object_store_id < b.object_store_id;
+  if (a.index_id != b.index_id)
+    return a.index_id < b.index_id;
+  return a.index_key.IsLessThan(b.index_key);
+}
+
+bool IndexPopulationBuffer::Flush(
+    IndexedDBBackingStore* store,
+    IndexedDBBackingStore::Transaction* transaction) {
+  IDB_TRACE("IndexPopulationBuffer::Flush");
+  // Records were visited in primary key order, which is also the order
+  // duplicates within an index are stored in, so a stable sort keeps
+  // insertions into the transaction's tree sequential.
+  std::stable_sort(entries_.begin(), entries_.end(), EntryLessThan);
+
+  bool ok = true;
+  for (size_t i = 0; i < entries_.size() && ok; ++i) {
+    const Entry& entry = entries_[i];
+    IndexedDBBackingStore::RecordIdentifier record_identifier(
+        entry.encoded_primary_key, entry.version);
+    ok = store->PutIndexDataForRecord(transaction,
+                                      entry.database_id,
+                                      entry.object_store_id,
+                                      entry.index_id,
+                                      entry.index_key,
+                                      record_identifier);
+  }
+  Clear();
+  return ok;
+}
+
 }  // namespace content
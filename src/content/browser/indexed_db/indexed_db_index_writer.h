@@ -17,6 +17,7 @@
 
 namespace content {
 
+class IndexPopulationBuffer;
 class IndexedDBTransaction;
 struct IndexedDBObjectStoreMetadata;
 
@@ -42,6 +43,17 @@ class IndexWriter {
                       int64 database_id,
                       int64 object_store_id) const;
 
+  // Defers this writer's index entries to |buffer| instead of writing them
+  // through the transaction. Only valid for non-unique indexes, since
+  // uniqueness checks can't see buffered entries.
+  void BufferIndexKeys(
+      const IndexedDBBackingStore::RecordIdentifier& record,
+      int64 database_id,
+      int64 object_store_id,
+      IndexPopulationBuffer* buffer) const;
+
+  bool unique() const { return index_metadata_.unique; }
+
   ~IndexWriter();
 
  private:
@@ -58,6 +70,57 @@ class IndexWriter {
   IndexedDBDatabase::IndexKeys index_keys_;
 };
 
+// Collects index entries produced while populating newly created indexes in
+// a version change transaction. Each record written through the
+// LevelDBTransaction invalidates the iterator of the cursor driving the
+// population, forcing it to re-seek on every step; buffering the entries and
+// writing them in key order once the indexes are ready avoids that.
+class IndexPopulationBuffer {
+ public:
+  IndexPopulationBuffer();
+  ~IndexPopulationBuffer();
+
+  void Add(int64 database_id,
+           int64 object_store_id,
+           int64 index_id,
+           const IndexedDBKey& index_key,
+           const IndexedDBBackingStore::RecordIdentifier& record);
+
+  // Writes all buffered entries, sorted by index and key, and empties the
+  // buffer.
+  bool Flush(IndexedDBBackingStore* store,
+             IndexedDBBackingStore::Transaction* transaction)
+      WARN_UNUSED_RESULT;
+
+  // Returns true once the buffered entries take up enough memory that they
+  // should be flushed before more are added.
+  bool IsFull() const;
+
+  void Clear();
+  bool empty() const { return entries_.empty(); }
+  size_t size() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    Entry();
+    ~Entry();
+
+    int64 database_id;
+    int64 object_store_id;
+    int64 index_id;
+    IndexedDBKey index_key;
+    std::string encoded_primary_key;
+    int64 version;
+  };
+
+  static bool EntryLessThan(const Entry& a, const Entry& b);
+
+  std::vector<Entry> entries_;
+  size_t size_estimate_;
+
+  DISALLOW_COPY_AND_ASSIGN(IndexPopulationBuffer);
+};
+
 bool MakeIndexWriters(
     scoped_refptr<IndexedDBTransaction> transaction,
     IndexedDBBackingStore* store,
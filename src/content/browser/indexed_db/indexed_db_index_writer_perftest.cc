@@ -0,0 +1,120 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/indexed_db/indexed_db_index_writer.h"
+
+#include "base/compiler_specific.h"
+#include "base/perftimer.h"
+#include "content/browser/indexed_db/indexed_db_backing_store.h"
+#include "content/common/indexed_db/indexed_db_key.h"
+#include "content/common/indexed_db/indexed_db_key_range.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/WebKit/public/platform/WebIDBTypes.h"
+
+namespace content {
+
+namespace {
+
+const int64 kDatabaseId = 1;
+const int64 kObjectStoreId = 1;
+const int64 kIndexId = 30;
+const int kRecordCount = 1000000;
+// Many records share each index key, as with a typical secondary index.
+const int kDistinctIndexKeys = 1000;
+
+class IndexedDBIndexPopulationPerfTest : public testing::Test {
+ public:
+  virtual void SetUp() OVERRIDE {
+    backing_store_ = IndexedDBBackingStore::OpenInMemory(std::string());
+    ASSERT_TRUE(backing_store_);
+
+    IndexedDBBackingStore::Transaction transaction(backing_store_);
+    transaction.Begin();
+    const std::string value(100, 'x');
+    for (int i = 0; i < kRecordCount; ++i) {
+      IndexedDBBackingStore::RecordIdentifier record;
+      ASSERT_TRUE(backing_store_->PutRecord(
+          &transaction,
+          kDatabaseId,
+          kObjectStoreId,
+          IndexedDBKey(i, WebKit::WebIDBKeyTypeNumber),
+          value,
+          &record));
+    }
+    ASSERT_TRUE(transaction.Commit());
+  }
+
+  // Mirrors index population: a cursor walks the object store and, for each
+  // record, the index entry is either written immediately or buffered.
+  void Populate(const char* name, bool buffered) {
+    IndexedDBBackingStore::Transaction transaction(backing_store_);
+    transaction.Begin();
+    IndexPopulationBuffer buffer;
+    {
+      PerfTimeLogger timer(name);
+      scoped_ptr<IndexedDBBackingStore::Cursor> cursor =
+          backing_store_->OpenObjectStoreCursor(&transaction,
+                                                kDatabaseId,
+                                                kObjectStoreId,
+                                                IndexedDBKeyRange(),
+                                                indexed_db::CURSOR_NEXT);
+      ASSERT_TRUE(cursor);
+      do {
+        const IndexedDBKey index_key(
+            static_cast<int>(cursor->key().number()) % kDistinctIndexKeys,
+            WebKit::WebIDBKeyTypeNumber);
+        if (buffered) {
+          buffer.Add(kDatabaseId,
+                     kObjectStoreId,
+                     kIndexId,
+                     index_key,
+                     cursor->record_identifier());
+        } else {
+          ASSERT_TRUE(backing_store_->PutIndexDataForRecord(
+              &transaction,
+              kDatabaseId,
+              kObjectStoreId,
+              kIndexId,
+              index_key,
+              cursor->record_identifier()));
+        }
+      } while (cursor->Continue());
+      cursor.reset();
+      EXPECT_TRUE(buffer.Flush(backing_store_, &transaction));
+      EXPECT_TRUE(transaction.Commit());
+      timer.Done();
+    }
+
+    IndexedDBBackingStore::Transaction verify(backing_store_);
+    verify.Begin();
+    scoped_ptr<IndexedDBBackingStore::Cursor> index_cursor =
+        backing_store_->OpenIndexKeyCursor(&verify,
+                                           kDatabaseId,
+                                           kObjectStoreId,
+                                           kIndexId,
+                                           IndexedDBKeyRange(),
+                                           indexed_db::CURSOR_NEXT);
+    ASSERT_TRUE(index_cursor);
+    int count = 1;
+    while (index_cursor->Continue())
+      ++count;
+    EXPECT_EQ(kRecordCount, count);
+    verify.Commit();
+  }
+
+ protected:
+  scoped_refptr<IndexedDBBackingStore> backing_store_;
+};
+
+}  // namespace
+
+TEST_F(IndexedDBIndexPopulationPerfTest, Unbuffered) {
+  Populate("IndexedDB_populate_index_unbuffered", false);
+}
+
+TEST_F(IndexedDBIndexPopulationPerfTest, Buffered) {
+  Populate("IndexedDB_populate_index_buffered", true);
+}
+
+}  // namespace content
@@ -0,0 +1,87 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/indexed_db/indexed_db_prefetch_policy.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace content {
+
+namespace {
+
+// Weight given to the newest sample in the moving averages.
+const double kSmoothingFactor = 0.5;
+
+double Smooth(double average, double sample) {
+  if (average <= 0)
+    return sample;
+  return average + kSmoothingFactor * (sample - average);
+}
+
+}  // namespace
+
+const int IndexedDBPrefetchPolicy::kMaxBatchSize = 2000;
+const size_t IndexedDBPrefetchPolicy::kMaxBatchBytes = 10 * 1024 * 1024;
+const int IndexedDBPrefetchPolicy::kTargetBatchMilliseconds = 50;
+
+IndexedDBPrefetchPolicy::IndexedDBPrefetchPolicy()
+    : records_per_second_(0), average_record_size_(0), last_batch_size_(0) {}
+
+int IndexedDBPrefetchPolicy::NextBatchSize(int requested,
+                                           base::TimeTicks now) {
+  DCHECK_GT(requested, 0);
+  int size = requested;
+
+  // The consumer only asks for another batch once the previous one has been
+  // used up, so the time since the last batch is its consumption time.
+  if (!last_batch_time_.is_null() && last_batch_size_ > 0) {
+    double elapsed = (now - last_batch_time_).InSecondsF();
+    if (elapsed > 0) {
+      records_per_second_ =
+          Smooth(records_per_second_, last_batch_size_ / elapsed);
+    }
+  }
+
+  if (records_per_second_ > 0) {
+    double target = records_per_second_ * kTargetBatchMilliseconds / 1000.0;
+    // Grow at most geometrically so a single fast batch can't balloon the
+    // next one.
+    target = std::min(target, 2.0 * std::max(last_batch_size_, requested));
+    if (target > size)
+      size = static_cast<int>(std::min<double>(target, kMaxBatchSize));
+  }
+
+  if (average_record_size_ > 0) {
+    double budget = kMaxBatchBytes / average_record_size_;
+    if (budget < size)
+      size = static_cast<int>(budget);
+  }
+
+  return std::max(1, std::min(size, std::max(requested, kMaxBatchSize)));
+}
+
+void IndexedDBPrefetchPolicy::DidFetch(int count,
+                                       size_t bytes,
+                                       base::TimeTicks now) {
+  if (count > 0) {
+    average_record_size_ =
+        Smooth(average_record_size_, static_cast<double>(bytes) / count);
+  }
+  last_batch_size_ = count;
+  last_batch_time_ = now;
+}
+
+void IndexedDBPrefetchPolicy::DidReset(int used, int unused) {
+  if (!unused)
+    return;
+  // The consumer abandoned the batch (seek, advance, or stopped iterating),
+  // so the observed rate no longer predicts the next batch.
+  records_per_second_ = 0;
+  last_batch_size_ = 0;
+  last_batch_time_ = base::TimeTicks();
+}
+
+}  // namespace content
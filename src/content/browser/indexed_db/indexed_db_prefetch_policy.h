@@ -0,0 +1,59 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONTENT_BROWSER_INDEXED_DB_INDEXED_DB_PREFETCH_POLICY_H_
+#define CONTENT_BROWSER_INDEXED_DB_INDEXED_DB_PREFETCH_POLICY_H_
+
+#include "base/basictypes.h"
+#include "base/time/time.h"
+#include "content/common/content_export.h"
+
+namespace content {
+
+// Decides how many records a cursor prefetch should return. The renderer asks
+// for a fixed, slowly growing number of records; the browser sees how quickly
+// each batch is consumed and how large the records are, so it can hand back
+// batches that cover a fixed slice of iteration time without exceeding a
+// byte budget.
+class CONTENT_EXPORT IndexedDBPrefetchPolicy {
+ public:
+  // Hard upper bound on the number of records in a single batch.
+  static const int kMaxBatchSize;
+  // Upper bound on the estimated size of a single batch, in bytes.
+  static const size_t kMaxBatchBytes;
+  // Amount of iteration a batch should cover once the consumption rate is
+  // known.
+  static const int kTargetBatchMilliseconds;
+
+  IndexedDBPrefetchPolicy();
+
+  // Returns the number of records to fetch when the consumer asks for
+  // |requested| records at |now|. Never returns less than one.
+  int NextBatchSize(int requested, base::TimeTicks now);
+
+  // Records that a batch of |count| records, estimated at |bytes| in total,
+  // was handed to the consumer at |now|.
+  void DidFetch(int count, size_t bytes, base::TimeTicks now);
+
+  // Records that the consumer stopped iterating sequentially after consuming
+  // |used| records of the last batch and discarding |unused|.
+  void DidReset(int used, int unused);
+
+  double records_per_second() const { return records_per_second_; }
+  double average_record_size() const { return average_record_size_; }
+
+ private:
+  // Exponentially weighted moving averages over previous batches.
+  double records_per_second_;
+  double average_record_size_;
+
+  int last_batch_size_;
+  base::TimeTicks last_batch_time_;
+
+  DISALLOW_COPY_AND_ASSIGN(IndexedDBPrefetchPolicy);
+};
+
+}  // namespace content
+
+#endif  // CONTENT_BROWSER_INDEXED_DB_INDEXED_DB_PREFETCH_POLICY_H_
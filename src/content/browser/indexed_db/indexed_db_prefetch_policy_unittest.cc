@@ -0,0 +1,82 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/indexed_db/indexed_db_prefetch_policy.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace content {
+
+namespace {
+
+base::TimeTicks Milliseconds(int64 ms) {
+  return base::TimeTicks() + base::TimeDelta::FromMilliseconds(ms);
+}
+
+}  // namespace
+
+TEST(IndexedDBPrefetchPolicyTest, FirstBatchHonorsRequest) {
+  IndexedDBPrefetchPolicy policy;
+  EXPECT_EQ(5, policy.NextBatchSize(5, Milliseconds(1)));
+  EXPECT_EQ(100, policy.NextBatchSize(100, Milliseconds(1)));
+}
+
+TEST(IndexedDBPrefetchPolicyTest, GrowsWithFastConsumer) {
+  IndexedDBPrefetchPolicy policy;
+  base::TimeTicks now = Milliseconds(1);
+  int size = policy.NextBatchSize(5, now);
+  policy.DidFetch(size, size * 10, now);
+
+  // Each batch is consumed in 1ms, far below the target interval, so the
+  // batch size should double every round until the cap is reached.
+  int previous = size;
+  for (int i = 0; i < 20; ++i) {
+    now += base::TimeDelta::FromMilliseconds(1);
+    size = policy.NextBatchSize(5, now);
+    EXPECT_GE(size, previous);
+    EXPECT_LE(size, 2 * previous);
+    policy.DidFetch(size, size * 10, now);
+    previous = size;
+  }
+  EXPECT_EQ(IndexedDBPrefetchPolicy::kMaxBatchSize, size);
+}
+
+TEST(IndexedDBPrefetchPolicyTest, SlowConsumerKeepsRequestedSize) {
+  IndexedDBPrefetchPolicy policy;
+  base::TimeTicks now = Milliseconds(1);
+  policy.DidFetch(50, 500, now);
+  // 50 records in 10s is far below the target rate.
+  now += base::TimeDelta::FromSeconds(10);
+  EXPECT_EQ(50, policy.NextBatchSize(50, now));
+}
+
+TEST(IndexedDBPrefetchPolicyTest, RespectsByteBudget) {
+  IndexedDBPrefetchPolicy policy;
+  const size_t kRecordSize = 1024 * 1024;
+  base::TimeTicks now = Milliseconds(1);
+  policy.DidFetch(4, 4 * kRecordSize, now);
+  now += base::TimeDelta::FromMilliseconds(1);
+  EXPECT_EQ(
+      static_cast<int>(IndexedDBPrefetchPolicy::kMaxBatchBytes / kRecordSize),
+      policy.NextBatchSize(100, now));
+}
+
+TEST(IndexedDBPrefetchPolicyTest, ResetForgetsRate) {
+  IndexedDBPrefetchPolicy policy;
+  base::TimeTicks now = Milliseconds(1);
+  policy.DidFetch(100, 1000, now);
+  now += base::TimeDelta::FromMilliseconds(1);
+  EXPECT_GT(policy.NextBatchSize(5, now), 5);
+
+  // A reset with nothing discarded is just the consumer catching up.
+  policy.DidReset(100, 0);
+  EXPECT_GT(policy.records_per_second(), 0);
+
+  policy.DidReset(3, 97);
+  EXPECT_EQ(0, policy.records_per_second());
+  now += base::TimeDelta::FromMilliseconds(1);
+  EXPECT_EQ(5, policy.NextBatchSize(5, now));
+}
+
+}  // namespace content
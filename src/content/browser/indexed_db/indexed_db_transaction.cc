@@ -121,6 +121,7 @@ void IndexedDBTransaction::Abort(const IndexedDBDatabaseError& error) {
   state_ = FINISHED;
   should_process_queue_ = false;
 
+  index_population_buffer_.Clear();
   if (was_running)
     transaction_.Rollback();
 
@@ -164,6 +165,13 @@ bool IndexedDBTransaction::HasPendingTasks() const {
   return pending_preemptive_events_ || !IsTaskQueueEmpty();
 }
 
+bool IndexedDBTransaction::FlushIndexPopulationBuffer() {
+  if (index_population_buffer_.empty())
+    return true;
+  return index_population_buffer_.Flush(database_->BackingStore().get(),
+                                         &transaction_);
+}
+
 void IndexedDBTransaction::RegisterOpenCursor(IndexedDBCursor* cursor) {
   open_cursors_.insert(cursor);
 }
@@ -217,9 +225,13 @@ void IndexedDBTransaction::Commit() {
   abort_task_stack_.clear();
 
   bool unused = state_ == UNUSED;
+  // Index population normally flushes when the indexes are marked ready, but
+  // that relies on the renderer sending SetIndexesReady() after the keys, so
+  // write out anything still buffered rather than trusting it.
+  bool flushed = unused || FlushIndexPopulationBuffer();
   state_ = FINISHED;
 
-  bool committed = unused || transaction_.Commit();
+  bool committed = unused || (flushed && transaction_.Commit());
 
   // Backing store resources (held via cursors) must be released
   // before script callbacks are fired, as the script callbacks may
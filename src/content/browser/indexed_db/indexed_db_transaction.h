@@ -15,6 +15,7 @@
 #include "content/browser/indexed_db/indexed_db_backing_store.h"
 #include "content/browser/indexed_db/indexed_db_database.h"
 #include "content/browser/indexed_db/indexed_db_database_error.h"
+#include "content/browser/indexed_db/indexed_db_index_writer.h"
 
 namespace content {
 
@@ -65,6 +66,11 @@ class IndexedDBTransaction : public base::RefCounted<IndexedDBTransaction> {
   IndexedDBBackingStore::Transaction* BackingStoreTransaction() {
     return &transaction_;
   }
+  IndexPopulationBuffer* index_population_buffer() {
+    return &index_population_buffer_;
+  }
+  // Writes index entries buffered while populating new indexes.
+  bool FlushIndexPopulationBuffer() WARN_UNUSED_RESULT;
   int64 id() const { return id_; }
 
   IndexedDBDatabase* database() const { return database_; }
@@ -132,6 +138,7 @@ class IndexedDBTransaction : public base::RefCounted<IndexedDBTransaction> {
   TaskStack abort_task_stack_;
 
   IndexedDBBackingStore::Transaction transaction_;
+  IndexPopulationBuffer index_population_buffer_;
 
   bool should_process_queue_;
   int pending_preemptive_events_;
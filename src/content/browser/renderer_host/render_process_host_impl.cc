@@ -1038,7 +1038,10 @@ void RenderProcessHostImpl::PropagateBrowserCommandLineToRenderer(
     cc::switches::kDisableCompositedAntialiasing,
     cc::switches::kDisableImplSidePainting,
     cc::switches::kDisableThreadedAnimation,
+    cc::switches::kEnableCompressedTiles,
     cc::switches::kEnableImplSidePainting,
+    cc::switches::kEnableIncrementalDrawProperties,
+    cc::switches::kEnableParallelTileRaster,
     cc::switches::kEnablePartialSwap,
     cc::switches::kEnablePerTilePainting,
     cc::switches::kEnablePinchVirtualViewport,
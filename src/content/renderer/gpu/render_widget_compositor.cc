@@ -262,6 +262,15 @@ scoped_ptr<RenderWidgetCompositor> RenderWidgetCompositor::Create(
 
   settings.use_map_image = cmd->HasSwitch(cc::switches::kUseMapImage);
 
+  settings.parallel_tile_raster =
+      cmd->HasSwitch(cc::switches::kEnableParallelTileRaster);
+
+  settings.compress_evicted_tiles =
+      cmd->HasSwitch(cc::switches::kEnableCompressedTiles);
+
+  settings.incremental_draw_properties =
+      cmd->HasSwitch(cc::switches::kEnableIncrementalDrawProperties);
+
 #if defined(OS_ANDROID)
   // TODO(danakj): Move these to the android code.
   settings.can_use_lcd_text = false;
@@ -106,14 +106,24 @@ void AudioConverter::AddInput(InputCallback* input) {
 }
 
 void AudioConverter::RemoveInput(InputCallback* input) {
-  DCHECK(std::find(transform_inputs_.begin(), transform_inputs_.end(), input) !=
-         transform_inputs_.end());
-  transform_inputs_.remove(input);
+  InputCallbackSet::iterator it =
+      std::find(transform_inputs_.begin(), transform_inputs_.end(), input);
+  DCHECK(it != transform_inputs_.end());
+  if (it != transform_inputs_.end())
+    transform_inputs_.erase(it);
 
   if (transform_inputs_.empty())
     Reset();
 }
 
+void AudioConverter::SwapInputs(std::vector<InputCallback*>* inputs) {
+  bool had_inputs = !transform_inputs_.empty();
+  transform_inputs_.swap(*inputs);
+
+  if (had_inputs && transform_inputs_.empty())
+    Reset();
+}
+
 void AudioConverter::Reset() {
   if (audio_fifo_)
     audio_fifo_->Clear();
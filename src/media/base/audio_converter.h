@@ -18,7 +18,7 @@
 #ifndef MEDIA_BASE_AUDIO_CONVERTER_H_
 #define MEDIA_BASE_AUDIO_CONVERTER_H_
 
-#include <list>
+#include <vector>
 
 #include "base/callback.h"
 #include "base/memory/scoped_ptr.h"
@@ -84,6 +84,11 @@ class MEDIA_EXPORT AudioConverter {
   void AddInput(InputCallback* input);
   void RemoveInput(InputCallback* input);
 
+  // Exchanges the current inputs with |inputs|, which must not contain
+  // duplicates, and calls Reset() if that leaves no inputs.  Doesn't allocate,
+  // so callers on a real-time thread can change inputs prepared elsewhere.
+  void SwapInputs(std::vector<InputCallback*>* inputs);
+
   // Flushes all buffered data.
   void Reset();
 
@@ -97,7 +102,7 @@ class MEDIA_EXPORT AudioConverter {
   void SourceCallback(int fifo_frame_delay, AudioBus* audio_bus);
 
   // Set of inputs for Convert().
-  typedef std::list<InputCallback*> InputCallbackSet;
+  typedef std::vector<InputCallback*> InputCallbackSet;
   InputCallbackSet transform_inputs_;
 
   // Used to buffer data between the client and the output device in cases where
@@ -0,0 +1,123 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/time/time.h"
+#include "media/base/audio_bus.h"
+#include "media/base/audio_converter.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+static const int kTimeLimitMillis = 2000;
+static const int kWarmupRuns = 5;
+static const int kTimeCheckInterval = 10;
+
+static const int kBitsPerChannel = 16;
+static const int kBufferSize = 512;
+
+// Provides the same buffer of non-silent audio on every call, so that the
+// benchmark measures the converter rather than the source.
+class StaticInputProvider : public AudioConverter::InputCallback {
+ public:
+  explicit StaticInputProvider(const AudioParameters& params)
+      : audio_bus_(AudioBus::Create(params)) {
+    for (int ch = 0; ch < audio_bus_->channels(); ++ch) {
+      float* channel = audio_bus_->channel(ch);
+      for (int i = 0; i < audio_bus_->frames(); ++i)
+        channel[i] = ((i + ch) % 64) / 32.0f - 1.0f;
+    }
+  }
+  virtual ~StaticInputProvider() {}
+
+  virtual double ProvideInput(AudioBus* audio_bus,
+                              base::TimeDelta buffer_delay) OVERRIDE {
+    audio_bus_->CopyTo(audio_bus);
+    return 1;
+  }
+
+ private:
+  scoped_ptr<AudioBus> audio_bus_;
+
+  DISALLOW_COPY_AND_ASSIGN(StaticInputProvider);
+};
+
+class AudioConverterPerfTest : public testing::Test {
+ public:
+  AudioConverterPerfTest() : num_runs_(0) {}
+
+  // Converts audio from |input_params| to |output_params| as fast as possible
+  // and reports how many times faster than real time that is.
+  void RunConversion(const std::string& test_name,
+                     const AudioParameters& input_params,
+                     const AudioParameters& output_params) {
+    StaticInputProvider input(input_params);
+    AudioConverter converter(input_params, output_params, false);
+    converter.AddInput(&input);
+    scoped_ptr<AudioBus> output_bus = AudioBus::Create(output_params);
+
+    do {
+      converter.Convert(output_bus.get());
+    } while (DidRun());
+
+    converter.RemoveInput(&input);
+
+    double audio_seconds =
+        static_cast<double>(num_runs_ - kWarmupRuns) *
+        output_params.frames_per_buffer() / output_params.sample_rate();
+    // Format matches chrome/test/perf/perf_test.h:PrintResult
+    printf("*RESULT %s: %.2f x_realtime\n",
+           test_name.c_str(),
+           audio_seconds / elapsed_.InSecondsF());
+  }
+
+  bool DidRun() {
+    ++num_runs_;
+    if (num_runs_ == kWarmupRuns)
+      start_time_ = base::TimeTicks::HighResNow();
+
+    if (!start_time_.is_null() && (num_runs_ % kTimeCheckInterval) == 0) {
+      base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start_time_;
+      if (elapsed >= base::TimeDelta::FromMilliseconds(kTimeLimitMillis)) {
+        elapsed_ = elapsed;
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+ private:
+  base::TimeTicks start_time_;
+  base::TimeDelta elapsed_;
+  int num_runs_;
+
+  DISALLOW_COPY_AND_ASSIGN(AudioConverterPerfTest);
+};
+
+// Resampling runs through SincResampler::Convolve_*().
+TEST_F(AudioConverterPerfTest, Resample44100To48000) {
+  RunConversion(
+      "audio_converter_resample_44100_to_48000",
+      AudioParameters(AudioParameters::AUDIO_PCM_LINEAR, CHANNEL_LAYOUT_STEREO,
+                      44100, kBitsPerChannel, kBufferSize),
+      AudioParameters(AudioParameters::AUDIO_PCM_LOW_LATENCY,
+                      CHANNEL_LAYOUT_STEREO, 48000, kBitsPerChannel,
+                      kBufferSize));
+}
+
+// Downmixing runs through ChannelMixer and vector_math::FMAC()/FMUL().
+TEST_F(AudioConverterPerfTest, Downmix51ToStereo) {
+  RunConversion(
+      "audio_converter_downmix_5_1_to_stereo",
+      AudioParameters(AudioParameters::AUDIO_PCM_LINEAR, CHANNEL_LAYOUT_5_1,
+                      48000, kBitsPerChannel, kBufferSize),
+      AudioParameters(AudioParameters::AUDIO_PCM_LOW_LATENCY,
+                      CHANNEL_LAYOUT_STEREO, 48000, kBitsPerChannel,
+                      kBufferSize));
+}
+
+}  // namespace media
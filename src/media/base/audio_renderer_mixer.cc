@@ -7,6 +7,7 @@
 #include "base/bind.h"
 #include "base/bind_helpers.h"
 #include "base/logging.h"
+#include "base/threading/platform_thread.h"
 
 namespace media {
 
@@ -16,11 +17,25 @@ AudioRendererMixer::AudioRendererMixer(
     const AudioParameters& input_params, const AudioParameters& output_params,
     const scoped_refptr<AudioRendererSink>& sink)
     : audio_sink_(sink),
+      input_snapshot_(0),
+      render_sequence_(0),
       audio_converter_(input_params, output_params, true),
+      converter_generation_(0),
+      render_budget_(base::TimeDelta::FromMicroseconds(
+          output_params.frames_per_buffer() *
+          base::Time::kMicrosecondsPerSecond / output_params.sample_rate())),
+      glitch_count_(0),
       pause_delay_(base::TimeDelta::FromSeconds(kPauseDelaySeconds)),
       last_play_time_(base::TimeTicks::Now()),
+      play_start_time_(last_play_time_),
       // Initialize |playing_| to true since Start() results in an auto-play.
       playing_(true) {
+  InputSnapshot* snapshot = new InputSnapshot();
+  snapshot->generation = converter_generation_;
+  base::subtle::Release_Store(&input_snapshot_,
+                              reinterpret_cast<base::subtle::AtomicWord>(
+                                  snapshot));
+
   audio_sink_->Initialize(output_params, this);
   audio_sink_->Start();
 }
@@ -31,59 +46,146 @@ AudioRendererMixer::~AudioRendererMixer() {
 
   // Ensures that all mixer inputs have stopped themselves prior to destruction
   // and have called RemoveMixerInput().
-  DCHECK_EQ(mixer_inputs_.size(), 0U);
+  InputSnapshot* snapshot = reinterpret_cast<InputSnapshot*>(
+      base::subtle::Acquire_Load(&input_snapshot_));
+  DCHECK_EQ(snapshot->inputs.size(), 0U);
+  delete snapshot;
 }
 
 void AudioRendererMixer::AddMixerInput(AudioConverter::InputCallback* input,
                                        const base::Closure& error_cb) {
   base::AutoLock auto_lock(mixer_inputs_lock_);
 
+  const InputSnapshot* current = reinterpret_cast<InputSnapshot*>(
+      base::subtle::NoBarrier_Load(&input_snapshot_));
+  DCHECK(current->inputs.find(input) == current->inputs.end());
+  AudioRendererMixerInputSet inputs(current->inputs);
+  inputs[input] = error_cb;
+  PublishInputs(CreateInputSnapshot(inputs));
+
+  // Render() checks for inputs under the lock before pausing the sink, so
+  // the sink can't be paused again after this until |input| is removed.
   if (!playing_) {
     playing_ = true;
-    last_play_time_ = base::TimeTicks::Now();
+    play_start_time_ = base::TimeTicks::Now();
     audio_sink_->Play();
   }
-
-  DCHECK(mixer_inputs_.find(input) == mixer_inputs_.end());
-  mixer_inputs_[input] = error_cb;
-  audio_converter_.AddInput(input);
 }
 
 void AudioRendererMixer::RemoveMixerInput(
     AudioConverter::InputCallback* input) {
   base::AutoLock auto_lock(mixer_inputs_lock_);
-  audio_converter_.RemoveInput(input);
 
-  DCHECK(mixer_inputs_.find(input) != mixer_inputs_.end());
-  mixer_inputs_.erase(input);
+  const InputSnapshot* current = reinterpret_cast<InputSnapshot*>(
+      base::subtle::NoBarrier_Load(&input_snapshot_));
+  DCHECK(current->inputs.find(input) != current->inputs.end());
+  AudioRendererMixerInputSet inputs(current->inputs);
+  inputs.erase(input);
+
+  // Once this returns no Render() will call |input| again, so its owner is
+  // free to destroy it.
+  PublishInputs(CreateInputSnapshot(inputs));
+}
+
+AudioRendererMixer::InputSnapshot* AudioRendererMixer::CreateInputSnapshot(
+    const AudioRendererMixerInputSet& inputs) {
+  mixer_inputs_lock_.AssertAcquired();
+  const InputSnapshot* current = reinterpret_cast<InputSnapshot*>(
+      base::subtle::NoBarrier_Load(&input_snapshot_));
+
+  // Only |current->inputs| may be read here; Render() owns the converter
+  // inputs of published snapshots.
+  InputSnapshot* snapshot = new InputSnapshot();
+  snapshot->generation = current->generation + 1;
+  snapshot->inputs = inputs;
+  snapshot->converter_inputs.reserve(inputs.size());
+  for (AudioRendererMixerInputSet::const_iterator it = inputs.begin();
+       it != inputs.end(); ++it) {
+    snapshot->converter_inputs.push_back(it->first);
+  }
+  return snapshot;
+}
+
+void AudioRendererMixer::PublishInputs(InputSnapshot* snapshot) {
+  mixer_inputs_lock_.AssertAcquired();
+  InputSnapshot* old_snapshot = reinterpret_cast<InputSnapshot*>(
+      base::subtle::NoBarrier_Load(&input_snapshot_));
+  base::subtle::Release_Store(&input_snapshot_,
+                              reinterpret_cast<base::subtle::AtomicWord>(
+                                  snapshot));
+
+  // Make sure the store above is visible before |render_sequence_| is read,
+  // so that any Render() starting after the read sees the new snapshot.
+  base::subtle::MemoryBarrier();
+
+  // A Render() in progress may still be using |old_snapshot|.  Writers are
+  // never on the real-time thread, so they wait for it instead of the other
+  // way around.
+  const base::subtle::Atomic32 sequence =
+      base::subtle::Acquire_Load(&render_sequence_);
+  if (sequence & 1) {
+    while (base::subtle::Acquire_Load(&render_sequence_) == sequence)
+      base::PlatformThread::YieldCurrentThread();
+  }
+
+  delete old_snapshot;
 }
 
 int AudioRendererMixer::Render(AudioBus* audio_bus,
                                int audio_delay_milliseconds) {
-  base::AutoLock auto_lock(mixer_inputs_lock_);
+  // Render() runs on the real-time audio thread, so it must never block:
+  // inputs are read from the current snapshot without locking.
+  base::subtle::Barrier_AtomicIncrement(&render_sequence_, 1);
+  InputSnapshot* snapshot = reinterpret_cast<InputSnapshot*>(
+      base::subtle::Acquire_Load(&input_snapshot_));
+  if (snapshot->generation != converter_generation_) {
+    audio_converter_.SwapInputs(&snapshot->converter_inputs);
+    converter_generation_ = snapshot->generation;
+  }
 
   // If there are no mixer inputs and we haven't seen one for a while, pause the
   // sink to avoid wasting resources when media elements are present but remain
-  // in the pause state.
+  // in the pause state.  If AddMixerInput() holds the lock, an input is on its
+  // way, so there's no need to wait for it.
   const base::TimeTicks now = base::TimeTicks::Now();
-  if (!mixer_inputs_.empty()) {
+  if (!snapshot->inputs.empty()) {
     last_play_time_ = now;
-  } else if (now - last_play_time_ >= pause_delay_ && playing_) {
-    audio_sink_->Pause();
-    playing_ = false;
+  } else if (now - last_play_time_ >= pause_delay_ &&
+             mixer_inputs_lock_.Try()) {
+    // Check again now that AddMixerInput() can't run; an input may have been
+    // added since |snapshot| was read, or added and removed again without
+    // Render() ever seeing it.
+    const InputSnapshot* current = reinterpret_cast<InputSnapshot*>(
+        base::subtle::NoBarrier_Load(&input_snapshot_));
+    if (playing_ && current->inputs.empty() &&
+        now - play_start_time_ >= pause_delay_) {
+      audio_sink_->Pause();
+      playing_ = false;
+    }
+    mixer_inputs_lock_.Release();
   }
 
   audio_converter_.ConvertWithDelay(
       base::TimeDelta::FromMilliseconds(audio_delay_milliseconds), audio_bus);
+
+  if (base::TimeTicks::Now() - now > render_budget_)
+    base::subtle::NoBarrier_AtomicIncrement(&glitch_count_, 1);
+
+  base::subtle::Barrier_AtomicIncrement(&render_sequence_, 1);
   return audio_bus->frames();
 }
 
 void AudioRendererMixer::OnRenderError() {
+  // Errors aren't on the real-time path, so just keep the inputs from
+  // changing while they are notified.
   base::AutoLock auto_lock(mixer_inputs_lock_);
+  const InputSnapshot* snapshot = reinterpret_cast<InputSnapshot*>(
+      base::subtle::NoBarrier_Load(&input_snapshot_));
 
   // Call each mixer input and signal an error.
-  for (AudioRendererMixerInputSet::iterator it = mixer_inputs_.begin();
-       it != mixer_inputs_.end(); ++it) {
+  for (AudioRendererMixerInputSet::const_iterator it =
+           snapshot->inputs.begin();
+       it != snapshot->inputs.end(); ++it) {
     it->second.Run();
   }
 }
@@ -6,7 +6,9 @@
 #define MEDIA_BASE_AUDIO_RENDERER_MIXER_H_
 
 #include <map>
+#include <vector>
 
+#include "base/atomicops.h"
 #include "base/synchronization/lock.h"
 #include "base/time/time.h"
 #include "media/base/audio_converter.h"
@@ -34,29 +36,81 @@ class MEDIA_EXPORT AudioRendererMixer
     pause_delay_ = delay;
   }
 
+  // Returns the number of Render() calls which took longer than the audio
+  // they produced lasts, i.e. which would have underrun a real device.  Safe
+  // to call from any thread.
+  int glitch_count() const {
+    return base::subtle::NoBarrier_Load(&glitch_count_);
+  }
+
  private:
+  // Set of mixer inputs to be mixed by this mixer.
+  typedef std::map<AudioConverter::InputCallback*, base::Closure>
+      AudioRendererMixerInputSet;
+
+  // An immutable snapshot of the mixer inputs.  AddMixerInput() and
+  // RemoveMixerInput() publish a new snapshot instead of modifying the
+  // current one, so Render() can read it without taking a lock.
+  struct InputSnapshot {
+    // Increases with every snapshot; lets Render() tell snapshots apart
+    // even if one is allocated where a freed one used to be.
+    int generation;
+    AudioRendererMixerInputSet inputs;
+
+    // The inputs in the form |audio_converter_| takes them, built before the
+    // snapshot is published so that Render() never allocates.  The first
+    // Render() to see the snapshot swaps them into the converter; nothing
+    // else reads them after publication.
+    std::vector<AudioConverter::InputCallback*> converter_inputs;
+  };
+
   // AudioRendererSink::RenderCallback implementation.
   virtual int Render(AudioBus* audio_bus,
                      int audio_delay_milliseconds) OVERRIDE;
   virtual void OnRenderError() OVERRIDE;
 
+  // Returns a new snapshot holding |inputs|, numbered after the current one.
+  // Must be called with |mixer_inputs_lock_| held.
+  InputSnapshot* CreateInputSnapshot(const AudioRendererMixerInputSet& inputs);
+
+  // Publishes |snapshot| for Render() and frees the previous one once no
+  // Render() can still be using it.  Must be called with |mixer_inputs_lock_|
+  // held.
+  void PublishInputs(InputSnapshot* snapshot);
+
   // Output sink for this mixer.
   scoped_refptr<AudioRendererSink> audio_sink_;
 
-  // Set of mixer inputs to be mixed by this mixer.  Access is thread-safe
-  // through |mixer_inputs_lock_|.
-  typedef std::map<AudioConverter::InputCallback*, base::Closure>
-      AudioRendererMixerInputSet;
-  AudioRendererMixerInputSet mixer_inputs_;
+  // The current InputSnapshot.  Only replaced while holding
+  // |mixer_inputs_lock_|, which serializes writers; Render() never waits on
+  // the lock.
+  base::subtle::AtomicWord input_snapshot_;
   base::Lock mixer_inputs_lock_;
 
-  // Handles mixing and resampling between input and output parameters.
+  // Incremented on entry to and exit from Render(), so it is odd while a
+  // Render() is in progress.  Lets writers know when a replaced snapshot is
+  // no longer in use.
+  base::subtle::Atomic32 render_sequence_;
+
+  // Handles mixing and resampling between input and output parameters.  Only
+  // used from Render(), along with the snapshot generation whose inputs it
+  // was last given.
   AudioConverter audio_converter_;
+  int converter_generation_;
+
+  // How long each Render() call may take without underrunning, and how many
+  // didn't make it.
+  base::TimeDelta render_budget_;
+  base::subtle::Atomic32 glitch_count_;
 
   // Handles physical stream pause when no inputs are playing.  For latency
   // reasons we don't want to immediately pause the physical stream.
+  // |last_play_time_| is only used from Render(); |play_start_time_| and
+  // |playing_| are guarded by |mixer_inputs_lock_|, which Render() only ever
+  // tries to acquire.
   base::TimeDelta pause_delay_;
   base::TimeTicks last_play_time_;
+  base::TimeTicks play_start_time_;
   bool playing_;
 
   DISALLOW_COPY_AND_ASSIGN(AudioRendererMixer);
@@ -6,12 +6,14 @@
 #define _USE_MATH_DEFINES
 #include <cmath>
 
+#include "base/atomicops.h"
 #include "base/bind.h"
 #include "base/bind_helpers.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/scoped_vector.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/threading/platform_thread.h"
+#include "base/threading/simple_thread.h"
 #include "media/base/audio_renderer_mixer.h"
 #include "media/base/audio_renderer_mixer_input.h"
 #include "media/base/fake_audio_render_callback.h"
@@ -25,6 +27,10 @@ namespace media {
 static const int kMixerInputs = 8;
 static const int kMixerCycles = 3;
 
+// Parameters which control the stress test.
+static const int kStressMixerInputs = 64;
+static const int kStressIterations = 2000;
+
 // Parameters used for testing.
 static const int kBitsPerChannel = 32;
 static const ChannelLayout kChannelLayout = CHANNEL_LAYOUT_STEREO;
@@ -446,6 +452,152 @@ TEST_P(AudioRendererMixerBehavioralTest, MixerPausesStream) {
   mixer_inputs_[0]->Stop();
 }
 
+// Calls Render() on a mixer as fast as possible, the way the audio device
+// thread would, until told to stop.
+class RenderLoop : public base::DelegateSimpleThread::Delegate {
+ public:
+  RenderLoop(AudioRendererSink::RenderCallback* callback,
+             const AudioParameters& params)
+      : callback_(callback),
+        audio_bus_(AudioBus::Create(params)),
+        stop_(false, false),
+        renders_(0) {}
+
+  virtual void Run() OVERRIDE {
+    while (!stop_.IsSignaled()) {
+      EXPECT_EQ(audio_bus_->frames(), callback_->Render(audio_bus_.get(), 0));
+      base::subtle::NoBarrier_AtomicIncrement(&renders_, 1);
+    }
+  }
+
+  void Stop() { stop_.Signal(); }
+  int renders() const { return base::subtle::NoBarrier_Load(&renders_); }
+
+ private:
+  AudioRendererSink::RenderCallback* callback_;
+  scoped_ptr<AudioBus> audio_bus_;
+  base::WaitableEvent stop_;
+  base::subtle::Atomic32 renders_;
+
+  DISALLOW_COPY_AND_ASSIGN(RenderLoop);
+};
+
+// Provides silence, and counts calls made while it isn't part of the mixer.
+class RemovalCheckingInput : public AudioConverter::InputCallback {
+ public:
+  RemovalCheckingInput() : removed_(1), calls_while_removed_(0) {}
+  virtual ~RemovalCheckingInput() {}
+
+  virtual double ProvideInput(AudioBus* audio_bus,
+                              base::TimeDelta buffer_delay) OVERRIDE {
+    if (base::subtle::Acquire_Load(&removed_))
+      base::subtle::NoBarrier_AtomicIncrement(&calls_while_removed_, 1);
+    audio_bus->Zero();
+    return 1;
+  }
+
+  // Must be called just before AddMixerInput() and just after
+  // RemoveMixerInput() respectively.
+  void WillBeAdded() { base::subtle::Release_Store(&removed_, 0); }
+  void WasRemoved() { base::subtle::Release_Store(&removed_, 1); }
+
+  int calls_while_removed() const {
+    return base::subtle::NoBarrier_Load(&calls_while_removed_);
+  }
+
+ private:
+  base::subtle::Atomic32 removed_;
+  base::subtle::Atomic32 calls_while_removed_;
+
+  DISALLOW_COPY_AND_ASSIGN(RemovalCheckingInput);
+};
+
+// Mix many inputs on a render thread while inputs are added and removed on
+// another, as happens when media elements play and pause.  Render() never
+// takes a lock, so make sure removed inputs are never called after
+// RemoveMixerInput() returns.
+TEST_P(AudioRendererMixerBehavioralTest, StressAddRemoveWhileRendering) {
+  EXPECT_CALL(*sink_.get(), Play()).Times(testing::AnyNumber());
+  EXPECT_CALL(*sink_.get(), Pause()).Times(testing::AnyNumber());
+  ScopedVector<RemovalCheckingInput> inputs;
+  std::vector<bool> added(kStressMixerInputs);
+  for (int i = 0; i < kStressMixerInputs; ++i) {
+    inputs.push_back(new RemovalCheckingInput());
+    added[i] = (i % 2) != 0;
+    if (added[i]) {
+      inputs[i]->WillBeAdded();
+      mixer_->AddMixerInput(inputs[i], base::Closure());
+    }
+  }
+
+  RenderLoop render_loop(mixer_callback_, output_parameters_);
+  base::DelegateSimpleThread render_thread(&render_loop, "RenderLoop");
+  render_thread.Start();
+
+  // Toggle inputs in an order that doesn't line up with how they're stored.
+  for (int i = 0; i < kStressIterations; ++i) {
+    size_t index = (i * 37) % inputs.size();
+    if (added[index]) {
+      mixer_->RemoveMixerInput(inputs[index]);
+      inputs[index]->WasRemoved();
+    } else {
+      inputs[index]->WillBeAdded();
+      mixer_->AddMixerInput(inputs[index], base::Closure());
+    }
+    added[index] = !added[index];
+  }
+
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (added[i]) {
+      mixer_->RemoveMixerInput(inputs[i]);
+      inputs[i]->WasRemoved();
+    }
+  }
+
+  // Keep rendering for a bit with every input removed.
+  const int renders = render_loop.renders();
+  while (render_loop.renders() < renders + 10)
+    base::PlatformThread::YieldCurrentThread();
+
+  render_loop.Stop();
+  render_thread.Join();
+  EXPECT_GT(render_loop.renders(), 0);
+
+  for (size_t i = 0; i < inputs.size(); ++i)
+    EXPECT_EQ(0, inputs[i]->calls_while_removed()) << "Input " << i;
+}
+
+// Provides silence, but takes longer than the mixer's render budget.
+class SlowInput : public AudioConverter::InputCallback {
+ public:
+  explicit SlowInput(base::TimeDelta delay) : delay_(delay) {}
+  virtual ~SlowInput() {}
+
+  virtual double ProvideInput(AudioBus* audio_bus,
+                              base::TimeDelta buffer_delay) OVERRIDE {
+    base::PlatformThread::Sleep(delay_);
+    audio_bus->Zero();
+    return 1;
+  }
+
+ private:
+  base::TimeDelta delay_;
+
+  DISALLOW_COPY_AND_ASSIGN(SlowInput);
+};
+
+// Ensure Render() calls which overrun their buffer's duration are counted.
+TEST_P(AudioRendererMixerBehavioralTest, GlitchCount) {
+  EXPECT_EQ(0, mixer_->glitch_count());
+
+  // A buffer of |kLowLatencyBufferSize| frames lasts about 6ms.
+  SlowInput slow_input(base::TimeDelta::FromMilliseconds(50));
+  mixer_->AddMixerInput(&slow_input, base::Closure());
+  mixer_callback_->Render(audio_bus_.get(), 0);
+  EXPECT_EQ(1, mixer_->glitch_count());
+  mixer_->RemoveMixerInput(&slow_input);
+}
+
 INSTANTIATE_TEST_CASE_P(
     AudioRendererMixerTest, AudioRendererMixerTest, testing::Values(
         // No resampling.
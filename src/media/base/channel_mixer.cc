@@ -335,11 +335,10 @@ void ChannelMixer::Transform(const AudioBus* input, AudioBus* output) {
   CHECK_EQ(matrix_[0].size(), static_cast<size_t>(input->channels()));
   CHECK_EQ(input->frames(), output->frames());
 
-  // Zero initialize |output| so we're accumulating from zero.
-  output->Zero();
-
   // If we're just remapping we can simply copy the correct input to output.
   if (remapping_) {
+    // Zero initialize |output| for any channels without an input.
+    output->Zero();
     for (int output_ch = 0; output_ch < output->channels(); ++output_ch) {
       for (int input_ch = 0; input_ch < input->channels(); ++input_ch) {
         float scale = matrix_[output_ch][input_ch];
@@ -355,15 +354,30 @@ void ChannelMixer::Transform(const AudioBus* input, AudioBus* output) {
   }
 
   for (int output_ch = 0; output_ch < output->channels(); ++output_ch) {
+    bool output_written = false;
     for (int input_ch = 0; input_ch < input->channels(); ++input_ch) {
       float scale = matrix_[output_ch][input_ch];
       // Scale should always be positive.  Don't bother scaling by zero.
       DCHECK_GE(scale, 0);
-      if (scale > 0) {
+      if (scale <= 0)
+        continue;
+
+      // The first input to contribute overwrites the channel, which saves
+      // zeroing it and then reading the zeros back.
+      if (output_written) {
         vector_math::FMAC(input->channel(input_ch), scale, output->frames(),
                           output->channel(output_ch));
+      } else {
+        vector_math::FMUL(input->channel(input_ch), scale, output->frames(),
+                          output->channel(output_ch));
+        output_written = true;
       }
     }
+
+    if (!output_written) {
+      memset(output->channel(output_ch), 0,
+             sizeof(*output->channel(output_ch)) * output->frames());
+    }
   }
 }
 
@@ -111,13 +111,9 @@ static double SincScaleFactor(double io_ratio) {
 // methods and plumbing the -msse built library is non-trivial.  iOS lies
 // about its architecture, so we also need to exclude it here.
 #if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL) && !defined(OS_IOS)
-#if defined(__SSE__)
-#define CONVOLVE_FUNC Convolve_SSE
-void SincResampler::InitializeCPUSpecificFeatures() {}
-#else
 // X86 CPU detection required.  Functions will be set by
-// InitializeCPUSpecificFeatures().
-// TODO(dalecurtis): Once Chrome moves to an SSE baseline this can be removed.
+// InitializeCPUSpecificFeatures().  AVX is never part of the compile time
+// baseline, so this is needed even when SSE is.
 #define CONVOLVE_FUNC g_convolve_proc_
 
 typedef float (*ConvolveProc)(const float*, const float*, const float*, double);
@@ -125,9 +121,14 @@ static ConvolveProc g_convolve_proc_ = NULL;
 
 void SincResampler::InitializeCPUSpecificFeatures() {
   CHECK(!g_convolve_proc_);
-  g_convolve_proc_ = base::CPU().has_sse() ? Convolve_SSE : Convolve_C;
+  base::CPU cpu;
+  if (cpu.has_avx())
+    g_convolve_proc_ = Convolve_AVX;
+  else if (cpu.has_sse())
+    g_convolve_proc_ = Convolve_SSE;
+  else
+    g_convolve_proc_ = Convolve_C;
 }
-#endif
 #elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
 #define CONVOLVE_FUNC Convolve_NEON
 void SincResampler::InitializeCPUSpecificFeatures() {}
@@ -144,15 +145,15 @@ SincResampler::SincResampler(double io_sample_rate_ratio,
       read_cb_(read_cb),
       request_frames_(request_frames),
       input_buffer_size_(request_frames_ + kKernelSize),
-      // Create input buffers with a 16-byte alignment for SSE optimizations.
+      // Create input buffers with a 32-byte alignment for AVX optimizations.
       kernel_storage_(static_cast<float*>(
-          base::AlignedAlloc(sizeof(float) * kKernelStorageSize, 16))),
+          base::AlignedAlloc(sizeof(float) * kKernelStorageSize, 32))),
       kernel_pre_sinc_storage_(static_cast<float*>(
-          base::AlignedAlloc(sizeof(float) * kKernelStorageSize, 16))),
+          base::AlignedAlloc(sizeof(float) * kKernelStorageSize, 32))),
       kernel_window_storage_(static_cast<float*>(
-          base::AlignedAlloc(sizeof(float) * kKernelStorageSize, 16))),
+          base::AlignedAlloc(sizeof(float) * kKernelStorageSize, 32))),
       input_buffer_(static_cast<float*>(
-          base::AlignedAlloc(sizeof(float) * input_buffer_size_, 16))),
+          base::AlignedAlloc(sizeof(float) * input_buffer_size_, 32))),
       r1_(input_buffer_.get()),
       r2_(input_buffer_.get() + kKernelSize / 2) {
   CHECK_GT(request_frames_, 0);
@@ -289,10 +290,10 @@ void SincResampler::Resample(int frames, float* destination) {
       const float* const k1 = kernel_ptr + offset_idx * kKernelSize;
       const float* const k2 = k1 + kKernelSize;
 
-      // Ensure |k1|, |k2| are 16-byte aligned for SIMD usage.  Should always be
-      // true so long as kKernelSize is a multiple of 16.
-      DCHECK_EQ(0u, reinterpret_cast<uintptr_t>(k1) & 0x0F);
-      DCHECK_EQ(0u, reinterpret_cast<uintptr_t>(k2) & 0x0F);
+      // Ensure |k1|, |k2| are 32-byte aligned for SIMD usage.  Should always be
+      // true so long as kKernelSize is a multiple of 32.
+      DCHECK_EQ(0u, reinterpret_cast<uintptr_t>(k1) & 0x1F);
+      DCHECK_EQ(0u, reinterpret_cast<uintptr_t>(k2) & 0x1F);
 
       // Initialize input pointer based on quantized |virtual_source_idx_|.
       const float* const input_ptr = r1_ + source_idx;
@@ -21,13 +21,8 @@ namespace vector_math {
 // methods and plumbing the -msse built library is non-trivial.  iOS lies about
 // its architecture, so we also need to exclude it here.
 #if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL) && !defined(OS_IOS)
-#if defined(__SSE__)
-#define FMAC_FUNC FMAC_SSE
-#define FMUL_FUNC FMUL_SSE
-void Initialize() {}
-#else
-// X86 CPU detection required.  Functions will be set by Initialize().
-// TODO(dalecurtis): Once Chrome moves to an SSE baseline this can be removed.
+// X86 CPU detection required.  Functions will be set by Initialize().  AVX is
+// never part of the compile time baseline, so this is needed even when SSE is.
 #define FMAC_FUNC g_fmac_proc_
 #define FMUL_FUNC g_fmul_proc_
 
@@ -38,11 +33,18 @@ static MathProc g_fmul_proc_ = NULL;
 void Initialize() {
   CHECK(!g_fmac_proc_);
   CHECK(!g_fmul_proc_);
-  const bool kUseSSE = base::CPU().has_sse();
-  g_fmac_proc_ = kUseSSE ? FMAC_SSE : FMAC_C;
-  g_fmul_proc_ = kUseSSE ? FMUL_SSE : FMUL_C;
+  base::CPU cpu;
+  if (cpu.has_avx()) {
+    g_fmac_proc_ = FMAC_AVX;
+    g_fmul_proc_ = FMUL_AVX;
+  } else if (cpu.has_sse()) {
+    g_fmac_proc_ = FMAC_SSE;
+    g_fmul_proc_ = FMUL_SSE;
+  } else {
+    g_fmac_proc_ = FMAC_C;
+    g_fmul_proc_ = FMUL_C;
+  }
 }
-#endif
 #elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
 #define FMAC_FUNC FMAC_NEON
 #define FMUL_FUNC FMUL_NEON
@@ -0,0 +1,138 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/video_frame_pool.h"
+
+#include <list>
+
+#include "base/bind.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+
+namespace media {
+
+class VideoFramePool::PoolImpl
+    : public base::RefCountedThreadSafe<VideoFramePool::PoolImpl> {
+ public:
+  PoolImpl();
+
+  // See VideoFramePool::CreateFrame().
+  scoped_refptr<VideoFrame> CreateFrame(VideoFrame::Format format,
+                                        const gfx::Size& coded_size,
+                                        const gfx::Rect& visible_rect,
+                                        const gfx::Size& natural_size,
+                                        base::TimeDelta timestamp);
+
+  // Stops frames from being returned to the pool, and frees the ones in it.
+  // Called when the VideoFramePool is destroyed.
+  void Shutdown();
+
+  size_t GetPoolSizeForTesting();
+
+ private:
+  friend class base::RefCountedThreadSafe<VideoFramePool::PoolImpl>;
+  ~PoolImpl();
+
+  // Called when the last reference to a frame wrapping |frame| goes away.
+  void FrameReleased(const scoped_refptr<VideoFrame>& frame);
+
+  base::Lock lock_;
+  bool is_shutdown_;
+  std::list<scoped_refptr<VideoFrame> > frames_;
+
+  DISALLOW_COPY_AND_ASSIGN(PoolImpl);
+};
+
+VideoFramePool::PoolImpl::PoolImpl() : is_shutdown_(false) {}
+
+VideoFramePool::PoolImpl::~PoolImpl() {
+  DCHECK(is_shutdown_);
+}
+
+scoped_refptr<VideoFrame> VideoFramePool::PoolImpl::CreateFrame(
+    VideoFrame::Format format,
+    const gfx::Size& coded_size,
+    const gfx::Rect& visible_rect,
+    const gfx::Size& natural_size,
+    base::TimeDelta timestamp) {
+  DCHECK(format == VideoFrame::YV12 || format == VideoFrame::YV16 ||
+         format == VideoFrame::I420) << format;
+
+  scoped_refptr<VideoFrame> frame;
+  {
+    base::AutoLock auto_lock(lock_);
+    DCHECK(!is_shutdown_);
+
+    // Frames that don't match won't be asked for again until the format or
+    // size changes back, so drop them rather than keep them around.
+    while (!frame.get() && !frames_.empty()) {
+      scoped_refptr<VideoFrame> pool_frame = frames_.front();
+      frames_.pop_front();
+      if (pool_frame->format() == format &&
+          pool_frame->coded_size() == coded_size) {
+        frame = pool_frame;
+      }
+    }
+  }
+
+  if (!frame.get()) {
+    frame = VideoFrame::CreateFrame(
+        format, coded_size, gfx::Rect(coded_size), natural_size,
+        kNoTimestamp());
+  }
+
+  return VideoFrame::WrapExternalYuvData(
+      format, coded_size, visible_rect, natural_size,
+      frame->stride(VideoFrame::kYPlane),
+      frame->stride(VideoFrame::kUPlane),
+      frame->stride(VideoFrame::kVPlane),
+      frame->data(VideoFrame::kYPlane),
+      frame->data(VideoFrame::kUPlane),
+      frame->data(VideoFrame::kVPlane),
+      timestamp,
+      base::SharedMemory::NULLHandle(),
+      base::Bind(&VideoFramePool::PoolImpl::FrameReleased, this, frame));
+}
+
+void VideoFramePool::PoolImpl::Shutdown() {
+  base::AutoLock auto_lock(lock_);
+  is_shutdown_ = true;
+  frames_.clear();
+}
+
+size_t VideoFramePool::PoolImpl::GetPoolSizeForTesting() {
+  base::AutoLock auto_lock(lock_);
+  return frames_.size();
+}
+
+void VideoFramePool::PoolImpl::FrameReleased(
+    const scoped_refptr<VideoFrame>& frame) {
+  base::AutoLock auto_lock(lock_);
+  if (is_shutdown_)
+    return;
+
+  frames_.push_back(frame);
+}
+
+VideoFramePool::VideoFramePool() : pool_(new PoolImpl()) {}
+
+VideoFramePool::~VideoFramePool() {
+  pool_->Shutdown();
+}
+
+scoped_refptr<VideoFrame> VideoFramePool::CreateFrame(
+    VideoFrame::Format format,
+    const gfx::Size& coded_size,
+    const gfx::Rect& visible_rect,
+    const gfx::Size& natural_size,
+    base::TimeDelta timestamp) {
+  return pool_->CreateFrame(format, coded_size, visible_rect, natural_size,
+                            timestamp);
+}
+
+size_t VideoFramePool::GetPoolSizeForTesting() const {
+  return pool_->GetPoolSizeForTesting();
+}
+
+}  // namespace media
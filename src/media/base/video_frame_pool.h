@@ -0,0 +1,49 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_BASE_VIDEO_FRAME_POOL_H_
+#define MEDIA_BASE_VIDEO_FRAME_POOL_H_
+
+#include "media/base/media_export.h"
+#include "media/base/video_frame.h"
+
+namespace media {
+
+// Hands out YUV VideoFrames whose memory is recycled. When the last
+// reference to a frame from the pool goes away, its memory goes back to the
+// pool, so that decoders producing a stream of same-sized frames don't
+// allocate and free a large buffer for each one.
+//
+// Frames are only reused for the same format and coded size; asking for a
+// different one empties the pool. The pool may be used from any thread, and
+// frames may outlive it.
+class MEDIA_EXPORT VideoFramePool {
+ public:
+  VideoFramePool();
+  ~VideoFramePool();
+
+  // Returns a frame like VideoFrame::CreateFrame() does. The contents of a
+  // recycled frame are whatever was last written to it.
+  scoped_refptr<VideoFrame> CreateFrame(VideoFrame::Format format,
+                                        const gfx::Size& coded_size,
+                                        const gfx::Rect& visible_rect,
+                                        const gfx::Size& natural_size,
+                                        base::TimeDelta timestamp);
+
+ protected:
+  friend class VideoFramePoolTest;
+
+  // Returns the number of frames waiting in the pool to be reused.
+  size_t GetPoolSizeForTesting() const;
+
+ private:
+  class PoolImpl;
+  scoped_refptr<PoolImpl> pool_;
+
+  DISALLOW_COPY_AND_ASSIGN(VideoFramePool);
+};
+
+}  // namespace media
+
+#endif  // MEDIA_BASE_VIDEO_FRAME_POOL_H_
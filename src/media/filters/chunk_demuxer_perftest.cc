@@ -0,0 +1,292 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/message_loop/message_loop.h"
+#include "base/time/time.h"
+#include "media/base/decoder_buffer.h"
+#include "media/base/mock_demuxer_host.h"
+#include "media/base/test_data_util.h"
+#include "media/base/test_helpers.h"
+#include "media/filters/chunk_demuxer.h"
+#include "media/webm/cluster_builder.h"
+#include "media/webm/webm_constants.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using ::testing::AnyNumber;
+using ::testing::NiceMock;
+using ::testing::_;
+
+namespace media {
+
+static const uint8 kTracksHeader[] = {
+  0x16, 0x54, 0xAE, 0x6B,  // Tracks ID
+  0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // tracks(size = 0)
+};
+static const int kTracksSizeOffset = 4;
+
+// WebM Block bytes that start a VP8 keyframe and a VP8 interframe.
+static const uint8 kVP8Keyframe[] = {
+  0x010, 0x00, 0x00, 0x9d, 0x01, 0x2a, 0x00, 0x10, 0x00, 0x10, 0x00
+};
+static const uint8 kVP8Interframe[] = { 0x11, 0x00, 0x00 };
+
+static const char kSourceId[] = "SourceId";
+static const int kVideoTrackNum = 1;
+
+// Two hours of 30 fps video, appended one GOP per cluster. Frames are big
+// enough that the stream has to garbage collect long before the end.
+static const int kMediaDurationMs = 2 * 60 * 60 * 1000;
+static const int kFrameDurationMs = 33;
+static const int kFramesPerGOP = 30;
+static const int kFrameSize = 1024;
+
+// Each append throughput test parses this much media in total.
+static const int kAppendThroughputTotalMB = 200;
+
+static const int kTimeLimitMillis = 2000;
+static const int kWarmupRuns = 5;
+static const int kTimeCheckInterval = 10;
+
+static scoped_ptr<TextTrack> OnTextTrack(TextKind kind,
+                                         const std::string& label,
+                                         const std::string& language) {
+  return scoped_ptr<TextTrack>();
+}
+
+static void OnNeedKey(const std::string& type,
+                      scoped_ptr<uint8[]> init_data, int init_data_size) {}
+
+class ChunkDemuxerPerfTest : public testing::Test {
+ public:
+  ChunkDemuxerPerfTest() : num_runs_(0) {
+    EXPECT_CALL(host_, AddBufferedTimeRange(_, _)).Times(AnyNumber());
+    demuxer_.reset(new ChunkDemuxer(base::Bind(&base::DoNothing),
+                                    base::Bind(&OnNeedKey),
+                                    base::Bind(&OnTextTrack),
+                                    LogCB()));
+  }
+
+  virtual ~ChunkDemuxerPerfTest() {
+    demuxer_->Shutdown();
+    message_loop_.RunUntilIdle();
+  }
+
+  // Appends a video-only WebM initialization segment.
+  void InitDemuxer() {
+    demuxer_->Initialize(&host_, NewExpectedStatusCB(PIPELINE_OK));
+
+    std::vector<std::string> codecs;
+    codecs.push_back("vp8");
+    ASSERT_EQ(ChunkDemuxer::kOk,
+              demuxer_->AddId(kSourceId, "video/webm", codecs));
+
+    scoped_refptr<DecoderBuffer> ebml_header =
+        ReadTestDataFile("webm_ebml_element");
+    scoped_refptr<DecoderBuffer> info = ReadTestDataFile("webm_info_element");
+    scoped_refptr<DecoderBuffer> video_track_entry =
+        ReadTestDataFile("webm_vp8_track_entry");
+
+    std::vector<uint8> tracks(kTracksHeader,
+                              kTracksHeader + sizeof(kTracksHeader));
+    int64 tracks_size = video_track_entry->data_size();
+    for (int i = 7; i > 0; --i) {
+      tracks[kTracksSizeOffset + i] = tracks_size & 0xff;
+      tracks_size >>= 8;
+    }
+
+    demuxer_->AppendData(kSourceId, ebml_header->data(),
+                         ebml_header->data_size());
+    demuxer_->AppendData(kSourceId, info->data(), info->data_size());
+    demuxer_->AppendData(kSourceId, &tracks[0], tracks.size());
+    demuxer_->AppendData(kSourceId, video_track_entry->data(),
+                         video_track_entry->data_size());
+    message_loop_.RunUntilIdle();
+  }
+
+  // Returns a cluster holding the GOP that starts at |timecode|.
+  scoped_ptr<Cluster> GenerateGOP(int timecode) {
+    std::vector<uint8> keyframe(kFrameSize);
+    std::copy(kVP8Keyframe, kVP8Keyframe + sizeof(kVP8Keyframe),
+              keyframe.begin());
+    std::vector<uint8> interframe(kFrameSize);
+    std::copy(kVP8Interframe, kVP8Interframe + sizeof(kVP8Interframe),
+              interframe.begin());
+
+    ClusterBuilder cb;
+    cb.SetClusterTimecode(timecode);
+    cb.AddSimpleBlock(kVideoTrackNum, timecode, kWebMFlagKeyframe,
+                      &keyframe[0], keyframe.size());
+    for (int i = 1; i < kFramesPerGOP - 1; ++i) {
+      cb.AddSimpleBlock(kVideoTrackNum, timecode + i * kFrameDurationMs, 0,
+                        &interframe[0], interframe.size());
+    }
+
+    // Make the last block a BlockGroup so that it doesn't get delayed by the
+    // block duration calculation logic.
+    cb.AddBlockGroup(kVideoTrackNum,
+                     timecode + (kFramesPerGOP - 1) * kFrameDurationMs,
+                     kFrameDurationMs, 0, &interframe[0], interframe.size());
+    return cb.Finish();
+  }
+
+  void Seek(base::TimeDelta seek_time) {
+    demuxer_->StartWaitingForSeek(seek_time);
+    demuxer_->Seek(seek_time, NewExpectedStatusCB(PIPELINE_OK));
+    message_loop_.RunUntilIdle();
+  }
+
+  // Appends |segment_size_mb| megabyte media segments in single AppendData()
+  // calls and reports how fast they are parsed.
+  void RunAppendThroughput(const std::string& test_name,
+                           int segment_size_mb) {
+    InitDemuxer();
+
+    std::vector<uint8> segment;
+    int timecode = 0;
+    while (segment.size() < static_cast<size_t>(segment_size_mb << 20)) {
+      scoped_ptr<Cluster> cluster = GenerateGOP(timecode);
+      segment.insert(segment.end(), cluster->data(),
+                     cluster->data() + cluster->size());
+      timecode += kFramesPerGOP * kFrameDurationMs;
+    }
+
+    // Shift every append past the previous one so that each adds new media
+    // instead of overlapping what is already buffered.
+    base::TimeDelta segment_duration =
+        base::TimeDelta::FromMilliseconds(timecode);
+    base::TimeDelta timestamp_offset;
+    base::TimeDelta elapsed;
+    int total_mb = 0;
+    while (total_mb < kAppendThroughputTotalMB) {
+      ASSERT_TRUE(demuxer_->SetTimestampOffset(kSourceId, timestamp_offset));
+
+      base::TimeTicks start = base::TimeTicks::HighResNow();
+      demuxer_->AppendData(kSourceId, &segment[0], segment.size());
+      elapsed += base::TimeTicks::HighResNow() - start;
+
+      timestamp_offset += segment_duration;
+      total_mb += segment_size_mb;
+    }
+    message_loop_.RunUntilIdle();
+
+    // Format matches chrome/test/perf/perf_test.h:PrintResult
+    printf("*RESULT %s: %.2f MB/s\n",
+           test_name.c_str(),
+           total_mb / elapsed.InSecondsF());
+  }
+
+  bool DidRun() {
+    ++num_runs_;
+    if (num_runs_ == kWarmupRuns)
+      start_time_ = base::TimeTicks::HighResNow();
+
+    if (!start_time_.is_null() && (num_runs_ % kTimeCheckInterval) == 0) {
+      base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start_time_;
+      if (elapsed >= base::TimeDelta::FromMilliseconds(kTimeLimitMillis)) {
+        elapsed_ = elapsed;
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  void AfterTest(const std::string& test_name) {
+    // Format matches chrome/test/perf/perf_test.h:PrintResult
+    printf("*RESULT %s: %.2f ms/seek\n",
+           test_name.c_str(),
+           elapsed_.InMillisecondsF() / (num_runs_ - kWarmupRuns));
+  }
+
+ protected:
+  base::MessageLoop message_loop_;
+  NiceMock<MockDemuxerHost> host_;
+  scoped_ptr<ChunkDemuxer> demuxer_;
+
+ private:
+  base::TimeTicks start_time_;
+  base::TimeDelta elapsed_;
+  int num_runs_;
+
+  DISALLOW_COPY_AND_ASSIGN(ChunkDemuxerPerfTest);
+};
+
+// Appends two hours of video one GOP at a time, then seeks around whatever
+// is still buffered once garbage collection has done its work. Append
+// latency shouldn't grow with the amount of media appended so far.
+TEST_F(ChunkDemuxerPerfTest, AppendTwoHoursAndSeek) {
+  InitDemuxer();
+
+  const int kGOPDurationMs = kFramesPerGOP * kFrameDurationMs;
+  const int kGOPsPerMinute = 60 * 1000 / kGOPDurationMs;
+  base::TimeDelta total_append_time;
+  base::TimeDelta first_minute_append_time;
+  base::TimeDelta last_minute_append_time;
+  base::TimeDelta max_append_time;
+  int num_gops = 0;
+  for (int timecode = 0; timecode < kMediaDurationMs;
+       timecode += kGOPDurationMs) {
+    scoped_ptr<Cluster> cluster = GenerateGOP(timecode);
+
+    base::TimeTicks start = base::TimeTicks::HighResNow();
+    demuxer_->AppendData(kSourceId, cluster->data(), cluster->size());
+    base::TimeDelta append_time = base::TimeTicks::HighResNow() - start;
+
+    total_append_time += append_time;
+    max_append_time = std::max(max_append_time, append_time);
+    if (num_gops < kGOPsPerMinute)
+      first_minute_append_time += append_time;
+    if (timecode >= kMediaDurationMs - 60 * 1000)
+      last_minute_append_time += append_time;
+    ++num_gops;
+  }
+  message_loop_.RunUntilIdle();
+
+  printf("*RESULT chunk_demuxer_append: %.2f ms/gop\n",
+         total_append_time.InMillisecondsF() / num_gops);
+  printf("*RESULT chunk_demuxer_append_first_minute: %.2f ms/gop\n",
+         first_minute_append_time.InMillisecondsF() / kGOPsPerMinute);
+  printf("*RESULT chunk_demuxer_append_last_minute: %.2f ms/gop\n",
+         last_minute_append_time.InMillisecondsF() / kGOPsPerMinute);
+  printf("*RESULT chunk_demuxer_append_max: %.2f ms/gop\n",
+         max_append_time.InMillisecondsF());
+
+  Ranges<base::TimeDelta> ranges = demuxer_->GetBufferedRanges(kSourceId);
+  ASSERT_EQ(1u, ranges.size());
+  base::TimeDelta buffered_start = ranges.start(0);
+  base::TimeDelta buffered_duration = ranges.end(0) - buffered_start;
+  ASSERT_GT(buffered_duration, base::TimeDelta());
+
+  // Step through the buffered range by a prime number of frames so that
+  // seeks land all over it, both on and between keyframes.
+  const int64 kSeekStepMs = 997 * kFrameDurationMs;
+  int64 seek_offset_ms = 0;
+  do {
+    Seek(buffered_start + base::TimeDelta::FromMilliseconds(seek_offset_ms));
+    seek_offset_ms =
+        (seek_offset_ms + kSeekStepMs) % buffered_duration.InMilliseconds();
+  } while (DidRun());
+
+  AfterTest("chunk_demuxer_seek");
+}
+
+TEST_F(ChunkDemuxerPerfTest, AppendSegment1MB) {
+  RunAppendThroughput("chunk_demuxer_append_1mb_segments", 1);
+}
+
+TEST_F(ChunkDemuxerPerfTest, AppendSegment10MB) {
+  RunAppendThroughput("chunk_demuxer_append_10mb_segments", 10);
+}
+
+TEST_F(ChunkDemuxerPerfTest, AppendSegment50MB) {
+  RunAppendThroughput("chunk_demuxer_append_50mb_segments", 50);
+}
+
+}  // namespace media
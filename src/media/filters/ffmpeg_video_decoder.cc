@@ -93,7 +93,7 @@ int FFmpegVideoDecoder::GetVideoBuffer(AVCodecContext* codec_context,
     return AVERROR(EINVAL);
 
   scoped_refptr<VideoFrame> video_frame =
-      VideoFrame::CreateFrame(format, size, gfx::Rect(size), natural_size,
+      frame_pool_.CreateFrame(format, size, gfx::Rect(size), natural_size,
                               kNoTimestamp());
 
   for (int i = 0; i < 3; i++) {
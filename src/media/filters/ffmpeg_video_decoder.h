@@ -11,6 +11,7 @@
 #include "base/memory/weak_ptr.h"
 #include "media/base/video_decoder.h"
 #include "media/base/video_decoder_config.h"
+#include "media/base/video_frame_pool.h"
 
 struct AVCodecContext;
 struct AVFrame;
@@ -39,7 +40,8 @@ class MEDIA_EXPORT FFmpegVideoDecoder : public VideoDecoder {
 
   // Callback called from within FFmpeg to allocate a buffer based on
   // the dimensions of |codec_context|. See AVCodecContext.get_buffer
-  // documentation inside FFmpeg.
+  // documentation inside FFmpeg. FFmpeg decodes straight into the returned
+  // frame, whose memory comes from |frame_pool_|.
   int GetVideoBuffer(AVCodecContext *codec_context, AVFrame* frame);
 
  private:
@@ -82,6 +84,9 @@ class MEDIA_EXPORT FFmpegVideoDecoder : public VideoDecoder {
 
   VideoDecoderConfig config_;
 
+  // Recycles the memory of frames once the renderer is done with them.
+  VideoFramePool frame_pool_;
+
   DISALLOW_COPY_AND_ASSIGN(FFmpegVideoDecoder);
 };
 
@@ -0,0 +1,163 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <deque>
+#include <set>
+#include <string>
+
+#include "base/bind.h"
+#include "base/message_loop/message_loop.h"
+#include "base/time/time.h"
+#include "media/base/decoder_buffer.h"
+#include "media/base/test_data_util.h"
+#include "media/base/test_helpers.h"
+#include "media/base/video_frame.h"
+#include "media/base/video_frame_pool.h"
+#include "media/filters/ffmpeg_glue.h"
+#include "media/filters/ffmpeg_video_decoder.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+static const int kTimeLimitMillis = 2000;
+static const int kWarmupRuns = 5;
+static const int kTimeCheckInterval = 10;
+
+// Frames decoded per run.
+static const int kFramesPerRun = 30;
+
+// The renderer holds on to about this many decoded frames.
+static const size_t kRendererQueueSize = 4;
+
+class FFmpegVideoDecoderPerfTest : public testing::Test {
+ public:
+  FFmpegVideoDecoderPerfTest() : new_buffers_(0), num_runs_(0) {}
+
+  void AfterTest(const std::string test_name, size_t allocations) {
+    // Format matches chrome/test/perf/perf_test.h:PrintResult
+    printf("*RESULT %s: %.2f fps\n",
+           test_name.c_str(),
+           num_runs_ * kFramesPerRun / elapsed_.InSecondsF());
+    printf("*RESULT %s_allocations: %.2f allocations/s\n",
+           test_name.c_str(),
+           allocations / elapsed_.InSecondsF());
+  }
+
+  bool DidRun() {
+    ++num_runs_;
+    if (num_runs_ == kWarmupRuns)
+      start_time_ = base::TimeTicks::HighResNow();
+
+    if (!start_time_.is_null() && (num_runs_ % kTimeCheckInterval) == 0) {
+      base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start_time_;
+      if (elapsed >= base::TimeDelta::FromMilliseconds(kTimeLimitMillis)) {
+        elapsed_ = elapsed;
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // Keeps |frame| the way the renderer does until newer frames replace it.
+  // Pooled frames are never freed while the test runs, so a Y plane that
+  // hasn't been seen before is a new allocation.
+  void RenderFrame(const scoped_refptr<VideoFrame>& frame) {
+    if (buffers_.insert(frame->data(VideoFrame::kYPlane)).second &&
+        !start_time_.is_null()) {
+      ++new_buffers_;
+    }
+    frames_.push_back(frame);
+    if (frames_.size() > kRendererQueueSize)
+      frames_.pop_front();
+  }
+
+ protected:
+  std::deque<scoped_refptr<VideoFrame> > frames_;
+  std::set<const uint8*> buffers_;
+  size_t new_buffers_;
+
+ private:
+  base::TimeTicks start_time_;
+  base::TimeDelta elapsed_;
+  int num_runs_;
+};
+
+static void FrameReady(VideoDecoder::Status* status_out,
+                       scoped_refptr<VideoFrame>* frame_out,
+                       VideoDecoder::Status status,
+                       const scoped_refptr<VideoFrame>& frame) {
+  *status_out = status;
+  *frame_out = frame;
+}
+
+// Decodes 320x240 VP8 key frames with FFmpeg, which allocates the frames it
+// decodes into from the decoder's frame pool.
+TEST_F(FFmpegVideoDecoderPerfTest, DecodeVP8) {
+  base::MessageLoop message_loop;
+  FFmpegGlue::InitializeFFmpeg();
+  scoped_refptr<DecoderBuffer> i_frame =
+      ReadTestDataFile("vp8-I-frame-320x240");
+
+  FFmpegVideoDecoder decoder(message_loop.message_loop_proxy());
+  decoder.Initialize(TestVideoConfig::Normal(),
+                     NewExpectedStatusCB(PIPELINE_OK));
+  message_loop.RunUntilIdle();
+
+  do {
+    for (int i = 0; i < kFramesPerRun; ++i) {
+      VideoDecoder::Status status = VideoDecoder::kDecodeError;
+      scoped_refptr<VideoFrame> frame;
+      decoder.Decode(i_frame, base::Bind(&FrameReady, &status, &frame));
+      message_loop.RunUntilIdle();
+      ASSERT_NE(VideoDecoder::kDecodeError, status);
+      if (frame.get())
+        RenderFrame(frame);
+    }
+  } while (DidRun());
+
+  AfterTest("ffmpeg_decode_vp8_320x240", new_buffers_);
+
+  frames_.clear();
+  decoder.Stop(NewExpectedClosure());
+  message_loop.RunUntilIdle();
+}
+
+// Allocates 1080p frames the way a decoder does, with and without a pool.
+TEST_F(FFmpegVideoDecoderPerfTest, AllocateFrames1080p) {
+  gfx::Size size(1920, 1080);
+  VideoFramePool pool;
+
+  do {
+    for (int i = 0; i < kFramesPerRun; ++i) {
+      RenderFrame(pool.CreateFrame(VideoFrame::YV12, size, gfx::Rect(size),
+                                   size, kNoTimestamp()));
+    }
+  } while (DidRun());
+  frames_.clear();
+
+  AfterTest("allocate_frames_1080p_pool", new_buffers_);
+}
+
+TEST_F(FFmpegVideoDecoderPerfTest, AllocateFrames1080pNoPool) {
+  gfx::Size size(1920, 1080);
+
+  // Freed frames are likely to be allocated at the same address again, so
+  // every frame counts as an allocation here.
+  size_t allocations = 0;
+  do {
+    for (int i = 0; i < kFramesPerRun; ++i) {
+      RenderFrame(VideoFrame::CreateFrame(VideoFrame::YV12, size,
+                                          gfx::Rect(size), size,
+                                          kNoTimestamp()));
+      ++allocations;
+    }
+  } while (DidRun());
+  frames_.clear();
+
+  AfterTest("allocate_frames_1080p_no_pool",
+            allocations - kWarmupRuns * kFramesPerRun);
+}
+
+}  // namespace media
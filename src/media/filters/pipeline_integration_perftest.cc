@@ -0,0 +1,90 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/filters/pipeline_integration_test_base.h"
+
+#include <string>
+
+#include "base/command_line.h"
+#include "base/file_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+#include "media/base/media_switches.h"
+#include "media/base/test_data_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+// Video-only clips are played this many times faster than real time, so
+// the renderer always wants the next frame and decoding is the bottleneck.
+static const float kPlaybackRate = 100.0f;
+
+static const int kThreadCounts[] = { 1, 2, 4, 8 };
+
+// Plays a clip through the whole pipeline and reports how many frames per
+// second were decoded.
+class DecodeBenchmark : public PipelineIntegrationTestBase {
+ public:
+  DecodeBenchmark() {}
+
+  void Run(const std::string& test_name, const base::FilePath& file_path) {
+    // Hashing disables frame dropping, so every frame is decoded.
+    ASSERT_TRUE(Start(file_path, PIPELINE_OK, true));
+
+    base::TimeTicks start = base::TimeTicks::HighResNow();
+    pipeline_->SetPlaybackRate(kPlaybackRate);
+    ASSERT_TRUE(WaitUntilOnEnded());
+    base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start;
+
+    PipelineStatistics stats = pipeline_->GetStatistics();
+    Stop();
+
+    // Format matches chrome/test/perf/perf_test.h:PrintResult
+    printf("*RESULT %s: %.2f fps\n",
+           test_name.c_str(),
+           stats.video_frames_decoded / elapsed.InSecondsF());
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(DecodeBenchmark);
+};
+
+// Decodes |filename| with each of kThreadCounts libvpx threads.
+static void RunVp9DecodeBenchmark(const std::string& test_name,
+                                  const std::string& filename) {
+  base::FilePath file_path = GetTestDataFilePath(filename);
+  if (!base::PathExists(file_path)) {
+    LOG(WARNING) << "Skipping " << test_name << ", " << filename
+                 << " is not in media/test/data.";
+    return;
+  }
+
+  // The decoder reads its thread count from the process's command line, so
+  // put that back afterwards for the tests that run next.
+  CommandLine* cmd_line = CommandLine::ForCurrentProcess();
+  const CommandLine original_cmd_line(*cmd_line);
+  for (size_t i = 0; i < arraysize(kThreadCounts); ++i) {
+    std::string threads = base::IntToString(kThreadCounts[i]);
+    cmd_line->AppendSwitchASCII(switches::kVideoThreads, threads);
+    DecodeBenchmark benchmark;
+    benchmark.Run(test_name + "_threads_" + threads, file_path);
+  }
+  *cmd_line = original_cmd_line;
+}
+
+TEST(PipelineIntegrationPerfTest, VP9DecodeSmall) {
+  RunVp9DecodeBenchmark("vp9_decode_320x240", "bear-vp9.webm");
+}
+
+// The HD clips are too big to check in with the other test data, so these
+// tests only run where they have been copied into media/test/data.
+TEST(PipelineIntegrationPerfTest, VP9Decode1080p) {
+  RunVp9DecodeBenchmark("vp9_decode_1920x1080", "vp9-1920x1080.webm");
+}
+
+TEST(PipelineIntegrationPerfTest, VP9Decode4K) {
+  RunVp9DecodeBenchmark("vp9_decode_3840x2160", "vp9-3840x2160.webm");
+}
+
+}  // namespace media
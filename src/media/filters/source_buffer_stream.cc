@@ -254,12 +254,26 @@ static bool IsRangeListSorted(
   return true;
 }
 
-// Comparison function for two Buffers based on timestamp.
-static bool BufferComparator(
-    const scoped_refptr<media::StreamParserBuffer>& first,
-    const scoped_refptr<media::StreamParserBuffer>& second) {
-  return first->GetDecodeTimestamp() < second->GetDecodeTimestamp();
-}
+// Orders buffers by decode timestamp, so that |buffers_| can be searched for
+// a timestamp without making a dummy buffer to compare against.
+struct BufferTimestampComparator {
+  bool operator()(
+      const scoped_refptr<media::StreamParserBuffer>& buffer,
+      base::TimeDelta timestamp) const {
+    return buffer->GetDecodeTimestamp() < timestamp;
+  }
+  bool operator()(
+      base::TimeDelta timestamp,
+      const scoped_refptr<media::StreamParserBuffer>& buffer) const {
+    return timestamp < buffer->GetDecodeTimestamp();
+  }
+  // Used by debug iterator checks that the range is sorted.
+  bool operator()(
+      const scoped_refptr<media::StreamParserBuffer>& first,
+      const scoped_refptr<media::StreamParserBuffer>& second) const {
+    return first->GetDecodeTimestamp() < second->GetDecodeTimestamp();
+  }
+};
 
 // Returns an estimate of how far from the beginning or end of a range a buffer
 // can be to still be considered in the range, given the |approximate_duration|
@@ -1067,6 +1081,10 @@ base::TimeDelta SourceBufferStream::GetEndBufferTimestamp() {
 SourceBufferStream::RangeList::iterator
 SourceBufferStream::FindExistingRangeFor(base::TimeDelta start_timestamp) {
   for (RangeList::iterator itr = ranges_.begin(); itr != ranges_.end(); ++itr) {
+    // |ranges_| is sorted, and no range can contain a timestamp before its
+    // start, so there is no need to look past here.
+    if ((*itr)->GetStartTimestamp() > start_timestamp)
+      break;
     if ((*itr)->BelongsToRange(start_timestamp))
       return itr;
   }
@@ -1490,18 +1508,31 @@ SourceBufferRange* SourceBufferRange::SplitRange(
 
 SourceBufferRange::BufferQueue::iterator SourceBufferRange::GetBufferItrAt(
     base::TimeDelta timestamp, bool skip_given_timestamp) {
-  // Need to make a dummy buffer with timestamp |timestamp| in order to search
-  // the |buffers_| container.
-  scoped_refptr<StreamParserBuffer> dummy_buffer =
-      StreamParserBuffer::CopyFrom(NULL, 0, false);
-  dummy_buffer->SetDecodeTimestamp(timestamp);
+  // Only the GOP containing |timestamp| needs to be searched: every buffer
+  // before its keyframe is earlier than |timestamp|, and the next keyframe is
+  // already past it. This keeps lookups in long ranges from touching more
+  // than one GOP's worth of buffers.
+  KeyframeMap::iterator next_keyframe =
+      GetFirstKeyframeAt(timestamp, skip_given_timestamp);
+  BufferQueue::iterator search_begin = buffers_.begin();
+  BufferQueue::iterator search_end = buffers_.end();
+  if (next_keyframe != keyframe_map_.end()) {
+    search_end = buffers_.begin() +
+        (next_keyframe->second - keyframe_map_index_base_);
+  }
+  if (next_keyframe != keyframe_map_.begin()) {
+    KeyframeMap::iterator gop_keyframe = next_keyframe;
+    --gop_keyframe;
+    search_begin = buffers_.begin() +
+        (gop_keyframe->second - keyframe_map_index_base_);
+  }
 
   if (skip_given_timestamp) {
     return std::upper_bound(
-        buffers_.begin(), buffers_.end(), dummy_buffer, BufferComparator);
+        search_begin, search_end, timestamp, BufferTimestampComparator());
   }
   return std::lower_bound(
-      buffers_.begin(), buffers_.end(), dummy_buffer, BufferComparator);
+      search_begin, search_end, timestamp, BufferTimestampComparator());
 }
 
 SourceBufferRange::KeyframeMap::iterator
@@ -15,6 +15,7 @@
 #include "base/message_loop/message_loop_proxy.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/sys_byteorder.h"
+#include "base/sys_info.h"
 #include "media/base/bind_to_loop.h"
 #include "media/base/decoder_buffer.h"
 #include "media/base/demuxer_stream.h"
@@ -41,8 +42,19 @@ namespace media {
 static const int kDecodeThreads = 2;
 static const int kMaxDecodeThreads = 16;
 
-// Returns the number of threads.
-static int GetThreadCount() {
+// libvpx decodes the tile columns of a VP9 frame in parallel. Tile columns
+// are at least 256 pixels wide, so wide streams can make use of more
+// threads.
+static const int kVp9HdWidth = 1024;
+static const int kVp9HdDecodeThreads = 4;
+static const int kVp9UltraHdWidth = 2048;
+static const int kVp9UltraHdDecodeThreads = 8;
+
+// One buffer is decoded while the next one is queued up behind it.
+static const int kMaxPendingDecodes = 2;
+
+// Returns the number of threads libvpx should use to decode |config|.
+static int GetThreadCount(const VideoDecoderConfig& config) {
   // TODO(scherkus): De-duplicate this function and the one used by
   // FFmpegVideoDecoder.
 
@@ -51,8 +63,17 @@ static int GetThreadCount() {
 
   const CommandLine* cmd_line = CommandLine::ForCurrentProcess();
   std::string threads(cmd_line->GetSwitchValueASCII(switches::kVideoThreads));
-  if (threads.empty() || !base::StringToInt(threads, &decode_threads))
-    return decode_threads;
+  if (threads.empty() || !base::StringToInt(threads, &decode_threads)) {
+    decode_threads = kDecodeThreads;
+    if (config.codec() == kCodecVP9) {
+      int width = config.coded_size().width();
+      if (width >= kVp9UltraHdWidth)
+        decode_threads = kVp9UltraHdDecodeThreads;
+      else if (width >= kVp9HdWidth)
+        decode_threads = kVp9HdDecodeThreads;
+    }
+    return std::min(decode_threads, base::SysInfo::NumberOfProcessors());
+  }
 
   decode_threads = std::max(decode_threads, 0);
   decode_threads = std::min(decode_threads, kMaxDecodeThreads);
@@ -65,7 +86,10 @@ VpxVideoDecoder::VpxVideoDecoder(
       weak_factory_(this),
       state_(kUninitialized),
       vpx_codec_(NULL),
-      vpx_codec_alpha_(NULL) {
+      vpx_codec_alpha_(NULL),
+      decoder_thread_("VpxVideoDecoderThread"),
+      pending_decodes_(0),
+      decode_error_(false) {
 }
 
 VpxVideoDecoder::~VpxVideoDecoder() {
@@ -80,6 +104,7 @@ void VpxVideoDecoder::Initialize(const VideoDecoderConfig& config,
   DCHECK(!config.is_encrypted());
   DCHECK(decode_cb_.is_null());
   DCHECK(reset_cb_.is_null());
+  DCHECK_EQ(0, pending_decodes_);
 
   weak_this_ = weak_factory_.GetWeakPtr();
 
@@ -88,6 +113,11 @@ void VpxVideoDecoder::Initialize(const VideoDecoderConfig& config,
     return;
   }
 
+  if (!decoder_thread_.IsRunning() && !decoder_thread_.Start()) {
+    status_cb.Run(PIPELINE_ERROR_INITIALIZATION_FAILED);
+    return;
+  }
+
   // Success!
   config_ = config;
   state_ = kNormal;
@@ -100,7 +130,7 @@ static vpx_codec_ctx* InitializeVpxContext(vpx_codec_ctx* context,
   vpx_codec_dec_cfg_t vpx_config = {0};
   vpx_config.w = config.coded_size().width();
   vpx_config.h = config.coded_size().height();
-  vpx_config.threads = GetThreadCount();
+  vpx_config.threads = GetThreadCount(config);
 
   vpx_codec_err_t status = vpx_codec_dec_init(context,
                                               config.codec() == kCodecVP9 ?
@@ -176,7 +206,22 @@ void VpxVideoDecoder::Decode(const scoped_refptr<DecoderBuffer>& buffer,
     return;
   }
 
-  DecodeBuffer(buffer);
+  DCHECK(reset_cb_.is_null());
+  DCHECK(buffer);
+
+  // Transition to kFlushCodec on the first end of stream buffer. The frames
+  // of the buffers still being decoded are returned before the empty frame.
+  if (buffer->end_of_stream()) {
+    state_ = kFlushCodec;
+  } else {
+    DCHECK_EQ(state_, kNormal);
+    ++pending_decodes_;
+    decoder_thread_.message_loop_proxy()->PostTask(FROM_HERE, base::Bind(
+        &VpxVideoDecoder::DecodeOnDecoderThread, base::Unretained(this),
+        buffer, weak_this_));
+  }
+
+  SatisfyDecodeIfPossible();
 }
 
 void VpxVideoDecoder::Reset(const base::Closure& closure) {
@@ -184,8 +229,9 @@ void VpxVideoDecoder::Reset(const base::Closure& closure) {
   DCHECK(reset_cb_.is_null());
   reset_cb_ = BindToCurrentLoop(closure);
 
-  // Defer the reset if a decode is pending.
-  if (!decode_cb_.is_null())
+  // Defer the reset if a decode is pending, or while libvpx is still
+  // decoding buffers from before the reset.
+  if (!decode_cb_.is_null() || pending_decodes_)
     return;
 
   DoReset();
@@ -198,12 +244,18 @@ void VpxVideoDecoder::Stop(const base::Closure& closure) {
   if (state_ == kUninitialized)
     return;
 
-  if (!decode_cb_.is_null()) {
+  // Wait for libvpx to finish the buffers it is decoding, and drop their
+  // frames.
+  decoder_thread_.Stop();
+  weak_factory_.InvalidateWeakPtrs();
+  pending_decodes_ = 0;
+  ready_frames_.clear();
+  decode_error_ = false;
+
+  if (!decode_cb_.is_null())
     base::ResetAndReturn(&decode_cb_).Run(kOk, NULL);
-    // Reset is pending only when decode is pending.
-    if (!reset_cb_.is_null())
-      base::ResetAndReturn(&reset_cb_).Run();
-  }
+  if (!reset_cb_.is_null())
+    base::ResetAndReturn(&reset_cb_).Run();
 
   state_ = kUninitialized;
 }
@@ -212,36 +264,65 @@ bool VpxVideoDecoder::HasAlpha() const {
   return vpx_codec_alpha_ != NULL;
 }
 
-void VpxVideoDecoder::DecodeBuffer(const scoped_refptr<DecoderBuffer>& buffer) {
+void VpxVideoDecoder::DecodeOnDecoderThread(
+    const scoped_refptr<DecoderBuffer>& buffer,
+    const base::WeakPtr<VpxVideoDecoder>& weak_this) {
+  DCHECK(decoder_thread_.message_loop_proxy()->BelongsToCurrentThread());
+
+  scoped_refptr<VideoFrame> video_frame;
+  bool success = VpxDecode(buffer, &video_frame);
+  message_loop_->PostTask(FROM_HERE, base::Bind(
+      &VpxVideoDecoder::OnBufferDecoded, weak_this, success, video_frame));
+}
+
+void VpxVideoDecoder::OnBufferDecoded(
+    bool success,
+    const scoped_refptr<VideoFrame>& video_frame) {
   DCHECK(message_loop_->BelongsToCurrentThread());
-  DCHECK_NE(state_, kUninitialized);
-  DCHECK_NE(state_, kDecodeFinished);
-  DCHECK_NE(state_, kError);
-  DCHECK(reset_cb_.is_null());
-  DCHECK(!decode_cb_.is_null());
-  DCHECK(buffer);
+  DCHECK_GT(pending_decodes_, 0);
+  --pending_decodes_;
 
-  // Transition to kDecodeFinished on the first end of stream buffer.
-  if (state_ == kNormal && buffer->end_of_stream()) {
-    state_ = kDecodeFinished;
-    base::ResetAndReturn(&decode_cb_).Run(kOk, VideoFrame::CreateEmptyFrame());
+  if (!success)
+    decode_error_ = true;
+  else if (video_frame.get())
+    ready_frames_.push_back(video_frame);
+
+  if (!decode_cb_.is_null()) {
+    SatisfyDecodeIfPossible();
     return;
   }
 
-  scoped_refptr<VideoFrame> video_frame;
-  if (!VpxDecode(buffer, &video_frame)) {
+  if (!reset_cb_.is_null() && !pending_decodes_)
+    DoReset();
+}
+
+void VpxVideoDecoder::SatisfyDecodeIfPossible() {
+  DCHECK(message_loop_->BelongsToCurrentThread());
+  DCHECK(!decode_cb_.is_null());
+
+  if (decode_error_) {
     state_ = kError;
+    ready_frames_.clear();
     base::ResetAndReturn(&decode_cb_).Run(kDecodeError, NULL);
-    return;
-  }
-
-  // If we didn't get a frame we need more data.
-  if (!video_frame.get()) {
+  } else if (!ready_frames_.empty()) {
+    scoped_refptr<VideoFrame> video_frame = ready_frames_.front();
+    ready_frames_.pop_front();
+    base::ResetAndReturn(&decode_cb_).Run(kOk, video_frame);
+  } else if (state_ == kFlushCodec) {
+    // Wait for the remaining buffers to be decoded.
+    if (pending_decodes_)
+      return;
+    state_ = kDecodeFinished;
+    base::ResetAndReturn(&decode_cb_).Run(kOk, VideoFrame::CreateEmptyFrame());
+  } else if (pending_decodes_ < kMaxPendingDecodes) {
     base::ResetAndReturn(&decode_cb_).Run(kNotEnoughData, NULL);
+  } else {
+    // Wait for a pending buffer to be decoded.
     return;
   }
 
-  base::ResetAndReturn(&decode_cb_).Run(kOk, video_frame);
+  if (!reset_cb_.is_null() && !pending_decodes_)
+    DoReset();
 }
 
 bool VpxVideoDecoder::VpxDecode(const scoped_refptr<DecoderBuffer>& buffer,
@@ -319,7 +400,10 @@ bool VpxVideoDecoder::VpxDecode(const scoped_refptr<DecoderBuffer>& buffer,
 
 void VpxVideoDecoder::DoReset() {
   DCHECK(decode_cb_.is_null());
+  DCHECK_EQ(0, pending_decodes_);
 
+  ready_frames_.clear();
+  decode_error_ = false;
   state_ = kNormal;
   reset_cb_.Run();
   reset_cb_.Reset();
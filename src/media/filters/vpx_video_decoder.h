@@ -5,8 +5,11 @@
 #ifndef MEDIA_FILTERS_VPX_VIDEO_DECODER_H_
 #define MEDIA_FILTERS_VPX_VIDEO_DECODER_H_
 
+#include <deque>
+
 #include "base/callback.h"
 #include "base/memory/weak_ptr.h"
+#include "base/threading/thread.h"
 #include "media/base/demuxer_stream.h"
 #include "media/base/video_decoder.h"
 #include "media/base/video_decoder_config.h"
@@ -25,6 +28,11 @@ namespace media {
 // Note: VpxVideoDecoder accepts only YV12A VP8 content or VP9 content. This is
 // done to avoid usurping FFmpeg for all vp8 decoding, because the FFmpeg VP8
 // decoder is faster than the libvpx VP8 decoder.
+//
+// Buffers are decoded on a dedicated thread so that decoding a large frame
+// doesn't hold up the media thread. A few buffers may be in flight at once:
+// Decode() asks for more data while fewer than kMaxPendingDecodes buffers
+// are being decoded, and returns decoded frames in order on later calls.
 class MEDIA_EXPORT VpxVideoDecoder : public VideoDecoder {
  public:
   explicit VpxVideoDecoder(
@@ -55,7 +63,17 @@ class MEDIA_EXPORT VpxVideoDecoder : public VideoDecoder {
 
   void CloseDecoder();
 
-  void DecodeBuffer(const scoped_refptr<DecoderBuffer>& buffer);
+  // Decodes |buffer| on |decoder_thread_| and posts the result back to
+  // OnBufferDecoded() through |weak_this|.
+  void DecodeOnDecoderThread(const scoped_refptr<DecoderBuffer>& buffer,
+                             const base::WeakPtr<VpxVideoDecoder>& weak_this);
+  void OnBufferDecoded(bool success,
+                       const scoped_refptr<VideoFrame>& video_frame);
+
+  // Runs |decode_cb_| if there is a frame, an error or a request for more
+  // data to report, and then finishes a pending reset if it can.
+  void SatisfyDecodeIfPossible();
+
   bool VpxDecode(const scoped_refptr<DecoderBuffer>& buffer,
                  scoped_refptr<VideoFrame>* video_frame);
 
@@ -80,6 +98,20 @@ class MEDIA_EXPORT VpxVideoDecoder : public VideoDecoder {
   vpx_codec_ctx* vpx_codec_;
   vpx_codec_ctx* vpx_codec_alpha_;
 
+  // Once the decoder is initialized, libvpx is only used on this thread.
+  base::Thread decoder_thread_;
+
+  // Number of buffers posted to |decoder_thread_| whose result hasn't come
+  // back yet.
+  int pending_decodes_;
+
+  // Decoded frames that haven't been returned yet, in decode order. There
+  // are never more of them than kMaxPendingDecodes.
+  std::deque<scoped_refptr<VideoFrame> > ready_frames_;
+
+  // Set when decoding a pending buffer failed.
+  bool decode_error_;
+
   DISALLOW_COPY_AND_ASSIGN(VpxVideoDecoder);
 };
 
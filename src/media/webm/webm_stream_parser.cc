@@ -75,14 +75,25 @@ bool WebMStreamParser::Parse(const uint8* buf, int size) {
   if (state_ == kError)
     return false;
 
-  byte_queue_.Push(buf, size);
-
   int result = 0;
   int bytes_parsed = 0;
   const uint8* cur = NULL;
   int cur_size = 0;
 
+  // Appends usually end on an element boundary, so when nothing is left over
+  // from the previous call, parse straight out of |buf| and only queue what
+  // couldn't be parsed yet. This avoids copying every append, which matters
+  // for multi-megabyte media segments.
   byte_queue_.Peek(&cur, &cur_size);
+  bool parsing_from_queue = cur_size > 0;
+  if (parsing_from_queue) {
+    byte_queue_.Push(buf, size);
+    byte_queue_.Peek(&cur, &cur_size);
+  } else {
+    cur = buf;
+    cur_size = size;
+  }
+
   while (cur_size > 0) {
     State oldState = state_;
     switch (state_) {
@@ -113,7 +124,10 @@ bool WebMStreamParser::Parse(const uint8* buf, int size) {
     bytes_parsed += result;
   }
 
-  byte_queue_.Pop(bytes_parsed);
+  if (parsing_from_queue)
+    byte_queue_.Pop(bytes_parsed);
+  else if (cur_size > 0)
+    byte_queue_.Push(cur, cur_size);
   return true;
 }
 
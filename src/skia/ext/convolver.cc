@@ -3,10 +3,17 @@
 // found in the LICENSE file.
 
 #include <algorithm>
+#include <deque>
 
+#include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/memory/scoped_vector.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/simple_thread.h"
 #include "skia/ext/convolver.h"
 #include "skia/ext/convolver_SSE2.h"
+#include "skia/ext/convolver_avx2.h"
 #include "skia/ext/convolver_mips_dspr2.h"
 #include "third_party/skia/include/core/SkSize.h"
 #include "third_party/skia/include/core/SkTypes.h"
@@ -369,6 +376,15 @@ void SetupSIMD(ConvolveProcs *procs) {
     procs->convolve_4rows_horizontally = &Convolve4RowsHorizontally_SSE2;
     procs->convolve_horizontally = &ConvolveHorizontally_SSE2;
   }
+#ifdef SIMD_AVX2
+  // The AVX2 procs read as many pixels past the end of a row as the SSE2
+  // ones.
+  if (cpu.has_avx2()) {
+    procs->convolve_vertically = &ConvolveVertically_AVX2;
+    procs->convolve_4rows_horizontally = &Convolve4RowsHorizontally_AVX2;
+    procs->convolve_horizontally = &ConvolveHorizontally_AVX2;
+  }
+#endif
 #elif defined SIMD_MIPS_DSPR2
   procs->extra_horizontal_reads = 3;
   procs->convolve_vertically = &ConvolveVertically_mips_dspr2;
@@ -376,33 +392,76 @@ void SetupSIMD(ConvolveProcs *procs) {
 #endif
 }
 
-void BGRAConvolve2D(const unsigned char* source_data,
-                    int source_byte_row_stride,
-                    bool source_has_alpha,
-                    const ConvolutionFilter1D& filter_x,
-                    const ConvolutionFilter1D& filter_y,
-                    int output_byte_row_stride,
-                    unsigned char* output,
-                    bool use_simd_if_possible) {
-  ConvolveProcs simd;
-  simd.extra_horizontal_reads = 0;
-  simd.convolve_vertically = NULL;
-  simd.convolve_4rows_horizontally = NULL;
-  simd.convolve_horizontally = NULL;
-  if (use_simd_if_possible) {
-    SetupSIMD(&simd);
-  }
+namespace {
+
+// Output images are split into bands of at least this many rows before
+// being convolved on several threads. The horizontally convolved rows at
+// the top of each band are computed by both bands that need them, so thin
+// bands would mostly redo their neighbours' work.
+const int kMinRowsPerBand = 32;
+
+// Convolves the output rows [begin_row, end_row) of a BGRAConvolve2D call.
+// Bands of the same image only share the read-only filters and source, so
+// they can be run on different threads.
+class RowBandConvolver {
+ public:
+  RowBandConvolver(const unsigned char* source_data,
+                   int source_byte_row_stride,
+                   bool source_has_alpha,
+                   const ConvolutionFilter1D& filter_x,
+                   const ConvolutionFilter1D& filter_y,
+                   int output_byte_row_stride,
+                   unsigned char* output,
+                   const ConvolveProcs& simd,
+                   int begin_row,
+                   int end_row)
+      : source_data_(source_data),
+        source_byte_row_stride_(source_byte_row_stride),
+        source_has_alpha_(source_has_alpha),
+        filter_x_(filter_x),
+        filter_y_(filter_y),
+        output_byte_row_stride_(output_byte_row_stride),
+        output_(output),
+        simd_(simd),
+        begin_row_(begin_row),
+        end_row_(end_row) {}
+
+  void Run();
+
+ private:
+  const unsigned char* source_data_;
+  int source_byte_row_stride_;
+  bool source_has_alpha_;
+  const ConvolutionFilter1D& filter_x_;
+  const ConvolutionFilter1D& filter_y_;
+  int output_byte_row_stride_;
+  unsigned char* output_;
+  const ConvolveProcs& simd_;
+  int begin_row_;
+  int end_row_;
+
+  DISALLOW_COPY_AND_ASSIGN(RowBandConvolver);
+};
+
+void RowBandConvolver::Run() {
+  const ConvolutionFilter1D& filter_x = filter_x_;
+  const ConvolutionFilter1D& filter_y = filter_y_;
+  const ConvolveProcs& simd = simd_;
+  const unsigned char* source_data = source_data_;
+  int source_byte_row_stride = source_byte_row_stride_;
+  bool source_has_alpha = source_has_alpha_;
 
   int max_y_filter_size = filter_y.max_filter();
 
   // The next row in the input that we will generate a horizontally
   // convolved row for. If the filter doesn't start at the beginning of the
-  // image (this is the case when we are only resizing a subset), then we
-  // don't want to generate any output rows before that. Compute the starting
-  // row for convolution as the first pixel for the first vertical filter.
+  // image (this is the case when we are only resizing a subset, or when
+  // this is not the first band), then we don't want to generate any output
+  // rows before that. Compute the starting row for convolution as the first
+  // pixel for the first vertical filter of the band.
   int filter_offset, filter_length;
   const ConvolutionFilter1D::Fixed* filter_values =
-      filter_y.FilterForValue(0, &filter_offset, &filter_length);
+      filter_y.FilterForValue(begin_row_, &filter_offset, &filter_length);
   int next_x_row = filter_offset;
 
   // We loop over each row in the input doing a horizontal convolution. This
@@ -422,9 +481,8 @@ void BGRAConvolve2D(const unsigned char* source_data,
                                row_buffer_height,
                                filter_offset);
 
-  // Loop over every possible output row, processing just enough horizontal
-  // convolutions to run each subsequent vertical convolution.
-  SkASSERT(output_byte_row_stride >= filter_x.num_values() * 4);
+  // Loop over every output row in the band, processing just enough
+  // horizontal convolutions to run each subsequent vertical convolution.
   int num_output_rows = filter_y.num_values();
 
   // We need to check which is the last line to convolve before we advance 4
@@ -446,7 +504,7 @@ void BGRAConvolve2D(const unsigned char* source_data,
   filter_y.FilterForValue(num_output_rows - 1, &last_filter_offset,
                           &last_filter_length);
 
-  for (int out_y = 0; out_y < num_output_rows; out_y++) {
+  for (int out_y = begin_row_; out_y < end_row_; out_y++) {
     filter_values = filter_y.FilterForValue(out_y,
                                             &filter_offset, &filter_length);
 
@@ -487,7 +545,7 @@ void BGRAConvolve2D(const unsigned char* source_data,
     }
 
     // Compute where in the output image this row of final data will go.
-    unsigned char* cur_output_row = &output[out_y * output_byte_row_stride];
+    unsigned char* cur_output_row = &output_[out_y * output_byte_row_stride_];
 
     // Get the list of rows that the circular buffer has, in order.
     int first_row_in_circular_buffer;
@@ -513,6 +571,159 @@ void BGRAConvolve2D(const unsigned char* source_data,
   }
 }
 
+// The threads that BGRAConvolve2DInParallel convolves bands on. They are
+// started the first time a call needs them and then wait for the bands of
+// later calls, so a call does not pay for creating and joining threads. The
+// pool grows to one thread less than the most bands any call has had.
+class BandThreadPool : public base::DelegateSimpleThread::Delegate {
+ public:
+  BandThreadPool();
+  virtual ~BandThreadPool();
+
+  // Runs bands[0] on the calling thread and the other bands on the pool,
+  // and returns once all of them are done. Bands of other calls that are
+  // still queued may delay this one, in which case the calling thread runs
+  // its own bands that no thread has picked up yet.
+  void RunBands(const std::vector<RowBandConvolver*>& bands);
+
+  // Overridden from base::DelegateSimpleThread::Delegate:
+  virtual void Run() OVERRIDE;
+
+ private:
+  // A band waiting for a thread. |remaining| counts the bands of the same
+  // call that have not finished.
+  struct QueuedBand {
+    RowBandConvolver* band;
+    size_t* remaining;
+  };
+
+  base::Lock lock_;
+  base::ConditionVariable band_queued_;
+  base::ConditionVariable band_finished_;
+  std::deque<QueuedBand> queue_;
+  ScopedVector<base::DelegateSimpleThread> threads_;
+
+  DISALLOW_COPY_AND_ASSIGN(BandThreadPool);
+};
+
+BandThreadPool::BandThreadPool()
+    : band_queued_(&lock_),
+      band_finished_(&lock_) {
+}
+
+// The pool is leaked, so its threads never have to be joined.
+BandThreadPool::~BandThreadPool() {}
+
+void BandThreadPool::RunBands(const std::vector<RowBandConvolver*>& bands) {
+  size_t remaining = bands.size() - 1;
+  {
+    base::AutoLock auto_lock(lock_);
+    for (size_t i = 1; i < bands.size(); ++i) {
+      QueuedBand queued = { bands[i], &remaining };
+      queue_.push_back(queued);
+    }
+    while (threads_.size() < bands.size() - 1) {
+      threads_.push_back(
+          new base::DelegateSimpleThread(this, "BGRAConvolve2D"));
+      threads_.back()->Start();
+    }
+    band_queued_.Broadcast();
+  }
+
+  bands[0]->Run();
+
+  base::AutoLock auto_lock(lock_);
+  while (remaining) {
+    std::deque<QueuedBand>::iterator it = queue_.begin();
+    while (it != queue_.end() && it->remaining != &remaining)
+      ++it;
+    if (it == queue_.end()) {
+      band_finished_.Wait();
+      continue;
+    }
+    RowBandConvolver* band = it->band;
+    queue_.erase(it);
+    {
+      base::AutoUnlock auto_unlock(lock_);
+      band->Run();
+    }
+    remaining--;
+  }
+}
+
+void BandThreadPool::Run() {
+  base::AutoLock auto_lock(lock_);
+  for (;;) {
+    while (queue_.empty())
+      band_queued_.Wait();
+    QueuedBand queued = queue_.front();
+    queue_.pop_front();
+    {
+      base::AutoUnlock auto_unlock(lock_);
+      queued.band->Run();
+    }
+    (*queued.remaining)--;
+    band_finished_.Broadcast();
+  }
+}
+
+base::LazyInstance<BandThreadPool>::Leaky g_band_thread_pool =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+void BGRAConvolve2D(const unsigned char* source_data,
+                    int source_byte_row_stride,
+                    bool source_has_alpha,
+                    const ConvolutionFilter1D& filter_x,
+                    const ConvolutionFilter1D& filter_y,
+                    int output_byte_row_stride,
+                    unsigned char* output,
+                    bool use_simd_if_possible) {
+  BGRAConvolve2DInParallel(source_data, source_byte_row_stride,
+                           source_has_alpha, filter_x, filter_y,
+                           output_byte_row_stride, output,
+                           use_simd_if_possible, 1);
+}
+
+void BGRAConvolve2DInParallel(const unsigned char* source_data,
+                              int source_byte_row_stride,
+                              bool source_has_alpha,
+                              const ConvolutionFilter1D& filter_x,
+                              const ConvolutionFilter1D& filter_y,
+                              int output_byte_row_stride,
+                              unsigned char* output,
+                              bool use_simd_if_possible,
+                              int num_threads) {
+  ConvolveProcs simd;
+  simd.extra_horizontal_reads = 0;
+  simd.convolve_vertically = NULL;
+  simd.convolve_4rows_horizontally = NULL;
+  simd.convolve_horizontally = NULL;
+  if (use_simd_if_possible) {
+    SetupSIMD(&simd);
+  }
+
+  SkASSERT(output_byte_row_stride >= filter_x.num_values() * 4);
+  int num_output_rows = filter_y.num_values();
+  int num_bands = std::max(
+      1, std::min(num_threads, num_output_rows / kMinRowsPerBand));
+
+  ScopedVector<RowBandConvolver> bands;
+  for (int i = 0; i < num_bands; ++i) {
+    bands.push_back(new RowBandConvolver(
+        source_data, source_byte_row_stride, source_has_alpha,
+        filter_x, filter_y, output_byte_row_stride, output, simd,
+        num_output_rows * i / num_bands,
+        num_output_rows * (i + 1) / num_bands));
+  }
+
+  if (num_bands == 1)
+    bands[0]->Run();
+  else
+    g_band_thread_pool.Get().RunBands(bands.get());
+}
+
 void SingleChannelConvolveX1D(const unsigned char* source_data,
                               int source_byte_row_stride,
                               int input_channel_index,
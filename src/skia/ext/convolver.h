@@ -20,6 +20,15 @@
 #define SIMD_PADDING 8  // 8 * int16
 #endif
 
+// AVX2 versions are built with compilers that can generate AVX2 code, and
+// are picked over the SSE2 ones when the CPU and OS support AVX2.
+#if defined(SIMD_SSE2) && (defined(__clang__) || \
+    (defined(__GNUC__) && \
+     (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))) || \
+    (defined(_MSC_VER) && _MSC_VER >= 1700))
+#define SIMD_AVX2 1
+#endif
+
 #if defined (ARCH_CPU_MIPS_FAMILY) && \
     defined(__mips_dsp) && (__mips_dsp_rev >= 2)
 #define SIMD_MIPS_DSPR2 1
@@ -191,6 +200,20 @@ SK_API void BGRAConvolve2D(const unsigned char* source_data,
                            unsigned char* output,
                            bool use_simd_if_possible);
 
+// Same as BGRAConvolve2D, but splits the output image into bands of rows
+// that are convolved on up to |num_threads| threads, one of which is the
+// calling thread. Small images use fewer threads. The result is identical
+// to that of BGRAConvolve2D.
+SK_API void BGRAConvolve2DInParallel(const unsigned char* source_data,
+                                     int source_byte_row_stride,
+                                     bool source_has_alpha,
+                                     const ConvolutionFilter1D& xfilter,
+                                     const ConvolutionFilter1D& yfilter,
+                                     int output_byte_row_stride,
+                                     unsigned char* output,
+                                     bool use_simd_if_possible,
+                                     int num_threads);
+
 // Does a 1D convolution of the given source image along the X dimension on
 // a single channel of the bitmap.
 //
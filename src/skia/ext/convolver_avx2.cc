@@ -0,0 +1,275 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string.h>
+
+#include "skia/ext/convolver.h"
+#include "skia/ext/convolver_avx2.h"
+#include "third_party/skia/include/core/SkTypes.h"
+
+#if defined(SIMD_AVX2)
+
+#include <immintrin.h>  // This file is built with -mavx2 (/arch:AVX2).
+
+namespace skia {
+
+namespace {
+
+// Loads four filter coefficients and spreads them over the channels of the
+// four pixels they apply to, the first two in the low 128-bit lane and the
+// last two in the high one.
+// [16] c3 c3 c3 c3 c2 c2 c2 c2 | c1 c1 c1 c1 c0 c0 c0 c0
+inline __m256i LoadCoefficients(const ConvolutionFilter1D::Fixed* values,
+                                __m128i mask) {
+  // [16] xx xx xx xx c3 c2 c1 c0
+  __m128i coeff = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(values));
+  coeff = _mm_and_si128(coeff, mask);
+  // [16] c3 c3 c2 c2 c1 c1 c0 c0
+  coeff = _mm_unpacklo_epi16(coeff, coeff);
+  return _mm256_inserti128_si256(
+      _mm256_castsi128_si256(_mm_unpacklo_epi32(coeff, coeff)),
+      _mm_unpackhi_epi32(coeff, coeff), 1);
+}
+
+// Multiplies four pixels at |src| with the coefficients from
+// LoadCoefficients() and adds the products to |accum|, which holds one
+// partial sum per channel in each lane.
+inline __m256i AccumulateFourPixels(const unsigned char* src,
+                                    __m256i coeff16,
+                                    __m256i accum) {
+  // [16] a3 b3 g3 r3 a2 b2 g2 r2 | a1 b1 g1 r1 a0 b0 g0 r0
+  __m256i src16 = _mm256_cvtepu8_epi16(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+  __m256i mul_hi = _mm256_mulhi_epi16(src16, coeff16);
+  __m256i mul_lo = _mm256_mullo_epi16(src16, coeff16);
+  // [32] a2*c2 b2*c2 g2*c2 r2*c2 | a0*c0 b0*c0 g0*c0 r0*c0
+  accum = _mm256_add_epi32(accum, _mm256_unpacklo_epi16(mul_lo, mul_hi));
+  // [32] a3*c3 b3*c3 g3*c3 r3*c3 | a1*c1 b1*c1 g1*c1 r1*c1
+  return _mm256_add_epi32(accum, _mm256_unpackhi_epi16(mul_lo, mul_hi));
+}
+
+// Adds up the two lanes of |accum| and stores the result as one pixel.
+inline void StorePixel(__m256i accum, unsigned char* out) {
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(accum),
+                              _mm256_extracti128_si256(accum, 1));
+  sum = _mm_srai_epi32(sum, ConvolutionFilter1D::kShiftBits);
+  sum = _mm_packs_epi32(sum, sum);
+  sum = _mm_packus_epi16(sum, sum);
+  *(reinterpret_cast<int*>(out)) = _mm_cvtsi128_si32(sum);
+}
+
+}  // namespace
+
+// Convolves horizontally along a single row. The row data is given in
+// |src_data| and continues for the num_values() of the filter. This does
+// the work of ConvolveHorizontally_SSE2 for four coefficients at a time.
+void ConvolveHorizontally_AVX2(const unsigned char* src_data,
+                               const ConvolutionFilter1D& filter,
+                               unsigned char* out_row,
+                               bool /*has_alpha*/) {
+  int num_values = filter.num_values();
+  int filter_offset, filter_length;
+  // |mask| clears the coefficients loaded past the end of a filter whose
+  // length is not divisible by 4. mask[0] keeps all four.
+  __m128i mask[4];
+  mask[0] = _mm_set_epi16(0, 0, 0, 0, -1, -1, -1, -1);
+  mask[1] = _mm_set_epi16(0, 0, 0, 0, 0, 0, 0, -1);
+  mask[2] = _mm_set_epi16(0, 0, 0, 0, 0, 0, -1, -1);
+  mask[3] = _mm_set_epi16(0, 0, 0, 0, 0, -1, -1, -1);
+
+  for (int out_x = 0; out_x < num_values; out_x++) {
+    const ConvolutionFilter1D::Fixed* filter_values =
+        filter.FilterForValue(out_x, &filter_offset, &filter_length);
+    const unsigned char* row_to_filter = &src_data[filter_offset << 2];
+    __m256i accum = _mm256_setzero_si256();
+
+    for (int filter_x = 0; filter_x < filter_length >> 2; filter_x++) {
+      accum = AccumulateFourPixels(
+          row_to_filter, LoadCoefficients(filter_values, mask[0]), accum);
+      row_to_filter += 16;
+      filter_values += 4;
+    }
+
+    // Like the SSE2 version, this reads up to three pixels past the end of
+    // the filter, whose coefficients are masked out.
+    int r = filter_length & 3;
+    if (r) {
+      accum = AccumulateFourPixels(
+          row_to_filter, LoadCoefficients(filter_values, mask[r]), accum);
+    }
+
+    StorePixel(accum, out_row);
+    out_row += 4;
+  }
+}
+
+// Convolves horizontally along four rows, sharing the coefficients between
+// them. See ConvolveHorizontally_AVX2.
+void Convolve4RowsHorizontally_AVX2(const unsigned char* src_data[4],
+                                    const ConvolutionFilter1D& filter,
+                                    unsigned char* out_row[4]) {
+  int num_values = filter.num_values();
+  int filter_offset, filter_length;
+  __m128i mask[4];
+  mask[0] = _mm_set_epi16(0, 0, 0, 0, -1, -1, -1, -1);
+  mask[1] = _mm_set_epi16(0, 0, 0, 0, 0, 0, 0, -1);
+  mask[2] = _mm_set_epi16(0, 0, 0, 0, 0, 0, -1, -1);
+  mask[3] = _mm_set_epi16(0, 0, 0, 0, 0, -1, -1, -1);
+
+  for (int out_x = 0; out_x < num_values; out_x++) {
+    const ConvolutionFilter1D::Fixed* filter_values =
+        filter.FilterForValue(out_x, &filter_offset, &filter_length);
+    int start = filter_offset << 2;
+    __m256i accum0 = _mm256_setzero_si256();
+    __m256i accum1 = _mm256_setzero_si256();
+    __m256i accum2 = _mm256_setzero_si256();
+    __m256i accum3 = _mm256_setzero_si256();
+
+    int r = filter_length & 3;
+    int iterations = (filter_length >> 2) + (r ? 1 : 0);
+    for (int filter_x = 0; filter_x < iterations; filter_x++) {
+      __m256i coeff16 = LoadCoefficients(
+          filter_values, mask[filter_x < filter_length >> 2 ? 0 : r]);
+      accum0 = AccumulateFourPixels(src_data[0] + start, coeff16, accum0);
+      accum1 = AccumulateFourPixels(src_data[1] + start, coeff16, accum1);
+      accum2 = AccumulateFourPixels(src_data[2] + start, coeff16, accum2);
+      accum3 = AccumulateFourPixels(src_data[3] + start, coeff16, accum3);
+      start += 16;
+      filter_values += 4;
+    }
+
+    StorePixel(accum0, out_row[0]);
+    StorePixel(accum1, out_row[1]);
+    StorePixel(accum2, out_row[2]);
+    StorePixel(accum3, out_row[3]);
+    out_row[0] += 4;
+    out_row[1] += 4;
+    out_row[2] += 4;
+    out_row[3] += 4;
+  }
+}
+
+namespace {
+
+// Convolves the eight pixels starting at |out_x| of each of the
+// |filter_length| rows and returns the packed result. The unpack and pack
+// instructions work within each 128-bit lane, so the pixels come out in
+// the order they were loaded.
+template<bool has_alpha>
+inline __m256i ConvolveEightPixelsVertically(
+    const ConvolutionFilter1D::Fixed* filter_values,
+    int filter_length,
+    unsigned char* const* source_data_rows,
+    int out_x) {
+  __m256i zero = _mm256_setzero_si256();
+  __m256i accum0 = _mm256_setzero_si256();
+  __m256i accum1 = _mm256_setzero_si256();
+  __m256i accum2 = _mm256_setzero_si256();
+  __m256i accum3 = _mm256_setzero_si256();
+
+  for (int filter_y = 0; filter_y < filter_length; filter_y++) {
+    __m256i coeff16 = _mm256_set1_epi16(filter_values[filter_y]);
+    // [8] p7 p6 p5 p4 | p3 p2 p1 p0
+    __m256i src8 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(
+        &source_data_rows[filter_y][out_x << 2]));
+
+    // [16] p5 p4 | p1 p0
+    __m256i src16 = _mm256_unpacklo_epi8(src8, zero);
+    __m256i mul_hi = _mm256_mulhi_epi16(src16, coeff16);
+    __m256i mul_lo = _mm256_mullo_epi16(src16, coeff16);
+    // [32] p4 | p0
+    accum0 = _mm256_add_epi32(accum0, _mm256_unpacklo_epi16(mul_lo, mul_hi));
+    // [32] p5 | p1
+    accum1 = _mm256_add_epi32(accum1, _mm256_unpackhi_epi16(mul_lo, mul_hi));
+
+    // [16] p7 p6 | p3 p2
+    src16 = _mm256_unpackhi_epi8(src8, zero);
+    mul_hi = _mm256_mulhi_epi16(src16, coeff16);
+    mul_lo = _mm256_mullo_epi16(src16, coeff16);
+    // [32] p6 | p2
+    accum2 = _mm256_add_epi32(accum2, _mm256_unpacklo_epi16(mul_lo, mul_hi));
+    // [32] p7 | p3
+    accum3 = _mm256_add_epi32(accum3, _mm256_unpackhi_epi16(mul_lo, mul_hi));
+  }
+
+  accum0 = _mm256_srai_epi32(accum0, ConvolutionFilter1D::kShiftBits);
+  accum1 = _mm256_srai_epi32(accum1, ConvolutionFilter1D::kShiftBits);
+  accum2 = _mm256_srai_epi32(accum2, ConvolutionFilter1D::kShiftBits);
+  accum3 = _mm256_srai_epi32(accum3, ConvolutionFilter1D::kShiftBits);
+  // [16] p5 p4 | p1 p0
+  accum0 = _mm256_packs_epi32(accum0, accum1);
+  // [16] p7 p6 | p3 p2
+  accum2 = _mm256_packs_epi32(accum2, accum3);
+  // [8] p7 p6 p5 p4 | p3 p2 p1 p0
+  accum0 = _mm256_packus_epi16(accum0, accum2);
+
+  if (has_alpha) {
+    // Make sure the value of the alpha channel is at least the maximum of
+    // the color channels, as in ConvolveVertically_SSE2.
+    __m256i a = _mm256_srli_epi32(accum0, 8);
+    __m256i b = _mm256_max_epu8(a, accum0);
+    a = _mm256_srli_epi32(accum0, 16);
+    b = _mm256_max_epu8(a, b);
+    b = _mm256_slli_epi32(b, 24);
+    accum0 = _mm256_max_epu8(b, accum0);
+  } else {
+    accum0 = _mm256_or_si256(accum0, _mm256_set1_epi32(0xff000000));
+  }
+  return accum0;
+}
+
+// Does vertical convolution to produce one output row, eight pixels at a
+// time. The output must have room for |pixel_width * 4| bytes.
+template<bool has_alpha>
+void ConvolveVertically_AVX2(const ConvolutionFilter1D::Fixed* filter_values,
+                             int filter_length,
+                             unsigned char* const* source_data_rows,
+                             int pixel_width,
+                             unsigned char* out_row) {
+  int width = pixel_width & ~7;
+  for (int out_x = 0; out_x < width; out_x += 8) {
+    __m256i result = ConvolveEightPixelsVertically<has_alpha>(
+        filter_values, filter_length, source_data_rows, out_x);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out_row), result);
+    out_row += 32;
+  }
+
+  // The rows in the circular buffer are padded to a multiple of 16 pixels,
+  // so the last eight pixels can be loaded together even when the output
+  // ends before them.
+  if (pixel_width & 7) {
+    __m256i result = ConvolveEightPixelsVertically<has_alpha>(
+        filter_values, filter_length, source_data_rows, width);
+    unsigned char pixels[32];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels), result);
+    memcpy(out_row, pixels, (pixel_width & 7) * 4);
+  }
+}
+
+}  // namespace
+
+void ConvolveVertically_AVX2(const ConvolutionFilter1D::Fixed* filter_values,
+                             int filter_length,
+                             unsigned char* const* source_data_rows,
+                             int pixel_width,
+                             unsigned char* out_row,
+                             bool has_alpha) {
+  if (has_alpha) {
+    ConvolveVertically_AVX2<true>(filter_values,
+                                  filter_length,
+                                  source_data_rows,
+                                  pixel_width,
+                                  out_row);
+  } else {
+    ConvolveVertically_AVX2<false>(filter_values,
+                                   filter_length,
+                                   source_data_rows,
+                                   pixel_width,
+                                   out_row);
+  }
+}
+
+}  // namespace skia
+
+#endif  // defined(SIMD_AVX2)
@@ -9,9 +9,12 @@
 #include <vector>
 
 #include "base/basictypes.h"
+#include "base/cpu.h"
 #include "base/logging.h"
 #include "base/time/time.h"
 #include "skia/ext/convolver.h"
+#include "skia/ext/convolver_SSE2.h"
+#include "skia/ext/convolver_avx2.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkColorPriv.h"
@@ -326,6 +329,153 @@ TEST(Convolver, SIMDVerification) {
   }
 }
 
+#if defined(SIMD_AVX2)
+// Checks the AVX2 procs against the SSE2 ones they replace, so that a machine
+// with AVX2 produces exactly the same pixels as one without.
+TEST(Convolver, SIMDVerificationAVX2) {
+  if (!base::CPU().has_avx2())
+    return;
+
+  int sizes[][4] = {
+    {1, 1, 1280, 1024}, {3, 5, 177, 123}, {4, 4, 480, 270},
+    {8, 8, 9, 17}, {13, 9, 7, 5},
+    {1920, 1080, 1280, 1024}, {1377, 523, 177, 123}, {325, 241, 480, 270} };
+  // Filters of 6 and 5 taps; the latter isn't a multiple of the 4 taps the
+  // horizontal procs handle per iteration.
+  float filter6[] = { 0.05f, -0.15f, 0.6f, 0.6f, -0.15f, 0.05f };
+  float filter5[] = { 0.1f, 0.2f, 0.4f, 0.2f, 0.1f };
+
+  for (size_t i = 0; i < arraysize(sizes); ++i) {
+    for (int taps = 5; taps <= 6; ++taps) {
+      int source_width = sizes[i][0];
+      int source_height = sizes[i][1];
+      int dest_width = sizes[i][2];
+      int dest_height = sizes[i][3];
+      const float* filter = taps == 5 ? filter5 : filter6;
+
+      ConvolutionFilter1D x_filter, y_filter;
+      for (int p = 0; p < dest_width; ++p) {
+        int offset = source_width * p / dest_width;
+        x_filter.AddFilter(offset, filter,
+                           std::min(taps, source_width - offset));
+      }
+      x_filter.PaddingForSIMD();
+      for (int p = 0; p < dest_height; ++p) {
+        int offset = source_height * p / dest_height;
+        y_filter.AddFilter(offset, filter,
+                           std::min(taps, source_height - offset));
+      }
+      y_filter.PaddingForSIMD();
+
+      // Source rows are padded like the ones BGRAConvolve2D hands the procs.
+      std::vector<unsigned char> source_rows[4];
+      const unsigned char* source[4];
+      for (int r = 0; r < 4; ++r) {
+        source_rows[r].resize(source_width * 4 + 64);
+        for (size_t b = 0; b < source_rows[r].size(); ++b)
+          source_rows[r][b] = rand() % 255;
+        source[r] = &source_rows[r][0];
+      }
+
+      std::vector<unsigned char> sse2_rows[4], avx2_rows[4];
+      unsigned char* sse2_out[4];
+      unsigned char* avx2_out[4];
+      for (int r = 0; r < 4; ++r) {
+        sse2_rows[r].assign(dest_width * 4, 0);
+        avx2_rows[r].assign(dest_width * 4, 1);
+        sse2_out[r] = &sse2_rows[r][0];
+        avx2_out[r] = &avx2_rows[r][0];
+      }
+      Convolve4RowsHorizontally_SSE2(source, x_filter, sse2_out);
+      Convolve4RowsHorizontally_AVX2(source, x_filter, avx2_out);
+      for (int r = 0; r < 4; ++r)
+        EXPECT_TRUE(sse2_rows[r] == avx2_rows[r]) << "4 rows, size " << i;
+
+      std::vector<unsigned char> sse2_row(dest_width * 4, 0);
+      std::vector<unsigned char> avx2_row(dest_width * 4, 1);
+      ConvolveHorizontally_SSE2(source[0], x_filter, &sse2_row[0], true);
+      ConvolveHorizontally_AVX2(source[0], x_filter, &avx2_row[0], true);
+      EXPECT_TRUE(sse2_row == avx2_row) << "horizontal, size " << i;
+
+      // The row buffer of the vertical pass is padded to 16 pixels.
+      int padded_width = (dest_width + 15) & ~15;
+      std::vector<unsigned char> vertical_rows[6];
+      unsigned char* vertical_source[6];
+      for (int r = 0; r < 6; ++r) {
+        vertical_rows[r].resize(padded_width * 4);
+        for (size_t b = 0; b < vertical_rows[r].size(); ++b)
+          vertical_rows[r][b] = rand() % 255;
+        vertical_source[r] = &vertical_rows[r][0];
+      }
+      int filter_offset, filter_length;
+      const ConvolutionFilter1D::Fixed* filter_values =
+          y_filter.FilterForValue(dest_height / 2, &filter_offset,
+                                  &filter_length);
+      for (int has_alpha = 0; has_alpha < 2; ++has_alpha) {
+        // One extra pixel catches writes past the end of the row.
+        std::vector<unsigned char> sse2_column(dest_width * 4 + 4, 9);
+        std::vector<unsigned char> avx2_column(dest_width * 4 + 4, 9);
+        ConvolveVertically_SSE2(filter_values, filter_length, vertical_source,
+                                dest_width, &sse2_column[0], has_alpha != 0);
+        ConvolveVertically_AVX2(filter_values, filter_length, vertical_source,
+                                dest_width, &avx2_column[0], has_alpha != 0);
+        EXPECT_TRUE(sse2_column == avx2_column)
+            << "vertical, size " << i << " alpha " << has_alpha;
+      }
+    }
+  }
+}
+#endif  // SIMD_AVX2
+
+TEST(Convolver, InParallelMatchesSingleThread) {
+  static const int kSourceWidth = 1021;
+  static const int kSourceHeight = 777;
+  static const int kDestWidth = 337;
+  static const int kDestHeight = 251;
+  static const float kFilter[] = { 0.1f, 0.2f, 0.4f, 0.2f, 0.1f };
+
+  ConvolutionFilter1D x_filter, y_filter;
+  for (int p = 0; p < kDestWidth; ++p) {
+    int offset = kSourceWidth * p / kDestWidth;
+    x_filter.AddFilter(offset, kFilter,
+                       std::min<int>(arraysize(kFilter),
+                                     kSourceWidth - offset));
+  }
+  x_filter.PaddingForSIMD();
+  for (int p = 0; p < kDestHeight; ++p) {
+    int offset = kSourceHeight * p / kDestHeight;
+    y_filter.AddFilter(offset, kFilter,
+                       std::min<int>(arraysize(kFilter),
+                                     kSourceHeight - offset));
+  }
+  y_filter.PaddingForSIMD();
+
+  int source_row_stride = kSourceWidth * 4;
+  std::vector<unsigned char> source(source_row_stride * kSourceHeight);
+  for (size_t i = 0; i < source.size(); ++i)
+    source[i] = rand() % 255;
+
+  int dest_row_stride = kDestWidth * 4;
+  std::vector<unsigned char> expected(dest_row_stride * kDestHeight);
+  std::vector<unsigned char> actual(dest_row_stride * kDestHeight);
+  for (int simd = 0; simd < 2; ++simd) {
+    BGRAConvolve2D(&source[0], source_row_stride, true, x_filter, y_filter,
+                   dest_row_stride, &expected[0], simd != 0);
+
+    // The odd thread counts give bands that don't divide the image evenly,
+    // and 64 threads asks for more bands than there are rows for.
+    static const int kThreadCounts[] = { 1, 2, 3, 7, 64 };
+    for (size_t i = 0; i < arraysize(kThreadCounts); ++i) {
+      std::fill(actual.begin(), actual.end(), 0);
+      BGRAConvolve2DInParallel(&source[0], source_row_stride, true,
+                               x_filter, y_filter, dest_row_stride,
+                               &actual[0], simd != 0, kThreadCounts[i]);
+      EXPECT_TRUE(expected == actual) << "simd: " << simd
+                                      << " threads: " << kThreadCounts[i];
+    }
+  }
+}
+
 TEST(Convolver, SeparableSingleConvolution) {
   static const int kImgWidth = 1024;
   static const int kImgHeight = 1024;
@@ -10,6 +10,7 @@
 #include "skia/ext/image_operations.h"
 
 // TODO(pkasting): skia/ext should not depend on base/!
+#include "base/atomicops.h"
 #include "base/containers/stack_container.h"
 #include "base/debug/trace_event.h"
 #include "base/logging.h"
@@ -332,6 +333,10 @@ ImageOperations::ResizeMethod ResizeMethodToAlgorithmMethod(
   }
 }
 
+// The number of threads that ResizeBasic convolves images on. This is atomic
+// since SetResizeThreadCount may race with resizes on other threads.
+base::subtle::Atomic32 g_resize_thread_count = 1;
+
 }  // namespace
 
 // Resize ----------------------------------------------------------------------
@@ -516,11 +521,14 @@ SkBitmap ImageOperations::ResizeBasic(const SkBitmap& source,
   if (!result.readyToDraw())
     return SkBitmap();
 
-  BGRAConvolve2D(source_subset, static_cast<int>(source.rowBytes()),
-                 !source.isOpaque(), filter.x_filter(), filter.y_filter(),
-                 static_cast<int>(result.rowBytes()),
-                 static_cast<unsigned char*>(result.getPixels()),
-                 true);
+  BGRAConvolve2DInParallel(source_subset, static_cast<int>(source.rowBytes()),
+                           !source.isOpaque(), filter.x_filter(),
+                           filter.y_filter(),
+                           static_cast<int>(result.rowBytes()),
+                           static_cast<unsigned char*>(result.getPixels()),
+                           true,
+                           base::subtle::NoBarrier_Load(
+                               &g_resize_thread_count));
 
   // Preserve the "opaque" flag for use as an optimization later.
   result.setIsOpaque(source.isOpaque());
@@ -541,4 +549,10 @@ SkBitmap ImageOperations::Resize(const SkBitmap& source,
                 allocator);
 }
 
+// static
+void ImageOperations::SetResizeThreadCount(int thread_count) {
+  DCHECK_GE(thread_count, 1);
+  base::subtle::NoBarrier_Store(&g_resize_thread_count, thread_count);
+}
+
 }  // namespace skia
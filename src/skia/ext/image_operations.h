@@ -111,6 +111,15 @@ class SK_API ImageOperations {
                          int dest_width, int dest_height,
                          SkBitmap::Allocator* allocator = NULL);
 
+  // Sets the number of threads that Resize may convolve a large image on,
+  // which is 1 by default. This is meant for processes that resize many big
+  // images, such as thumbnail generators. It may be called at any time and
+  // applies to resizes that start afterwards. The worker threads are created
+  // on first use and kept for the life of the process, and a multithreaded
+  // Resize blocks its caller, so it must only be used on threads that are
+  // allowed to wait.
+  static void SetResizeThreadCount(int thread_count);
+
  private:
   ImageOperations();  // Class for scoping only.
 
@@ -32,6 +32,10 @@ class SK_API LazyPixelRef : public SkPixelRef {
 
   // Start decoding the image.
   virtual void Decode() = 0;
+
+  // Returns the size of the decoded image, which is kept in memory for as
+  // long as the pixels are locked.
+  virtual size_t DecodedSizeInBytes() const = 0;
 };
 
 }  // namespace skia
@@ -52,9 +52,11 @@ class TestLazyPixelRef : public skia::LazyPixelRef {
   virtual SkPixelRef* deepCopy(SkBitmap::Config config, const SkIRect* subset)
       OVERRIDE;
   virtual void Decode() OVERRIDE {}
+  virtual size_t DecodedSizeInBytes() const OVERRIDE;
 
  private:
   scoped_ptr<char[]> pixels_;
+  size_t decoded_size_in_bytes_;
 };
 
 class TestLazyShader : public SkShader {
@@ -107,7 +109,8 @@ SkPixelRef* TestPixelRef::deepCopy(SkBitmap::Config config,
 }
 
 TestLazyPixelRef::TestLazyPixelRef(int width, int height)
-    : pixels_(new char[4 * width * height]) {}
+    : pixels_(new char[4 * width * height]),
+      decoded_size_in_bytes_(4 * width * height) {}
 
 TestLazyPixelRef::~TestLazyPixelRef() {}
 
@@ -125,6 +128,10 @@ bool TestLazyPixelRef::MaybeDecoded() {
   return true;
 }
 
+size_t TestLazyPixelRef::DecodedSizeInBytes() const {
+  return decoded_size_in_bytes_;
+}
+
 SkPixelRef* TestLazyPixelRef::deepCopy(SkBitmap::Config config,
                                        const SkIRect* subset) {
   this->ref();
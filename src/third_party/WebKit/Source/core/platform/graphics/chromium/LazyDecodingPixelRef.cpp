@@ -126,5 +126,11 @@ void LazyDecodingPixelRef::Decode()
     unlockPixels();
 }
 
+size_t LazyDecodingPixelRef::DecodedSizeInBytes() const
+{
+    // The whole scaled image is cached, even when only a subset is used.
+    return static_cast<size_t>(m_scaledSize.width()) * m_scaledSize.height() * 4;
+}
+
 
 } // namespace WebKit
@@ -61,6 +61,7 @@ public:
     virtual bool MaybeDecoded();
     virtual bool PrepareToDecode(const LazyPixelRef::PrepareParams&);
     virtual void Decode();
+    virtual size_t DecodedSizeInBytes() const;
 
 protected:
     // SkPixelRef implementation.
@@ -460,6 +460,25 @@ class DecompressDestroyer {
 bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
                        ColorFormat format, std::vector<unsigned char>* output,
                        int* w, int* h) {
+  return DecodeInternal(input, input_size, format, 0, 0, output, w, h);
+}
+
+bool JPEGCodec::DecodeScaled(const unsigned char* input, size_t input_size,
+                             ColorFormat format, int min_width, int min_height,
+                             std::vector<unsigned char>* output,
+                             int* w, int* h) {
+  DCHECK_GT(min_width, 0);
+  DCHECK_GT(min_height, 0);
+  return DecodeInternal(input, input_size, format, min_width, min_height,
+                        output, w, h);
+}
+
+// static
+bool JPEGCodec::DecodeInternal(const unsigned char* input, size_t input_size,
+                               ColorFormat format,
+                               int min_width, int min_height,
+                               std::vector<unsigned char>* output,
+                               int* w, int* h) {
   jpeg_decompress_struct cinfo;
   DecompressDestroyer destroyer;
   destroyer.SetManagedObject(&cinfo);
@@ -542,6 +561,21 @@ bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
   cinfo.output_components = 3;
 #endif
 
+  // Pick the largest reduction that keeps the image at least the minimum
+  // size. Scaled output only needs part of the inverse DCT of each block.
+  if (min_width > 0 && min_height > 0) {
+    for (unsigned int denom = 8; denom > 1; denom /= 2) {
+      unsigned int scaled_width = (cinfo.image_width + denom - 1) / denom;
+      unsigned int scaled_height = (cinfo.image_height + denom - 1) / denom;
+      if (scaled_width >= static_cast<unsigned int>(min_width) &&
+          scaled_height >= static_cast<unsigned int>(min_height)) {
+        cinfo.scale_num = 1;
+        cinfo.scale_denom = denom;
+        break;
+      }
+    }
+  }
+
   jpeg_calc_output_dimensions(&cinfo);
   *w = cinfo.output_width;
   *h = cinfo.output_height;
@@ -629,4 +663,28 @@ SkBitmap* JPEGCodec::Decode(const unsigned char* input, size_t input_size) {
   return bitmap;
 }
 
+// static
+SkBitmap* JPEGCodec::DecodeAndResize(const unsigned char* input,
+                                     size_t input_size,
+                                     skia::ImageOperations::ResizeMethod method,
+                                     int dest_width, int dest_height) {
+  int w, h;
+  std::vector<unsigned char> data_vector;
+  if (!DecodeScaled(input, input_size, FORMAT_SkBitmap, dest_width,
+                    dest_height, &data_vector, &w, &h))
+    return NULL;
+
+  SkBitmap decoded;
+  decoded.setConfig(SkBitmap::kARGB_8888_Config, w, h);
+  decoded.setPixels(&data_vector[0]);
+
+  SkBitmap* bitmap = new SkBitmap();
+  if (w == dest_width && h == dest_height)
+    decoded.copyTo(bitmap, SkBitmap::kARGB_8888_Config);
+  else
+    *bitmap = skia::ImageOperations::Resize(decoded, method, dest_width,
+                                            dest_height);
+  return bitmap;
+}
+
 }  // namespace gfx
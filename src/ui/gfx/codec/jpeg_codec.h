@@ -8,6 +8,7 @@
 #include <stddef.h>
 #include <vector>
 
+#include "skia/ext/image_operations.h"
 #include "ui/base/ui_export.h"
 
 class SkBitmap;
@@ -72,6 +73,31 @@ class UI_EXPORT JPEGCodec {
   // successful, a SkBitmap is created and returned. It is up to the caller
   // to delete the returned bitmap.
   static SkBitmap* Decode(const unsigned char* input, size_t input_size);
+
+  // Like Decode(), but for images that will be scaled down: the JPEG
+  // library can skip most of the work of decoding by producing the image at
+  // 1/2, 1/4 or 1/8 of its size. The smallest of these sizes that is still
+  // at least |min_width| x |min_height| is used, and returned in *w and *h.
+  static bool DecodeScaled(const unsigned char* input, size_t input_size,
+                           ColorFormat format, int min_width, int min_height,
+                           std::vector<unsigned char>* output, int* w, int* h);
+
+  // Decodes the JPEG data and resizes it to |dest_width| x |dest_height|
+  // with |method|, decoding at a reduced size first when possible. If
+  // successful, a SkBitmap is created and returned. It is up to the caller
+  // to delete the returned bitmap.
+  static SkBitmap* DecodeAndResize(const unsigned char* input,
+                                   size_t input_size,
+                                   skia::ImageOperations::ResizeMethod method,
+                                   int dest_width, int dest_height);
+
+ private:
+  // Decodes at full size when |min_width| and |min_height| are 0.
+  static bool DecodeInternal(const unsigned char* input, size_t input_size,
+                             ColorFormat format,
+                             int min_width, int min_height,
+                             std::vector<unsigned char>* output,
+                             int* w, int* h);
 };
 
 }  // namespace gfx
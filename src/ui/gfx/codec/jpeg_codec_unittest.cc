@@ -5,7 +5,9 @@
 #include <math.h>
 
 #include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
 #include "ui/gfx/codec/jpeg_codec.h"
 
 namespace {
@@ -98,6 +100,43 @@ static void MakeRGBImage(int w, int h, std::vector<unsigned char>* dat) {
   }
 }
 
+// Makes an image that is smooth enough for a reduced size decode to match
+// averaging blocks of pixels.
+static void MakeGradientRGBImage(int w, int h,
+                                 std::vector<unsigned char>* dat) {
+  dat->resize(w * h * 3);
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      unsigned char* org_px = &(*dat)[(y * w + x) * 3];
+      org_px[0] = x * 255 / (w - 1);            // r
+      org_px[1] = y * 255 / (h - 1);            // g
+      org_px[2] = (org_px[0] + org_px[1]) / 2;  // b
+    }
+  }
+}
+
+// Averages blocks of |scale| x |scale| RGB pixels.
+static void ScaleDownRGBImage(const std::vector<unsigned char>& dat,
+                              int w, int h, int scale,
+                              std::vector<unsigned char>* scaled) {
+  int scaled_w = w / scale;
+  int scaled_h = h / scale;
+  scaled->resize(scaled_w * scaled_h * 3);
+  for (int y = 0; y < scaled_h; y++) {
+    for (int x = 0; x < scaled_w; x++) {
+      for (int c = 0; c < 3; c++) {
+        int sum = 0;
+        for (int j = 0; j < scale; j++) {
+          for (int i = 0; i < scale; i++)
+            sum += dat[((y * scale + j) * w + x * scale + i) * 3 + c];
+        }
+        (*scaled)[(y * scaled_w + x) * 3 + c] =
+            (sum + scale * scale / 2) / (scale * scale);
+      }
+    }
+  }
+}
+
 TEST(JPEGCodec, EncodeDecodeRGB) {
   int w = 20, h = 20;
 
@@ -164,6 +203,72 @@ TEST(JPEGCodec, EncodeDecodeRGBA) {
   ASSERT_GE(jpeg_equality_threshold, AveragePixelDelta(original, decoded));
 }
 
+TEST(JPEGCodec, DecodeScaled) {
+  int w = 256, h = 256;
+  std::vector<unsigned char> original;
+  MakeGradientRGBImage(w, h, &original);
+  std::vector<unsigned char> encoded;
+  EXPECT_TRUE(JPEGCodec::Encode(&original[0], JPEGCodec::FORMAT_RGB, w, h,
+                                w * 3, jpeg_quality, &encoded));
+
+  // The smallest reduction that is at least the minimum size is used.
+  std::vector<unsigned char> decoded;
+  int outw, outh;
+  EXPECT_TRUE(JPEGCodec::DecodeScaled(&encoded[0], encoded.size(),
+                                      JPEGCodec::FORMAT_RGB, 60, 40,
+                                      &decoded, &outw, &outh));
+  EXPECT_EQ(64, outw);
+  EXPECT_EQ(64, outh);
+  std::vector<unsigned char> expected;
+  ScaleDownRGBImage(original, w, h, 4, &expected);
+  ASSERT_GE(jpeg_equality_threshold, AveragePixelDelta(expected, decoded));
+
+  EXPECT_TRUE(JPEGCodec::DecodeScaled(&encoded[0], encoded.size(),
+                                      JPEGCodec::FORMAT_RGB, 20, 32,
+                                      &decoded, &outw, &outh));
+  EXPECT_EQ(32, outw);
+  EXPECT_EQ(32, outh);
+  ScaleDownRGBImage(original, w, h, 8, &expected);
+  ASSERT_GE(jpeg_equality_threshold, AveragePixelDelta(expected, decoded));
+
+  // No reduction keeps the image large enough.
+  EXPECT_TRUE(JPEGCodec::DecodeScaled(&encoded[0], encoded.size(),
+                                      JPEGCodec::FORMAT_RGB, 200, 100,
+                                      &decoded, &outw, &outh));
+  EXPECT_EQ(w, outw);
+  EXPECT_EQ(h, outh);
+  ASSERT_GE(jpeg_equality_threshold, AveragePixelDelta(original, decoded));
+}
+
+TEST(JPEGCodec, DecodeAndResize) {
+  int w = 256, h = 256;
+  std::vector<unsigned char> original;
+  MakeGradientRGBImage(w, h, &original);
+  std::vector<unsigned char> encoded;
+  EXPECT_TRUE(JPEGCodec::Encode(&original[0], JPEGCodec::FORMAT_RGB, w, h,
+                                w * 3, jpeg_quality, &encoded));
+
+  // Decoded at 1/4 size, then resized.
+  scoped_ptr<SkBitmap> bitmap(JPEGCodec::DecodeAndResize(
+      &encoded[0], encoded.size(), skia::ImageOperations::RESIZE_LANCZOS3,
+      48, 48));
+  ASSERT_TRUE(bitmap.get());
+  EXPECT_EQ(48, bitmap->width());
+  EXPECT_EQ(48, bitmap->height());
+
+  // Decoded right at the destination size.
+  bitmap.reset(JPEGCodec::DecodeAndResize(
+      &encoded[0], encoded.size(), skia::ImageOperations::RESIZE_LANCZOS3,
+      32, 32));
+  ASSERT_TRUE(bitmap.get());
+  EXPECT_EQ(32, bitmap->width());
+  EXPECT_EQ(32, bitmap->height());
+  SkAutoLockPixels lock(*bitmap);
+  SkColor color = bitmap->getColor(31, 0);
+  EXPECT_NEAR(251, SkColorGetR(color), 3);
+  EXPECT_NEAR(3, SkColorGetG(color), 3);
+}
+
 // Test that corrupted data decompression causes failures.
 TEST(JPEGCodec, DecodeCorrupted) {
   int w = 20, h = 20;